@@ -0,0 +1,251 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// -----------------------------------------------------------------------------
+//                            Allocation counting
+// -----------------------------------------------------------------------------
+
+// The bench binary is linked with --wrap for each of these, so every
+// allocation made by the library ends up here first. The count is per thread
+// so that threaded suites neither race on it nor pay for atomics.
+
+_Thread_local unsigned long bench_allocs;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    bench_allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    bench_allocs++;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    bench_allocs++;
+    return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size) {
+    bench_allocs++;
+    return __real_aligned_alloc(alignment, size);
+}
+
+// -----------------------------------------------------------------------------
+//                                  Harness
+// -----------------------------------------------------------------------------
+
+// The cheapest back to back pair of clock reads, taken off every latency sample
+static uint64_t bench_overhead;
+
+uint64_t bench_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+size_t bench_heap_bytes(void) {
+#if defined(__GLIBC__) \
+    && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+int bench_selected(const struct bench_config *cfg, const char *structure) {
+    return cfg->filter == NULL || strstr(structure, cfg->filter) != NULL;
+}
+
+static int bench_cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static uint64_t bench_percentile(const uint64_t *sorted, long n, double p) {
+    long i;
+
+    if (n == 0)
+        return 0;
+    i = (long)(p * (double)(n - 1) + 0.5);
+    return sorted[i];
+}
+
+void bench_report(const char *structure, const char *op, long size,
+                  int threads, long ops, uint64_t total_ns,
+                  unsigned long allocs, uint64_t *samples, long nsamples) {
+    if (nsamples > 0)
+        qsort(samples, (size_t)nsamples, sizeof(uint64_t), bench_cmp_u64);
+
+    printf("%s,%s,%ld,%d,%ld,%.2f,%.3f,%llu,%llu,%llu,%llu,\n",
+           structure, op, size, threads, ops,
+           ops ? (double)total_ns / (double)ops : 0.0,
+           ops ? (double)allocs / (double)ops : 0.0,
+           (unsigned long long)bench_percentile(samples, nsamples, 0.50),
+           (unsigned long long)bench_percentile(samples, nsamples, 0.90),
+           (unsigned long long)bench_percentile(samples, nsamples, 0.99),
+           (unsigned long long)bench_percentile(samples, nsamples, 0.999));
+    fflush(stdout);
+}
+
+void bench_report_bytes(const char *structure, long size, size_t before) {
+    size_t after = bench_heap_bytes();
+
+    printf("%s,footprint,%ld,1,%ld,,,,,,,", structure, size, size);
+    if (after != 0)
+        printf("%.1f", after > before
+               ? (double)(after - before) / (double)size : 0.0);
+    printf("\n");
+    fflush(stdout);
+}
+
+void bench_run_op(const char *structure, const struct bench_op *op,
+                  void *ctx, long size) {
+    long total = BENCH_OPS, batch, nsamples, n, k;
+    uint64_t ns = 0, start, *samples;
+    unsigned long allocs = 0, before;
+
+    if (op->linear || op->per_elem) {
+        total = BENCH_WORK / size;
+        if (total > BENCH_OPS)
+            total = BENCH_OPS;
+        if (total < 1)
+            total = 1;
+    }
+    // Removals must never empty the structure mid-batch
+    batch = op->per_elem ? 1 : size / 2;
+    if (batch > BENCH_BATCH)
+        batch = BENCH_BATCH;
+    if (batch > total)
+        batch = total;
+    if (batch < 1)
+        batch = 1;
+
+    // Warm up caches and the allocator before anything is timed
+    op->run(ctx, batch);
+    if (op->undo)
+        op->undo(ctx, batch);
+
+    for (long done = 0; done < total; done += n) {
+        n = total - done < batch ? total - done : batch;
+        before = bench_allocs;
+        start = bench_now();
+        op->run(ctx, n);
+        ns += bench_now() - start;
+        allocs += bench_allocs - before;
+        if (op->undo)
+            op->undo(ctx, n);
+    }
+
+    // Batch operations are sampled a batch at a time, within the same bound
+    // that keeps removals from emptying the structure
+    k = op->sample_ops > 1 ? op->sample_ops : 1;
+    if (k > batch)
+        k = batch;
+    nsamples = total / k < BENCH_SAMPLES ? total / k : BENCH_SAMPLES;
+    samples = malloc((size_t)nsamples * sizeof(uint64_t));
+    if (samples == NULL)
+        nsamples = 0;
+    for (long i = 0; i < nsamples; ++i) {
+        start = bench_now();
+        op->run(ctx, k);
+        samples[i] = bench_now() - start;
+        samples[i] -= samples[i] < bench_overhead ? samples[i] : bench_overhead;
+        if (op->per_elem)
+            samples[i] /= (uint64_t)size;
+        samples[i] /= (uint64_t)k;
+        if (op->undo)
+            op->undo(ctx, k);
+    }
+
+    if (op->per_elem)
+        total *= size;
+    bench_report(structure, op->name, size, 1, total, ns, allocs,
+                 samples, nsamples);
+    free(samples);
+}
+
+// -----------------------------------------------------------------------------
+//                                    Main
+// -----------------------------------------------------------------------------
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-n min_size] [-N max_size] [-t max_threads] [filter]\n"
+            "Sizes step by powers of ten. Only structures whose name contains\n"
+            "filter are run. Results are written to stdout as CSV.\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    struct bench_config cfg = { 10, 10000000, 2, NULL };
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t start;
+
+    if (cpus > cfg.max_threads)
+        cfg.max_threads = (int)cpus;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            cfg.min_size = atol(argv[++i]);
+        else if (strcmp(argv[i], "-N") == 0 && i + 1 < argc)
+            cfg.max_size = atol(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            cfg.max_threads = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && cfg.filter == NULL)
+            cfg.filter = argv[i];
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (cfg.min_size < 2 || cfg.max_size < cfg.min_size
+        || cfg.max_threads < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    bench_overhead = UINT64_MAX;
+    for (int i = 0; i < 1000; ++i) {
+        start = bench_now();
+        start = bench_now() - start;
+        if (start < bench_overhead)
+            bench_overhead = start;
+    }
+    printf("# timer overhead %llu ns\n", (unsigned long long)bench_overhead);
+    printf("structure,operation,size,threads,ops,ns_per_op,allocs_per_op,"
+           "p50_ns,p90_ns,p99_ns,p999_ns,bytes_per_elem\n");
+
+    bench_lists(&cfg);
+    bench_mpmcq(&cfg);
+    bench_hasht(&cfg);
+    bench_heap(&cfg);
+    bench_bptree(&cfg);
+    bench_skiplist(&cfg);
+    bench_stack(&cfg);
+    bench_spscq(&cfg);
+    bench_tsdlist(&cfg);
+    bench_parallel(&cfg);
+    bench_prefetch(&cfg);
+    bench_listio(&cfg);
+    bench_adlist(&cfg);
+    bench_xlist(&cfg);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    bench.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// Shared harness for the micro-benchmarks built by "make bench". Every suite
+/// reports one CSV row per measurement through bench_report, or
+/// bench_report_bytes for memory footprints, so results from different runs
+/// and builds can be compared mechanically.
+///
+/// A row is keyed by its structure, operation, size and threads, and no key
+/// appears twice in a run. Variants of a structure are named structure/variant,
+/// as in "list/pool" or "cdlist/mutex". A structure measured only as a
+/// baseline inside another structure's suite, where its rows would repeat keys
+/// reported elsewhere, has the suite's name added after an @, as in
+/// "dlist@xlist".
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// The number of operations timed per measurement of a constant time operation
+#define BENCH_OPS 100000
+
+/// The number of element visits a linear operation may spend per measurement
+#define BENCH_WORK 100000000
+
+/// The most operations run back to back between two undo calls
+#define BENCH_BATCH 1000
+
+/// The most operations timed individually for the latency percentiles
+#define BENCH_SAMPLES 10000
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// One operation under test. run performs k operations on ctx and is timed;
+/// undo, if not NULL, restores ctx to its previous size afterwards untimed.
+/// Operations whose cost grows with the size of the structure set linear, so
+/// that fewer of them are run at large sizes. Operations that visit every
+/// element once per call, such as for_each, set per_elem and are reported per
+/// element visited. Operations that work on batches, such as ins_tail_n, set
+/// sample_ops to the size of a batch, so that each latency sample times a
+/// whole batch and is divided by it, as the mean is; 0 samples one at a time.
+struct bench_op {
+    const char *name;
+    void (*run)(void *ctx, long k);
+    /*@null@*/ void (*undo)(void *ctx, long k);
+    int linear;
+    int per_elem;
+    int sample_ops;
+};
+
+/// Settings shared by every suite, taken from the command line
+struct bench_config {
+    long min_size;
+    long max_size;
+    int max_threads;
+    /*@null@*/ const char *filter;
+};
+
+// -----------------------------------------------------------------------------
+//                                  Harness
+// -----------------------------------------------------------------------------
+
+/// The number of calls made to malloc, calloc and realloc so far by the calling
+/// thread. Maintained by the allocator wrappers the bench binary is linked with.
+extern _Thread_local unsigned long bench_allocs;
+
+/// Returns a monotonic timestamp in nanoseconds
+uint64_t bench_now(void);
+
+/// Returns the number of bytes the allocator has handed out and not had back,
+/// allocator overheads included, or 0 where the C library cannot say
+size_t bench_heap_bytes(void);
+
+/// Determine whether a structure was selected by the command line filter
+///
+/// @return 1 if the structure should be benchmarked, else 0
+int bench_selected(const struct bench_config *cfg, const char *structure);
+
+/// Prints one result row. samples holds nsamples individually timed
+/// operations and is sorted in place to compute the latency percentiles; it may
+/// be NULL if nsamples is 0.
+///
+/// @param structure The structure measured, e.g. "cdlist"
+/// @param op The operation measured, e.g. "ins_tail"
+/// @param size The number of elements in the structure
+/// @param threads The number of threads taking part
+/// @param ops The number of operations timed in total_ns
+/// @param total_ns The wall clock time taken by all ops
+/// @param allocs The number of allocations made during the timed run
+/// @param samples Individually timed operations, in nanoseconds
+/// @param nsamples The number of samples
+void bench_report(const char *structure, const char *op, long size,
+                  int threads, long ops, uint64_t total_ns,
+                  unsigned long allocs, uint64_t *samples, long nsamples);
+
+/// Prints one footprint row, with operation "footprint": the bytes per element
+/// the heap has grown by since before was read from bench_heap_bytes. A heap
+/// that did not grow gives 0, and one whose size the C library cannot report
+/// leaves the column empty, so the row is printed either way.
+///
+/// @param structure The structure measured, e.g. "cdlist"
+/// @param size The number of elements built since before was read
+/// @param before What bench_heap_bytes returned before building
+void bench_report_bytes(const char *structure, long size, size_t before);
+
+/// Measures one operation and reports it. A batched pass over many operations
+/// gives throughput and allocations per operation, then a second pass times up
+/// to BENCH_SAMPLES operations individually for the latency percentiles.
+///
+/// @param structure The structure measured, e.g. "cdlist"
+/// @param op The operation to measure
+/// @param ctx The structure instance, passed through to op
+/// @param size The number of elements in ctx
+void bench_run_op(const char *structure, const struct bench_op *op,
+                  void *ctx, long size);
+
+// -----------------------------------------------------------------------------
+//                                   Suites
+// -----------------------------------------------------------------------------
+
+void bench_lists(const struct bench_config *cfg);
+void bench_mpmcq(const struct bench_config *cfg);
+void bench_hasht(const struct bench_config *cfg);
+void bench_heap(const struct bench_config *cfg);
+void bench_bptree(const struct bench_config *cfg);
+void bench_skiplist(const struct bench_config *cfg);
+void bench_stack(const struct bench_config *cfg);
+void bench_spscq(const struct bench_config *cfg);
+void bench_tsdlist(const struct bench_config *cfg);
+void bench_parallel(const struct bench_config *cfg);
+void bench_prefetch(const struct bench_config *cfg);
+void bench_listio(const struct bench_config *cfg);
+void bench_adlist(const struct bench_config *cfg);
+void bench_xlist(const struct bench_config *cfg);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // BENCH_H
@@ -0,0 +1,171 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "adlist.h"
+#include "bench.h"
+#include "dlist.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Short lists are walked repeatedly so that each timing covers at least this
+// many elements
+#define ADLIST_BENCH_MIN_OPS 1000000L
+
+static uint64_t adlist_bench_state = 0x9e3779b97f4a7c15ULL;
+
+static long adlist_bench_rand(long n) {
+    adlist_bench_state ^= adlist_bench_state << 13;
+    adlist_bench_state ^= adlist_bench_state >> 7;
+    adlist_bench_state ^= adlist_bench_state << 17;
+    return (long)(adlist_bench_state % (uint64_t)n);
+}
+
+static uint64_t dlist_sum(struct dlist *dlist) {
+    uint64_t sum = 0;
+
+    dlist_for_each(dlist, elem)
+        sum += (uintptr_t)elem->data;
+    return sum;
+}
+
+static uint64_t adlist_sum(struct adlist *adlist) {
+    uint64_t sum = 0;
+
+    adlist_for_each(adlist, elem)
+        sum += (uintptr_t)elem->data;
+    return sum;
+}
+
+// Times enough walks with sum to cover ADLIST_BENCH_MIN_OPS elements
+static void run_walk(const char *structure, const char *op, void *l,
+                     long size, uint64_t (*sum)(void *l)) {
+    long passes = ADLIST_BENCH_MIN_OPS / size > 0
+                  ? ADLIST_BENCH_MIN_OPS / size : 1;
+    uint64_t start, total = 0;
+
+    start = bench_now();
+    for (long i = 0; i < passes; ++i)
+        total += sum(l);
+    bench_report(structure, op, size, 1, size * passes, bench_now() - start,
+                 0, NULL, 0);
+    if (total == 1)
+        printf("# unlikely sum\n");
+}
+
+static uint64_t dlist_run_sum(void *l) {
+    return dlist_sum(l);
+}
+
+static uint64_t adlist_run_sum(void *l) {
+    return adlist_sum(l);
+}
+
+// Builds a dlist, measures it, then churns it: size times a random element is
+// removed and a new one inserted after another random element, scattering
+// the list across memory as long-lived lists are
+static void bench_dlist_side(long size, struct dlist_elem **handles) {
+    struct dlist dlist;
+    unsigned long before;
+    size_t heap;
+    uint64_t start;
+    long p, q;
+
+    heap = bench_heap_bytes();
+    dlist_init(&dlist);
+    before = bench_allocs;
+    start = bench_now();
+    for (long i = 0; i < size; ++i)
+        dlist_ins_tail(&dlist, (void *)(uintptr_t)i);
+    bench_report("dlist@adlist", "ins_tail", size, 1, size,
+                 bench_now() - start, bench_allocs - before, NULL, 0);
+    bench_report_bytes("dlist@adlist", size, heap);
+    run_walk("dlist@adlist", "for_each", &dlist, size, dlist_run_sum);
+
+    p = 0;
+    dlist_for_each(&dlist, elem)
+        handles[p++] = elem;
+    for (long i = 0; i < size; ++i) {
+        p = adlist_bench_rand(size);
+        do
+            q = adlist_bench_rand(size);
+        while (q == p);
+        dlist_rem_elem(&dlist, handles[p], NULL);
+        dlist_ins_next(&dlist, handles[q], (void *)(uintptr_t)i);
+        handles[p] = handles[q]->next;
+    }
+    run_walk("dlist@adlist", "for_each_churned", &dlist, size,
+             dlist_run_sum);
+    dlist_destroy(&dlist, NULL);
+}
+
+static void bench_adlist_side(long size, uint32_t *handles) {
+    struct adlist adlist;
+    unsigned long before;
+    size_t heap;
+    uint64_t start;
+    long p, q;
+
+    heap = bench_heap_bytes();
+    adlist_init(&adlist);
+    before = bench_allocs;
+    start = bench_now();
+    for (long i = 0; i < size; ++i)
+        adlist_ins_tail(&adlist, (void *)(uintptr_t)i);
+    bench_report("adlist", "ins_tail", size, 1, size, bench_now() - start,
+                 bench_allocs - before, NULL, 0);
+    bench_report_bytes("adlist", size, heap);
+    run_walk("adlist", "for_each", &adlist, size, adlist_run_sum);
+
+    p = 0;
+    adlist_for_each(&adlist, elem)
+        handles[p++] = adlist_index(&adlist, elem);
+    for (long i = 0; i < size; ++i) {
+        p = adlist_bench_rand(size);
+        do
+            q = adlist_bench_rand(size);
+        while (q == p);
+        adlist_rem_elem(&adlist, handles[p], NULL);
+        adlist_ins_next(&adlist, handles[q], (void *)(uintptr_t)i);
+        handles[p] = adlist_at(&adlist, handles[q])->next;
+    }
+    run_walk("adlist", "for_each_churned", &adlist, size, adlist_run_sum);
+
+    start = bench_now();
+    adlist_compact(&adlist);
+    bench_report("adlist", "compact", size, 1, size, bench_now() - start,
+                 0, NULL, 0);
+    run_walk("adlist", "for_each_compacted", &adlist, size, adlist_run_sum);
+    adlist_destroy(&adlist, NULL);
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+// The dlist rows carry the suite's name, as bench_lists already reports plain
+// dlist ins_tail and for_each
+void bench_adlist(const struct bench_config *cfg) {
+    struct dlist_elem **dlist_handles;
+    uint32_t *adlist_handles;
+
+    for (long size = cfg->min_size; size <= cfg->max_size; size *= 10) {
+        if (bench_selected(cfg, "dlist@adlist")) {
+            dlist_handles = malloc((size_t)size * sizeof(*dlist_handles));
+            if (dlist_handles == NULL)
+                break;
+            bench_dlist_side(size, dlist_handles);
+            free(dlist_handles);
+        }
+        if (bench_selected(cfg, "adlist")) {
+            adlist_handles = malloc((size_t)size * sizeof(*adlist_handles));
+            if (adlist_handles == NULL)
+                break;
+            bench_adlist_side(size, adlist_handles);
+            free(adlist_handles);
+        }
+    }
+}
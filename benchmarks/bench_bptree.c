@@ -0,0 +1,182 @@
+#include "bench.h"
+#include "bptree.h"
+#include "dlist.h"
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Present keys are odd and absent keys even, as in bench_hasht.c
+#define key_hit(i) ((void *)(uintptr_t)(2 * (i) + 1))
+#define key_miss(i) ((void *)(uintptr_t)(2 * (i) + 2))
+
+// The number of entries visited by each range scan
+#define RANGE_LEN 100
+
+struct ordered_bench {
+    struct bptree tree;
+    struct dlist dlist;
+    long size;
+    long cursor;
+    long first;
+};
+
+static volatile uintptr_t sink;
+
+static int key_cmp(const void *a, const void *b) {
+    return ((uintptr_t)a > (uintptr_t)b) - ((uintptr_t)a < (uintptr_t)b);
+}
+
+static long next_index(struct ordered_bench *b) {
+    b->cursor = (b->cursor + 7919) % b->size;
+    return b->cursor;
+}
+
+static void bptree_b_get_hit(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)bptree_get(&b->tree, key_hit(next_index(b)));
+}
+
+static void bptree_b_get_miss(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)bptree_get(&b->tree, key_miss(next_index(b)));
+}
+
+// Inserts absent keys between present ones, removed again by the undo
+static void bptree_b_ins(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    b->first = next_index(b);
+    for (long i = 0; i < k; ++i)
+        bptree_ins(&b->tree, key_miss((b->first + i) % b->size), NULL);
+}
+
+static void bptree_b_ins_undo(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        bptree_rem(&b->tree, key_miss((b->first + i) % b->size), NULL);
+}
+
+static void bptree_b_rem(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    b->first = next_index(b);
+    for (long i = 0; i < k; ++i)
+        bptree_rem(&b->tree, key_hit((b->first + i) % b->size), NULL);
+}
+
+static void bptree_b_rem_undo(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        bptree_ins(&b->tree, key_hit((b->first + i) % b->size), NULL);
+}
+
+static void bptree_b_range(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+    long lo;
+
+    while (k--) {
+        lo = next_index(b);
+        bptree_for_each_range(&b->tree, key_hit(lo),
+                              key_hit(lo + RANGE_LEN), cur)
+            sink ^= (uintptr_t)cur.entry->key;
+    }
+}
+
+static void bptree_b_for_each(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    while (k--)
+        bptree_for_each(&b->tree, cur)
+            sink ^= (uintptr_t)cur.entry->key;
+}
+
+// The baseline: the first element at or after a key in a sorted dlist
+/*@null@*/
+static struct dlist_elem* dlist_seek(struct dlist *dlist, void *key) {
+    dlist_for_each(dlist, elem)
+        if ((uintptr_t)elem->data >= (uintptr_t)key)
+            return elem;
+    return NULL;
+}
+
+static void dlist_b_get_hit(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)dlist_seek(&b->dlist, key_hit(next_index(b)));
+}
+
+static void dlist_b_get_miss(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)dlist_seek(&b->dlist, key_miss(next_index(b)));
+}
+
+static void dlist_b_range(void *ctx, long k) {
+    struct ordered_bench *b = ctx;
+    struct dlist_elem *elem;
+    uintptr_t hi;
+    long lo;
+
+    while (k--) {
+        lo = next_index(b);
+        hi = (uintptr_t)key_hit(lo + RANGE_LEN);
+        for (elem = dlist_seek(&b->dlist, key_hit(lo));
+             elem && (uintptr_t)elem->data < hi;
+             elem = elem->next)
+            sink ^= (uintptr_t)elem->data;
+    }
+}
+
+static const struct bench_op bptree_ops[] = {
+    { "get_hit", bptree_b_get_hit, NULL, 0, 0 },
+    { "get_miss", bptree_b_get_miss, NULL, 0, 0 },
+    { "ins", bptree_b_ins, bptree_b_ins_undo, 0, 0 },
+    { "rem", bptree_b_rem, bptree_b_rem_undo, 0, 0 },
+    { "range", bptree_b_range, NULL, 0, 0 },
+    { "for_each", bptree_b_for_each, NULL, 0, 1 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op dlist_scan_ops[] = {
+    { "get_hit", dlist_b_get_hit, NULL, 1, 0 },
+    { "get_miss", dlist_b_get_miss, NULL, 1, 0 },
+    { "range", dlist_b_range, NULL, 1, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_bptree(const struct bench_config *cfg) {
+    struct ordered_bench b;
+
+    for (long n = cfg->min_size; n <= cfg->max_size; n *= 10) {
+        b.size = n;
+        b.cursor = 0;
+        dlist_init(&b.dlist);
+        for (long i = n - 1; i >= 0; --i)
+            dlist_ins_head(&b.dlist, key_hit(i));
+        if (bench_selected(cfg, "bptree")) {
+            bptree_init(&b.tree, key_cmp);
+            bptree_load_dlist(&b.tree, &b.dlist, NULL);
+            for (const struct bench_op *op = bptree_ops; op->name; ++op)
+                bench_run_op("bptree", op, &b, n);
+            bptree_destroy(&b.tree, NULL);
+        }
+        if (bench_selected(cfg, "dlist/scan"))
+            for (const struct bench_op *op = dlist_scan_ops; op->name; ++op)
+                bench_run_op("dlist/scan", op, &b, n);
+        dlist_destroy(&b.dlist, NULL);
+    }
+}
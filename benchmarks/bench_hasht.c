@@ -0,0 +1,241 @@
+#include "bench.h"
+#include "chasht.h"
+#include "hash.h"
+#include "list.h"
+#include "oahasht.h"
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Present keys are odd and absent keys even, so misses cost a real probe
+#define key_hit(i) ((void *)(uintptr_t)(2 * (i) + 1))
+#define key_miss(i) ((void *)(uintptr_t)(2 * (i) + 2))
+
+struct lookup_bench {
+    struct oahasht table;
+    struct chasht chained;
+    struct list list;
+    long size;
+    long cursor;
+    long first;
+    long grown;
+};
+
+static volatile uintptr_t sink;
+
+// Visits keys in a scattered order so lookups do not walk memory in sequence
+static long next_index(struct lookup_bench *b) {
+    b->cursor = (b->cursor + 7919) % b->size;
+    return b->cursor;
+}
+
+static void oahasht_b_get_hit(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)oahasht_get(&b->table, key_hit(next_index(b)));
+}
+
+static void oahasht_b_get_miss(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)oahasht_get(&b->table, key_miss(next_index(b)));
+}
+
+// Inserts keys past the end of the present range, removed again by the undo
+static void oahasht_b_ins(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        oahasht_ins(&b->table, key_hit(b->size + i), NULL);
+}
+
+static void oahasht_b_ins_undo(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        oahasht_rem(&b->table, key_hit(b->size + i), NULL);
+}
+
+// Removes a run of present keys, put back by the undo
+static void oahasht_b_rem(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    b->first = next_index(b);
+    for (long i = 0; i < k; ++i)
+        oahasht_rem(&b->table, key_hit((b->first + i) % b->size), NULL);
+}
+
+static void oahasht_b_rem_undo(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        oahasht_ins(&b->table, key_hit((b->first + i) % b->size), NULL);
+}
+
+static void oahasht_b_for_each(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        oahasht_for_each(&b->table, slot)
+            sink ^= (uintptr_t)slot->key;
+}
+
+// Inserts fresh keys and never removes them, so the table grows through the
+// run and the percentiles show what each resize costs
+static void oahasht_b_ins_grow(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        oahasht_ins(&b->table, key_miss(b->grown++), NULL);
+}
+
+static void chasht_b_get_hit(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)chasht_get(&b->chained, key_hit(next_index(b)));
+}
+
+static void chasht_b_get_miss(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)chasht_get(&b->chained, key_miss(next_index(b)));
+}
+
+static void chasht_b_ins(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        chasht_ins(&b->chained, key_hit(b->size + i), NULL);
+}
+
+static void chasht_b_ins_undo(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        chasht_rem(&b->chained, key_hit(b->size + i), NULL);
+}
+
+static void chasht_b_rem(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    b->first = next_index(b);
+    for (long i = 0; i < k; ++i)
+        chasht_rem(&b->chained, key_hit((b->first + i) % b->size), NULL);
+}
+
+static void chasht_b_rem_undo(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        chasht_ins(&b->chained, key_hit((b->first + i) % b->size), NULL);
+}
+
+static void chasht_b_for_each(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        chasht_for_each(&b->chained, entry)
+            sink ^= (uintptr_t)entry->key;
+}
+
+static void chasht_b_ins_grow(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        chasht_ins(&b->chained, key_miss(b->grown++), NULL);
+}
+
+// The baseline: finding a key by scanning a list
+static void list_scan(struct list *list, void *key) {
+    list_for_each(list, elem) {
+        if (elem->data == key) {
+            sink ^= (uintptr_t)elem;
+            return;
+        }
+    }
+}
+
+static void list_b_get_hit(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        list_scan(&b->list, key_hit(next_index(b)));
+}
+
+static void list_b_get_miss(void *ctx, long k) {
+    struct lookup_bench *b = ctx;
+
+    while (k--)
+        list_scan(&b->list, key_miss(next_index(b)));
+}
+
+static const struct bench_op oahasht_ops[] = {
+    { "get_hit", oahasht_b_get_hit, NULL, 0, 0 },
+    { "get_miss", oahasht_b_get_miss, NULL, 0, 0 },
+    { "ins", oahasht_b_ins, oahasht_b_ins_undo, 0, 0 },
+    { "rem", oahasht_b_rem, oahasht_b_rem_undo, 0, 0 },
+    { "for_each", oahasht_b_for_each, NULL, 0, 1 },
+    { "ins_grow", oahasht_b_ins_grow, NULL, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op chasht_ops[] = {
+    { "get_hit", chasht_b_get_hit, NULL, 0, 0 },
+    { "get_miss", chasht_b_get_miss, NULL, 0, 0 },
+    { "ins", chasht_b_ins, chasht_b_ins_undo, 0, 0 },
+    { "rem", chasht_b_rem, chasht_b_rem_undo, 0, 0 },
+    { "for_each", chasht_b_for_each, NULL, 0, 1 },
+    { "ins_grow", chasht_b_ins_grow, NULL, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op list_scan_ops[] = {
+    { "get_hit", list_b_get_hit, NULL, 1, 0 },
+    { "get_miss", list_b_get_miss, NULL, 1, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_hasht(const struct bench_config *cfg) {
+    struct lookup_bench b;
+
+    for (long n = cfg->min_size; n <= cfg->max_size; n *= 10) {
+        b.size = n;
+        b.cursor = 0;
+        b.grown = 0;
+        if (bench_selected(cfg, "oahasht")) {
+            oahasht_init(&b.table, hash_ptr, hash_ptr_cmp);
+            for (long i = 0; i < n; ++i)
+                oahasht_ins(&b.table, key_hit(i), NULL);
+            for (const struct bench_op *op = oahasht_ops; op->name; ++op)
+                bench_run_op("oahasht", op, &b, n);
+            oahasht_destroy(&b.table, NULL);
+        }
+        b.grown = 0;
+        if (bench_selected(cfg, "chasht")) {
+            chasht_init(&b.chained, hash_ptr, hash_ptr_cmp);
+            for (long i = 0; i < n; ++i)
+                chasht_ins(&b.chained, key_hit(i), NULL);
+            for (const struct bench_op *op = chasht_ops; op->name; ++op)
+                bench_run_op("chasht", op, &b, n);
+            chasht_destroy(&b.chained, NULL);
+        }
+        if (bench_selected(cfg, "list/scan")) {
+            list_init(&b.list);
+            for (long i = n - 1; i >= 0; --i)
+                list_ins_head(&b.list, key_hit(i));
+            for (const struct bench_op *op = list_scan_ops; op->name; ++op)
+                bench_run_op("list/scan", op, &b, n);
+            list_destroy(&b.list, NULL);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#include "bench.h"
+#include "dlist.h"
+#include "heap.h"
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// A scheduled job. elem is its handle while it is on the heap.
+struct job {
+    long due;
+    struct heap_elem *elem;
+};
+
+struct sched_bench {
+    struct heap heap;
+    struct dlist dlist;
+    struct job *jobs;
+    long size;
+    unsigned long seed;
+};
+
+// Delays are spread over the queue's size so a rescheduled job lands
+// somewhere in the middle rather than always at the back
+static long next_delay(struct sched_bench *b) {
+    b->seed = b->seed * 6364136223846793005UL + 1442695040888963407UL;
+    return (long)((b->seed >> 33) % (unsigned long)b->size) + 1;
+}
+
+static int job_cmp(const void *a, const void *b) {
+    const struct job *x = a, *y = b;
+
+    return (x->due > y->due) - (x->due < y->due);
+}
+
+// The classic hold model: take the earliest job and schedule it again later
+static void heap_b_hold(void *ctx, long k) {
+    struct sched_bench *b = ctx;
+    struct job *job;
+
+    while (k--) {
+        job = heap_get_top(&b->heap)->data;
+        heap_rem_top(&b->heap, NULL);
+        job->due += next_delay(b);
+        job->elem = heap_ins(&b->heap, job);
+    }
+}
+
+// Brings a random job forward through its handle
+static void heap_b_update(void *ctx, long k) {
+    struct sched_bench *b = ctx;
+    struct job *job;
+
+    while (k--) {
+        job = &b->jobs[next_delay(b) - 1];
+        job->due -= next_delay(b);
+        heap_update(&b->heap, job->elem);
+    }
+}
+
+// The sorted dlist the heap replaces: every insertion scans for its place
+static void dlist_b_hold(void *ctx, long k) {
+    struct sched_bench *b = ctx;
+    struct dlist_elem *pos;
+    struct job *job;
+
+    while (k--) {
+        job = dlist_get_head(&b->dlist)->data;
+        dlist_rem_head(&b->dlist, NULL);
+        job->due += next_delay(b);
+        for (pos = dlist_get_head(&b->dlist); pos != NULL; pos = pos->next)
+            if (job_cmp(pos->data, job) > 0)
+                break;
+        if (pos != NULL)
+            dlist_ins_prev(&b->dlist, pos, job);
+        else
+            dlist_ins_tail(&b->dlist, job);
+    }
+}
+
+static const struct bench_op heap_ops[] = {
+    { "hold", heap_b_hold, NULL, 0, 0 },
+    { "update", heap_b_update, NULL, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op sorted_dlist_ops[] = {
+    { "hold", dlist_b_hold, NULL, 1, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_heap(const struct bench_config *cfg) {
+    struct sched_bench b;
+
+    for (long n = cfg->min_size; n <= cfg->max_size; n *= 10) {
+        b.jobs = malloc((size_t)n * sizeof(*b.jobs));
+        if (b.jobs == NULL)
+            return;
+        b.size = n;
+        b.seed = 1;
+        if (bench_selected(cfg, "heap")) {
+            heap_init(&b.heap, job_cmp);
+            for (long i = 0; i < n; ++i) {
+                b.jobs[i].due = next_delay(&b);
+                b.jobs[i].elem = heap_ins(&b.heap, &b.jobs[i]);
+            }
+            for (const struct bench_op *op = heap_ops; op->name; ++op)
+                bench_run_op("heap", op, &b, n);
+            heap_destroy(&b.heap, NULL);
+        }
+        if (bench_selected(cfg, "dlist/sorted")) {
+            dlist_init(&b.dlist);
+            for (long i = 0; i < n; ++i)
+                b.jobs[i].due = i;
+            for (long i = n - 1; i >= 0; --i)
+                dlist_ins_head(&b.dlist, &b.jobs[i]);
+            for (const struct bench_op *op = sorted_dlist_ops; op->name; ++op)
+                bench_run_op("dlist/sorted", op, &b, n);
+            dlist_destroy(&b.dlist, NULL);
+        }
+        free(b.jobs);
+    }
+}
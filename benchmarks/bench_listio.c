@@ -0,0 +1,109 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "cdlist.h"
+#include "listio.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// The most elements written, whatever the command line asks for, to keep the
+// file to a few tens of megabytes
+#define LISTIO_BENCH_MAX_SIZE 1000000
+
+static size_t listio_bench_encode(const void *data, void *buf, size_t len,
+                                  void *arg) {
+    (void)arg;
+    if (len >= sizeof(uint64_t))
+        memcpy(buf, data, sizeof(uint64_t));
+    return sizeof(uint64_t);
+}
+
+// What a restart did before: rebuild the cdlist from the file, one
+// ins_tail per record
+static void listio_bench_rebuild(const struct listio_view *view,
+                                 struct cdlist *cdlist, uint64_t *values) {
+    long i = 0;
+
+    cdlist_init(cdlist);
+    listio_view_for_each(view, rec) {
+        memcpy(&values[i], listio_record_data(rec), sizeof(uint64_t));
+        cdlist_ins_tail(cdlist, &values[i++]);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_listio(const struct bench_config *cfg) {
+    static uint64_t values[LISTIO_BENCH_MAX_SIZE];
+    static uint64_t loaded[LISTIO_BENCH_MAX_SIZE];
+    struct listio_codec codec = { listio_bench_encode, NULL };
+    char path[] = "/tmp/structures_bench_XXXXXX";
+    struct listio_view view;
+    struct cdlist cdlist, rebuilt;
+    unsigned long before;
+    uint64_t start, sum;
+    int fd;
+
+    if (!bench_selected(cfg, "listio"))
+        return;
+    fd = mkstemp(path);
+    if (fd < 0)
+        return;
+    close(fd);
+    for (long size = cfg->min_size;
+         size <= cfg->max_size && size <= LISTIO_BENCH_MAX_SIZE;
+         size *= 10) {
+        cdlist_init(&cdlist);
+        for (long i = 0; i < size; ++i) {
+            values[i] = (uint64_t)i;
+            cdlist_ins_tail(&cdlist, &values[i]);
+        }
+
+        before = bench_allocs;
+        start = bench_now();
+        if (cdlist_write(&cdlist, path, &codec) != 0) {
+            cdlist_destroy(&cdlist, NULL);
+            break;
+        }
+        bench_report("listio", "write", size, 1, size, bench_now() - start,
+                     bench_allocs - before, NULL, 0);
+
+        // Warm restart: map and walk, against rebuilding a cdlist
+        before = bench_allocs;
+        start = bench_now();
+        if (listio_map(&view, path) != 0) {
+            cdlist_destroy(&cdlist, NULL);
+            break;
+        }
+        bench_report("listio", "map", size, 1, 1, bench_now() - start,
+                     bench_allocs - before, NULL, 0);
+        sum = 0;
+        start = bench_now();
+        listio_view_for_each(&view, rec)
+            sum += *(const uint64_t *)listio_record_data(rec);
+        bench_report("listio", "view_walk", size, 1, size,
+                     bench_now() - start, 0, NULL, 0);
+        before = bench_allocs;
+        start = bench_now();
+        listio_bench_rebuild(&view, &rebuilt, loaded);
+        bench_report("listio", "rebuild", size, 1, size, bench_now() - start,
+                     bench_allocs - before, NULL, 0);
+        if (sum != (uint64_t)size * (uint64_t)(size - 1) / 2
+            || cdlist_get_size(&rebuilt) != size)
+            printf("# listio read back the wrong elements\n");
+
+        listio_unmap(&view);
+        cdlist_destroy(&rebuilt, NULL);
+        cdlist_destroy(&cdlist, NULL);
+    }
+    remove(path);
+}
@@ -0,0 +1,219 @@
+#include "bench.h"
+#include "cdlist.h"
+#include "clist.h"
+#include "dlist.h"
+#include "list.h"
+#include "pool.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Cost of the operations that depend on the compile time switches
+#ifdef STRUCTURES_NO_SIZE_CACHE
+#define SIZE_COST 1
+#else
+#define SIZE_COST 0
+#endif
+
+#ifdef STRUCTURES_NO_TAIL_CACHE
+#define TAIL_COST 1
+#else
+#define TAIL_COST 0
+#endif
+
+// The number of elements passed to each ins_tail_n and rem_head_n call
+#define BENCH_LIST_BATCH 64
+
+static int datum;
+static volatile uintptr_t sink;
+static void *batch_data[BENCH_LIST_BATCH];
+static void *batch_out[BENCH_LIST_BATCH];
+
+// Every list type gets the same head, tail, accessor and loop benchmarks. The
+// undo of an insertion always removes from the head so that restoring the size
+// stays cheap whatever is being measured.
+#define BENCH_LIST_COMMON(type)                                         \
+    static void type##_b_ins_head(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            type##_ins_head(ctx, &datum);                               \
+    }                                                                   \
+    static void type##_b_rem_head(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            type##_rem_head(ctx, NULL);                                 \
+    }                                                                   \
+    static void type##_b_ins_tail(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            type##_ins_tail(ctx, &datum);                               \
+    }                                                                   \
+    static void type##_b_rem_tail(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            type##_rem_tail(ctx, NULL);                                 \
+    }                                                                   \
+    static void type##_b_get_head(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            sink ^= (uintptr_t)type##_get_head(ctx);                    \
+    }                                                                   \
+    static void type##_b_get_tail(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            sink ^= (uintptr_t)type##_get_tail(ctx);                    \
+    }                                                                   \
+    static void type##_b_get_size(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            sink ^= (uintptr_t)type##_get_size(ctx);                    \
+    }                                                                   \
+    static void type##_b_is_empty(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            sink ^= (uintptr_t)type##_is_empty(ctx);                    \
+    }                                                                   \
+    static void type##_b_for_each(void *ctx, long k) {                  \
+        struct type *l = ctx;                                           \
+        while (k--)                                                     \
+            type##_for_each(l, e)                                       \
+                sink ^= (uintptr_t)e->data;                             \
+    }                                                                   \
+    static void type##_b_ins_next(void *ctx, long k) {                  \
+        while (k--)                                                     \
+            type##_ins_next(ctx, type##_get_head(ctx), &datum);         \
+    }                                                                   \
+    static void type##_b_ins_tail_n(void *ctx, long k) {                \
+        for (; k > 0; k -= BENCH_LIST_BATCH)                            \
+            type##_ins_tail_n(ctx, batch_data,                          \
+                              k < BENCH_LIST_BATCH ? (int)k             \
+                                                   : BENCH_LIST_BATCH); \
+    }                                                                   \
+    static void type##_b_rem_head_n(void *ctx, long k) {                \
+        for (; k > 0; k -= BENCH_LIST_BATCH)                            \
+            type##_rem_head_n(ctx, batch_out,                           \
+                              k < BENCH_LIST_BATCH ? (int)k             \
+                                                   : BENCH_LIST_BATCH,  \
+                              NULL);                                    \
+    }
+
+#define BENCH_LIST_OPS(type, tail_cost, ins_tail_cost, rem_tail_cost)   \
+    { "ins_head", type##_b_ins_head, type##_b_rem_head, 0, 0 },         \
+    { "rem_head", type##_b_rem_head, type##_b_ins_head, 0, 0 },         \
+    { "ins_tail", type##_b_ins_tail, type##_b_rem_head,                 \
+      ins_tail_cost, 0 },                                               \
+    { "rem_tail", type##_b_rem_tail, type##_b_ins_head,                 \
+      rem_tail_cost, 0 },                                               \
+    { "ins_next", type##_b_ins_next, type##_b_rem_head, 0, 0 },         \
+    { "ins_tail_n", type##_b_ins_tail_n, type##_b_rem_head_n,           \
+      ins_tail_cost, 0, BENCH_LIST_BATCH },                             \
+    { "rem_head_n", type##_b_rem_head_n, type##_b_ins_tail_n, 0, 0,     \
+      BENCH_LIST_BATCH },                                               \
+    { "get_head", type##_b_get_head, NULL, 0, 0 },                      \
+    { "get_tail", type##_b_get_tail, NULL, tail_cost, 0 },              \
+    { "get_size", type##_b_get_size, NULL, SIZE_COST, 0 },              \
+    { "is_empty", type##_b_is_empty, NULL, 0, 0 },                      \
+    { "for_each", type##_b_for_each, NULL, 0, 1 }
+
+BENCH_LIST_COMMON(list)
+BENCH_LIST_COMMON(dlist)
+BENCH_LIST_COMMON(clist)
+BENCH_LIST_COMMON(cdlist)
+
+// Removal after an element, always the head, restored by inserting there
+static void list_b_rem_next(void *ctx, long k) {
+    while (k--)
+        list_rem_next(ctx, list_get_head(ctx), NULL);
+}
+
+static void clist_b_rem_next(void *ctx, long k) {
+    while (k--)
+        clist_rem_next(ctx, clist_get_head(ctx), NULL);
+}
+
+// Insertion before the tail and removal of the element after the head
+static void dlist_b_ins_prev(void *ctx, long k) {
+    while (k--)
+        dlist_ins_prev(ctx, dlist_get_tail(ctx), &datum);
+}
+
+static void dlist_b_rem_elem(void *ctx, long k) {
+    while (k--)
+        dlist_rem_elem(ctx, dlist_get_head(ctx)->next, NULL);
+}
+
+static void cdlist_b_ins_prev(void *ctx, long k) {
+    while (k--)
+        cdlist_ins_prev(ctx, cdlist_get_tail(ctx), &datum);
+}
+
+static void cdlist_b_rem_elem(void *ctx, long k) {
+    while (k--)
+        cdlist_rem_elem(ctx, cdlist_get_head(ctx)->next, NULL);
+}
+
+static const struct bench_op list_ops[] = {
+    BENCH_LIST_OPS(list, TAIL_COST, TAIL_COST, 1),
+    { "rem_next", list_b_rem_next, list_b_ins_next, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op dlist_ops[] = {
+    BENCH_LIST_OPS(dlist, TAIL_COST, TAIL_COST, TAIL_COST),
+    { "ins_prev", dlist_b_ins_prev, dlist_b_rem_head, TAIL_COST, 0 },
+    { "rem_elem", dlist_b_rem_elem, dlist_b_ins_next, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op clist_ops[] = {
+    BENCH_LIST_OPS(clist, 1, 1, 1),
+    { "rem_next", clist_b_rem_next, clist_b_ins_next, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op cdlist_ops[] = {
+    BENCH_LIST_OPS(cdlist, 0, 0, 0),
+    { "ins_prev", cdlist_b_ins_prev, cdlist_b_rem_head, 0, 0 },
+    { "rem_elem", cdlist_b_rem_elem, cdlist_b_ins_next, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+// Builds a list of each type at every size and runs every operation on it
+#define BENCH_LIST_SUITE(type, cfg, pooled)                             \
+    do {                                                                \
+        const char *name = (pooled) ? #type "/pool" : #type;            \
+        struct type l;                                                  \
+        struct pool pool;                                               \
+        if (!bench_selected(cfg, name))                                 \
+            break;                                                      \
+        for (long n = (cfg)->min_size; n <= (cfg)->max_size; n *= 10) { \
+            if (pooled) {                                               \
+                pool_init(&pool, sizeof(struct type##_elem), 0);        \
+                type##_init_with_pool(&l, &pool);                       \
+            } else                                                      \
+                type##_init(&l);                                        \
+            type##_b_ins_head(&l, n);                                   \
+            if (type##_get_size(&l) != n) {                             \
+                fprintf(stderr, "%s: out of memory at %ld\n", name, n); \
+                type##_destroy(&l, NULL);                               \
+                if (pooled)                                             \
+                    pool_destroy(&pool);                                \
+                break;                                                  \
+            }                                                           \
+            for (const struct bench_op *op = type##_ops; op->name; ++op) \
+                bench_run_op(name, op, &l, n);                          \
+            type##_destroy(&l, NULL);                                   \
+            if (pooled)                                                 \
+                pool_destroy(&pool);                                    \
+        }                                                               \
+    } while (0)
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_lists(const struct bench_config *cfg) {
+    for (int i = 0; i < BENCH_LIST_BATCH; ++i)
+        batch_data[i] = &datum;
+    for (int pooled = 0; pooled <= 1; ++pooled) {
+        BENCH_LIST_SUITE(list, cfg, pooled);
+        BENCH_LIST_SUITE(dlist, cfg, pooled);
+        BENCH_LIST_SUITE(clist, cfg, pooled);
+        BENCH_LIST_SUITE(cdlist, cfg, pooled);
+    }
+}
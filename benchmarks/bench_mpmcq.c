@@ -0,0 +1,157 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "cdlist.h"
+#include "mpmcq.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Items passed through the queue by each producer
+#define MPMCQ_BENCH_ITEMS 1000000L
+
+// The capacity of the queue under test
+#define MPMCQ_BENCH_CAPACITY 1024
+
+// What the lock-free queue replaces: a cdlist behind one global mutex
+struct locked_cdlist {
+    pthread_mutex_t lock;
+    struct cdlist list;
+};
+
+struct mpmcq_bench_queue {
+    const char *name;
+    int (*ins_tail)(void *q, void *data);
+    int (*rem_head)(void *q, void **data);
+};
+
+struct mpmcq_bench_thread {
+    pthread_t thread;
+    const struct mpmcq_bench_queue *queue;
+    void *q;
+    pthread_barrier_t *start;
+    unsigned long allocs;
+};
+
+static int locked_ins_tail(void *q, void *data) {
+    struct locked_cdlist *l = q;
+    int ret;
+
+    pthread_mutex_lock(&l->lock);
+    ret = cdlist_ins_tail(&l->list, data);
+    pthread_mutex_unlock(&l->lock);
+    return ret;
+}
+
+static int locked_rem_head(void *q, void **data) {
+    struct locked_cdlist *l = q;
+    struct cdlist_elem *head;
+    int ret = -1;
+
+    pthread_mutex_lock(&l->lock);
+    head = cdlist_get_head(&l->list);
+    if (head != NULL) {
+        *data = head->data;
+        ret = cdlist_rem_head(&l->list, NULL);
+    }
+    pthread_mutex_unlock(&l->lock);
+    return ret;
+}
+
+static int lockfree_ins_tail(void *q, void *data) {
+    return mpmcq_ins_tail(q, data);
+}
+
+static int lockfree_rem_head(void *q, void **data) {
+    return mpmcq_rem_head(q, data);
+}
+
+static const struct mpmcq_bench_queue queues[] = {
+    { "cdlist/mutex", locked_ins_tail, locked_rem_head },
+    { "mpmcq", lockfree_ins_tail, lockfree_rem_head },
+};
+
+static void* producer(void *arg) {
+    struct mpmcq_bench_thread *t = arg;
+    unsigned long before = bench_allocs;
+
+    pthread_barrier_wait(t->start);
+    for (uintptr_t i = 1; i <= MPMCQ_BENCH_ITEMS; ++i)
+        while (t->queue->ins_tail(t->q, (void *)i) != 0)
+            sched_yield();
+    t->allocs = bench_allocs - before;
+    return NULL;
+}
+
+// Producers and consumers are paired, so each consumer takes one producer's
+// worth of items
+static void* consumer(void *arg) {
+    struct mpmcq_bench_thread *t = arg;
+    unsigned long before = bench_allocs;
+    void *data;
+
+    pthread_barrier_wait(t->start);
+    for (long i = 0; i < MPMCQ_BENCH_ITEMS; ) {
+        if (t->queue->rem_head(t->q, &data) == 0)
+            ++i;
+        else
+            sched_yield();
+    }
+    t->allocs = bench_allocs - before;
+    return NULL;
+}
+
+static void run(const struct mpmcq_bench_queue *queue, void *q, int threads) {
+    struct mpmcq_bench_thread t[threads];
+    pthread_barrier_t start;
+    unsigned long allocs = 0;
+    uint64_t begin;
+
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+    for (int i = 0; i < threads; ++i) {
+        t[i].queue = queue;
+        t[i].q = q;
+        t[i].start = &start;
+        pthread_create(&t[i].thread, NULL, i % 2 ? consumer : producer, &t[i]);
+    }
+    begin = bench_now();
+    pthread_barrier_wait(&start);
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(t[i].thread, NULL);
+        allocs += t[i].allocs;
+    }
+    bench_report(queue->name, "transfer", MPMCQ_BENCH_CAPACITY, threads,
+                 MPMCQ_BENCH_ITEMS * (threads / 2), bench_now() - begin,
+                 allocs, NULL, 0);
+    pthread_barrier_destroy(&start);
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_mpmcq(const struct bench_config *cfg) {
+    struct locked_cdlist locked;
+    struct mpmcq lockfree;
+
+    // Half the threads produce and half consume; ns/op is wall time per item
+    for (int threads = 2; threads <= cfg->max_threads; threads *= 2) {
+        if (bench_selected(cfg, queues[0].name)) {
+            pthread_mutex_init(&locked.lock, NULL);
+            cdlist_init(&locked.list);
+            run(&queues[0], &locked, threads);
+            cdlist_destroy(&locked.list, NULL);
+            pthread_mutex_destroy(&locked.lock);
+        }
+        if (bench_selected(cfg, queues[1].name)
+            && mpmcq_init(&lockfree, MPMCQ_BENCH_CAPACITY) == 0) {
+            run(&queues[1], &lockfree, threads);
+            mpmcq_destroy(&lockfree, NULL);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "cdlist.h"
+#include "list.h"
+#include "workpool.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Rounds of mixing each callback does, standing in for real per-element work
+#define PARALLEL_BENCH_ROUNDS 64
+
+// The most elements in the list walked, whatever the command line asks for
+#define PARALLEL_BENCH_MAX_SIZE 1000000
+
+static uint64_t parallel_bench_mix(uintptr_t value) {
+    uint64_t x = value;
+
+    for (int i = 0; i < PARALLEL_BENCH_ROUNDS; ++i) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+    }
+    return x;
+}
+
+// Stores its result back so the work cannot be optimised out
+static void parallel_bench_work(void *data, void *arg) {
+    (void)arg;
+    *(uint64_t *)data = parallel_bench_mix(*(uint64_t *)data);
+}
+
+static void parallel_bench_fold(void *acc, void *data, void *arg) {
+    (void)arg;
+    *(uint64_t *)acc += parallel_bench_mix(*(uint64_t *)data);
+}
+
+static void parallel_bench_combine(void *acc, const void *part, void *arg) {
+    (void)arg;
+    *(uint64_t *)acc += *(const uint64_t *)part;
+}
+
+// Times one pass of each kind over the list and reports ns per element
+static void run(const char *structure, void *l, long size,
+                struct workpool *workpool,
+                void (*for_each)(void *l, struct workpool *workpool),
+                void (*reduce)(void *l, uint64_t *sum,
+                               struct workpool *workpool)) {
+    int threads = workpool ? workpool_get_threads(workpool) : 1;
+    unsigned long before;
+    uint64_t start, sum = 0;
+
+    before = bench_allocs;
+    start = bench_now();
+    for_each(l, workpool);
+    bench_report(structure, "for_each_parallel", size, threads, size,
+                 bench_now() - start, bench_allocs - before, NULL, 0);
+    before = bench_allocs;
+    start = bench_now();
+    reduce(l, &sum, workpool);
+    bench_report(structure, "reduce_parallel", size, threads, size,
+                 bench_now() - start, bench_allocs - before, NULL, 0);
+    if (sum == 1)
+        printf("# unlikely sum\n");
+}
+
+static void list_run_for_each(void *l, struct workpool *workpool) {
+    list_for_each_parallel(l, parallel_bench_work, NULL, workpool);
+}
+
+static void list_run_reduce(void *l, uint64_t *sum,
+                            struct workpool *workpool) {
+    list_reduce_parallel(l, parallel_bench_fold, parallel_bench_combine, sum,
+                         sizeof(*sum), NULL, workpool);
+}
+
+static void cdlist_run_for_each(void *l, struct workpool *workpool) {
+    cdlist_for_each_parallel(l, parallel_bench_work, NULL, workpool);
+}
+
+static void cdlist_run_reduce(void *l, uint64_t *sum,
+                              struct workpool *workpool) {
+    cdlist_reduce_parallel(l, parallel_bench_fold, parallel_bench_combine,
+                           sum, sizeof(*sum), NULL, workpool);
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_parallel(const struct bench_config *cfg) {
+    static uint64_t values[PARALLEL_BENCH_MAX_SIZE];
+    struct workpool workpool;
+    struct list list;
+    struct cdlist cdlist;
+
+    // threads 1 is the sequential path with no pool at all
+    for (long size = cfg->min_size;
+         size <= cfg->max_size && size <= PARALLEL_BENCH_MAX_SIZE;
+         size *= 10) {
+        list_init(&list);
+        cdlist_init(&cdlist);
+        for (long i = 0; i < size; ++i) {
+            values[i] = (uint64_t)i;
+            list_ins_tail(&list, &values[i]);
+            cdlist_ins_tail(&cdlist, &values[i]);
+        }
+        for (int threads = 1; threads <= cfg->max_threads; threads *= 2) {
+            if (threads > 1 && workpool_init(&workpool, threads) != 0)
+                break;
+            if (bench_selected(cfg, "list"))
+                run("list", &list, size, threads > 1 ? &workpool : NULL,
+                    list_run_for_each, list_run_reduce);
+            if (bench_selected(cfg, "cdlist"))
+                run("cdlist", &cdlist, size, threads > 1 ? &workpool : NULL,
+                    cdlist_run_for_each, cdlist_run_reduce);
+            if (threads > 1)
+                workpool_destroy(&workpool);
+        }
+        list_destroy(&list, NULL);
+        cdlist_destroy(&cdlist, NULL);
+    }
+}
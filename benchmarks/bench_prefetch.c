@@ -0,0 +1,153 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "cdlist.h"
+#include "list.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Short lists are walked repeatedly so that each timing covers at least this
+// many elements
+#define PREFETCH_BENCH_MIN_OPS 1000000L
+
+// Each element's data fills a cache line of its own, so that reading it is a
+// miss separate from reading the element
+struct prefetch_bench_item {
+    uint64_t key;
+    uint64_t value;
+    char pad[48];
+};
+
+static int prefetch_bench_cmp(const void *a, const void *b) {
+    const struct prefetch_bench_item *x = a, *y = b;
+
+    return x->key < y->key ? -1 : x->key > y->key;
+}
+
+// Keys are a shuffle of 0..size-1, so that sorting on them leaves neither the
+// elements nor their data in address order
+static void prefetch_bench_shuffle(struct prefetch_bench_item *items,
+                                   long size) {
+    uint64_t state = 0x9e3779b97f4a7c15ULL, tmp;
+
+    for (long i = 0; i < size; ++i) {
+        items[i].key = (uint64_t)i;
+        items[i].value = (uint64_t)i;
+    }
+    for (long i = size - 1; i > 0; --i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        long j = (long)(state % (uint64_t)(i + 1));
+        tmp = items[i].key;
+        items[i].key = items[j].key;
+        items[j].key = tmp;
+    }
+}
+
+static uint64_t list_sum(struct list *list) {
+    uint64_t sum = 0;
+
+    list_for_each(list, elem)
+        sum += ((struct prefetch_bench_item *)elem->data)->value;
+    return sum;
+}
+
+static uint64_t list_sum_prefetch(struct list *list) {
+    uint64_t sum = 0;
+
+    list_for_each_prefetch(list, elem)
+        sum += ((struct prefetch_bench_item *)elem->data)->value;
+    return sum;
+}
+
+static uint64_t cdlist_sum(struct cdlist *cdlist) {
+    uint64_t sum = 0;
+
+    cdlist_for_each(cdlist, elem)
+        sum += ((struct prefetch_bench_item *)elem->data)->value;
+    return sum;
+}
+
+static uint64_t cdlist_sum_prefetch(struct cdlist *cdlist) {
+    uint64_t sum = 0;
+
+    cdlist_for_each_prefetch(cdlist, elem)
+        sum += ((struct prefetch_bench_item *)elem->data)->value;
+    return sum;
+}
+
+// Times passes walks with sum and reports ns per element visited
+static void run(const char *structure, const char *op, void *l, long size,
+                uint64_t (*sum)(void *l)) {
+    long passes = PREFETCH_BENCH_MIN_OPS / size > 0
+                  ? PREFETCH_BENCH_MIN_OPS / size : 1;
+    uint64_t start, total = 0;
+
+    start = bench_now();
+    for (long i = 0; i < passes; ++i)
+        total += sum(l);
+    bench_report(structure, op, size, 1, size * passes, bench_now() - start,
+                 0, NULL, 0);
+    if (total != (uint64_t)passes * (uint64_t)size * (uint64_t)(size - 1) / 2)
+        printf("# %s %s visited the wrong elements\n", structure, op);
+}
+
+static uint64_t list_run_sum(void *l) {
+    return list_sum(l);
+}
+
+static uint64_t list_run_sum_prefetch(void *l) {
+    return list_sum_prefetch(l);
+}
+
+static uint64_t cdlist_run_sum(void *l) {
+    return cdlist_sum(l);
+}
+
+static uint64_t cdlist_run_sum_prefetch(void *l) {
+    return cdlist_sum_prefetch(l);
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_prefetch(const struct bench_config *cfg) {
+    struct prefetch_bench_item *items;
+    struct list list;
+    struct cdlist cdlist;
+
+    // Gains show once size * 96 bytes or so is well past the last level cache
+    for (long size = cfg->min_size; size <= cfg->max_size; size *= 10) {
+        items = malloc((size_t)size * sizeof(*items));
+        if (items == NULL)
+            break;
+        prefetch_bench_shuffle(items, size);
+        if (bench_selected(cfg, "list")) {
+            list_init(&list);
+            for (long i = 0; i < size; ++i)
+                list_ins_tail(&list, &items[i]);
+            list_sort(&list, prefetch_bench_cmp);
+            run("list", "sum", &list, size, list_run_sum);
+            run("list", "sum_prefetch", &list, size, list_run_sum_prefetch);
+            list_destroy(&list, NULL);
+        }
+        if (bench_selected(cfg, "cdlist")) {
+            cdlist_init(&cdlist);
+            for (long i = 0; i < size; ++i)
+                cdlist_ins_tail(&cdlist, &items[i]);
+            cdlist_sort(&cdlist, prefetch_bench_cmp);
+            run("cdlist", "sum", &cdlist, size, cdlist_run_sum);
+            run("cdlist", "sum_prefetch", &cdlist, size,
+                cdlist_run_sum_prefetch);
+            cdlist_destroy(&cdlist, NULL);
+        }
+        free(items);
+    }
+}
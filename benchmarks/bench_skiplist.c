@@ -0,0 +1,259 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "bptree.h"
+#include "skiplist.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Present keys are odd and absent keys even, as in bench_hasht.c
+#define key_hit(i) ((void *)(uintptr_t)(2 * (i) + 1))
+#define key_miss(i) ((void *)(uintptr_t)(2 * (i) + 2))
+
+// The size of the set shared by the threaded runs
+#define SKIPLIST_BENCH_KEYS 100000L
+
+// Lookups made by each reader thread in the threaded runs
+#define SKIPLIST_BENCH_READS 1000000L
+
+struct skiplist_bench {
+    struct skiplist list;
+    long size;
+    long cursor;
+    long first;
+};
+
+// What lock-free reads replace: a B+ tree behind a readers-writer lock
+struct locked_bptree {
+    pthread_rwlock_t lock;
+    struct bptree tree;
+};
+
+struct ordered_set {
+    const char *name;
+    int (*contains)(void *set, void *key);
+    void (*ins)(void *set, void *key);
+    void (*rem)(void *set, void *key);
+};
+
+struct reader_thread {
+    pthread_t thread;
+    const struct ordered_set *ops;
+    void *set;
+    pthread_barrier_t *start;
+    long seed;
+};
+
+static volatile uintptr_t sink;
+static atomic_int readers_left;
+
+static int key_cmp(const void *a, const void *b) {
+    return ((uintptr_t)a > (uintptr_t)b) - ((uintptr_t)a < (uintptr_t)b);
+}
+
+static long next_index(struct skiplist_bench *b) {
+    b->cursor = (b->cursor + 7919) % b->size;
+    return b->cursor;
+}
+
+static void skiplist_b_get_hit(void *ctx, long k) {
+    struct skiplist_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)skiplist_find(&b->list, key_hit(next_index(b)));
+}
+
+static void skiplist_b_get_miss(void *ctx, long k) {
+    struct skiplist_bench *b = ctx;
+
+    while (k--)
+        sink ^= (uintptr_t)skiplist_find(&b->list, key_miss(next_index(b)));
+}
+
+static void skiplist_b_ins(void *ctx, long k) {
+    struct skiplist_bench *b = ctx;
+
+    b->first = next_index(b);
+    for (long i = 0; i < k; ++i)
+        skiplist_ins(&b->list, key_miss((b->first + i) % b->size));
+}
+
+static void skiplist_b_ins_undo(void *ctx, long k) {
+    struct skiplist_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        skiplist_rem(&b->list, key_miss((b->first + i) % b->size), NULL);
+}
+
+static void skiplist_b_rem(void *ctx, long k) {
+    struct skiplist_bench *b = ctx;
+
+    b->first = next_index(b);
+    for (long i = 0; i < k; ++i)
+        skiplist_rem(&b->list, key_hit((b->first + i) % b->size), NULL);
+}
+
+static void skiplist_b_rem_undo(void *ctx, long k) {
+    struct skiplist_bench *b = ctx;
+
+    for (long i = 0; i < k; ++i)
+        skiplist_ins(&b->list, key_hit((b->first + i) % b->size));
+}
+
+static void skiplist_b_for_each(void *ctx, long k) {
+    struct skiplist_bench *b = ctx;
+
+    while (k--)
+        skiplist_for_each(&b->list, elem)
+            sink ^= (uintptr_t)elem->data;
+}
+
+static const struct bench_op skiplist_ops[] = {
+    { "get_hit", skiplist_b_get_hit, NULL, 0, 0 },
+    { "get_miss", skiplist_b_get_miss, NULL, 0, 0 },
+    { "ins", skiplist_b_ins, skiplist_b_ins_undo, 0, 0 },
+    { "rem", skiplist_b_rem, skiplist_b_rem_undo, 0, 0 },
+    { "for_each", skiplist_b_for_each, NULL, 0, 1 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static int skiplist_contains(void *set, void *key) {
+    struct skiplist *list = set;
+    unsigned epoch;
+    int found;
+
+    epoch = skiplist_read_begin(list);
+    found = skiplist_find(list, key) != NULL;
+    skiplist_read_end(list, epoch);
+    return found;
+}
+
+static void skiplist_set_ins(void *set, void *key) {
+    skiplist_ins(set, key);
+}
+
+static void skiplist_set_rem(void *set, void *key) {
+    skiplist_rem(set, key, NULL);
+}
+
+static int locked_contains(void *set, void *key) {
+    struct locked_bptree *l = set;
+    int found;
+
+    pthread_rwlock_rdlock(&l->lock);
+    found = bptree_find(&l->tree, key).entry != NULL;
+    pthread_rwlock_unlock(&l->lock);
+    return found;
+}
+
+static void locked_ins(void *set, void *key) {
+    struct locked_bptree *l = set;
+
+    pthread_rwlock_wrlock(&l->lock);
+    bptree_ins(&l->tree, key, NULL);
+    pthread_rwlock_unlock(&l->lock);
+}
+
+static void locked_rem(void *set, void *key) {
+    struct locked_bptree *l = set;
+
+    pthread_rwlock_wrlock(&l->lock);
+    bptree_rem(&l->tree, key, NULL);
+    pthread_rwlock_unlock(&l->lock);
+}
+
+static const struct ordered_set sets[] = {
+    { "bptree/rwlock", locked_contains, locked_ins, locked_rem },
+    { "skiplist", skiplist_contains, skiplist_set_ins, skiplist_set_rem },
+};
+
+static void* reader(void *arg) {
+    struct reader_thread *t = arg;
+    long i = t->seed;
+
+    pthread_barrier_wait(t->start);
+    for (long n = 0; n < SKIPLIST_BENCH_READS; ++n) {
+        i = (i + 7919) % SKIPLIST_BENCH_KEYS;
+        sink ^= (uintptr_t)t->ops->contains(t->set, key_hit(i));
+    }
+    atomic_fetch_sub(&readers_left, 1);
+    return NULL;
+}
+
+// One writer churns absent keys in and out for as long as the readers run
+static void run(const struct ordered_set *ops, void *set, int threads) {
+    struct reader_thread t[threads];
+    pthread_barrier_t start;
+    uint64_t begin;
+    long i = 0;
+
+    atomic_store(&readers_left, threads - 1);
+    pthread_barrier_init(&start, NULL, (unsigned)threads);
+    for (int r = 0; r < threads - 1; ++r) {
+        t[r].ops = ops;
+        t[r].set = set;
+        t[r].start = &start;
+        t[r].seed = r * 1009L;
+        pthread_create(&t[r].thread, NULL, reader, &t[r]);
+    }
+    begin = bench_now();
+    pthread_barrier_wait(&start);
+    while (atomic_load(&readers_left) > 0) {
+        i = (i + 7919) % SKIPLIST_BENCH_KEYS;
+        ops->ins(set, key_miss(i));
+        ops->rem(set, key_miss(i));
+    }
+    for (int r = 0; r < threads - 1; ++r)
+        pthread_join(t[r].thread, NULL);
+    bench_report(ops->name, "read", SKIPLIST_BENCH_KEYS, threads,
+                 SKIPLIST_BENCH_READS * (threads - 1), bench_now() - begin,
+                 0, NULL, 0);
+    pthread_barrier_destroy(&start);
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_skiplist(const struct bench_config *cfg) {
+    struct skiplist_bench b;
+    struct locked_bptree locked;
+
+    for (long n = cfg->min_size; n <= cfg->max_size; n *= 10) {
+        if (!bench_selected(cfg, "skiplist")
+            || skiplist_init(&b.list, key_cmp) != 0)
+            break;
+        b.size = n;
+        b.cursor = 0;
+        for (long i = 0; i < n; ++i)
+            skiplist_ins(&b.list, key_hit(i));
+        for (const struct bench_op *op = skiplist_ops; op->name; ++op)
+            bench_run_op("skiplist", op, &b, n);
+        skiplist_destroy(&b.list, NULL);
+    }
+
+    // One thread writes and the rest read; ns/op is wall time per lookup
+    for (int threads = 2; threads <= cfg->max_threads; threads *= 2) {
+        if (bench_selected(cfg, sets[0].name)) {
+            pthread_rwlock_init(&locked.lock, NULL);
+            bptree_init(&locked.tree, key_cmp);
+            for (long i = 0; i < SKIPLIST_BENCH_KEYS; ++i)
+                bptree_ins(&locked.tree, key_hit(i), NULL);
+            run(&sets[0], &locked, threads);
+            bptree_destroy(&locked.tree, NULL);
+            pthread_rwlock_destroy(&locked.lock);
+        }
+        if (bench_selected(cfg, sets[1].name)
+            && skiplist_init(&b.list, key_cmp) == 0) {
+            for (long i = 0; i < SKIPLIST_BENCH_KEYS; ++i)
+                skiplist_ins(&b.list, key_hit(i));
+            run(&sets[1], &b.list, threads);
+            skiplist_destroy(&b.list, NULL);
+        }
+    }
+}
@@ -0,0 +1,242 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "cdlist.h"
+#include "spscq.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Items passed from the producer to the consumer per throughput run
+#define SPSCQ_BENCH_ITEMS 1000000L
+
+// The capacity of the queue under test
+#define SPSCQ_BENCH_CAPACITY 1024
+
+// Items moved per call by the batched transfer
+#define SPSCQ_BENCH_BATCH 32
+
+// The handoff being replaced: a cdlist behind a mutex
+struct locked_cdlist {
+    pthread_mutex_t lock;
+    struct cdlist list;
+};
+
+// Both ends of a queue. The batched calls return how many items they moved.
+struct spscq_bench_queue {
+    const char *name;
+    size_t (*ins_tail_n)(void *q, void *const *data, size_t n);
+    size_t (*rem_head_n)(void *q, void **data, size_t n);
+};
+
+struct spscq_bench_thread {
+    pthread_t thread;
+    const struct spscq_bench_queue *queue;
+    void *q;
+    void *reply;
+    size_t batch;
+    pthread_barrier_t *start;
+    unsigned long allocs;
+};
+
+static size_t locked_ins_tail_n(void *q, void *const *data, size_t n) {
+    struct locked_cdlist *l = q;
+    size_t i;
+
+    pthread_mutex_lock(&l->lock);
+    for (i = 0; i < n; ++i)
+        if (cdlist_ins_tail(&l->list, data[i]) != 0)
+            break;
+    pthread_mutex_unlock(&l->lock);
+    return i;
+}
+
+static size_t locked_rem_head_n(void *q, void **data, size_t n) {
+    struct locked_cdlist *l = q;
+    struct cdlist_elem *head;
+    size_t i;
+
+    pthread_mutex_lock(&l->lock);
+    for (i = 0; i < n && (head = cdlist_get_head(&l->list)) != NULL; ++i) {
+        data[i] = head->data;
+        cdlist_rem_head(&l->list, NULL);
+    }
+    pthread_mutex_unlock(&l->lock);
+    return i;
+}
+
+// Single items go through spscq_ins_tail and spscq_rem_head, so the unbatched
+// runs measure the calls a caller would actually make
+static size_t ring_ins_tail_n(void *q, void *const *data, size_t n) {
+    if (n == 1)
+        return spscq_ins_tail(q, data[0]) == 0;
+    return spscq_ins_tail_n(q, data, n);
+}
+
+static size_t ring_rem_head_n(void *q, void **data, size_t n) {
+    if (n == 1)
+        return spscq_rem_head(q, data) == 0;
+    return spscq_rem_head_n(q, data, n);
+}
+
+static const struct spscq_bench_queue queues[] = {
+    { "cdlist/mutex@spscq", locked_ins_tail_n, locked_rem_head_n },
+    { "spscq", ring_ins_tail_n, ring_rem_head_n },
+};
+
+static void send(const struct spscq_bench_thread *t, void *const *data,
+                 size_t n) {
+    for (size_t done = 0; done < n; )
+        if ((done += t->queue->ins_tail_n(t->q, data + done, n - done)) < n)
+            sched_yield();
+}
+
+static void* producer(void *arg) {
+    struct spscq_bench_thread *t = arg;
+    unsigned long before = bench_allocs;
+    void *data[SPSCQ_BENCH_BATCH];
+
+    pthread_barrier_wait(t->start);
+    for (uintptr_t i = 0; i < SPSCQ_BENCH_ITEMS; i += t->batch) {
+        for (size_t j = 0; j < t->batch; ++j)
+            data[j] = (void *)(i + j);
+        send(t, data, t->batch);
+    }
+    t->allocs = bench_allocs - before;
+    return NULL;
+}
+
+static void* consumer(void *arg) {
+    struct spscq_bench_thread *t = arg;
+    unsigned long before = bench_allocs;
+    void *data[SPSCQ_BENCH_BATCH];
+    size_t n;
+
+    pthread_barrier_wait(t->start);
+    for (long i = 0; i < SPSCQ_BENCH_ITEMS; i += (long)n)
+        if ((n = t->queue->rem_head_n(t->q, data, t->batch)) == 0)
+            sched_yield();
+    t->allocs = bench_allocs - before;
+    return NULL;
+}
+
+// Sends every item straight back on the reply queue
+static void* echo(void *arg) {
+    struct spscq_bench_thread *t = arg;
+    struct spscq_bench_thread back = *t;
+    void *data;
+
+    back.q = t->reply;
+    pthread_barrier_wait(t->start);
+    for (long i = 0; i < BENCH_SAMPLES; ++i) {
+        while (t->queue->rem_head_n(t->q, &data, 1) == 0)
+            sched_yield();
+        send(&back, &data, 1);
+    }
+    return NULL;
+}
+
+static void transfer(const struct spscq_bench_queue *queue, void *q,
+                     size_t batch) {
+    struct spscq_bench_thread t[2];
+    pthread_barrier_t start;
+    uint64_t begin;
+
+    pthread_barrier_init(&start, NULL, 3);
+    for (int i = 0; i < 2; ++i) {
+        t[i].queue = queue;
+        t[i].q = q;
+        t[i].batch = batch;
+        t[i].start = &start;
+        pthread_create(&t[i].thread, NULL, i ? consumer : producer, &t[i]);
+    }
+    begin = bench_now();
+    pthread_barrier_wait(&start);
+    for (int i = 0; i < 2; ++i)
+        pthread_join(t[i].thread, NULL);
+    bench_report(queue->name, batch > 1 ? "transfer_batch" : "transfer",
+                 SPSCQ_BENCH_CAPACITY, 2, SPSCQ_BENCH_ITEMS,
+                 bench_now() - begin, t[0].allocs + t[1].allocs, NULL, 0);
+    pthread_barrier_destroy(&start);
+}
+
+// Times BENCH_SAMPLES one-item round trips through a pair of queues. Each
+// sample is two handoffs, so the percentiles are twice the one-way latency.
+static void round_trip(const struct spscq_bench_queue *queue, void *q,
+                       void *reply) {
+    static uint64_t samples[BENCH_SAMPLES];
+    struct spscq_bench_thread t, back;
+    pthread_barrier_t start;
+    uint64_t begin, total;
+    unsigned long before;
+    void *data = NULL;
+
+    pthread_barrier_init(&start, NULL, 2);
+    t.queue = queue;
+    t.q = q;
+    t.reply = reply;
+    t.start = &start;
+    back = t;
+    back.q = reply;
+    pthread_create(&t.thread, NULL, echo, &t);
+    pthread_barrier_wait(&start);
+    before = bench_allocs;
+    total = bench_now();
+    for (long i = 0; i < BENCH_SAMPLES; ++i) {
+        begin = bench_now();
+        send(&t, &data, 1);
+        while (queue->rem_head_n(back.q, &data, 1) == 0)
+            sched_yield();
+        samples[i] = bench_now() - begin;
+    }
+    total = bench_now() - total;
+    pthread_join(t.thread, NULL);
+    bench_report(queue->name, "round_trip", SPSCQ_BENCH_CAPACITY, 2,
+                 BENCH_SAMPLES, total, bench_allocs - before, samples,
+                 BENCH_SAMPLES);
+    pthread_barrier_destroy(&start);
+}
+
+static void run(const struct spscq_bench_queue *queue, void *q, void *reply) {
+    transfer(queue, q, 1);
+    transfer(queue, q, SPSCQ_BENCH_BATCH);
+    round_trip(queue, q, reply);
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_spscq(const struct bench_config *cfg) {
+    struct locked_cdlist locked[2];
+    struct spscq ring[2];
+
+    // One producer and one consumer, whatever the thread limit. The
+    // allocations counted for round_trip are the pinging thread's only.
+    if (cfg->max_threads < 2)
+        return;
+    if (bench_selected(cfg, queues[0].name)) {
+        for (int i = 0; i < 2; ++i) {
+            pthread_mutex_init(&locked[i].lock, NULL);
+            cdlist_init(&locked[i].list);
+        }
+        run(&queues[0], &locked[0], &locked[1]);
+        for (int i = 0; i < 2; ++i) {
+            cdlist_destroy(&locked[i].list, NULL);
+            pthread_mutex_destroy(&locked[i].lock);
+        }
+    }
+    if (bench_selected(cfg, queues[1].name)
+        && spscq_init(&ring[0], SPSCQ_BENCH_CAPACITY) == 0) {
+        if (spscq_init(&ring[1], SPSCQ_BENCH_CAPACITY) == 0) {
+            run(&queues[1], &ring[0], &ring[1]);
+            spscq_destroy(&ring[1], NULL);
+        }
+        spscq_destroy(&ring[0], NULL);
+    }
+}
@@ -0,0 +1,149 @@
+#include "bench.h"
+#include "cdlist.h"
+#include "list.h"
+#include "queue.h"
+#include "stack.h"
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Each structure is benchmarked at a steady size: pushes are undone by pops
+// and pops by pushes
+struct push_pop_bench {
+    struct stack stack;
+    struct queue queue;
+    struct list list;
+    struct cdlist cdlist;
+};
+
+static volatile uintptr_t sink;
+
+static void stack_b_push(void *ctx, long k) {
+    struct push_pop_bench *b = ctx;
+
+    while (k--)
+        stack_push(&b->stack, (void *)(uintptr_t)k);
+}
+
+static void stack_b_pop(void *ctx, long k) {
+    struct push_pop_bench *b = ctx;
+    void *data;
+
+    while (k--) {
+        stack_pop(&b->stack, &data);
+        sink ^= (uintptr_t)data;
+    }
+}
+
+static void queue_b_push(void *ctx, long k) {
+    struct push_pop_bench *b = ctx;
+
+    while (k--)
+        queue_push(&b->queue, (void *)(uintptr_t)k);
+}
+
+static void queue_b_pop(void *ctx, long k) {
+    struct push_pop_bench *b = ctx;
+    void *data;
+
+    while (k--) {
+        queue_pop(&b->queue, &data);
+        sink ^= (uintptr_t)data;
+    }
+}
+
+// The list idioms the two types replace
+static void list_b_push(void *ctx, long k) {
+    struct push_pop_bench *b = ctx;
+
+    while (k--)
+        list_ins_head(&b->list, (void *)(uintptr_t)k);
+}
+
+static void list_b_pop(void *ctx, long k) {
+    struct push_pop_bench *b = ctx;
+
+    while (k--) {
+        sink ^= (uintptr_t)list_get_head(&b->list)->data;
+        list_rem_head(&b->list, NULL);
+    }
+}
+
+static void cdlist_b_push(void *ctx, long k) {
+    struct push_pop_bench *b = ctx;
+
+    while (k--)
+        cdlist_ins_tail(&b->cdlist, (void *)(uintptr_t)k);
+}
+
+static void cdlist_b_pop(void *ctx, long k) {
+    struct push_pop_bench *b = ctx;
+
+    while (k--) {
+        sink ^= (uintptr_t)cdlist_get_head(&b->cdlist)->data;
+        cdlist_rem_head(&b->cdlist, NULL);
+    }
+}
+
+static const struct bench_op stack_ops[] = {
+    { "push", stack_b_push, stack_b_pop, 0, 0 },
+    { "pop", stack_b_pop, stack_b_push, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op queue_ops[] = {
+    { "push", queue_b_push, queue_b_pop, 0, 0 },
+    { "pop", queue_b_pop, queue_b_push, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op list_stack_ops[] = {
+    { "push", list_b_push, list_b_pop, 0, 0 },
+    { "pop", list_b_pop, list_b_push, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+static const struct bench_op cdlist_queue_ops[] = {
+    { "push", cdlist_b_push, cdlist_b_pop, 0, 0 },
+    { "pop", cdlist_b_pop, cdlist_b_push, 0, 0 },
+    { NULL, NULL, NULL, 0, 0 }
+};
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_stack(const struct bench_config *cfg) {
+    struct push_pop_bench b;
+
+    for (long n = cfg->min_size; n <= cfg->max_size; n *= 10) {
+        stack_init(&b.stack);
+        queue_init(&b.queue);
+        list_init(&b.list);
+        cdlist_init(&b.cdlist);
+        for (long i = 0; i < n; ++i) {
+            stack_push(&b.stack, NULL);
+            queue_push(&b.queue, NULL);
+            list_ins_head(&b.list, NULL);
+            cdlist_ins_tail(&b.cdlist, NULL);
+        }
+        if (bench_selected(cfg, "stack"))
+            for (const struct bench_op *op = stack_ops; op->name; ++op)
+                bench_run_op("stack", op, &b, n);
+        if (bench_selected(cfg, "queue"))
+            for (const struct bench_op *op = queue_ops; op->name; ++op)
+                bench_run_op("queue", op, &b, n);
+        if (bench_selected(cfg, "list/stack"))
+            for (const struct bench_op *op = list_stack_ops; op->name; ++op)
+                bench_run_op("list/stack", op, &b, n);
+        if (bench_selected(cfg, "cdlist/queue"))
+            for (const struct bench_op *op = cdlist_queue_ops; op->name; ++op)
+                bench_run_op("cdlist/queue", op, &b, n);
+        stack_destroy(&b.stack, NULL);
+        queue_destroy(&b.queue, NULL);
+        list_destroy(&b.list, NULL);
+        cdlist_destroy(&b.cdlist, NULL);
+    }
+}
@@ -0,0 +1,268 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "dlist.h"
+#include "tsdlist.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Operations made by each thread at the ends of the list per run
+#define TSDLIST_BENCH_ENDS_OPS 200000L
+
+// Sorted inserts, each followed by a removal by value, made by each thread
+#define TSDLIST_BENCH_SORTED_OPS 2000L
+
+// The number of elements kept in the list while the sorted workload runs
+#define TSDLIST_BENCH_SIZE 1000
+
+// What the fine-grained list replaces: a dlist behind one global mutex
+struct locked_dlist {
+    pthread_mutex_t lock;
+    struct dlist list;
+};
+
+struct tsdlist_bench_list {
+    const char *name;
+    int (*ins_head)(void *l, void *data);
+    int (*ins_tail)(void *l, void *data);
+    int (*rem_head)(void *l, void **data);
+    int (*rem_tail)(void *l, void **data);
+    int (*ins_sorted)(void *l, void *data);
+    int (*rem_match)(void *l, void *key);
+};
+
+struct tsdlist_bench_thread {
+    pthread_t thread;
+    const struct tsdlist_bench_list *list;
+    void *l;
+    int id;
+    pthread_barrier_t *start;
+    unsigned long allocs;
+};
+
+static int tsdlist_bench_cmp(const void *a, const void *b) {
+    return (uintptr_t)a < (uintptr_t)b ? -1 : (uintptr_t)a > (uintptr_t)b;
+}
+
+static int locked_ins_head(void *l, void *data) {
+    struct locked_dlist *d = l;
+    int ret;
+
+    pthread_mutex_lock(&d->lock);
+    ret = dlist_ins_head(&d->list, data);
+    pthread_mutex_unlock(&d->lock);
+    return ret;
+}
+
+static int locked_ins_tail(void *l, void *data) {
+    struct locked_dlist *d = l;
+    int ret;
+
+    pthread_mutex_lock(&d->lock);
+    ret = dlist_ins_tail(&d->list, data);
+    pthread_mutex_unlock(&d->lock);
+    return ret;
+}
+
+static int locked_rem_head(void *l, void **data) {
+    struct locked_dlist *d = l;
+    struct dlist_elem *head;
+    int ret = -1;
+
+    pthread_mutex_lock(&d->lock);
+    head = dlist_get_head(&d->list);
+    if (head != NULL) {
+        *data = head->data;
+        ret = dlist_rem_head(&d->list, NULL);
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ret;
+}
+
+static int locked_rem_tail(void *l, void **data) {
+    struct locked_dlist *d = l;
+    struct dlist_elem *tail;
+    int ret = -1;
+
+    pthread_mutex_lock(&d->lock);
+    tail = dlist_get_tail(&d->list);
+    if (tail != NULL) {
+        *data = tail->data;
+        ret = dlist_rem_tail(&d->list, NULL);
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ret;
+}
+
+static int locked_ins_sorted(void *l, void *data) {
+    struct locked_dlist *d = l;
+    struct dlist_elem *last = NULL;
+    int ret;
+
+    pthread_mutex_lock(&d->lock);
+    dlist_for_each(&d->list, elem) {
+        if (tsdlist_bench_cmp(elem->data, data) > 0)
+            break;
+        last = elem;
+    }
+    if (last == NULL)
+        ret = dlist_ins_head(&d->list, data);
+    else
+        ret = dlist_ins_next(&d->list, last, data);
+    pthread_mutex_unlock(&d->lock);
+    return ret;
+}
+
+static int locked_rem_match(void *l, void *key) {
+    struct locked_dlist *d = l;
+    int ret = -1;
+
+    pthread_mutex_lock(&d->lock);
+    dlist_for_each(&d->list, elem)
+        if (tsdlist_bench_cmp(elem->data, key) == 0) {
+            ret = dlist_rem_elem(&d->list, elem, NULL);
+            break;
+        }
+    pthread_mutex_unlock(&d->lock);
+    return ret;
+}
+
+static int fine_ins_head(void *l, void *data) {
+    return tsdlist_ins_head(l, data);
+}
+
+static int fine_ins_tail(void *l, void *data) {
+    return tsdlist_ins_tail(l, data);
+}
+
+static int fine_rem_head(void *l, void **data) {
+    return tsdlist_rem_head(l, data);
+}
+
+static int fine_rem_tail(void *l, void **data) {
+    return tsdlist_rem_tail(l, data);
+}
+
+static int fine_ins_sorted(void *l, void *data) {
+    return tsdlist_ins_sorted(l, data, tsdlist_bench_cmp);
+}
+
+static int fine_rem_match(void *l, void *key) {
+    return tsdlist_rem_match(l, key, tsdlist_bench_cmp, NULL);
+}
+
+static const struct tsdlist_bench_list lists[] = {
+    { "dlist/mutex", locked_ins_head, locked_ins_tail, locked_rem_head,
+      locked_rem_tail, locked_ins_sorted, locked_rem_match },
+    { "tsdlist", fine_ins_head, fine_ins_tail, fine_rem_head, fine_rem_tail,
+      fine_ins_sorted, fine_rem_match },
+};
+
+// Even threads push at the head and pop at the tail, odd threads the other
+// way round, so the list is used as a deque from both ends at once
+static void* ends(void *arg) {
+    struct tsdlist_bench_thread *t = arg;
+    unsigned long before = bench_allocs;
+    void *data;
+
+    pthread_barrier_wait(t->start);
+    for (uintptr_t i = 1; i <= TSDLIST_BENCH_ENDS_OPS / 2; ++i) {
+        if (t->id % 2) {
+            t->list->ins_tail(t->l, (void *)i);
+            t->list->rem_head(t->l, &data);
+        } else {
+            t->list->ins_head(t->l, (void *)i);
+            t->list->rem_tail(t->l, &data);
+        }
+    }
+    t->allocs = bench_allocs - before;
+    return NULL;
+}
+
+// The list holds the even numbers below twice TSDLIST_BENCH_SIZE. Each thread
+// puts in odd numbers spread across that range and takes each straight back
+// out, so walks from the head run over each other all the way along.
+static void* sorted(void *arg) {
+    struct tsdlist_bench_thread *t = arg;
+    unsigned long before = bench_allocs;
+    uintptr_t key = (uintptr_t)t->id * 2 + 1;
+
+    pthread_barrier_wait(t->start);
+    for (long i = 0; i < TSDLIST_BENCH_SORTED_OPS / 2; ++i) {
+        key = (key * 37 + 2) % (TSDLIST_BENCH_SIZE * 2);
+        key |= 1;
+        t->list->ins_sorted(t->l, (void *)key);
+        t->list->rem_match(t->l, (void *)key);
+    }
+    t->allocs = bench_allocs - before;
+    return NULL;
+}
+
+static void run(const struct tsdlist_bench_list *list, void *l, int threads,
+                const char *op, void *(*work)(void *), long ops, long size) {
+    struct tsdlist_bench_thread t[threads];
+    pthread_barrier_t start;
+    unsigned long allocs = 0;
+    uint64_t begin;
+
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+    for (int i = 0; i < threads; ++i) {
+        t[i].list = list;
+        t[i].l = l;
+        t[i].id = i;
+        t[i].start = &start;
+        pthread_create(&t[i].thread, NULL, work, &t[i]);
+    }
+    begin = bench_now();
+    pthread_barrier_wait(&start);
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(t[i].thread, NULL);
+        allocs += t[i].allocs;
+    }
+    bench_report(list->name, op, size, threads, ops * threads,
+                 bench_now() - begin, allocs, NULL, 0);
+    pthread_barrier_destroy(&start);
+}
+
+static void run_all(const struct tsdlist_bench_list *list, void *l,
+                    int threads) {
+    void *data;
+
+    run(list, l, threads, "ends", ends, TSDLIST_BENCH_ENDS_OPS, 0);
+    for (uintptr_t i = 0; i < TSDLIST_BENCH_SIZE; ++i)
+        list->ins_tail(l, (void *)(i * 2));
+    run(list, l, threads, "sorted", sorted, TSDLIST_BENCH_SORTED_OPS,
+        TSDLIST_BENCH_SIZE);
+    while (list->rem_head(l, &data) == 0)
+        ;
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+void bench_tsdlist(const struct bench_config *cfg) {
+    struct locked_dlist locked;
+    struct tsdlist fine;
+
+    // ns/op is wall time over the operations of all threads, so it halves each
+    // time the threads double if the list scales perfectly
+    for (int threads = 1; threads <= cfg->max_threads; threads *= 2) {
+        if (bench_selected(cfg, lists[0].name)) {
+            pthread_mutex_init(&locked.lock, NULL);
+            dlist_init(&locked.list);
+            run_all(&lists[0], &locked, threads);
+            dlist_destroy(&locked.list, NULL);
+            pthread_mutex_destroy(&locked.lock);
+        }
+        if (bench_selected(cfg, lists[1].name) && tsdlist_init(&fine) == 0) {
+            run_all(&lists[1], &fine, threads);
+            tsdlist_destroy(&fine, NULL);
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "dlist.h"
+#include "pool.h"
+#include "xlist.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Short lists are walked repeatedly so that each timing covers at least this
+// many elements
+#define XLIST_BENCH_MIN_OPS 1000000L
+
+static uint64_t dlist_sum(void *l) {
+    uint64_t sum = 0;
+
+    dlist_for_each((struct dlist *)l, elem)
+        sum += (uintptr_t)elem->data;
+    return sum;
+}
+
+static uint64_t dlist_sum_rev(void *l) {
+    uint64_t sum = 0;
+
+    dlist_for_each_elem_rev(dlist_get_tail(l), elem)
+        sum += (uintptr_t)elem->data;
+    return sum;
+}
+
+static uint64_t xlist_sum(void *l) {
+    uint64_t sum = 0;
+
+    xlist_for_each((struct xlist *)l, elem)
+        sum += (uintptr_t)elem->data;
+    return sum;
+}
+
+static uint64_t xlist_sum_rev(void *l) {
+    uint64_t sum = 0;
+
+    xlist_for_each_rev((struct xlist *)l, elem)
+        sum += (uintptr_t)elem->data;
+    return sum;
+}
+
+// Times enough walks with sum to cover XLIST_BENCH_MIN_OPS elements
+static void run_walk(const char *structure, const char *op, void *l,
+                     long size, uint64_t (*sum)(void *l)) {
+    long passes = XLIST_BENCH_MIN_OPS / size > 0
+                  ? XLIST_BENCH_MIN_OPS / size : 1;
+    uint64_t start, total = 0;
+
+    start = bench_now();
+    for (long i = 0; i < passes; ++i)
+        total += sum(l);
+    bench_report(structure, op, size, 1, size * passes, bench_now() - start,
+                 0, NULL, 0);
+    if (total != (uint64_t)passes * (uint64_t)size * (uint64_t)(size - 1) / 2)
+        printf("# %s %s summed the wrong elements\n", structure, op);
+}
+
+// Builds a dlist of size elements, from pool if it is non-NULL, and measures
+// its footprint and walks in both directions
+static void bench_dlist_side(const char *structure, long size,
+                             struct pool *pool) {
+    struct dlist dlist;
+    unsigned long before;
+    size_t heap;
+    uint64_t start;
+
+    heap = bench_heap_bytes();
+    if (pool != NULL)
+        dlist_init_with_pool(&dlist, pool);
+    else
+        dlist_init(&dlist);
+    before = bench_allocs;
+    start = bench_now();
+    for (long i = 0; i < size; ++i)
+        dlist_ins_tail(&dlist, (void *)(uintptr_t)i);
+    bench_report(structure, "ins_tail", size, 1, size, bench_now() - start,
+                 bench_allocs - before, NULL, 0);
+    bench_report_bytes(structure, size, heap);
+    run_walk(structure, "for_each", &dlist, size, dlist_sum);
+    run_walk(structure, "for_each_rev", &dlist, size, dlist_sum_rev);
+    dlist_destroy(&dlist, NULL);
+}
+
+static void bench_xlist_side(const char *structure, long size,
+                             struct pool *pool) {
+    struct xlist xlist;
+    unsigned long before;
+    size_t heap;
+    uint64_t start;
+
+    heap = bench_heap_bytes();
+    if (pool != NULL)
+        xlist_init_with_pool(&xlist, pool);
+    else
+        xlist_init(&xlist);
+    before = bench_allocs;
+    start = bench_now();
+    for (long i = 0; i < size; ++i)
+        xlist_ins_tail(&xlist, (void *)(uintptr_t)i);
+    bench_report(structure, "ins_tail", size, 1, size, bench_now() - start,
+                 bench_allocs - before, NULL, 0);
+    bench_report_bytes(structure, size, heap);
+    run_walk(structure, "for_each", &xlist, size, xlist_sum);
+    run_walk(structure, "for_each_rev", &xlist, size, xlist_sum_rev);
+    xlist_destroy(&xlist, NULL);
+}
+
+// -----------------------------------------------------------------------------
+//                                   Suite
+// -----------------------------------------------------------------------------
+
+// The dlist rows carry the suite's name, as bench_lists already reports plain
+// dlist ins_tail and for_each
+void bench_xlist(const struct bench_config *cfg) {
+    struct pool pool;
+
+    for (long size = cfg->min_size; size <= cfg->max_size; size *= 10) {
+        if (bench_selected(cfg, "dlist@xlist")) {
+            bench_dlist_side("dlist@xlist", size, NULL);
+            pool_init(&pool, sizeof(struct dlist_elem), 0);
+            bench_dlist_side("dlist/pool@xlist", size, &pool);
+            pool_destroy(&pool);
+        }
+        if (bench_selected(cfg, "xlist")) {
+            bench_xlist_side("xlist", size, NULL);
+            pool_init(&pool, sizeof(struct xlist_elem), 0);
+            bench_xlist_side("xlist/pool", size, &pool);
+            pool_destroy(&pool);
+        }
+    }
+}
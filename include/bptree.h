@@ -0,0 +1,365 @@
+#ifndef BPTREE_H
+#define BPTREE_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    bptree.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An ordered map kept as a B+ tree. Every entry lives in a leaf, leaves are
+/// chained in key order for iteration and range scans, and the branches above
+/// them hold only separator keys. Nodes are BPTREE_NODE_SIZE bytes and aligned
+/// to cache lines, so each level of a lookup touches a few adjacent lines
+/// rather than one scattered node per comparison as a binary tree would. A
+/// lookup costs O(log n) comparisons and the tree's height in node visits.
+///
+/// Keys and data are stored as pointers and neither is copied. Keys are
+/// ordered by the cmp callback given to bptree_init and are never freed by the
+/// tree. Branches only ever name keys of entries still in the tree, so a key
+/// may be freed as soon as its entry has been removed.
+
+#include <stddef.h>
+
+struct dlist;
+struct list;
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The size of every node in bytes. Define before building the library to
+/// change it; it should be a multiple of BPTREE_CACHE_LINE.
+#ifndef BPTREE_NODE_SIZE
+#define BPTREE_NODE_SIZE 256
+#endif
+
+/// The alignment of every node
+#define BPTREE_CACHE_LINE 64
+
+/// The header shared by leaves and branches
+///
+/// These are created and managed by the bptree_ functions. You should never
+/// need to touch them.
+struct bptree_node {
+    unsigned int count;
+    unsigned int leaf;
+};
+
+/// One entry of a bptree
+struct bptree_entry {
+    void *key;
+    void *data;
+};
+
+/// The number of separator keys that fit in a branch node
+#define BPTREE_BRANCH_KEYS                                              \
+    ((BPTREE_NODE_SIZE - sizeof(struct bptree_node) - sizeof(void *))   \
+     / (2 * sizeof(void *)))
+
+/// The number of entries that fit in a leaf node
+#define BPTREE_LEAF_ENTRIES                                             \
+    ((BPTREE_NODE_SIZE - sizeof(struct bptree_node) - 2 * sizeof(void *)) \
+     / sizeof(struct bptree_entry))
+
+/// An inner node. Every key in children[i] orders before keys[i], and every
+/// key in children[i + 1] orders at or after it.
+struct bptree_branch {
+    struct bptree_node node;
+    void *keys[BPTREE_BRANCH_KEYS];
+    struct bptree_node *children[BPTREE_BRANCH_KEYS + 1];
+};
+
+/// A leaf node, holding entries in key order
+struct bptree_leaf {
+    struct bptree_node node;
+    /*@null@*/ struct bptree_leaf *prev;
+    /*@null@*/ struct bptree_leaf *next;
+    struct bptree_entry entries[BPTREE_LEAF_ENTRIES];
+};
+
+/// A position in a bptree
+///
+/// entry is NULL when the cursor is past either end. A cursor is only valid
+/// until the tree is next changed.
+struct bptree_cursor {
+    /*@null@*/ struct bptree_leaf *leaf;
+    /*@null@*/ struct bptree_entry *entry;
+};
+
+/// A B+ tree struct
+///
+/// This structure must be initialised with bptree_init() before use. When done
+/// with, use bptree_destroy. head and tail are the first and last leaves.
+struct bptree {
+    /*@null@*/ struct bptree_node *root;
+    /*@null@*/ struct bptree_leaf *head;
+    /*@null@*/ struct bptree_leaf *tail;
+    size_t size;
+    int height;
+    int (*cmp)(const void *a, const void *b);
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a B+ tree. This operation must be called for a bptree before
+/// the bptree can be used with any other operation. Nothing is allocated until
+/// the first insertion.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param bptree The bptree to initialise
+/// @param cmp Callback function ordering two keys, returning less than, equal
+///            to or greater than zero as strcmp does
+void bptree_init(/*@out@*/ struct bptree *bptree,
+                 /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Destroys a B+ tree. If destroy is non-NULL it is called on the data of
+/// every entry. The tree is left empty and may be reused.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param bptree The bptree to destroy
+/// @param destroy Callback function for freeing each entry's data
+void bptree_destroy(/*@notnull@*/ struct bptree *bptree,
+                    /*@null@*/ void (*destroy)(void *data));
+
+/// Fills an empty B+ tree from a dlist already sorted by key, building the
+/// tree bottom-up with full leaves rather than inserting entry by entry. The
+/// data of each element is stored under the key returned by key, or under the
+/// data itself if key is NULL. The dlist is left untouched.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param bptree The empty bptree to fill
+/// @param dlist The dlist to load, in strictly ascending key order
+/// @param key Callback function returning the key of an element's data
+///
+/// @return 0 on success, -1 if bptree is not empty, the dlist is out of order
+///         or on failure. bptree is left empty on failure
+int bptree_load_dlist(/*@notnull@*/ struct bptree *bptree,
+                      /*@notnull@*/ const struct dlist *dlist,
+                      /*@null@*/ void* (*key)(void *data));
+
+/// Fills an empty B+ tree from a list already sorted by key, as
+/// bptree_load_dlist does.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param bptree The empty bptree to fill
+/// @param list The list to load, in strictly ascending key order
+/// @param key Callback function returning the key of an element's data
+///
+/// @return 0 on success, -1 if bptree is not empty, the list is out of order
+///         or on failure. bptree is left empty on failure
+int bptree_load_list(/*@notnull@*/ struct bptree *bptree,
+                     /*@notnull@*/ const struct list *list,
+                     /*@null@*/ void* (*key)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the number of entries in a bptree.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param bptree The bptree whose entries to count
+///
+/// @return Number of entries in bptree
+size_t bptree_get_size(/*@notnull@*/ const struct bptree *bptree);
+
+/// Determine whether a bptree is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param bptree The bptree to test for emptiness
+///
+/// @return 1 if the bptree contains no entries, else 0
+int bptree_is_empty(/*@notnull@*/ const struct bptree *bptree);
+
+/// Finds the entry for a key.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param bptree The bptree to search
+/// @param key The key to look for
+///
+/// @return A cursor at the entry, with a NULL entry if key is not present
+struct bptree_cursor bptree_find(/*@notnull@*/ const struct bptree *bptree,
+                                 /*@null@*/ const void *key);
+
+/// Returns the data stored under a key.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param bptree The bptree to search
+/// @param key The key to look for
+///
+/// @return The key's data, or NULL if key is not present
+/*@null@*/
+void* bptree_get(/*@notnull@*/ const struct bptree *bptree,
+                 /*@null@*/ const void *key);
+
+/// Finds the first entry whose key does not order before key.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param bptree The bptree to search
+/// @param key The bound
+///
+/// @return A cursor at the entry, with a NULL entry if every key orders
+///         before key
+struct bptree_cursor bptree_lower_bound(/*@notnull@*/ const struct bptree *bptree,
+                                        /*@null@*/ const void *key);
+
+/// Finds the first entry whose key orders after key.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param bptree The bptree to search
+/// @param key The bound
+///
+/// @return A cursor at the entry, with a NULL entry if no key orders after key
+struct bptree_cursor bptree_upper_bound(/*@notnull@*/ const struct bptree *bptree,
+                                        /*@null@*/ const void *key);
+
+/// Returns a cursor at the entry with the smallest key.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param bptree The bptree to iterate over
+///
+/// @return The cursor, with a NULL entry if the bptree is empty
+struct bptree_cursor bptree_first(/*@notnull@*/ const struct bptree *bptree);
+
+/// Returns a cursor at the entry with the largest key.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param bptree The bptree to iterate over
+///
+/// @return The cursor, with a NULL entry if the bptree is empty
+struct bptree_cursor bptree_last(/*@notnull@*/ const struct bptree *bptree);
+
+/// Moves a cursor to the next entry in key order.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param cursor The cursor to move. Its entry becomes NULL past the end
+void bptree_next(/*@notnull@*/ struct bptree_cursor *cursor);
+
+/// Moves a cursor to the previous entry in key order.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param cursor The cursor to move. Its entry becomes NULL past the start
+void bptree_prev(/*@notnull@*/ struct bptree_cursor *cursor);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Inserts data under a key. A full leaf is split in two, which may split the
+/// nodes above it in turn.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param bptree The bptree to insert into
+/// @param key The key to store data under
+/// @param data The data to store
+///
+/// @return 0 on success, -1 if key is already present or on failure, in which
+///         case the tree is unchanged
+int bptree_ins(/*@notnull@*/ struct bptree *bptree,
+               /*@null@*/ void *key,
+               /*@null@*/ void *data);
+
+/// Removes the entry for a key. If destroy is non-NULL it is called on the
+/// entry's data, after the entry's key has left every branch. A node left less
+/// than half full borrows from or merges with a sibling.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param bptree The bptree to remove from
+/// @param key The key to remove
+/// @param destroy Callback function for freeing the entry's data
+///
+/// @return 0 on success, -1 if key is not present
+int bptree_rem(/*@notnull@*/ struct bptree *bptree,
+               /*@null@*/ const void *key,
+               /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the entries of a bptree in
+/// key order. name is a struct bptree_cursor; use name.entry->key and
+/// name.entry->data. The bptree must not be changed during the loop.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param bptree The bptree to iterate over
+/// @param name The name used for the iterator
+#define bptree_for_each(bptree, name)                                   \
+    for (struct bptree_cursor name = bptree_first(bptree);              \
+         name.entry;                                                    \
+         bptree_next(&name))
+
+/// A macro for generating for loops - loop over all the entries of a bptree
+/// backwards, from the largest key to the smallest
+///
+/// COMPLEXITY: O(n)
+///
+/// @param bptree The bptree to iterate over
+/// @param name The name used for the iterator
+#define bptree_for_each_rev(bptree, name)                               \
+    for (struct bptree_cursor name = bptree_last(bptree);               \
+         name.entry;                                                    \
+         bptree_prev(&name))
+
+/// A macro for generating for loops - loop over the entries of a bptree whose
+/// keys order at or after lo and before hi, in key order
+///
+/// COMPLEXITY: O(log n + m) for m entries in the range
+///
+/// @param bptree The bptree to iterate over
+/// @param lo The inclusive lower bound
+/// @param hi The exclusive upper bound
+/// @param name The name used for the iterator
+#define bptree_for_each_range(bptree, lo, hi, name)                     \
+    for (struct bptree_cursor name = bptree_lower_bound(bptree, lo);    \
+         name.entry && (bptree)->cmp(name.entry->key, hi) < 0;          \
+         bptree_next(&name))
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // BPTREE_H
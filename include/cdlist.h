@@ -31,10 +31,18 @@
 /// A simple, generic circular doubly linked list structure using a generic data
 /// structure.
 
+#include "prefetch.h"
+#include <stddef.h>
+
 // -----------------------------------------------------------------------------
 //                                 Structures
 // -----------------------------------------------------------------------------
 
+struct ebr;
+struct listio_codec;
+struct pool;
+struct workpool;
+
 /// Individual elements within a circular doubly linked list
 ///
 /// These should almost universally be created and managed by the cdlist_
@@ -47,13 +55,22 @@ struct cdlist_elem {
 
 /// A generic circular doubly linked list struct
 ///
-/// This structure must be initialised with cdlist_init() before use. When done
-/// with, use list_destroy. Note that this differs by not providing a
-/// transparent data structure -- to access the head (or tail) element you must
-/// use a getter function. The "link" member of this struct is an empty list
-/// element used for handle termination when iterating correctly.
+/// This structure must be initialised with cdlist_init() or
+/// cdlist_init_with_pool() before use. When done with, use list_destroy. Note
+/// that this differs by not providing a transparent data structure -- to access
+/// the head (or tail) element you must use a getter function. The "link" member
+/// of this struct is an empty list element used for handle termination when
+/// iterating correctly. pool is NULL unless elements come from a pool, and ebr
+/// is NULL unless one was attached with cdlist_set_ebr. size is kept up to
+/// date by every operation unless STRUCTURES_NO_SIZE_CACHE is defined, in which
+/// case cdlist_get_size counts the elements instead.
 struct cdlist {
     struct cdlist_elem link;
+    struct pool *pool;
+    struct ebr *ebr;
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    int size;
+#endif
 };
 
 // -----------------------------------------------------------------------------
@@ -73,10 +90,26 @@ struct cdlist {
 /// @param cdlist The circular doubly linked list to initialise
 void cdlist_init(/*@out@*/ struct cdlist *cdlist);
 
+/// Initialises a circular doubly linked list whose elements are allocated from
+/// pool instead of with malloc. The pool must have been initialised with an
+/// element size of at least sizeof(struct cdlist_elem) and must outlive the
+/// cdlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing an initialised cdlist to this function is undefined
+/// behaviour. Expect a memory leak.
+///
+/// @param cdlist The circular doubly linked list to initialise
+/// @param pool The pool to allocate elements from
+void cdlist_init_with_pool(/*@out@*/ struct cdlist *cdlist,
+                           /*@notnull@*/ struct pool *pool);
+
 /// Destroys a circular doubly linked list. No other operations are permitted
 /// after destroying unless cdlist_init is called on the list again. This
 /// function removes all elements from the list and calls destroy on their data
-/// unless destroy is NULL.
+/// unless destroy is NULL. The elements of a pooled cdlist are handed back to
+/// the pool in one go rather than freed one at a time.
 ///
 /// COMPLEXITY: O(n)
 ///
@@ -87,6 +120,19 @@ void cdlist_init(/*@out@*/ struct cdlist *cdlist);
 void cdlist_destroy(/*@notnull@*/ struct cdlist *cdlist,
                     /*@null@*/ void (*destroy)(void *data));
 
+/// Attaches an ebr to a cdlist, after which its rem functions retire elements
+/// to the ebr instead of freeing them, and readers registered with the ebr may
+/// walk the cdlist with cdlist_for_each_ebr while it is changed; see ebr.h. The
+/// ebr must outlive the cdlist, and must be attached before the cdlist is
+/// shared with any reader.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param cdlist The cdlist to attach ebr to
+/// @param ebr The ebr to retire removed elements to
+void cdlist_set_ebr(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@notnull@*/ struct ebr *ebr);
+
 // -----------------------------------------------------------------------------
 //                                 Accessors
 // -----------------------------------------------------------------------------
@@ -102,10 +148,9 @@ void cdlist_destroy(/*@notnull@*/ struct cdlist *cdlist,
 /*@null@*/
 struct cdlist_elem* cdlist_get_head(/*@notnull@*/ const struct cdlist *cdlist);
 
-/// Counts the elements in a cdlist. This is highly inefficient and probably not
-/// a good use of a linked list.
+/// Returns the number of elements in a cdlist.
 ///
-/// COMPLEXITY: O(n)
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_SIZE_CACHE is defined
 ///
 /// @param cdlist Circular doubly linked list whose elements to count
 ///
@@ -129,7 +174,7 @@ struct cdlist_elem* cdlist_get_tail(/*@notnull@*/ const struct cdlist *cdlist);
 ///
 /// @param cdlist The cdlist to test for emptiness
 ///
-/// @return 1 if the cdlist contains any elements, else 0
+/// @return 1 if the cdlist contains no elements, else 0
 int cdlist_is_empty(/*@notnull@*/ const struct cdlist *cdlist);
 
 // -----------------------------------------------------------------------------
@@ -148,27 +193,33 @@ int cdlist_ins_head(/*@notnull@*/ struct cdlist *cdlist,
                     /*@null@*/ void *data);
 
 /// Inserts an element to a circular doubly linked list after the given element.
+/// cdlist is required so that the new element can be allocated from the
+/// cdlist's pool.
 ///
 /// COMPLEXITY: O(1)
 ///
+/// @param cdlist The parent list
 /// @param elem The element to insert after
 /// @param data The data the newly created element should point to
 ///
 /// @return 0 for success, -1 for failure
-int cdlist_ins_next(/*@notnull@*/ struct cdlist_elem *elem,
+int cdlist_ins_next(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@notnull@*/ struct cdlist_elem *elem,
                     /*@null@*/ void *data);
 
 /// Inserts an element to a circular doubly linked list before the given
-/// element.
+/// element. cdlist is required so that the new element can be allocated from
+/// the cdlist's pool.
 ///
 /// COMPLEXITY: O(1)
 ///
-/// @param cdlist The parent list. Used for resetting the list head
+/// @param cdlist The parent list
 /// @param elem The element to insert before
 /// @param data The data the newly created element should point to
 ///
 /// @return 0 for success, -1 for failure
-int cdlist_ins_prev(/*@notnull@*/ struct cdlist_elem *elem,
+int cdlist_ins_prev(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@notnull@*/ struct cdlist_elem *elem,
                     /*@null@*/ void *data);
 
 /// Inserts an element into a circular doubly linked list at the tail end.
@@ -182,9 +233,26 @@ int cdlist_ins_prev(/*@notnull@*/ struct cdlist_elem *elem,
 int cdlist_ins_tail(/*@notnull@*/ struct cdlist *cdlist,
                     /*@null@*/ void *data);
 
+/// Inserts n elements at the end of a cdlist, the i-th pointing to data[i]. The
+/// elements are allocated together, from a single block of the cdlist's pool if
+/// it has one, and linked in one pass. Either every element is inserted or,
+/// on failure, none is.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param cdlist The cdlist to insert at the end of
+/// @param data The data the new elements should point to, in order
+/// @param n The number of elements to insert
+///
+/// @return 0 for success, -1 for failure
+int cdlist_ins_tail_n(/*@notnull@*/ struct cdlist *cdlist,
+                      /*@notnull@*/ void **data,
+                      int n);
+
 /// Removes an element from a circular doubly linked list. The destroyed element
 /// will have destroy() called upon elem->data to free it if destroy is
-/// non-NULL.
+/// non-NULL. cdlist is required so that the element can be returned to the
+/// cdlist's pool.
 ///
 /// COMPLEXITY: O(1)
 ///
@@ -195,7 +263,8 @@ int cdlist_ins_tail(/*@notnull@*/ struct cdlist *cdlist,
 /// @param destroy Callback function for freeing the element's data
 ///
 /// @return 0 on success, -1 on failure
-int cdlist_rem_elem(/*@notnull@*/ struct cdlist_elem *elem,
+int cdlist_rem_elem(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@notnull@*/ struct cdlist_elem *elem,
                     /*@null@*/ void (*destroy)(void *data));
 
 /// Removes an element from the head of a circular doubly linked list. If
@@ -212,6 +281,26 @@ int cdlist_rem_elem(/*@notnull@*/ struct cdlist_elem *elem,
 int cdlist_rem_head(/*@notnull@*/ struct cdlist *cdlist,
                     /*@null@*/ void (*destroy)(void *data));
 
+/// Removes up to n elements from the head of a cdlist, as repeated calls to
+/// cdlist_rem_head would, but unlinking them in one pass and, if the cdlist has a
+/// pool and no ebr, returning them to the pool in one go. If out is non-NULL
+/// the data of the i-th element removed is stored in out[i]. If destroy is
+/// non-NULL it is called on each element's data; leave it NULL when keeping
+/// the data in out.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param cdlist The cdlist to remove from the head of
+/// @param out Where to store the removed data, with room for n pointers
+/// @param n The most elements to remove
+/// @param destroy Callback function for freeing the elements' data
+///
+/// @return The number of elements removed, fewer than n if the cdlist ran out
+int cdlist_rem_head_n(/*@notnull@*/ struct cdlist *cdlist,
+                      /*@null@*/ void **out,
+                      int n,
+                      /*@null@*/ void (*destroy)(void *data));
+
 /// Removes an element from the tail of a circular doubly linked list. If
 /// destroy is non-NULL it will be used to free the element's data.
 ///
@@ -226,6 +315,146 @@ int cdlist_rem_head(/*@notnull@*/ struct cdlist *cdlist,
 int cdlist_rem_tail(/*@notnull@*/ struct cdlist *cdlist,
                     /*@null@*/ void (*destroy)(void *data));
 
+/// Moves every element of other onto the tail of cdlist, leaving other empty.
+/// No element is allocated, freed or copied: the two chains are relinked. Both
+/// lists must share the same pool, or both have none, as elements are always
+/// returned to the pool of the list they are on.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param cdlist The cdlist to append to
+/// @param other The cdlist whose elements are moved
+///
+/// @return 0 on success, -1 if the pools differ or cdlist and other are the
+/// same list
+int cdlist_concat(/*@notnull@*/ struct cdlist *cdlist,
+                  /*@notnull@*/ struct cdlist *other);
+
+/// Moves every element of other into cdlist after elem, or at the head if elem
+/// is NULL, leaving other empty. As with cdlist_concat, elements are relinked
+/// in place and both lists must share the same pool.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param cdlist The cdlist to insert into
+/// @param elem The element of cdlist to insert after, or NULL for the head
+/// @param other The cdlist whose elements are moved
+///
+/// @return 0 on success, -1 if the pools differ or cdlist and other are the
+/// same list
+int cdlist_splice(/*@notnull@*/ struct cdlist *cdlist,
+                  /*@null@*/ struct cdlist_elem *elem,
+                  /*@notnull@*/ struct cdlist *other);
+
+/// Moves every element after elem, or the whole cdlist if elem is NULL, onto
+/// other, which must be empty. elem becomes the tail of cdlist. Elements are
+/// relinked in place and both lists must share the same pool.
+///
+/// COMPLEXITY: O(k) in the number of elements moved, O(1) if
+/// STRUCTURES_NO_SIZE_CACHE is defined
+///
+/// @param cdlist The cdlist to split
+/// @param elem The element of cdlist to split after, or NULL to move everything
+/// @param other An empty cdlist to receive the elements after elem
+///
+/// @return 0 on success, -1 if the pools differ or other is not empty
+int cdlist_split_at(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@null@*/ struct cdlist_elem *elem,
+                    /*@notnull@*/ struct cdlist *other);
+
+/// Sorts a cdlist in place with a stable merge sort. Elements are relinked
+/// rather than reallocated, so pointers to them stay valid. cmp is given two
+/// elements' data pointers and returns less than, equal to or greater than
+/// zero, as strcmp does.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param cdlist The cdlist to sort
+/// @param cmp Callback function comparing two elements' data
+void cdlist_sort(/*@notnull@*/ struct cdlist *cdlist,
+                 /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Sorts a cdlist as cdlist_sort does, using up to threads threads. Each thread
+/// is given at least LISTSORT_PARALLEL_MIN elements, so short lists are sorted
+/// on the calling thread alone. cmp must be safe to call concurrently.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param cdlist The cdlist to sort
+/// @param cmp Callback function comparing two elements' data
+/// @param threads The most threads to use
+void cdlist_sort_parallel(/*@notnull@*/ struct cdlist *cdlist,
+                          /*@notnull@*/
+                          int (*cmp)(const void *a, const void *b),
+                          int threads);
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+/// Calls fn on every element's data, spread in chunks of LISTPAR_CHUNK elements
+/// over the workers of workpool, and returns once every call has. Elements are
+/// visited in no particular order. Runs on the calling thread alone if workpool
+/// is NULL or the cdlist is short. The cdlist must not change until this
+/// returns.
+///
+/// COMPLEXITY: O(n / threads) if fn takes equal time for every element
+///
+/// @param cdlist The cdlist to iterate over
+/// @param fn Callback function given each element's data and arg. Called
+///           concurrently
+/// @param arg Passed through to fn
+/// @param workpool The workers to run on
+void cdlist_for_each_parallel(/*@notnull@*/ struct cdlist *cdlist,
+                              /*@notnull@*/ void (*fn)(void *data, void *arg),
+                              /*@null@*/ void *arg,
+                              /*@null@*/ struct workpool *workpool);
+
+/// Folds every element's data into acc, spread over the workers of workpool as
+/// cdlist_for_each_parallel is. acc holds the identity of combine on entry, and
+/// the result on return. Each chunk of elements is folded in order into its own
+/// copy of the identity, and the chunks are combined into acc in cdlist order,
+/// so combine need only be associative. See listpar_reduce.
+///
+/// COMPLEXITY: O(n / threads + n / LISTPAR_CHUNK)
+///
+/// @param cdlist The cdlist to reduce
+/// @param fold Callback function folding one element's data into an
+///             accumulator. Called concurrently on different accumulators
+/// @param combine Callback function folding the accumulator part into acc
+/// @param acc The identity on entry and the result on return
+/// @param acc_size The size of the accumulator in bytes
+/// @param arg Passed through to fold and combine
+/// @param workpool The workers to run on
+void cdlist_reduce_parallel(/*@notnull@*/ struct cdlist *cdlist,
+                            /*@notnull@*/
+                            void (*fold)(void *acc, void *data, void *arg),
+                            /*@notnull@*/
+                            void (*combine)(void *acc, const void *part,
+                                            void *arg),
+                            /*@notnull@*/ void *acc, size_t acc_size,
+                            /*@null@*/ void *arg,
+                            /*@null@*/ struct workpool *workpool);
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+/// Writes a cdlist to path in the format described in listio.h, one record per
+/// element in cdlist order, each element's data encoded by codec. The file can
+/// be mapped back with listio_map and walked without rebuilding the cdlist.
+///
+/// COMPLEXITY: O(n) plus the cost of encoding
+///
+/// @param cdlist The cdlist to write
+/// @param path The file to create or replace
+/// @param codec Turns each element's data into bytes
+///
+/// @return 0 on success, -1 on failure, in which case path is left as it was
+int cdlist_write(/*@notnull@*/ const struct cdlist *cdlist,
+                 /*@notnull@*/ const char *path,
+                 /*@notnull@*/ const struct listio_codec *codec);
+
 // -----------------------------------------------------------------------------
 //                               Looping Macros
 // -----------------------------------------------------------------------------
@@ -237,10 +466,23 @@ int cdlist_rem_tail(/*@notnull@*/ struct cdlist *cdlist,
 /// @param cdlist The cdlist to iterate over
 /// @param name The name used for the iterator
 #define cdlist_for_each(cdlist, name)                   \
-    for (struct cdlist_elem * name = cdlist->link.next; \
-         name != &cdlist->link;                         \
+    for (struct cdlist_elem * name = (cdlist)->link.next; \
+         name != &(cdlist)->link;                       \
          name = name->next)
 
+/// A macro for generating for loops - loop over all the elements of a cdlist
+/// from inside an ebr read section while another thread changes it. Every
+/// link is read with ebr_load, so ebr.h must be included to use this.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param cdlist The cdlist to iterate over
+/// @param name The name used for the iterator
+#define cdlist_for_each_ebr(cdlist, name)                           \
+    for (struct cdlist_elem * name = ebr_load((cdlist)->link.next); \
+         name != &(cdlist)->link;                                   \
+         name = ebr_load(name->next))
+
 /// A macro for generating for loops - loop over all the elements of a
 /// cdlist. This safe version allows for removal of the current element
 ///
@@ -250,11 +492,48 @@ int cdlist_rem_tail(/*@notnull@*/ struct cdlist *cdlist,
 /// @param name The name used for the iterator
 #define cdlist_for_each_safe(cdlist, name)                      \
     for (struct cdlist_elem                                     \
-             * name = cdlist->link.next,                        \
+             * name = (cdlist)->link.next,                      \
              * __temp_elem = name->next;                        \
-         name != &cdlist->link;                                 \
+         name != &(cdlist)->link;                               \
          name = __temp_elem, __temp_elem = __temp_elem->next)
 
+/// A macro for generating for loops - loop over all the elements of a cdlist,
+/// prefetching STRUCTURES_PREFETCH_DISTANCE elements ahead of the body. Worth
+/// using over cdlist_for_each when the body touches each element's data.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param cdlist The cdlist to iterate over
+/// @param name The name used for the iterator
+#define cdlist_for_each_prefetch(cdlist, name)                      \
+    for (struct cdlist_elem                                         \
+             * name = (cdlist)->link.next,                          \
+             * __ahead_elem = prefetch_ahead(name, &(cdlist)->link, \
+                                  offsetof(struct cdlist_elem, data),\
+                                  STRUCTURES_PREFETCH_DISTANCE);    \
+         name != &(cdlist)->link;                                   \
+         name = name->next,                                         \
+             __ahead_elem = prefetch_step(__ahead_elem, &(cdlist)->link))
+
+/// A macro for generating for loops - loop over all the elements of a cdlist,
+/// prefetching as cdlist_for_each_prefetch does. This safe version allows for
+/// removal of the current element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param cdlist The cdlist to iterate over
+/// @param name The name used for the iterator
+#define cdlist_for_each_safe_prefetch(cdlist, name)                 \
+    for (struct cdlist_elem                                         \
+             * name = (cdlist)->link.next,                          \
+             * __temp_elem = name->next,                            \
+             * __ahead_elem = prefetch_ahead(name, &(cdlist)->link, \
+                                  offsetof(struct cdlist_elem, data),\
+                                  STRUCTURES_PREFETCH_DISTANCE);    \
+         name != &(cdlist)->link;                                   \
+         name = __temp_elem, __temp_elem = __temp_elem->next,       \
+             __ahead_elem = prefetch_step(__ahead_elem, &(cdlist)->link))
+
 /// A macro for generating for loops - loop over all the elements of a cdlist
 /// backwards, starting with the tail and ending with the head
 ///
@@ -263,8 +542,8 @@ int cdlist_rem_tail(/*@notnull@*/ struct cdlist *cdlist,
 /// @param cdlist The cdlist to iterate over
 /// @param name The name used for the iterator
 #define cdlist_for_each_rev(cdlist, name)               \
-    for (struct cdlist_elem * name = cdlist->link.prev; \
-         name != &cdlist->link;                         \
+    for (struct cdlist_elem * name = (cdlist)->link.prev; \
+         name != &(cdlist)->link;                       \
          name = name->prev)
 
 /// A macro for generating for loops - loop over all the elements of a
@@ -276,9 +555,9 @@ int cdlist_rem_tail(/*@notnull@*/ struct cdlist *cdlist,
 /// @param name The name used for the iterator
 #define cdlist_for_each_rev_safe(cdlist, name)                  \
     for (struct cdlist_elem                                     \
-             * name = cdlist->link.prev,                        \
+             * name = (cdlist)->link.prev,                      \
              * __temp_elem = name->prev;                        \
-         name != &cdlist->link;                                 \
+         name != &(cdlist)->link;                               \
          name = __temp_elem, __temp_elem = __temp_elem->prev)
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,239 @@
+#ifndef CHASHT_H
+#define CHASHT_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    chasht.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A chained hash table mapping keys to data. Each bucket is an idlist and
+/// every entry embeds the idlist_elem linking it into its bucket, so entries
+/// are allocated once, from a pool owned by the table, and never copied.
+///
+/// The table grows incrementally. When it passes one entry per bucket a
+/// bucket array of twice the size is allocated alongside the old one, and
+/// each later insertion or removal relinks a few old buckets into the new
+/// array. Lookups check whichever array still holds the key's bucket. No
+/// single operation ever rehashes the whole table, so the worst case cost of
+/// an insertion stays flat as the table grows.
+///
+/// Keys and data are stored as pointers and neither is copied. Keys are never
+/// freed by the table; point them into the data they index, or manage them
+/// separately.
+
+#include "idlist.h"
+#include "pool.h"
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The number of old buckets moved into the new bucket array by each
+/// insertion or removal while the table is growing
+#define CHASHT_MIGRATE_STEP 8
+
+/// One entry of a chasht
+///
+/// These are created and managed by the chasht_ functions. Only key and data
+/// may be read, and only data may be written.
+struct chasht_entry {
+    struct idlist_elem link;
+    size_t hash;
+    void *key;
+    void *data;
+};
+
+/// A chained hash table struct
+///
+/// This structure must be initialised with chasht_init() before use. Nothing
+/// is allocated until the first insertion. old is the bucket array being
+/// migrated away from, or NULL when the table is not growing; its buckets
+/// below migrated have already been moved.
+struct chasht {
+    /*@null@*/ struct idlist *buckets;
+    size_t nbuckets;
+    /*@null@*/ struct idlist *old;
+    size_t old_nbuckets;
+    size_t migrated;
+    size_t size;
+    struct pool pool;
+    size_t (*hash)(const void *key);
+    int (*cmp)(const void *a, const void *b);
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a chained hash table. This operation must be called for a
+/// chasht before the chasht can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param chasht The chasht to initialise
+/// @param hash Callback function hashing a key, e.g. hash_str from hash.h
+/// @param cmp Callback function returning 0 if two keys are equal
+void chasht_init(/*@out@*/ struct chasht *chasht,
+                 /*@notnull@*/ size_t (*hash)(const void *key),
+                 /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Destroys a chained hash table. If destroy is non-NULL it is called on the
+/// data of every entry. The table is left empty and may be reused.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param chasht The chasht to destroy
+/// @param destroy Callback function for freeing each entry's data
+void chasht_destroy(/*@notnull@*/ struct chasht *chasht,
+                    /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Looks up the entry for a key.
+///
+/// COMPLEXITY: O(1) on average
+///
+/// @param chasht The chasht to search
+/// @param key The key to look up
+///
+/// @return The entry for key, or NULL if there is none
+/*@null@*/
+struct chasht_entry* chasht_find(/*@notnull@*/ const struct chasht *chasht,
+                                 /*@null@*/ const void *key);
+
+/// Looks up the data stored under a key. Use chasht_find instead if NULL may
+/// be stored as data.
+///
+/// COMPLEXITY: O(1) on average
+///
+/// @param chasht The chasht to search
+/// @param key The key to look up
+///
+/// @return The data stored under key, or NULL if there is none
+/*@null@*/
+void* chasht_get(/*@notnull@*/ const struct chasht *chasht,
+                 /*@null@*/ const void *key);
+
+/// Returns the number of entries in a chasht.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param chasht The chasht whose entries to count
+///
+/// @return Number of entries in chasht
+size_t chasht_get_size(/*@notnull@*/ const struct chasht *chasht);
+
+/// Determine whether a chasht is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param chasht The chasht to test for emptiness
+///
+/// @return 1 if the chasht contains no entries, else 0
+int chasht_is_empty(/*@notnull@*/ const struct chasht *chasht);
+
+/// Returns the first entry of a chasht, for use with chasht_next. Entries are
+/// in no meaningful order.
+///
+/// COMPLEXITY: O(b) in the number of buckets, O(1) amortised over a full
+/// iteration
+///
+/// @param chasht The chasht to iterate over
+///
+/// @return The first entry, or NULL if the chasht is empty
+/*@null@*/
+struct chasht_entry* chasht_first(/*@notnull@*/ const struct chasht *chasht);
+
+/// Returns the entry after entry.
+///
+/// COMPLEXITY: O(b) in the number of buckets, O(1) amortised over a full
+/// iteration
+///
+/// @param chasht The chasht being iterated over
+/// @param entry The current entry
+///
+/// @return The next entry, or NULL if entry was the last
+/*@null@*/
+struct chasht_entry* chasht_next(/*@notnull@*/ const struct chasht *chasht,
+                                 /*@notnull@*/ const struct chasht_entry *entry);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Inserts data under a key. While the table is growing, also moves up to
+/// CHASHT_MIGRATE_STEP buckets into the new bucket array.
+///
+/// COMPLEXITY: O(1) on average
+///
+/// @param chasht The chasht to insert into
+/// @param key The key to store data under
+/// @param data The data to store
+///
+/// @return 0 on success, -1 if key is already present or on failure
+int chasht_ins(/*@notnull@*/ struct chasht *chasht,
+               /*@null@*/ void *key,
+               /*@null@*/ void *data);
+
+/// Removes the entry for a key. If destroy is non-NULL it is called on the
+/// entry's data. While the table is growing, also moves up to
+/// CHASHT_MIGRATE_STEP buckets into the new bucket array.
+///
+/// COMPLEXITY: O(1) on average
+///
+/// @param chasht The chasht to remove from
+/// @param key The key of the entry to remove
+/// @param destroy Callback function for freeing the entry's data
+///
+/// @return 0 on success, -1 if key is not present
+int chasht_rem(/*@notnull@*/ struct chasht *chasht,
+               /*@null@*/ const void *key,
+               /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the entries of a chasht
+///
+/// COMPLEXITY: O(n + b) in the number of entries and buckets
+///
+/// @param chasht The chasht to iterate over
+/// @param name The name used for the iterator
+#define chasht_for_each(chasht, name)                                   \
+    for (struct chasht_entry * name = chasht_first(chasht);             \
+         name;                                                          \
+         name = chasht_next((chasht), name))
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // CHASHT_H
@@ -31,10 +31,18 @@
 /// A simple, generic circular linked list structure using a generic data
 /// structure.
 
+#include "prefetch.h"
+#include <stddef.h>
+
 // -----------------------------------------------------------------------------
 //                                 Structures
 // -----------------------------------------------------------------------------
 
+struct ebr;
+struct listio_codec;
+struct pool;
+struct workpool;
+
 /// Individual elements within a circular linked list
 ///
 /// These should almost universally be created and managed by the clist_
@@ -46,13 +54,22 @@ struct clist_elem {
 
 /// A generic circular doubly linked list struct
 ///
-/// This structure must be initialised with clist_init() before use. When done
-/// with, use list_destroy. Note that this differs by not providing a
-/// transparent data structure -- to access the head (or tail) element you must
-/// use a getter function. The "link" member of this struct is an empty list
-/// element used for handle termination when iterating correctly.
+/// This structure must be initialised with clist_init() or
+/// clist_init_with_pool() before use. When done with, use list_destroy. Note
+/// that this differs by not providing a transparent data structure -- to access
+/// the head (or tail) element you must use a getter function. The "link" member
+/// of this struct is an empty list element used for handle termination when
+/// iterating correctly. pool is NULL unless elements come from a pool, and ebr
+/// is NULL unless one was attached with clist_set_ebr. size is kept up to date
+/// by every operation unless STRUCTURES_NO_SIZE_CACHE is defined, in which case
+/// clist_get_size counts the elements instead.
 struct clist {
     struct clist_elem link;
+    struct pool *pool;
+    struct ebr *ebr;
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    int size;
+#endif
 };
 
 // -----------------------------------------------------------------------------
@@ -72,10 +89,25 @@ struct clist {
 /// @param clist The circular linked list to initialise
 void clist_init(/*@out@*/ struct clist *clist);
 
+/// Initialises a circular linked list whose elements are allocated from pool
+/// instead of with malloc. The pool must have been initialised with an element
+/// size of at least sizeof(struct clist_elem) and must outlive the clist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing an initialised clist to this function is undefined
+/// behaviour. Expect a memory leak.
+///
+/// @param clist The circular linked list to initialise
+/// @param pool The pool to allocate elements from
+void clist_init_with_pool(/*@out@*/ struct clist *clist,
+                          /*@notnull@*/ struct pool *pool);
+
 /// Destroys a circular linked list. No other operations are permitted after
 /// destroying unless clist_init is called on the list again. This function
 /// removes all elements from the list and calls destroy on their data unless
-/// destroy is NULL.
+/// destroy is NULL. The elements of a pooled clist are handed back to the pool
+/// in one go rather than freed one at a time.
 ///
 /// COMPLEXITY: O(n)
 ///
@@ -86,6 +118,19 @@ void clist_init(/*@out@*/ struct clist *clist);
 void clist_destroy(/*@notnull@*/ struct clist *clist,
                    /*@null@*/ void (*destroy)(void *data));
 
+/// Attaches an ebr to a clist, after which its rem functions retire elements to
+/// the ebr instead of freeing them, and readers registered with the ebr may
+/// walk the clist with clist_for_each_ebr while it is changed; see ebr.h. The
+/// ebr must outlive the clist, and must be attached before the clist is shared
+/// with any reader.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param clist The clist to attach ebr to
+/// @param ebr The ebr to retire removed elements to
+void clist_set_ebr(/*@notnull@*/ struct clist *clist,
+                   /*@notnull@*/ struct ebr *ebr);
+
 // -----------------------------------------------------------------------------
 //                                 Accessors
 // -----------------------------------------------------------------------------
@@ -101,10 +146,9 @@ void clist_destroy(/*@notnull@*/ struct clist *clist,
 /*@null@*/
 struct clist_elem* clist_get_head(/*@notnull@*/ const struct clist *clist);
 
-/// Counts the elements in a clist. This is highly inefficient and probably not
-/// a good use of a linked list.
+/// Returns the number of elements in a clist.
 ///
-/// COMPLEXITY: O(n)
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_SIZE_CACHE is defined
 ///
 /// @param clist Circular linked list whose elements to count
 ///
@@ -130,7 +174,7 @@ struct clist_elem* clist_get_tail(/*@notnull@*/ const struct clist *clist);
 ///
 /// @param clist The clist to test for emptiness
 ///
-/// @return 1 if the clist contains any elements, else 0
+/// @return 1 if the clist contains no elements, else 0
 int clist_is_empty(/*@notnull@*/ const struct clist *clist);
 
 // -----------------------------------------------------------------------------
@@ -148,15 +192,18 @@ int clist_is_empty(/*@notnull@*/ const struct clist *clist);
 int clist_ins_head(/*@notnull@*/ struct clist *clist,
                    /*@null@*/ void *data);
 
-/// Inserts an element to a circular linked list after the given element.
+/// Inserts an element to a circular linked list after the given element. clist
+/// is required so that the new element can be allocated from the clist's pool.
 ///
 /// COMPLEXITY: O(1)
 ///
+/// @param clist The parent clist
 /// @param elem The element to insert after
 /// @param data The data the newly created element should point to
 ///
 /// @return 0 for success, -1 for failure
-int clist_ins_next(/*@notnull@*/ struct clist_elem *elem,
+int clist_ins_next(/*@notnull@*/ struct clist *clist,
+                   /*@notnull@*/ struct clist_elem *elem,
                    /*@null@*/ void *data);
 
 /// Inserts an element into a circular linked list at the tail end.
@@ -172,6 +219,22 @@ int clist_ins_next(/*@notnull@*/ struct clist_elem *elem,
 int clist_ins_tail(/*@notnull@*/ struct clist *clist,
                    /*@null@*/ void *data);
 
+/// Inserts n elements at the end of a clist, the i-th pointing to data[i]. The
+/// elements are allocated together, from a single block of the clist's pool if
+/// it has one, and linked in one pass. Either every element is inserted or,
+/// on failure, none is.
+///
+/// COMPLEXITY: O(n + size)
+///
+/// @param clist The clist to insert at the end of
+/// @param data The data the new elements should point to, in order
+/// @param n The number of elements to insert
+///
+/// @return 0 for success, -1 for failure
+int clist_ins_tail_n(/*@notnull@*/ struct clist *clist,
+                     /*@notnull@*/ void **data,
+                     int n);
+
 /// Removes an element from the head of a circular linked list. If destroy is
 /// non-NULL it will be used to free the element's data.
 ///
@@ -186,6 +249,26 @@ int clist_ins_tail(/*@notnull@*/ struct clist *clist,
 int clist_rem_head(/*@notnull@*/ struct clist *clist,
                    /*@null@*/ void (*destroy)(void *data));
 
+/// Removes up to n elements from the head of a clist, as repeated calls to
+/// clist_rem_head would, but unlinking them in one pass and, if the clist has a
+/// pool and no ebr, returning them to the pool in one go. If out is non-NULL
+/// the data of the i-th element removed is stored in out[i]. If destroy is
+/// non-NULL it is called on each element's data; leave it NULL when keeping
+/// the data in out.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param clist The clist to remove from the head of
+/// @param out Where to store the removed data, with room for n pointers
+/// @param n The most elements to remove
+/// @param destroy Callback function for freeing the elements' data
+///
+/// @return The number of elements removed, fewer than n if the clist ran out
+int clist_rem_head_n(/*@notnull@*/ struct clist *clist,
+                     /*@null@*/ void **out,
+                     int n,
+                     /*@null@*/ void (*destroy)(void *data));
+
 /// Removes an element from a circular linked list after the given element. The
 /// destroyed element will have destroy() called upon elem->data to free it if
 /// destroy is non-NULL.
@@ -219,6 +302,97 @@ int clist_rem_next(/*@notnull@*/ struct clist *clist,
 int clist_rem_tail(/*@notnull@*/ struct clist *clist,
                    /*@null@*/ void (*destroy)(void *data));
 
+/// Sorts a clist in place with a stable merge sort. Elements are relinked
+/// rather than reallocated, so pointers to them stay valid. cmp is given two
+/// elements' data pointers and returns less than, equal to or greater than
+/// zero, as strcmp does.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param clist The clist to sort
+/// @param cmp Callback function comparing two elements' data
+void clist_sort(/*@notnull@*/ struct clist *clist,
+                /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Sorts a clist as clist_sort does, using up to threads threads. Each thread
+/// is given at least LISTSORT_PARALLEL_MIN elements, so short lists are sorted
+/// on the calling thread alone. cmp must be safe to call concurrently.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param clist The clist to sort
+/// @param cmp Callback function comparing two elements' data
+/// @param threads The most threads to use
+void clist_sort_parallel(/*@notnull@*/ struct clist *clist,
+                         /*@notnull@*/ int (*cmp)(const void *a, const void *b),
+                         int threads);
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+/// Calls fn on every element's data, spread in chunks of LISTPAR_CHUNK elements
+/// over the workers of workpool, and returns once every call has. Elements are
+/// visited in no particular order. Runs on the calling thread alone if workpool
+/// is NULL or the clist is short. The clist must not change until this returns.
+///
+/// COMPLEXITY: O(n / threads) if fn takes equal time for every element
+///
+/// @param clist The clist to iterate over
+/// @param fn Callback function given each element's data and arg. Called
+///           concurrently
+/// @param arg Passed through to fn
+/// @param workpool The workers to run on
+void clist_for_each_parallel(/*@notnull@*/ struct clist *clist,
+                             /*@notnull@*/ void (*fn)(void *data, void *arg),
+                             /*@null@*/ void *arg,
+                             /*@null@*/ struct workpool *workpool);
+
+/// Folds every element's data into acc, spread over the workers of workpool as
+/// clist_for_each_parallel is. acc holds the identity of combine on entry, and
+/// the result on return. Each chunk of elements is folded in order into its own
+/// copy of the identity, and the chunks are combined into acc in clist order,
+/// so combine need only be associative. See listpar_reduce.
+///
+/// COMPLEXITY: O(n / threads + n / LISTPAR_CHUNK)
+///
+/// @param clist The clist to reduce
+/// @param fold Callback function folding one element's data into an
+///             accumulator. Called concurrently on different accumulators
+/// @param combine Callback function folding the accumulator part into acc
+/// @param acc The identity on entry and the result on return
+/// @param acc_size The size of the accumulator in bytes
+/// @param arg Passed through to fold and combine
+/// @param workpool The workers to run on
+void clist_reduce_parallel(/*@notnull@*/ struct clist *clist,
+                           /*@notnull@*/
+                           void (*fold)(void *acc, void *data, void *arg),
+                           /*@notnull@*/
+                           void (*combine)(void *acc, const void *part,
+                                           void *arg),
+                           /*@notnull@*/ void *acc, size_t acc_size,
+                           /*@null@*/ void *arg,
+                           /*@null@*/ struct workpool *workpool);
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+/// Writes a clist to path in the format described in listio.h, one record per
+/// element in clist order, each element's data encoded by codec. The file can
+/// be mapped back with listio_map and walked without rebuilding the clist.
+///
+/// COMPLEXITY: O(n) plus the cost of encoding
+///
+/// @param clist The clist to write
+/// @param path The file to create or replace
+/// @param codec Turns each element's data into bytes
+///
+/// @return 0 on success, -1 on failure, in which case path is left as it was
+int clist_write(/*@notnull@*/ const struct clist *clist,
+                /*@notnull@*/ const char *path,
+                /*@notnull@*/ const struct listio_codec *codec);
+
 // -----------------------------------------------------------------------------
 //                               Looping Macros
 // -----------------------------------------------------------------------------
@@ -230,10 +404,23 @@ int clist_rem_tail(/*@notnull@*/ struct clist *clist,
 /// @param clist The clist to iterate over
 /// @param name The name used for the iterator
 #define clist_for_each(clist, name)                     \
-    for (struct clist_elem * name = clist->link.next;   \
-         name != &clist->link;                          \
+    for (struct clist_elem * name = (clist)->link.next; \
+         name != &(clist)->link;                        \
          name = name->next)
 
+/// A macro for generating for loops - loop over all the elements of a clist
+/// from inside an ebr read section while another thread changes it. Every
+/// link is read with ebr_load, so ebr.h must be included to use this.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param clist The clist to iterate over
+/// @param name The name used for the iterator
+#define clist_for_each_ebr(clist, name)                           \
+    for (struct clist_elem * name = ebr_load((clist)->link.next); \
+         name != &(clist)->link;                                  \
+         name = ebr_load(name->next))
+
 /// A macro for generating for loops - loop over all the elements of a
 /// clist. This safe version allows for removal of the current element
 ///
@@ -243,11 +430,48 @@ int clist_rem_tail(/*@notnull@*/ struct clist *clist,
 /// @param name The name used for the iterator
 #define clist_for_each_safe(clist, name)                        \
     for (struct clist_elem                                      \
-             * name = clist->link.next,                         \
+             * name = (clist)->link.next,                       \
              * __temp_elem = name->next;                        \
-         name != &clist->link;                                  \
+         name != &(clist)->link;                                \
          name = __temp_elem, __temp_elem = __temp_elem->next)
 
+/// A macro for generating for loops - loop over all the elements of a clist,
+/// prefetching STRUCTURES_PREFETCH_DISTANCE elements ahead of the body. Worth
+/// using over clist_for_each when the body touches each element's data.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param clist The clist to iterate over
+/// @param name The name used for the iterator
+#define clist_for_each_prefetch(clist, name)                        \
+    for (struct clist_elem                                          \
+             * name = (clist)->link.next,                           \
+             * __ahead_elem = prefetch_ahead(name, &(clist)->link,  \
+                                  offsetof(struct clist_elem, data),\
+                                  STRUCTURES_PREFETCH_DISTANCE);    \
+         name != &(clist)->link;                                    \
+         name = name->next,                                         \
+             __ahead_elem = prefetch_step(__ahead_elem, &(clist)->link))
+
+/// A macro for generating for loops - loop over all the elements of a clist,
+/// prefetching as clist_for_each_prefetch does. This safe version allows for
+/// removal of the current element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param clist The clist to iterate over
+/// @param name The name used for the iterator
+#define clist_for_each_safe_prefetch(clist, name)                   \
+    for (struct clist_elem                                          \
+             * name = (clist)->link.next,                           \
+             * __temp_elem = name->next,                            \
+             * __ahead_elem = prefetch_ahead(name, &(clist)->link,  \
+                                  offsetof(struct clist_elem, data),\
+                                  STRUCTURES_PREFETCH_DISTANCE);    \
+         name != &(clist)->link;                                    \
+         name = __temp_elem, __temp_elem = __temp_elem->next,       \
+             __ahead_elem = prefetch_step(__ahead_elem, &(clist)->link))
+
 // -----------------------------------------------------------------------------
 //                                    End
 // -----------------------------------------------------------------------------
@@ -32,10 +32,18 @@
 /// structure. All functions are safe to use with empty dlists except dlist_init
 /// for obvious reasons.
 
+#include "prefetch.h"
+#include <stddef.h>
+
 // -----------------------------------------------------------------------------
 //                                 Structures
 // -----------------------------------------------------------------------------
 
+struct ebr;
+struct listio_codec;
+struct pool;
+struct workpool;
+
 /// Individual elements within a doubly linked list
 ///
 /// These should almost universally be created and managed by the dlist_
@@ -49,10 +57,23 @@ struct dlist_elem {
 /// A generic doubly-linked list struct
 ///
 /// When first initialised and when empty, head is NULL. This structure must be
-/// initialised with dlist_init() before use. When done with, use
-/// dlist_destroy.
+/// initialised with dlist_init() or dlist_init_with_pool() before use. When
+/// done with, use dlist_destroy. pool is NULL unless elements come from a pool,
+/// and ebr is NULL unless one was attached with dlist_set_ebr. size is kept up
+/// to date by every operation unless STRUCTURES_NO_SIZE_CACHE
+/// is defined, in which case dlist_get_size counts the elements instead.
+/// Likewise tail points at the last element, or is NULL when the dlist is
+/// empty, unless STRUCTURES_NO_TAIL_CACHE is defined.
 struct dlist {
     struct dlist_elem *head;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    struct dlist_elem *tail;
+#endif
+    struct pool *pool;
+    struct ebr *ebr;
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    int size;
+#endif
 };
 
 // -----------------------------------------------------------------------------
@@ -71,10 +92,25 @@ struct dlist {
 /// @param dlist The doubly linked list to initialise
 void dlist_init(/*@out@*/ /*@notnull@*/ struct dlist *dlist);
 
+/// Initialises a doubly linked list whose elements are allocated from pool
+/// instead of with malloc. The pool must have been initialised with an element
+/// size of at least sizeof(struct dlist_elem) and must outlive the dlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing an initialised dlist to this function is undefined
+/// behaviour. Expect a memory leak.
+///
+/// @param dlist The doubly linked list to initialise
+/// @param pool The pool to allocate elements from
+void dlist_init_with_pool(/*@out@*/ /*@notnull@*/ struct dlist *dlist,
+                          /*@notnull@*/ struct pool *pool);
+
 /// Destroys a doubly linked list. No other operations are permitted after
 /// destroying unless dlist_init is called again. This function removes all
 /// elements from the dlist and calls the given destroy function on them unless
-/// destroy is set to NULL.
+/// destroy is set to NULL. The elements of a pooled dlist are handed back to
+/// the pool in one go rather than freed one at a time.
 ///
 /// COMPLEXITY: O(n)
 ///
@@ -85,6 +121,19 @@ void dlist_init(/*@out@*/ /*@notnull@*/ struct dlist *dlist);
 void dlist_destroy(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void (*destroy)(void *data));
 
+/// Attaches an ebr to a dlist, after which its rem functions retire elements to
+/// the ebr instead of freeing them, and readers registered with the ebr may
+/// walk the dlist with dlist_for_each_ebr while it is changed; see ebr.h. The
+/// ebr must outlive the dlist, and must be attached before the dlist is shared
+/// with any reader.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param dlist The dlist to attach ebr to
+/// @param ebr The ebr to retire removed elements to
+void dlist_set_ebr(/*@notnull@*/ struct dlist *dlist,
+                   /*@notnull@*/ struct ebr *ebr);
+
 // -----------------------------------------------------------------------------
 //                                 Accessors
 // -----------------------------------------------------------------------------
@@ -100,10 +149,9 @@ void dlist_destroy(/*@notnull@*/ struct dlist *dlist,
 /*@null@*/
 struct dlist_elem* dlist_get_head(/*@notnull@*/ const struct dlist *dlist);
 
-/// Counts the elements in a dlist. This is highly inefficient and probably not
-/// a good use of a linked list.
+/// Returns the number of elements in a dlist.
 ///
-/// COMPLEXITY: O(n)
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_SIZE_CACHE is defined
 ///
 /// @param dlist Doubly-linked list whose elements to count
 ///
@@ -111,10 +159,9 @@ struct dlist_elem* dlist_get_head(/*@notnull@*/ const struct dlist *dlist);
 int dlist_get_size(/*@notnull@*/ const struct dlist *dlist);
 
 /// Returns the last element of a doubly-linked list. Returns NULL if the dlist
-/// is empty. This is highly inefficient and you should probably rethink what
-/// you're doing.
+/// is empty.
 ///
-/// COMPLEXITY: O(n)
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
 ///
 /// @param dlist The doubly-linked list to return the tail element of
 ///
@@ -128,7 +175,7 @@ struct dlist_elem* dlist_get_tail(/*@notnull@*/ const struct dlist *dlist);
 ///
 /// @param dlist The dlist to test for emptiness
 ///
-/// @return 1 if the dlist contains any elements, else 0
+/// @return 1 if the dlist contains no elements, else 0
 int dlist_is_empty(/*@notnull@*/ const struct dlist *dlist);
 
 // -----------------------------------------------------------------------------
@@ -146,15 +193,18 @@ int dlist_is_empty(/*@notnull@*/ const struct dlist *dlist);
 int dlist_ins_head(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void *data);
 
-/// Inserts an element to a doubly-linked list after the given element.
+/// Inserts an element to a doubly-linked list after the given element. dlist is
+/// required so that the new element can be allocated from the dlist's pool.
 ///
 /// COMPLEXITY: O(1)
 ///
+/// @param dlist The parent dlist
 /// @param elem The element to insert after
 /// @param data The data the newly created element should point to
 ///
 /// @return 0 for success, -1 for failure
-int dlist_ins_next(/*@notnull@*/ struct dlist_elem *elem,
+int dlist_ins_next(/*@notnull@*/ struct dlist *dlist,
+                   /*@notnull@*/ struct dlist_elem *elem,
                    /*@null@*/ void *data);
 
 /// Inserts an element to a doubly-linked list before the given element. dlist
@@ -174,9 +224,7 @@ int dlist_ins_prev(/*@notnull@*/ struct dlist *dlist,
 
 /// Inserts an element at the end of a dlist
 ///
-/// COMPLEXITY: O(n)
-///
-/// @warning cdlists offer O(1) tail insertion. Consider using a cdlist
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
 ///
 /// @param list The list to insert at the end of
 /// @param data The data the newly created element should point to
@@ -185,6 +233,22 @@ int dlist_ins_prev(/*@notnull@*/ struct dlist *dlist,
 int dlist_ins_tail(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void *data);
 
+/// Inserts n elements at the end of a dlist, the i-th pointing to data[i]. The
+/// elements are allocated together, from a single block of the dlist's pool if
+/// it has one, and linked in one pass. Either every element is inserted or,
+/// on failure, none is.
+///
+/// COMPLEXITY: O(n), O(n + size) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param dlist The dlist to insert at the end of
+/// @param data The data the new elements should point to, in order
+/// @param n The number of elements to insert
+///
+/// @return 0 for success, -1 for failure
+int dlist_ins_tail_n(/*@notnull@*/ struct dlist *dlist,
+                     /*@notnull@*/ void **data,
+                     int n);
+
 /// Removes an element from a doubly-linked list. dlist is required so that
 /// dlist->head can be changed if we are removing the head of the dlist. The
 /// destroyed element will have destroy() called upon elem->data to free it if
@@ -217,13 +281,31 @@ int dlist_rem_elem(/*@notnull@*/ struct dlist *dlist,
 int dlist_rem_head(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void (*destroy)(void *data));
 
+/// Removes up to n elements from the head of a dlist, as repeated calls to
+/// dlist_rem_head would, but unlinking them in one pass and, if the dlist has a
+/// pool and no ebr, returning them to the pool in one go. If out is non-NULL
+/// the data of the i-th element removed is stored in out[i]. If destroy is
+/// non-NULL it is called on each element's data; leave it NULL when keeping
+/// the data in out.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param dlist The dlist to remove from the head of
+/// @param out Where to store the removed data, with room for n pointers
+/// @param n The most elements to remove
+/// @param destroy Callback function for freeing the elements' data
+///
+/// @return The number of elements removed, fewer than n if the dlist ran out
+int dlist_rem_head_n(/*@notnull@*/ struct dlist *dlist,
+                     /*@null@*/ void **out,
+                     int n,
+                     /*@null@*/ void (*destroy)(void *data));
+
 /// Removes an element from the tail of a list. It is the user's responsibility
 /// to free the element's data. If destroy is non-NULL it will be called on the
 /// element's data to free it.
 ///
-/// COMPLEXITY: O(n)
-///
-/// @warning cdlists do this operation in O(1). Consider using a cdlist
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
 ///
 /// @param list The list to remove from the head of
 /// @param destroy Callback function for freeing the element's data
@@ -232,6 +314,144 @@ int dlist_rem_head(/*@notnull@*/ struct dlist *dlist,
 int dlist_rem_tail(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void (*destroy)(void *data));
 
+/// Moves every element of other onto the tail of dlist, leaving other empty. No
+/// element is allocated, freed or copied: the two chains are relinked. Both
+/// lists must share the same pool, or both have none, as elements are always
+/// returned to the pool of the list they are on.
+///
+/// COMPLEXITY: O(1), O(n + m) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param dlist The dlist to append to
+/// @param other The dlist whose elements are moved
+///
+/// @return 0 on success, -1 if the pools differ or dlist and other are the
+/// same list
+int dlist_concat(/*@notnull@*/ struct dlist *dlist,
+                 /*@notnull@*/ struct dlist *other);
+
+/// Moves every element of other into dlist after elem, or at the head if elem
+/// is NULL, leaving other empty. As with dlist_concat, elements are relinked in
+/// place and both lists must share the same pool.
+///
+/// COMPLEXITY: O(1), O(m) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param dlist The dlist to insert into
+/// @param elem The element of dlist to insert after, or NULL for the head
+/// @param other The dlist whose elements are moved
+///
+/// @return 0 on success, -1 if the pools differ or dlist and other are the
+/// same list
+int dlist_splice(/*@notnull@*/ struct dlist *dlist,
+                 /*@null@*/ struct dlist_elem *elem,
+                 /*@notnull@*/ struct dlist *other);
+
+/// Moves every element after elem, or the whole dlist if elem is NULL, onto
+/// other, which must be empty. elem becomes the tail of dlist. Elements are
+/// relinked in place and both lists must share the same pool.
+///
+/// COMPLEXITY: O(k) in the number of elements moved, O(1) if
+/// STRUCTURES_NO_SIZE_CACHE is defined
+///
+/// @param dlist The dlist to split
+/// @param elem The element of dlist to split after, or NULL to move everything
+/// @param other An empty dlist to receive the elements after elem
+///
+/// @return 0 on success, -1 if the pools differ or other is not empty
+int dlist_split_at(/*@notnull@*/ struct dlist *dlist,
+                   /*@null@*/ struct dlist_elem *elem,
+                   /*@notnull@*/ struct dlist *other);
+
+/// Sorts a dlist in place with a stable merge sort. Elements are relinked
+/// rather than reallocated, so pointers to them stay valid. cmp is given two
+/// elements' data pointers and returns less than, equal to or greater than
+/// zero, as strcmp does.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param dlist The dlist to sort
+/// @param cmp Callback function comparing two elements' data
+void dlist_sort(/*@notnull@*/ struct dlist *dlist,
+                /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Sorts a dlist as dlist_sort does, using up to threads threads. Each thread
+/// is given at least LISTSORT_PARALLEL_MIN elements, so short lists are sorted
+/// on the calling thread alone. cmp must be safe to call concurrently.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param dlist The dlist to sort
+/// @param cmp Callback function comparing two elements' data
+/// @param threads The most threads to use
+void dlist_sort_parallel(/*@notnull@*/ struct dlist *dlist,
+                         /*@notnull@*/ int (*cmp)(const void *a, const void *b),
+                         int threads);
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+/// Calls fn on every element's data, spread in chunks of LISTPAR_CHUNK elements
+/// over the workers of workpool, and returns once every call has. Elements are
+/// visited in no particular order. Runs on the calling thread alone if workpool
+/// is NULL or the dlist is short. The dlist must not change until this returns.
+///
+/// COMPLEXITY: O(n / threads) if fn takes equal time for every element
+///
+/// @param dlist The dlist to iterate over
+/// @param fn Callback function given each element's data and arg. Called
+///           concurrently
+/// @param arg Passed through to fn
+/// @param workpool The workers to run on
+void dlist_for_each_parallel(/*@notnull@*/ struct dlist *dlist,
+                             /*@notnull@*/ void (*fn)(void *data, void *arg),
+                             /*@null@*/ void *arg,
+                             /*@null@*/ struct workpool *workpool);
+
+/// Folds every element's data into acc, spread over the workers of workpool as
+/// dlist_for_each_parallel is. acc holds the identity of combine on entry, and
+/// the result on return. Each chunk of elements is folded in order into its own
+/// copy of the identity, and the chunks are combined into acc in dlist order,
+/// so combine need only be associative. See listpar_reduce.
+///
+/// COMPLEXITY: O(n / threads + n / LISTPAR_CHUNK)
+///
+/// @param dlist The dlist to reduce
+/// @param fold Callback function folding one element's data into an
+///             accumulator. Called concurrently on different accumulators
+/// @param combine Callback function folding the accumulator part into acc
+/// @param acc The identity on entry and the result on return
+/// @param acc_size The size of the accumulator in bytes
+/// @param arg Passed through to fold and combine
+/// @param workpool The workers to run on
+void dlist_reduce_parallel(/*@notnull@*/ struct dlist *dlist,
+                           /*@notnull@*/
+                           void (*fold)(void *acc, void *data, void *arg),
+                           /*@notnull@*/
+                           void (*combine)(void *acc, const void *part,
+                                           void *arg),
+                           /*@notnull@*/ void *acc, size_t acc_size,
+                           /*@null@*/ void *arg,
+                           /*@null@*/ struct workpool *workpool);
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+/// Writes a dlist to path in the format described in listio.h, one record per
+/// element in dlist order, each element's data encoded by codec. The file can
+/// be mapped back with listio_map and walked without rebuilding the dlist.
+///
+/// COMPLEXITY: O(n) plus the cost of encoding
+///
+/// @param dlist The dlist to write
+/// @param path The file to create or replace
+/// @param codec Turns each element's data into bytes
+///
+/// @return 0 on success, -1 on failure, in which case path is left as it was
+int dlist_write(/*@notnull@*/ const struct dlist *dlist,
+                /*@notnull@*/ const char *path,
+                /*@notnull@*/ const struct listio_codec *codec);
+
 // -----------------------------------------------------------------------------
 //                               Looping Macros
 // -----------------------------------------------------------------------------
@@ -245,6 +465,19 @@ int dlist_rem_tail(/*@notnull@*/ struct dlist *dlist,
 #define dlist_for_each(dlist, name)                                     \
     for (struct dlist_elem * name = (dlist)->head; name; name = name->next)
 
+/// A macro for generating for loops - loop over all the elements of a dlist
+/// from inside an ebr read section while another thread changes it. Every
+/// link is read with ebr_load, so ebr.h must be included to use this.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param dlist The dlist to iterate over
+/// @param name The name used for the iterator
+#define dlist_for_each_ebr(dlist, name)                                 \
+    for (struct dlist_elem * name = ebr_load((dlist)->head);            \
+         name;                                                          \
+         name = ebr_load(name->next))
+
 /// A macro for generating for loops - loop over all the elements of a
 /// dlist. This safe version allows for removal of the current element
 ///
@@ -258,7 +491,44 @@ int dlist_rem_tail(/*@notnull@*/ struct dlist *dlist,
                  * name = (dlist)->head,                            \
                  * __temp_elem = (dlist)->head->next;               \
              name;                                                  \
-             name = __temp_elem, __temp_elem = __temp_elem->next)
+             name = __temp_elem, __temp_elem = name ? name->next : NULL)
+
+/// A macro for generating for loops - loop over all the elements of a dlist,
+/// prefetching STRUCTURES_PREFETCH_DISTANCE elements ahead of the body. Worth
+/// using over dlist_for_each when the body touches each element's data.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param dlist The dlist to iterate over
+/// @param name The name used for the iterator
+#define dlist_for_each_prefetch(dlist, name)                        \
+    for (struct dlist_elem                                          \
+             * name = (dlist)->head,                                \
+             * __ahead_elem = prefetch_ahead(name, NULL,            \
+                                  offsetof(struct dlist_elem, data),\
+                                  STRUCTURES_PREFETCH_DISTANCE);    \
+         name;                                                      \
+         name = name->next,                                         \
+             __ahead_elem = prefetch_step(__ahead_elem, NULL))
+
+/// A macro for generating for loops - loop over all the elements of a dlist,
+/// prefetching as dlist_for_each_prefetch does. This safe version allows for
+/// removal of the current element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param dlist The dlist to iterate over
+/// @param name The name used for the iterator
+#define dlist_for_each_safe_prefetch(dlist, name)                   \
+    for (struct dlist_elem                                          \
+             * name = (dlist)->head,                                \
+             * __temp_elem = name ? name->next : NULL,              \
+             * __ahead_elem = prefetch_ahead(name, NULL,            \
+                                  offsetof(struct dlist_elem, data),\
+                                  STRUCTURES_PREFETCH_DISTANCE);    \
+         name;                                                      \
+         name = __temp_elem, __temp_elem = name ? name->next : NULL,\
+             __ahead_elem = prefetch_step(__ahead_elem, NULL))
 
 /// A macro for looping over a dlist from a given element
 ///
@@ -281,7 +551,7 @@ int dlist_rem_tail(/*@notnull@*/ struct dlist *dlist,
              * name = elem,                                     \
              * __temp_elem = elem->next;                        \
          name;                                                  \
-         name = __temp_elem, __temp_elem = __temp_elem->next)
+         name = __temp_elem, __temp_elem = name ? name->next : NULL)
 
 /// A macro for looping over a dlist from a given element
 ///
@@ -304,7 +574,7 @@ int dlist_rem_tail(/*@notnull@*/ struct dlist *dlist,
              * name = elem,                                    \
              * __temp_elem = elem->prev;                       \
          name;                                                 \
-         name = __temp_elem, __temp_elem = __temp_elem->prev)
+         name = __temp_elem, __temp_elem = name ? name->prev : NULL)
 
 // -----------------------------------------------------------------------------
 //                                    End
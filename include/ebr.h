@@ -0,0 +1,248 @@
+#ifndef EBR_H
+#define EBR_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    ebr.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// Epoch-based reclamation, letting threads walk a list without a lock while
+/// another thread removes elements from it. Attach an ebr to a list with
+/// list_set_ebr, dlist_set_ebr, clist_set_ebr or cdlist_set_ebr and its rem
+/// functions stop freeing elements and destroying their data straight away:
+/// both are retired to the ebr instead, and only released once no reader can
+/// still be standing on the element.
+///
+/// Each reading thread registers an ebr_reader and brackets every walk with
+/// ebr_read_begin and ebr_read_end, which only announce the epoch the reader
+/// started in. Writers must still be serialised with each other, by a lock of
+/// the caller's choosing, and must not hold a read section of their own while
+/// removing. Readers walk forwards with list_for_each_ebr, dlist_for_each_ebr,
+/// clist_for_each_ebr or cdlist_for_each_ebr, which read every link with
+/// ebr_load and pair with the ebr_store the ins and rem functions link
+/// elements in and out with. The ordinary for_each macros, reverse walks, the
+/// get functions and size read links and fields with plain loads, and are a
+/// data race while a writer runs. Readers must not keep a pointer to an
+/// element once their read section ends. Only the ins and rem functions may
+/// run alongside readers; concat, splice, split_at, sort and destroy need the
+/// list to themselves.
+///
+/// ebr_retire takes the ebr's lock on every removal. With writers already
+/// serialised by one lock of their own that lock is never contended, but
+/// writers to several lists sharing one ebr under different locks will queue
+/// on it.
+///
+/// A global epoch advances once every registered reader that is inside a read
+/// section has seen its current value. Elements are kept in one of three limbo
+/// lists by the epoch they were retired in, and a limbo list is released when
+/// the epoch has advanced twice past it, by which time every reader that could
+/// have reached its elements has finished.
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+struct pool;
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The assumed size of a cache line. Every reader's epoch sits on its own line
+/// so that readers entering and leaving do not slow each other down.
+#define EBR_CACHE_LINE 64
+
+/// The number of retirements between attempts to advance the epoch
+#define EBR_COLLECT_BATCH 32
+
+/// A retired element waiting to be released
+///
+/// These are created and managed by the ebr_ functions. You should never need
+/// to reference them.
+struct ebr_retired {
+    struct ebr_retired *next;
+    void *elem;
+    /*@null@*/ struct pool *pool;
+    void *data;
+    /*@null@*/ void (*destroy)(void *data);
+};
+
+/// The record of one reading thread
+///
+/// epoch is 0 outside a read section and the epoch the reader started in,
+/// with its lowest bit set, inside one. Register with ebr_reader_register
+/// before use.
+struct ebr_reader {
+    _Alignas(EBR_CACHE_LINE) atomic_uint epoch;
+    struct ebr *ebr;
+    /*@null@*/ struct ebr_reader *next;
+};
+
+/// An epoch-based reclamation domain
+///
+/// epoch only ever moves on in steps of two, leaving the lowest bit free for
+/// the readers. Everything but epoch is protected by lock. limbo[bucket] is
+/// where elements retired in the current epoch go, and spare holds records
+/// left over from released elements for reuse. This structure must be
+/// initialised with ebr_init() before use, and may not be shared between
+/// threads until it has been.
+struct ebr {
+    atomic_uint epoch;
+    pthread_mutex_t lock;
+    /*@null@*/ struct ebr_reader *readers;
+    /*@null@*/ struct ebr_retired *limbo[3];
+    /*@null@*/ struct ebr_retired *spare;
+    int bucket;
+    int pending;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises an epoch-based reclamation domain. This operation must be called
+/// for an ebr before the ebr can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ebr The ebr to initialise
+///
+/// @return 0 on success, -1 on failure
+int ebr_init(/*@out@*/ struct ebr *ebr);
+
+/// Destroys an epoch-based reclamation domain, releasing every element still
+/// retired to it. No reader may be inside a read section and no list attached
+/// to the ebr may be used again until it is given another.
+///
+/// COMPLEXITY: O(n) in the number of retired elements
+///
+/// @param ebr The ebr to destroy
+void ebr_destroy(/*@notnull@*/ struct ebr *ebr);
+
+/// Registers a reading thread's record with an ebr. Each reading thread needs
+/// its own record, which must stay registered for as long as the thread reads.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ebr The ebr to register with
+/// @param reader The calling thread's record
+void ebr_reader_register(/*@notnull@*/ struct ebr *ebr,
+                         /*@notnull@*/ struct ebr_reader *reader);
+
+/// Removes a reading thread's record from its ebr. The reader must not be
+/// inside a read section.
+///
+/// COMPLEXITY: O(r) in the number of registered readers
+///
+/// @param reader The record to unregister
+void ebr_reader_unregister(/*@notnull@*/ struct ebr_reader *reader);
+
+// -----------------------------------------------------------------------------
+//                                  Reading
+// -----------------------------------------------------------------------------
+
+/// Starts a read section. No element reachable from a list attached to the
+/// reader's ebr will be freed until ebr_read_end. Read sections do not nest.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param reader The calling thread's registered record
+void ebr_read_begin(/*@notnull@*/ struct ebr_reader *reader);
+
+/// Ends a read section. The reader must not touch any element it found during
+/// the section after this.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param reader The calling thread's registered record
+void ebr_read_end(/*@notnull@*/ struct ebr_reader *reader);
+
+// -----------------------------------------------------------------------------
+//                                Reclamation
+// -----------------------------------------------------------------------------
+
+#if defined(__GNUC__) || defined(__clang__)
+
+/// Stores value to a link readers may be following, ordering everything the
+/// writer did to the element before it, so that a reader following the link
+/// sees the element whole. Used by the ins and rem functions for every link a
+/// forward walk reads.
+#define ebr_store(link, value) \
+    __atomic_store_n(&(link), (value), __ATOMIC_RELEASE)
+
+/// Loads a link a writer may be changing, pairing with ebr_store. Used by the
+/// for_each_ebr macros.
+#define ebr_load(link) __atomic_load_n(&(link), __ATOMIC_ACQUIRE)
+
+#else
+
+// Without the atomic builtins the links cannot be reached atomically without
+// making them _Atomic for every user, so fall back to a fence and plain
+// accesses. This keeps the ordering on every common target but is not free of
+// data races by the letter of C11.
+#define ebr_store(link, value)                         \
+    do {                                               \
+        atomic_thread_fence(memory_order_release);     \
+        (link) = (value);                              \
+    } while (0)
+#define ebr_load(link) (link)
+
+#endif
+
+/// Retires an element that has just been unlinked from a list. Once no reader
+/// can still be standing on it, destroy is called on data unless destroy is
+/// NULL, and elem is given back to pool, or freed if pool is NULL. Every few
+/// calls this also tries to advance the epoch, and releases whatever that
+/// makes safe. destroy may be called from any thread that retires or flushes
+/// to this ebr, with the ebr's lock held, so it must not use the ebr itself;
+/// likewise a pool must not be shared with lists written under another lock.
+///
+/// COMPLEXITY: O(r) in the number of registered readers, plus the elements
+/// released
+///
+/// @param ebr The ebr to retire to
+/// @param elem The unlinked element
+/// @param pool The pool elem came from, or NULL if it came from malloc
+/// @param data The element's data
+/// @param destroy Callback function for freeing the element's data
+void ebr_retire(/*@notnull@*/ struct ebr *ebr,
+                /*@notnull@*/ void *elem,
+                /*@null@*/ struct pool *pool,
+                /*@null@*/ void *data,
+                /*@null@*/ void (*destroy)(void *data));
+
+/// Waits until every element retired before the call can be released, and
+/// releases it. Must not be called from inside a read section.
+///
+/// COMPLEXITY: O(r) in the number of registered readers, plus the elements
+/// released, for as long as readers take to leave their sections
+///
+/// @param ebr The ebr to flush
+void ebr_flush(/*@notnull@*/ struct ebr *ebr);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // EBR_H
@@ -0,0 +1,84 @@
+#ifndef HASH_H
+#define HASH_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    hash.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// Hash and comparison callbacks for the common kinds of key, ready to pass to
+/// the hash tables. The hash tables mix every hash they are given, so these
+/// only need to be cheap and to spread distinct keys, not to be uniform.
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                 Functions
+// -----------------------------------------------------------------------------
+
+/// Hashes a NUL terminated string (FNV-1a).
+///
+/// COMPLEXITY: O(n) in the length of the string
+///
+/// @param key The string to hash
+///
+/// @return The hash of the string
+size_t hash_str(/*@notnull@*/ const void *key);
+
+/// Compares two NUL terminated strings, as strcmp does.
+///
+/// COMPLEXITY: O(n) in the length of the strings
+///
+/// @param a The first string
+/// @param b The second string
+///
+/// @return 0 if the strings are equal, else non-zero
+int hash_str_cmp(/*@notnull@*/ const void *a, /*@notnull@*/ const void *b);
+
+/// Hashes a pointer by its address, for keys that are compared by identity or
+/// that are integers cast to pointers.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param key The pointer to hash
+///
+/// @return The hash of the pointer
+size_t hash_ptr(/*@null@*/ const void *key);
+
+/// Compares two pointers by address.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param a The first pointer
+/// @param b The second pointer
+///
+/// @return 0 if the pointers are equal, else non-zero
+int hash_ptr_cmp(/*@null@*/ const void *a, /*@null@*/ const void *b);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // HASH_H
@@ -0,0 +1,255 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    heap.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An array-backed d-ary min-heap. The element that cmp orders first is always
+/// at the top. Every element inserted gets a heap_elem handle that stays valid
+/// until the element is removed, so an element whose priority has changed can
+/// be moved into place with heap_update, or removed from the middle with
+/// heap_rem_elem, in O(log n).
+///
+/// The array holds handle pointers and each handle records its position in
+/// the array. With HEAP_ARITY children per node the tree is shallower than a
+/// binary heap, and all of a node's children sit next to each other, which
+/// suits caches better during removals.
+
+#include <stddef.h>
+
+struct dlist;
+struct list;
+struct pool;
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The number of children of every node. Define before building the library
+/// to change it; 2 gives a binary heap.
+#ifndef HEAP_ARITY
+#define HEAP_ARITY 4
+#endif
+
+/// The handle of one element of a heap
+///
+/// These are created and managed by the heap_ functions. You should only read
+/// data from them; index is the element's position in the heap's array.
+struct heap_elem {
+    void *data;
+    size_t index;
+};
+
+/// A heap struct
+///
+/// This structure must be initialised with heap_init() or
+/// heap_init_with_pool() before use. When done with, use heap_destroy. pool is
+/// NULL unless handles come from a pool.
+struct heap {
+    /*@null@*/ struct heap_elem **elems;
+    size_t size;
+    size_t capacity;
+    int (*cmp)(const void *a, const void *b);
+    /*@null@*/ struct pool *pool;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a heap. This operation must be called for a heap before the
+/// heap can be used with any other operation. Nothing is allocated until the
+/// first insertion.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param heap The heap to initialise
+/// @param cmp Callback function comparing two elements' data. The element for
+///            which it returns less than zero is nearer the top
+void heap_init(/*@out@*/ struct heap *heap,
+               /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Initialises a heap whose handles are allocated from pool instead of with
+/// malloc. The pool must have been initialised with an element size of at
+/// least sizeof(struct heap_elem) and must outlive the heap.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param heap The heap to initialise
+/// @param cmp Callback function comparing two elements' data
+/// @param pool The pool to allocate handles from
+void heap_init_with_pool(/*@out@*/ struct heap *heap,
+                         /*@notnull@*/ int (*cmp)(const void *a, const void *b),
+                         /*@notnull@*/ struct pool *pool);
+
+/// Destroys a heap. This function removes all elements from the heap and calls
+/// the given destroy function on their data unless destroy is NULL. The heap is
+/// left empty and may be reused.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param heap The heap to destroy
+/// @param destroy The function to use to free all the element data
+void heap_destroy(/*@notnull@*/ struct heap *heap,
+                  /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the element at the top of a heap, the one cmp orders first.
+/// Returns NULL if the heap is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param heap The heap to return the top element of
+///
+/// @return The top element of the heap or NULL for an empty heap
+/*@null@*/
+struct heap_elem* heap_get_top(/*@notnull@*/ const struct heap *heap);
+
+/// Returns the number of elements in a heap.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param heap The heap whose elements to count
+///
+/// @return Number of elements in heap
+size_t heap_get_size(/*@notnull@*/ const struct heap *heap);
+
+/// Determine whether a heap is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param heap The heap to test for emptiness
+///
+/// @return 1 if the heap contains no elements, else 0
+int heap_is_empty(/*@notnull@*/ const struct heap *heap);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Inserts data into a heap.
+///
+/// COMPLEXITY: O(log n), amortised over the growth of the array
+///
+/// @param heap The heap to insert into
+/// @param data The data the new element should point to
+///
+/// @return The new element's handle, or NULL on failure
+/*@null@*/
+struct heap_elem* heap_ins(/*@notnull@*/ struct heap *heap,
+                           /*@null@*/ void *data);
+
+/// Inserts the data of every element of a dlist into a heap at once. The heap
+/// is rebuilt bottom-up afterwards, which is cheaper than inserting the
+/// elements one by one. The dlist is left untouched.
+///
+/// COMPLEXITY: O(n + m) for a heap of n elements and a dlist of m
+///
+/// @param heap The heap to insert into
+/// @param dlist The dlist whose data to insert
+///
+/// @return 0 on success, -1 on failure, in which case the heap is unchanged
+int heap_ins_dlist(/*@notnull@*/ struct heap *heap,
+                   /*@notnull@*/ const struct dlist *dlist);
+
+/// Inserts the data of every element of a list into a heap at once, as
+/// heap_ins_dlist does.
+///
+/// COMPLEXITY: O(n + m) for a heap of n elements and a list of m
+///
+/// @param heap The heap to insert into
+/// @param list The list whose data to insert
+///
+/// @return 0 on success, -1 on failure, in which case the heap is unchanged
+int heap_ins_list(/*@notnull@*/ struct heap *heap,
+                  /*@notnull@*/ const struct list *list);
+
+/// Restores the order of a heap after the priority of elem's data has changed,
+/// in either direction.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param heap The parent heap
+/// @param elem The element whose priority changed
+void heap_update(/*@notnull@*/ struct heap *heap,
+                 /*@notnull@*/ struct heap_elem *elem);
+
+/// Removes an element from anywhere in a heap. If destroy is non-NULL it is
+/// called on the element's data. elem is invalid afterwards.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param heap The parent heap
+/// @param elem The element to remove
+/// @param destroy Callback function for freeing the element's data
+void heap_rem_elem(/*@notnull@*/ struct heap *heap,
+                   /*@notnull@*/ struct heap_elem *elem,
+                   /*@null@*/ void (*destroy)(void *data));
+
+/// Removes the element at the top of a heap. If destroy is non-NULL it is
+/// called on the element's data.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param heap The heap to remove the top of
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 if the heap was empty
+int heap_rem_top(/*@notnull@*/ struct heap *heap,
+                 /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the elements of a heap in
+/// array order, which is not priority order. The heap must not be changed
+/// during the loop.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param heap The heap to iterate over
+/// @param name The name used for the iterator
+#define heap_for_each(heap, name)                                       \
+    for (struct heap_elem **__heap_pos = (heap)->elems, *name = NULL;   \
+         __heap_pos != NULL                                             \
+             && __heap_pos != (heap)->elems + (heap)->size              \
+             && (name = *__heap_pos) != NULL;                           \
+         ++__heap_pos)
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // HEAP_H
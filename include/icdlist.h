@@ -0,0 +1,258 @@
+#ifndef ICDLIST_H
+#define ICDLIST_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    icdlist.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An intrusive circular doubly linked list. Elements are embedded in the
+/// user's own structures and no operation allocates or frees memory. Use
+/// icdlist_entry to get from an element back to the structure containing it.
+
+#include "intrusive.h"
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The link embedded in every object that can be placed on an icdlist
+///
+/// An icdlist_elem may only be on one icdlist at a time.
+struct icdlist_elem {
+    struct icdlist_elem *next;
+    struct icdlist_elem *prev;
+};
+
+/// An intrusive circular doubly linked list struct
+///
+/// This structure must be initialised with icdlist_init() before use. As with
+/// cdlist, "link" is an empty element that terminates iteration, so the head
+/// and tail must be fetched with getter functions. size follows the same
+/// STRUCTURES_NO_SIZE_CACHE setting as struct cdlist.
+struct icdlist {
+    struct icdlist_elem link;
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    int size;
+#endif
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises an intrusive circular doubly linked list. This operation must
+/// be called for an icdlist before the icdlist can be used with any other
+/// operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The icdlist to initialise
+void icdlist_init(/*@out@*/ struct icdlist *icdlist);
+
+/// Destroys an intrusive circular doubly linked list. Every element is unlinked
+/// and, unless destroy is NULL, passed to destroy so that its containing object
+/// can be released.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param icdlist The icdlist to destroy
+/// @param destroy Callback function for releasing each element's object
+void icdlist_destroy(/*@notnull@*/ struct icdlist *icdlist,
+                     /*@null@*/ void (*destroy)(struct icdlist_elem *elem));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the first element of an icdlist. Returns NULL if the icdlist is
+/// empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The icdlist to return the head element of
+///
+/// @return The first element of the icdlist or NULL for an empty icdlist
+/*@null@*/
+struct icdlist_elem* icdlist_get_head(/*@notnull@*/ const struct icdlist *icdlist);
+
+/// Returns the number of elements in an icdlist.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_SIZE_CACHE is defined
+///
+/// @param icdlist The icdlist whose elements to count
+///
+/// @return Number of elements in icdlist.
+int icdlist_get_size(/*@notnull@*/ const struct icdlist *icdlist);
+
+/// Returns the last element of an icdlist. Returns NULL if the icdlist is
+/// empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The icdlist to return the tail element of
+///
+/// @return The last element of the icdlist or NULL for an empty icdlist
+/*@null@*/
+struct icdlist_elem* icdlist_get_tail(/*@notnull@*/ const struct icdlist *icdlist);
+
+/// Determine whether an icdlist is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The icdlist to test for emptiness
+///
+/// @return 1 if the icdlist contains no elements, else 0
+int icdlist_is_empty(/*@notnull@*/ const struct icdlist *icdlist);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Links an element in at the head of an icdlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The icdlist to insert at the head of
+/// @param elem The element to link in
+void icdlist_ins_head(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem);
+
+/// Links an element in after the given element.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The parent icdlist
+/// @param elem The element to insert after
+/// @param elem_new The element to link in
+void icdlist_ins_next(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem,
+                      /*@notnull@*/ struct icdlist_elem *elem_new);
+
+/// Links an element in before the given element.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The parent icdlist
+/// @param elem The element to insert before
+/// @param elem_new The element to link in
+void icdlist_ins_prev(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem,
+                      /*@notnull@*/ struct icdlist_elem *elem_new);
+
+/// Links an element in at the tail of an icdlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The icdlist to insert at the tail of
+/// @param elem The element to link in
+void icdlist_ins_tail(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem);
+
+/// Unlinks an element from an icdlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The parent icdlist
+/// @param elem The element to unlink
+void icdlist_rem_elem(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem);
+
+/// Unlinks the element at the head of an icdlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The icdlist to remove from the head of
+///
+/// @return The unlinked element or NULL if the icdlist was empty
+/*@null@*/
+struct icdlist_elem* icdlist_rem_head(/*@notnull@*/ struct icdlist *icdlist);
+
+/// Unlinks the element at the tail of an icdlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param icdlist The icdlist to remove from the tail of
+///
+/// @return The unlinked element or NULL if the icdlist was empty
+/*@null@*/
+struct icdlist_elem* icdlist_rem_tail(/*@notnull@*/ struct icdlist *icdlist);
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// Returns the object an icdlist element is embedded in
+///
+/// COMPLEXITY: O(1)
+///
+/// @param elem The element
+/// @param type The type of the containing object
+/// @param member The name of the icdlist_elem member within type
+#define icdlist_entry(elem, type, member) container_of(elem, type, member)
+
+/// A macro for generating for loops - loop over all the elements of an
+/// icdlist
+///
+/// COMPLEXITY: O(n)
+///
+/// @param icdlist The icdlist to iterate over
+/// @param name The name used for the iterator
+#define icdlist_for_each(icdlist, name)                     \
+    for (struct icdlist_elem * name = (icdlist)->link.next; \
+         name != &(icdlist)->link;                          \
+         name = name->next)
+
+/// A macro for generating for loops - loop over all the elements of an
+/// icdlist. This safe version allows for removal of the current element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param icdlist The icdlist to iterate over
+/// @param name The name used for the iterator
+#define icdlist_for_each_safe(icdlist, name)                    \
+    for (struct icdlist_elem                                    \
+             * name = (icdlist)->link.next,                     \
+             * __temp_elem = name->next;                        \
+         name != &(icdlist)->link;                              \
+         name = __temp_elem, __temp_elem = __temp_elem->next)
+
+/// A macro for generating for loops - loop over all the elements of an icdlist
+/// backwards, starting with the tail and ending with the head
+///
+/// COMPLEXITY: O(n)
+///
+/// @param icdlist The icdlist to iterate over
+/// @param name The name used for the iterator
+#define icdlist_for_each_rev(icdlist, name)                 \
+    for (struct icdlist_elem * name = (icdlist)->link.prev; \
+         name != &(icdlist)->link;                          \
+         name = name->prev)
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // ICDLIST_H
@@ -0,0 +1,240 @@
+#ifndef ICLIST_H
+#define ICLIST_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    iclist.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An intrusive circular linked list. Elements are embedded in the user's own
+/// structures and no operation allocates or frees memory. Use iclist_entry to
+/// get from an element back to the structure containing it.
+
+#include "intrusive.h"
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The link embedded in every object that can be placed on an iclist
+///
+/// An iclist_elem may only be on one iclist at a time.
+struct iclist_elem {
+    struct iclist_elem *next;
+};
+
+/// An intrusive circular linked list struct
+///
+/// This structure must be initialised with iclist_init() before use. As with
+/// clist, "link" is an empty element that terminates iteration, so the head
+/// and tail must be fetched with getter functions. size follows the same
+/// STRUCTURES_NO_SIZE_CACHE setting as struct clist.
+struct iclist {
+    struct iclist_elem link;
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    int size;
+#endif
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises an intrusive circular linked list. This operation must be
+/// called for an iclist before the iclist can be used with any other
+/// operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param iclist The iclist to initialise
+void iclist_init(/*@out@*/ struct iclist *iclist);
+
+/// Destroys an intrusive circular linked list. Every element is unlinked and,
+/// unless destroy is NULL, passed to destroy so that its containing object can
+/// be released.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param iclist The iclist to destroy
+/// @param destroy Callback function for releasing each element's object
+void iclist_destroy(/*@notnull@*/ struct iclist *iclist,
+                    /*@null@*/ void (*destroy)(struct iclist_elem *elem));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the first element of an iclist. Returns NULL if the iclist is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param iclist The iclist to return the head element of
+///
+/// @return The first element of the iclist or NULL for an empty iclist
+/*@null@*/
+struct iclist_elem* iclist_get_head(/*@notnull@*/ const struct iclist *iclist);
+
+/// Returns the number of elements in an iclist.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_SIZE_CACHE is defined
+///
+/// @param iclist The iclist whose elements to count
+///
+/// @return Number of elements in iclist.
+int iclist_get_size(/*@notnull@*/ const struct iclist *iclist);
+
+/// Returns the last element of an iclist. Returns NULL if the iclist is empty.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning icdlist offers this operation in O(1). Consider using an icdlist
+///
+/// @param iclist The iclist to return the tail element of
+///
+/// @return The last element of the iclist or NULL for an empty iclist
+/*@null@*/
+struct iclist_elem* iclist_get_tail(/*@notnull@*/ const struct iclist *iclist);
+
+/// Determine whether an iclist is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param iclist The iclist to test for emptiness
+///
+/// @return 1 if the iclist contains no elements, else 0
+int iclist_is_empty(/*@notnull@*/ const struct iclist *iclist);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Links an element in at the head of an iclist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param iclist The iclist to insert at the head of
+/// @param elem The element to link in
+void iclist_ins_head(/*@notnull@*/ struct iclist *iclist,
+                     /*@notnull@*/ struct iclist_elem *elem);
+
+/// Links an element in after the given element.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param iclist The parent iclist
+/// @param elem The element to insert after
+/// @param elem_new The element to link in
+void iclist_ins_next(/*@notnull@*/ struct iclist *iclist,
+                     /*@notnull@*/ struct iclist_elem *elem,
+                     /*@notnull@*/ struct iclist_elem *elem_new);
+
+/// Links an element in at the tail of an iclist.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning icdlist offers this operation in O(1). Consider using an icdlist
+///
+/// @param iclist The iclist to insert at the tail of
+/// @param elem The element to link in
+void iclist_ins_tail(/*@notnull@*/ struct iclist *iclist,
+                     /*@notnull@*/ struct iclist_elem *elem);
+
+/// Unlinks the element at the head of an iclist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param iclist The iclist to remove from the head of
+///
+/// @return The unlinked element or NULL if the iclist was empty
+/*@null@*/
+struct iclist_elem* iclist_rem_head(/*@notnull@*/ struct iclist *iclist);
+
+/// Unlinks the element after the given one.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param iclist The parent iclist
+/// @param elem The element to remove after
+///
+/// @return The unlinked element or NULL if elem was the last element
+/*@null@*/
+struct iclist_elem* iclist_rem_next(/*@notnull@*/ struct iclist *iclist,
+                                    /*@notnull@*/ struct iclist_elem *elem);
+
+/// Unlinks the element at the tail of an iclist.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning icdlist offers this operation in O(1). Consider using an icdlist
+///
+/// @param iclist The iclist to remove from the tail of
+///
+/// @return The unlinked element or NULL if the iclist was empty
+/*@null@*/
+struct iclist_elem* iclist_rem_tail(/*@notnull@*/ struct iclist *iclist);
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// Returns the object an iclist element is embedded in
+///
+/// COMPLEXITY: O(1)
+///
+/// @param elem The element
+/// @param type The type of the containing object
+/// @param member The name of the iclist_elem member within type
+#define iclist_entry(elem, type, member) container_of(elem, type, member)
+
+/// A macro for generating for loops - loop over all the elements of an iclist
+///
+/// COMPLEXITY: O(n)
+///
+/// @param iclist The iclist to iterate over
+/// @param name The name used for the iterator
+#define iclist_for_each(iclist, name)                       \
+    for (struct iclist_elem * name = (iclist)->link.next;   \
+         name != &(iclist)->link;                           \
+         name = name->next)
+
+/// A macro for generating for loops - loop over all the elements of an
+/// iclist. This safe version allows for removal of the current element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param iclist The iclist to iterate over
+/// @param name The name used for the iterator
+#define iclist_for_each_safe(iclist, name)                      \
+    for (struct iclist_elem                                     \
+             * name = (iclist)->link.next,                      \
+             * __temp_elem = name->next;                        \
+         name != &(iclist)->link;                               \
+         name = __temp_elem, __temp_elem = __temp_elem->next)
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // ICLIST_H
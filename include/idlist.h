@@ -0,0 +1,252 @@
+#ifndef IDLIST_H
+#define IDLIST_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    idlist.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An intrusive doubly linked list. Elements are embedded in the user's own
+/// structures and no operation allocates or frees memory. Use idlist_entry to
+/// get from an element back to the structure containing it.
+
+#include "intrusive.h"
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The link embedded in every object that can be placed on an idlist
+///
+/// An idlist_elem may only be on one idlist at a time.
+struct idlist_elem {
+    struct idlist_elem *next;
+    struct idlist_elem *prev;
+};
+
+/// An intrusive doubly linked list struct
+///
+/// When first initialised and when empty, head is NULL. This structure must be
+/// initialised with idlist_init() before use. tail and size follow the same
+/// STRUCTURES_NO_TAIL_CACHE and STRUCTURES_NO_SIZE_CACHE settings as struct
+/// dlist.
+struct idlist {
+    struct idlist_elem *head;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    struct idlist_elem *tail;
+#endif
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    int size;
+#endif
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises an intrusive doubly linked list. This operation must be called
+/// for an idlist before the idlist can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param idlist The idlist to initialise
+void idlist_init(/*@out@*/ struct idlist *idlist);
+
+/// Destroys an intrusive doubly linked list. Every element is unlinked and,
+/// unless destroy is NULL, passed to destroy so that its containing object can
+/// be released.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param idlist The idlist to destroy
+/// @param destroy Callback function for releasing each element's object
+void idlist_destroy(/*@notnull@*/ struct idlist *idlist,
+                    /*@null@*/ void (*destroy)(struct idlist_elem *elem));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the first element of an idlist. Returns NULL if the idlist is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param idlist The idlist to return the head element of
+///
+/// @return The first element of the idlist or NULL for an empty idlist
+/*@null@*/
+struct idlist_elem* idlist_get_head(/*@notnull@*/ const struct idlist *idlist);
+
+/// Returns the number of elements in an idlist.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_SIZE_CACHE is defined
+///
+/// @param idlist The idlist whose elements to count
+///
+/// @return Number of elements in idlist.
+int idlist_get_size(/*@notnull@*/ const struct idlist *idlist);
+
+/// Returns the last element of an idlist. Returns NULL if the idlist is empty.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param idlist The idlist to return the tail element of
+///
+/// @return The last element of the idlist or NULL for an empty idlist
+/*@null@*/
+struct idlist_elem* idlist_get_tail(/*@notnull@*/ const struct idlist *idlist);
+
+/// Determine whether an idlist is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param idlist The idlist to test for emptiness
+///
+/// @return 1 if the idlist contains no elements, else 0
+int idlist_is_empty(/*@notnull@*/ const struct idlist *idlist);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Links an element in at the head of an idlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param idlist The idlist to insert at the head of
+/// @param elem The element to link in
+void idlist_ins_head(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem);
+
+/// Links an element in after the given element.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param idlist The parent idlist
+/// @param elem The element to insert after
+/// @param elem_new The element to link in
+void idlist_ins_next(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem,
+                     /*@notnull@*/ struct idlist_elem *elem_new);
+
+/// Links an element in before the given element.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param idlist The parent idlist
+/// @param elem The element to insert before
+/// @param elem_new The element to link in
+void idlist_ins_prev(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem,
+                     /*@notnull@*/ struct idlist_elem *elem_new);
+
+/// Links an element in at the end of an idlist.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param idlist The idlist to insert at the end of
+/// @param elem The element to link in
+void idlist_ins_tail(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem);
+
+/// Unlinks an element from an idlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param idlist The parent idlist
+/// @param elem The element to unlink
+void idlist_rem_elem(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem);
+
+/// Unlinks the element at the head of an idlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param idlist The idlist to remove from the head of
+///
+/// @return The unlinked element or NULL if the idlist was empty
+/*@null@*/
+struct idlist_elem* idlist_rem_head(/*@notnull@*/ struct idlist *idlist);
+
+/// Unlinks the element at the tail of an idlist.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param idlist The idlist to remove from the tail of
+///
+/// @return The unlinked element or NULL if the idlist was empty
+/*@null@*/
+struct idlist_elem* idlist_rem_tail(/*@notnull@*/ struct idlist *idlist);
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// Returns the object an idlist element is embedded in
+///
+/// COMPLEXITY: O(1)
+///
+/// @param elem The element
+/// @param type The type of the containing object
+/// @param member The name of the idlist_elem member within type
+#define idlist_entry(elem, type, member) container_of(elem, type, member)
+
+/// A macro for generating for loops - loop over all the elements of an idlist
+///
+/// COMPLEXITY: O(n)
+///
+/// @param idlist The idlist to iterate over
+/// @param name The name used for the iterator
+#define idlist_for_each(idlist, name)                                   \
+    for (struct idlist_elem * name = (idlist)->head; name; name = name->next)
+
+/// A macro for generating for loops - loop over all the elements of an
+/// idlist. This safe version allows for removal of the current element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param idlist The idlist to iterate over
+/// @param name The name used for the iterator
+#define idlist_for_each_safe(idlist, name)                          \
+    for (struct idlist_elem                                         \
+             * name = (idlist)->head,                               \
+             * __temp_elem = name ? name->next : NULL;              \
+         name;                                                      \
+         name = __temp_elem, __temp_elem = name ? name->next : NULL)
+
+/// A macro for looping over an idlist backwards from a given element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param elem The element to start with
+/// @param name The label to use for the iterator
+#define idlist_for_each_elem_rev(elem, name)                        \
+    for (struct idlist_elem * name = elem; name; name = name->prev)
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // IDLIST_H
@@ -0,0 +1,234 @@
+#ifndef ILIST_H
+#define ILIST_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    ilist.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An intrusive singularly linked list. Elements are embedded in the user's
+/// own structures and no operation allocates or frees memory. Use ilist_entry
+/// to get from an element back to the structure containing it.
+
+#include "intrusive.h"
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The link embedded in every object that can be placed on an ilist
+///
+/// An ilist_elem may only be on one ilist at a time. Embed several to put the
+/// same object on several lists.
+struct ilist_elem {
+    struct ilist_elem *next;
+};
+
+/// An intrusive list struct
+///
+/// When first initialised and when empty, head is NULL. This structure must be
+/// initialised with ilist_init() before use. tail and size follow the same
+/// STRUCTURES_NO_TAIL_CACHE and STRUCTURES_NO_SIZE_CACHE settings as struct
+/// list.
+struct ilist {
+    struct ilist_elem *head;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    struct ilist_elem *tail;
+#endif
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    int size;
+#endif
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises an intrusive list. This operation must be called for an ilist
+/// before the ilist can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ilist The ilist to initialise
+void ilist_init(/*@out@*/ struct ilist *ilist);
+
+/// Destroys an intrusive list. Every element is unlinked and, unless destroy is
+/// NULL, passed to destroy so that its containing object can be released.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param ilist The ilist to destroy
+/// @param destroy Callback function for releasing each element's object
+void ilist_destroy(/*@notnull@*/ struct ilist *ilist,
+                   /*@null@*/ void (*destroy)(struct ilist_elem *elem));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the first element of an ilist. Returns NULL if the ilist is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ilist The ilist to return the head element of
+///
+/// @return The first element of the ilist or NULL for an empty ilist
+/*@null@*/
+struct ilist_elem* ilist_get_head(/*@notnull@*/ const struct ilist *ilist);
+
+/// Returns the number of elements in an ilist.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_SIZE_CACHE is defined
+///
+/// @param ilist The ilist whose elements to count
+///
+/// @return Number of elements in ilist.
+int ilist_get_size(/*@notnull@*/ const struct ilist *ilist);
+
+/// Returns the last element of an ilist. Returns NULL if the ilist is empty.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param ilist The ilist to return the tail element of
+///
+/// @return The last element of the ilist or NULL for an empty ilist
+/*@null@*/
+struct ilist_elem* ilist_get_tail(/*@notnull@*/ const struct ilist *ilist);
+
+/// Determine whether an ilist is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ilist The ilist to test for emptiness
+///
+/// @return 1 if the ilist contains no elements, else 0
+int ilist_is_empty(/*@notnull@*/ const struct ilist *ilist);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Links an element in at the head of an ilist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ilist The ilist to insert at the head of
+/// @param elem The element to link in
+void ilist_ins_head(/*@notnull@*/ struct ilist *ilist,
+                    /*@notnull@*/ struct ilist_elem *elem);
+
+/// Links an element in after the given element.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ilist The parent ilist
+/// @param elem The element to insert after
+/// @param elem_new The element to link in
+void ilist_ins_next(/*@notnull@*/ struct ilist *ilist,
+                    /*@notnull@*/ struct ilist_elem *elem,
+                    /*@notnull@*/ struct ilist_elem *elem_new);
+
+/// Links an element in at the end of an ilist.
+///
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param ilist The ilist to insert at the end of
+/// @param elem The element to link in
+void ilist_ins_tail(/*@notnull@*/ struct ilist *ilist,
+                    /*@notnull@*/ struct ilist_elem *elem);
+
+/// Unlinks the element at the head of an ilist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ilist The ilist to remove from the head of
+///
+/// @return The unlinked element or NULL if the ilist was empty
+/*@null@*/
+struct ilist_elem* ilist_rem_head(/*@notnull@*/ struct ilist *ilist);
+
+/// Unlinks the element after the given one.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ilist The parent ilist
+/// @param elem The element to remove after
+///
+/// @return The unlinked element or NULL if elem was the last element
+/*@null@*/
+struct ilist_elem* ilist_rem_next(/*@notnull@*/ struct ilist *ilist,
+                                  /*@notnull@*/ struct ilist_elem *elem);
+
+/// Unlinks the element at the tail of an ilist.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param ilist The ilist to remove from the tail of
+///
+/// @return The unlinked element or NULL if the ilist was empty
+/*@null@*/
+struct ilist_elem* ilist_rem_tail(/*@notnull@*/ struct ilist *ilist);
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// Returns the object an ilist element is embedded in
+///
+/// COMPLEXITY: O(1)
+///
+/// @param elem The element
+/// @param type The type of the containing object
+/// @param member The name of the ilist_elem member within type
+#define ilist_entry(elem, type, member) container_of(elem, type, member)
+
+/// A macro for generating for loops - loop over all the elements of an ilist
+///
+/// COMPLEXITY: O(n)
+///
+/// @param ilist The ilist to iterate over
+/// @param name The name used for the iterator
+#define ilist_for_each(ilist, name)                                     \
+    for (struct ilist_elem * name = (ilist)->head; name; name = name->next)
+
+/// A macro for generating for loops - loop over all the elements of an
+/// ilist. This safe version allows for removal of the current element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param ilist The ilist to iterate over
+/// @param name The name used for the iterator
+#define ilist_for_each_safe(ilist, name)                            \
+    for (struct ilist_elem                                          \
+             * name = (ilist)->head,                                \
+             * __temp_elem = name ? name->next : NULL;              \
+         name;                                                      \
+         name = __temp_elem, __temp_elem = name ? name->next : NULL)
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // ILIST_H
@@ -0,0 +1,59 @@
+#ifndef INTRUSIVE_H
+#define INTRUSIVE_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    intrusive.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// Helpers shared by the intrusive list types (ilist, idlist, iclist and
+/// icdlist). An intrusive list never allocates: the link structure is embedded
+/// in the user's own object, and container_of recovers the object from a
+/// pointer to its link.
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                   Macros
+// -----------------------------------------------------------------------------
+
+/// Recovers a pointer to the structure containing a member from a pointer to
+/// that member.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ptr A pointer to the embedded member
+/// @param type The type of the containing structure
+/// @param member The name of the member within type
+///
+/// @return A pointer to the containing structure
+#define container_of(ptr, type, member)                             \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // INTRUSIVE_H
@@ -31,10 +31,18 @@
 /// A simple, generic singularly linked list implementation using a generic data
 /// structure.
 
+#include "prefetch.h"
+#include <stddef.h>
+
 // -----------------------------------------------------------------------------
 //                                 Structures
 // -----------------------------------------------------------------------------
 
+struct ebr;
+struct listio_codec;
+struct pool;
+struct workpool;
+
 /// Individual elements within a linked list
 ///
 /// These should almost universally be created and managed by the list_
@@ -47,9 +55,24 @@ struct list_elem {
 /// A generic list struct
 ///
 /// When first initialised and when empty, head is NULL. This structure must be
-/// initialised with list_init() before use. When done with, use list_destroy.
+/// initialised with list_init() or list_init_with_pool() before use. When done
+/// with, use list_destroy. pool is NULL unless elements come from a pool, and
+/// ebr is NULL unless one was attached with list_set_ebr. size is kept up to
+/// date by every operation unless STRUCTURES_NO_SIZE_CACHE is defined, in
+/// which case list_get_size counts the elements instead. Likewise tail points
+/// at the last element, or is NULL when the list is empty, unless
+/// STRUCTURES_NO_TAIL_CACHE is defined. The library and its users must agree on
+/// these settings.
 struct list {
     struct list_elem *head;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    struct list_elem *tail;
+#endif
+    struct pool *pool;
+    struct ebr *ebr;
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    int size;
+#endif
 };
 
 // -----------------------------------------------------------------------------
@@ -68,10 +91,25 @@ struct list {
 /// @param list The list to initialise
 void list_init(/*@out@*/ struct list *list);
 
+/// Initialises a linked list whose elements are allocated from pool instead of
+/// with malloc. The pool must have been initialised with an element size of at
+/// least sizeof(struct list_elem) and must outlive the list.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing an initialised list to this function is undefined
+/// behaviour. Expect a memory leak.
+///
+/// @param list The list to initialise
+/// @param pool The pool to allocate elements from
+void list_init_with_pool(/*@out@*/ struct list *list,
+                         /*@notnull@*/ struct pool *pool);
+
 /// Destroys a linked list. No other operations are permitted after destroying
 /// unless list_init is called again. This function removes all elements from
 /// the list and calls the given destroy function on them unless destroy is set
-/// to NULL.
+/// to NULL. The elements of a pooled list are handed back to the pool in one
+/// go rather than freed one at a time.
 ///
 /// COMPLEXITY: O(n)
 ///
@@ -82,6 +120,19 @@ void list_init(/*@out@*/ struct list *list);
 void list_destroy(/*@notnull@*/ struct list *list,
                   /*@null@*/ void (*destroy)(void *data));
 
+/// Attaches an ebr to a list, after which its rem functions retire elements to
+/// the ebr instead of freeing them, and readers registered with the ebr may
+/// walk the list with list_for_each_ebr while it is changed; see ebr.h. The ebr
+/// must outlive the list, and must be attached before the list is shared with
+/// any reader.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param list The list to attach ebr to
+/// @param ebr The ebr to retire removed elements to
+void list_set_ebr(/*@notnull@*/ struct list *list,
+                  /*@notnull@*/ struct ebr *ebr);
+
 // -----------------------------------------------------------------------------
 //                                 Accessors
 // -----------------------------------------------------------------------------
@@ -96,21 +147,18 @@ void list_destroy(/*@notnull@*/ struct list *list,
 /*@null@*/
 struct list_elem* list_get_head(/*@notnull@*/ const struct list *list);
 
-/// Counts the elements in a list.
+/// Returns the number of elements in a list.
 ///
-/// COMPLEXITY: O(n)
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_SIZE_CACHE is defined
 ///
 /// @param list List whose elements to count
 ///
 /// @return Number of elements in list.
 int list_get_size(/*@notnull@*/ const struct list *list);
 
-/// Returns the last element of a list. Returns NULL if the list is empty. This
-/// is highly inefficient and you should probably rethink what you're doing.
-///
-/// @warning cdlists do this operation in O(1). Consider using a cdlist
+/// Returns the last element of a list. Returns NULL if the list is empty.
 ///
-/// COMPLEXITY: O(n)
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
 ///
 /// @param list The list to return the tail element of
 ///
@@ -124,7 +172,7 @@ struct list_elem* list_get_tail(/*@notnull@*/ const struct list *list);
 ///
 /// @param list The list to test for emptiness
 ///
-/// @return 1 if the list contains any elements, else 0
+/// @return 1 if the list contains no elements, else 0
 int list_is_empty(/*@notnull@*/ const struct list *list);
 
 // -----------------------------------------------------------------------------
@@ -142,22 +190,23 @@ int list_is_empty(/*@notnull@*/ const struct list *list);
 int list_ins_head(/*@notnull@*/ struct list *list,
                   /*@null@*/ void *data);
 
-/// Inserts an element to a list after the given element.
+/// Inserts an element to a list after the given element. list is required so
+/// that the new element can be allocated from the list's pool.
 ///
 /// COMPLEXITY: O(1)
 ///
+/// @param list The parent list
 /// @param elem The element to insert after
 /// @param data The data the newly created element should point to
 ///
 /// @return 0 for success, -1 for failure
-int list_ins_next(/*@notnull@*/ struct list_elem *elem,
+int list_ins_next(/*@notnull@*/ struct list *list,
+                  /*@notnull@*/ struct list_elem *elem,
                   /*@null@*/ void *data);
 
 /// Inserts an element at the end of a list
 ///
-/// COMPLEXITY: O(n)
-///
-/// @warning cdlists offer O(1) tail insertion. Consider using a cdlist
+/// COMPLEXITY: O(1), O(n) if STRUCTURES_NO_TAIL_CACHE is defined
 ///
 /// @param list The list to insert at the end of
 /// @param data The data the newly created element should point to
@@ -166,6 +215,22 @@ int list_ins_next(/*@notnull@*/ struct list_elem *elem,
 int list_ins_tail(/*@notnull@*/ struct list *list,
                   /*@null@*/ void *data);
 
+/// Inserts n elements at the end of a list, the i-th pointing to data[i]. The
+/// elements are allocated together, from a single block of the list's pool if
+/// it has one, and linked in one pass. Either every element is inserted or,
+/// on failure, none is.
+///
+/// COMPLEXITY: O(n), O(n + size) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param list The list to insert at the end of
+/// @param data The data the new elements should point to, in order
+/// @param n The number of elements to insert
+///
+/// @return 0 for success, -1 for failure
+int list_ins_tail_n(/*@notnull@*/ struct list *list,
+                    /*@notnull@*/ void **data,
+                    int n);
+
 /// Removes an element from the head of a list. It is the user's responsibility
 /// to free the element's data. If destroy is non-NULL it will be called on the
 /// element's data to free it.
@@ -179,17 +244,40 @@ int list_ins_tail(/*@notnull@*/ struct list *list,
 int list_rem_head(/*@notnull@*/ struct list *list,
                   /*@null@*/ void (*destroy)(void *data));
 
+/// Removes up to n elements from the head of a list, as repeated calls to
+/// list_rem_head would, but unlinking them in one pass and, if the list has a
+/// pool and no ebr, returning them to the pool in one go. If out is non-NULL
+/// the data of the i-th element removed is stored in out[i]. If destroy is
+/// non-NULL it is called on each element's data; leave it NULL when keeping
+/// the data in out.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param list The list to remove from the head of
+/// @param out Where to store the removed data, with room for n pointers
+/// @param n The most elements to remove
+/// @param destroy Callback function for freeing the elements' data
+///
+/// @return The number of elements removed, fewer than n if the list ran out
+int list_rem_head_n(/*@notnull@*/ struct list *list,
+                    /*@null@*/ void **out,
+                    int n,
+                    /*@null@*/ void (*destroy)(void *data));
+
 /// Removes a list element from the list position after the given one.  It is
 /// the user's responsibility to free the element's data. If destroy is non-NULL
-/// it will be called on the element's data to free it.
+/// it will be called on the element's data to free it. list is required so
+/// that the element can be returned to the list's pool.
 ///
 /// COMPLEXITY: O(1)
 ///
+/// @param list The parent list
 /// @param elem The element to remove after
 /// @param destroy Callback function for freeing the element's data
 ///
 /// @return 0 on success, -1 on failure
-int list_rem_next(/*@notnull@*/ struct list_elem *elem,
+int list_rem_next(/*@notnull@*/ struct list *list,
+                  /*@notnull@*/ struct list_elem *elem,
                   /*@null@*/ void (*destroy)(void *data));
 
 /// Removes an element from the tail of a list. It is the user's responsibility
@@ -207,6 +295,144 @@ int list_rem_next(/*@notnull@*/ struct list_elem *elem,
 int list_rem_tail(/*@notnull@*/ struct list *list,
                   /*@null@*/ void (*destroy)(void *data));
 
+/// Moves every element of other onto the tail of list, leaving other empty. No
+/// element is allocated, freed or copied: the two chains are relinked. Both
+/// lists must share the same pool, or both have none, as elements are always
+/// returned to the pool of the list they are on.
+///
+/// COMPLEXITY: O(1), O(n + m) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param list The list to append to
+/// @param other The list whose elements are moved
+///
+/// @return 0 on success, -1 if the pools differ or list and other are the
+/// same list
+int list_concat(/*@notnull@*/ struct list *list,
+                /*@notnull@*/ struct list *other);
+
+/// Moves every element of other into list after elem, or at the head if elem
+/// is NULL, leaving other empty. As with list_concat, elements are relinked in
+/// place and both lists must share the same pool.
+///
+/// COMPLEXITY: O(1), O(m) if STRUCTURES_NO_TAIL_CACHE is defined
+///
+/// @param list The list to insert into
+/// @param elem The element of list to insert after, or NULL for the head
+/// @param other The list whose elements are moved
+///
+/// @return 0 on success, -1 if the pools differ or list and other are the
+/// same list
+int list_splice(/*@notnull@*/ struct list *list,
+                /*@null@*/ struct list_elem *elem,
+                /*@notnull@*/ struct list *other);
+
+/// Moves every element after elem, or the whole list if elem is NULL, onto
+/// other, which must be empty. elem becomes the tail of list. Elements are
+/// relinked in place and both lists must share the same pool.
+///
+/// COMPLEXITY: O(k) in the number of elements moved, O(1) if
+/// STRUCTURES_NO_SIZE_CACHE is defined
+///
+/// @param list The list to split
+/// @param elem The element of list to split after, or NULL to move everything
+/// @param other An empty list to receive the elements after elem
+///
+/// @return 0 on success, -1 if the pools differ or other is not empty
+int list_split_at(/*@notnull@*/ struct list *list,
+                  /*@null@*/ struct list_elem *elem,
+                  /*@notnull@*/ struct list *other);
+
+/// Sorts a list in place with a stable merge sort. Elements are relinked
+/// rather than reallocated, so pointers to them stay valid. cmp is given two
+/// elements' data pointers and returns less than, equal to or greater than
+/// zero, as strcmp does.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param list The list to sort
+/// @param cmp Callback function comparing two elements' data
+void list_sort(/*@notnull@*/ struct list *list,
+               /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Sorts a list as list_sort does, using up to threads threads. Each thread is
+/// given at least LISTSORT_PARALLEL_MIN elements, so short lists are sorted on
+/// the calling thread alone. cmp must be safe to call concurrently.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param list The list to sort
+/// @param cmp Callback function comparing two elements' data
+/// @param threads The most threads to use
+void list_sort_parallel(/*@notnull@*/ struct list *list,
+                        /*@notnull@*/ int (*cmp)(const void *a, const void *b),
+                        int threads);
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+/// Calls fn on every element's data, spread in chunks of LISTPAR_CHUNK elements
+/// over the workers of workpool, and returns once every call has. Elements are
+/// visited in no particular order. Runs on the calling thread alone if workpool
+/// is NULL or the list is short. The list must not change until this returns.
+///
+/// COMPLEXITY: O(n / threads) if fn takes equal time for every element
+///
+/// @param list The list to iterate over
+/// @param fn Callback function given each element's data and arg. Called
+///           concurrently
+/// @param arg Passed through to fn
+/// @param workpool The workers to run on
+void list_for_each_parallel(/*@notnull@*/ struct list *list,
+                            /*@notnull@*/ void (*fn)(void *data, void *arg),
+                            /*@null@*/ void *arg,
+                            /*@null@*/ struct workpool *workpool);
+
+/// Folds every element's data into acc, spread over the workers of workpool as
+/// list_for_each_parallel is. acc holds the identity of combine on entry, and
+/// the result on return. Each chunk of elements is folded in order into its own
+/// copy of the identity, and the chunks are combined into acc in list order, so
+/// combine need only be associative. See listpar_reduce.
+///
+/// COMPLEXITY: O(n / threads + n / LISTPAR_CHUNK)
+///
+/// @param list The list to reduce
+/// @param fold Callback function folding one element's data into an
+///             accumulator. Called concurrently on different accumulators
+/// @param combine Callback function folding the accumulator part into acc
+/// @param acc The identity on entry and the result on return
+/// @param acc_size The size of the accumulator in bytes
+/// @param arg Passed through to fold and combine
+/// @param workpool The workers to run on
+void list_reduce_parallel(/*@notnull@*/ struct list *list,
+                          /*@notnull@*/
+                          void (*fold)(void *acc, void *data, void *arg),
+                          /*@notnull@*/
+                          void (*combine)(void *acc, const void *part,
+                                          void *arg),
+                          /*@notnull@*/ void *acc, size_t acc_size,
+                          /*@null@*/ void *arg,
+                          /*@null@*/ struct workpool *workpool);
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+/// Writes a list to path in the format described in listio.h, one record per
+/// element in list order, each element's data encoded by codec. The file can
+/// be mapped back with listio_map and walked without rebuilding the list.
+///
+/// COMPLEXITY: O(n) plus the cost of encoding
+///
+/// @param list The list to write
+/// @param path The file to create or replace
+/// @param codec Turns each element's data into bytes
+///
+/// @return 0 on success, -1 on failure, in which case path is left as it was
+int list_write(/*@notnull@*/ const struct list *list,
+               /*@notnull@*/ const char *path,
+               /*@notnull@*/ const struct listio_codec *codec);
+
 // -----------------------------------------------------------------------------
 //                               Looping Macros
 // -----------------------------------------------------------------------------
@@ -220,6 +446,19 @@ int list_rem_tail(/*@notnull@*/ struct list *list,
 #define list_for_each(list, name)                                       \
     for (struct list_elem * name = (list)->head; name; name = name->next)
 
+/// A macro for generating for loops - loop over all the elements of a list
+/// from inside an ebr read section while another thread changes it. Every
+/// link is read with ebr_load, so ebr.h must be included to use this.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param list The list to iterate over
+/// @param name The name used for the iterator
+#define list_for_each_ebr(list, name)                                   \
+    for (struct list_elem * name = ebr_load((list)->head);              \
+         name;                                                          \
+         name = ebr_load(name->next))
+
 /// A macro for generating for loops - loop over all the elements of a
 /// list. this safe version allows for removal of the current element
 ///
@@ -233,7 +472,44 @@ int list_rem_tail(/*@notnull@*/ struct list *list,
                  * name = (list)->head,                             \
                  * __temp_elem = (list)->head->next;                \
              name;                                                  \
-             name = __temp_elem, __temp_elem = __temp_elem->next)
+             name = __temp_elem, __temp_elem = name ? name->next : NULL)
+
+/// A macro for generating for loops - loop over all the elements of a list,
+/// prefetching STRUCTURES_PREFETCH_DISTANCE elements ahead of the body. Worth
+/// using over list_for_each when the body touches each element's data.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param list The list to iterate over
+/// @param name The name used for the iterator
+#define list_for_each_prefetch(list, name)                          \
+    for (struct list_elem                                           \
+             * name = (list)->head,                                 \
+             * __ahead_elem = prefetch_ahead(name, NULL,            \
+                                  offsetof(struct list_elem, data), \
+                                  STRUCTURES_PREFETCH_DISTANCE);    \
+         name;                                                      \
+         name = name->next,                                         \
+             __ahead_elem = prefetch_step(__ahead_elem, NULL))
+
+/// A macro for generating for loops - loop over all the elements of a list,
+/// prefetching as list_for_each_prefetch does. This safe version allows for
+/// removal of the current element
+///
+/// COMPLEXITY: O(n)
+///
+/// @param list The list to iterate over
+/// @param name The name used for the iterator
+#define list_for_each_safe_prefetch(list, name)                     \
+    for (struct list_elem                                           \
+             * name = (list)->head,                                 \
+             * __temp_elem = name ? name->next : NULL,              \
+             * __ahead_elem = prefetch_ahead(name, NULL,            \
+                                  offsetof(struct list_elem, data), \
+                                  STRUCTURES_PREFETCH_DISTANCE);    \
+         name;                                                      \
+         name = __temp_elem, __temp_elem = name ? name->next : NULL,\
+             __ahead_elem = prefetch_step(__ahead_elem, NULL))
 
 /// A macro for looping over a list from a given element
 ///
@@ -256,7 +532,7 @@ int list_rem_tail(/*@notnull@*/ struct list *list,
              * name = elem,                                           \
              * __temp_elem = elem->next;                              \
          name;                                                        \
-         name = __temp_elem, __temp_elem = __temp_elem->next)
+         name = __temp_elem, __temp_elem = name ? name->next : NULL)
 
 // -----------------------------------------------------------------------------
 //                                    End
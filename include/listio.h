@@ -0,0 +1,279 @@
+#ifndef LISTIO_H
+#define LISTIO_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    listio.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// Saving lists to files, and reading them back in place. list_write and
+/// friends stream a list to a file in one pass, each element's data turned
+/// into bytes by a caller-supplied codec. listio_map maps such a file
+/// read-only and gives a view of it that can be walked in either direction
+/// straight out of the mapping, with nothing allocated or copied, so a large
+/// list is usable as soon as the file is opened.
+///
+/// A file is a listio_header followed by one record per element, in list
+/// order. Each record is a listio_record followed by the encoded data, padded
+/// to a multiple of 8 bytes. Records find their neighbours through offsets
+/// relative to themselves, so the file means the same wherever it is mapped.
+/// Files are in the byte order of the machine that wrote them, and are
+/// rejected by machines of the other order.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The first bytes of every file, including the terminating NUL
+#define LISTIO_MAGIC "LISTIO"
+
+/// The version of the format written, bumped whenever the layout changes
+#define LISTIO_VERSION 1
+
+/// The type of list a file was written from. Any kind can be viewed, and
+/// walked in both directions.
+enum listio_kind {
+    LISTIO_LIST,
+    LISTIO_DLIST,
+    LISTIO_CLIST,
+    LISTIO_CDLIST
+};
+
+/// Turns list data into bytes. encode is given an element's data and a buffer
+/// of len bytes, and returns the number of bytes the encoding takes. If that
+/// is more than len the buffer may be left untouched, and encode is called
+/// again with a buffer big enough.
+struct listio_codec {
+    size_t (*encode)(const void *data, void *buf, size_t len, void *arg);
+    void *arg;
+};
+
+/// The start of every file. Offsets are from the start of the file, 0 if the
+/// list is empty.
+struct listio_header {
+    char magic[8];
+    uint32_t byte_order;
+    uint16_t version;
+    uint16_t kind;
+    uint64_t count;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t length;
+};
+
+/// One element in a file. next and prev are offsets from this record to its
+/// neighbours, 0 at either end. size bytes of data follow directly.
+struct listio_record {
+    int64_t next;
+    int64_t prev;
+    uint64_t size;
+};
+
+/// A mapped file
+///
+/// This structure must be initialised with listio_map() before use. When done
+/// with, use listio_unmap.
+struct listio_view {
+    const char *base;
+    size_t length;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Maps a file written by one of the list write functions read-only, and
+/// checks its header. The records are not checked; see listio_view_check for
+/// files that may not have come from a write function.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param view The view to initialise
+/// @param path The file to map
+///
+/// @return 0 on success, -1 if the file cannot be mapped or is not a list
+int listio_map(/*@out@*/ struct listio_view *view,
+               /*@notnull@*/ const char *path);
+
+/// Unmaps a file. Every record taken from the view becomes invalid.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param view The view to unmap
+void listio_unmap(/*@notnull@*/ struct listio_view *view);
+
+/// Checks that every record of a view lies within the file, that the records
+/// link up in both directions and that there are as many as the header says.
+/// Walking a view that passes is safe whatever the file held.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param view The view to check
+///
+/// @return 0 if the view is sound, else -1
+int listio_view_check(/*@notnull@*/ const struct listio_view *view);
+
+// -----------------------------------------------------------------------------
+//                                  Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the type of list the file was written from
+///
+/// COMPLEXITY: O(1)
+///
+/// @param view The view to query
+///
+/// @return The kind of list
+enum listio_kind listio_view_get_kind(/*@notnull@*/
+                                      const struct listio_view *view);
+
+/// Returns the number of elements in a view
+///
+/// COMPLEXITY: O(1)
+///
+/// @param view The view whose elements to count
+///
+/// @return Number of elements in view
+size_t listio_view_get_size(/*@notnull@*/ const struct listio_view *view);
+
+/// Returns the first record of a view
+///
+/// COMPLEXITY: O(1)
+///
+/// @param view The view to return the head record of
+///
+/// @return The first record or NULL if the list was empty
+/*@null@*/
+const struct listio_record* listio_view_get_head(/*@notnull@*/
+                                                 const struct listio_view *view);
+
+/// Returns the last record of a view
+///
+/// COMPLEXITY: O(1)
+///
+/// @param view The view to return the tail record of
+///
+/// @return The last record or NULL if the list was empty
+/*@null@*/
+const struct listio_record* listio_view_get_tail(/*@notnull@*/
+                                                 const struct listio_view *view);
+
+/// Returns the record after rec, or NULL at the end
+///
+/// COMPLEXITY: O(1)
+///
+/// @param rec The record to step on from
+#define listio_record_next(rec)                                         \
+    ((rec)->next != 0                                                   \
+     ? (const struct listio_record *)((const char *)(rec) + (rec)->next) \
+     : NULL)
+
+/// Returns the record before rec, or NULL at the start
+///
+/// COMPLEXITY: O(1)
+///
+/// @param rec The record to step back from
+#define listio_record_prev(rec)                                         \
+    ((rec)->prev != 0                                                   \
+     ? (const struct listio_record *)((const char *)(rec) + (rec)->prev) \
+     : NULL)
+
+/// Returns the encoded data of a record, aligned to 8 bytes
+///
+/// COMPLEXITY: O(1)
+///
+/// @param rec The record whose data to return
+#define listio_record_data(rec) ((const void *)((rec) + 1))
+
+/// Returns the number of bytes of encoded data in a record
+///
+/// COMPLEXITY: O(1)
+///
+/// @param rec The record whose data to measure
+#define listio_record_size(rec) ((size_t)(rec)->size)
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+/// Writes a chain of elements linked through their first pointer-sized member
+/// to path, in the format above. The chain runs from head up to but not
+/// including end, which is NULL or the link of a circular list. The records
+/// go to a new file beside path, named path followed by a random suffix,
+/// which is synced to disk and then renamed over path. path therefore holds
+/// either the file it held before or the whole new one, even across a crash,
+/// which makes it safe to checkpoint over the last good copy. Most users want
+/// list_write and friends rather than this.
+///
+/// COMPLEXITY: O(n) plus the cost of encoding
+///
+/// @param path The file to create or replace
+/// @param kind The type of list the chain belongs to
+/// @param head The first element of the chain
+/// @param end The element that ends the chain
+/// @param data_offset The offset of the data pointer within each element
+/// @param codec Turns each element's data into bytes
+///
+/// @return 0 on success, -1 on failure, in which case path is left as it was
+int listio_write(/*@notnull@*/ const char *path, enum listio_kind kind,
+                 /*@null@*/ void *head, /*@null@*/ const void *end,
+                 size_t data_offset,
+                 /*@notnull@*/ const struct listio_codec *codec);
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the records of a view
+///
+/// COMPLEXITY: O(n)
+///
+/// @param view The view to iterate over
+/// @param name The name used for the iterator
+#define listio_view_for_each(view, name)                                \
+    for (const struct listio_record * name = listio_view_get_head(view); \
+         name != NULL;                                                  \
+         name = listio_record_next(name))
+
+/// A macro for generating for loops - loop over all the records of a view in
+/// reverse order
+///
+/// COMPLEXITY: O(n)
+///
+/// @param view The view to iterate over
+/// @param name The name used for the iterator
+#define listio_view_for_each_rev(view, name)                            \
+    for (const struct listio_record * name = listio_view_get_tail(view); \
+         name != NULL;                                                  \
+         name = listio_record_prev(name))
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // LISTIO_H
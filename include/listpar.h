@@ -0,0 +1,107 @@
+#ifndef LISTPAR_H
+#define LISTPAR_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    listpar.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// The parallel iteration shared by the list types. Like listsort it works on
+/// a chain of elements linked through their first pointer-sized member, here
+/// given as its first element and length so that the circular lists need no
+/// opening up. One pass over the chain records where every LISTPAR_CHUNK-th
+/// element is, and the chunks are then visited as tasks on a workpool. Most
+/// users want list_for_each_parallel and friends rather than this.
+
+#include <stddef.h>
+
+struct workpool;
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The number of elements visited by each task. Chunks must be long enough
+/// for the visits to outweigh taking a task, and short enough that there are
+/// plenty to steal.
+#define LISTPAR_CHUNK 256
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+/// Calls fn on the data of each of the first n elements of a chain, spread
+/// over the workers of workpool. Runs on the calling thread alone if workpool
+/// is NULL, the chain is a single chunk or the chunk index cannot be
+/// allocated. The chain must not change until this returns.
+///
+/// COMPLEXITY: O(n / threads) if fn takes equal time for every element
+///
+/// @param head The first element of the chain
+/// @param n The number of elements to visit
+/// @param data_offset The offset of the data pointer within each element
+/// @param fn Callback function given each element's data and arg. Called
+///           concurrently
+/// @param arg Passed through to fn
+/// @param workpool The workers to run on
+void listpar_for_each(/*@null@*/ void *head, size_t n, size_t data_offset,
+                      /*@notnull@*/ void (*fn)(void *data, void *arg),
+                      /*@null@*/ void *arg,
+                      /*@null@*/ struct workpool *workpool);
+
+/// Folds the data of each of the first n elements of a chain into acc, spread
+/// over the workers of workpool. acc points to acc_size bytes holding the
+/// identity of combine, for example a zeroed sum. Each chunk starts from its
+/// own copy of acc and folds its elements in, in order; the chunks' results
+/// are then combined into acc in chain order, so combine need only be
+/// associative. Runs on the calling thread alone, folding straight into acc,
+/// under the same conditions as listpar_for_each.
+///
+/// COMPLEXITY: O(n / threads + n / LISTPAR_CHUNK)
+///
+/// @param head The first element of the chain
+/// @param n The number of elements to visit
+/// @param data_offset The offset of the data pointer within each element
+/// @param fold Callback function folding one element's data into an
+///             accumulator. Called concurrently on different accumulators
+/// @param combine Callback function folding the accumulator part into acc
+/// @param acc The identity on entry and the result on return
+/// @param acc_size The size of the accumulator in bytes
+/// @param arg Passed through to fold and combine
+/// @param workpool The workers to run on
+void listpar_reduce(/*@null@*/ void *head, size_t n, size_t data_offset,
+                    /*@notnull@*/
+                    void (*fold)(void *acc, void *data, void *arg),
+                    /*@notnull@*/
+                    void (*combine)(void *acc, const void *part, void *arg),
+                    /*@notnull@*/ void *acc, size_t acc_size,
+                    /*@null@*/ void *arg,
+                    /*@null@*/ struct workpool *workpool);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // LISTPAR_H
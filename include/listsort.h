@@ -0,0 +1,88 @@
+#ifndef LISTSORT_H
+#define LISTSORT_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    listsort.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// The merge sort shared by the list types. It works on a NULL terminated
+/// chain of elements linked through their first pointer-sized member, which is
+/// how list, dlist, clist and cdlist elements are all laid out, so each type
+/// only has to open its list into such a chain and repair prev pointers and
+/// tails afterwards. Most users want list_sort and friends rather than this.
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The fewest elements each thread of a parallel sort is given. Smaller lists
+/// are sorted with fewer threads, down to one.
+#define LISTSORT_PARALLEL_MIN 16384
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Stable merge sort of a chain. Elements are only relinked, never moved or
+/// allocated, and the sort itself needs no memory beyond a small fixed array.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param head The first element of the chain
+/// @param data_offset The offset of the data pointer within each element
+/// @param cmp Compares two data pointers as strcmp does
+///
+/// @return The first element of the sorted chain
+/*@null@*/
+void* listsort_chain(/*@null@*/ void *head, size_t data_offset,
+                     /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// As listsort_chain, but cuts the chain into up to threads runs that are
+/// sorted on worker threads and then merged pairwise, also on worker threads.
+/// Falls back to fewer threads, or none, if the chain is short or threads
+/// cannot be started. The result is identical to listsort_chain.
+///
+/// COMPLEXITY: O(n log n)
+///
+/// @param head The first element of the chain
+/// @param data_offset The offset of the data pointer within each element
+/// @param cmp Compares two data pointers as strcmp does. Called concurrently
+/// @param threads The most threads to use
+///
+/// @return The first element of the sorted chain
+/*@null@*/
+void* listsort_chain_parallel(/*@null@*/ void *head, size_t data_offset,
+                              /*@notnull@*/
+                              int (*cmp)(const void *a, const void *b),
+                              int threads);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // LISTSORT_H
@@ -0,0 +1,161 @@
+#ifndef MPMCQ_H
+#define MPMCQ_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    mpmcq.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A bounded lock-free multi-producer/multi-consumer queue. Any number of
+/// threads may call mpmcq_ins_tail and mpmcq_rem_head concurrently without a
+/// lock; elements come out in the order they went in, as with cdlist_ins_tail
+/// and cdlist_rem_head.
+///
+/// The queue is a ring of preallocated cells, each carrying a sequence number
+/// that tells threads whether it is ready to be written or read. Nothing is
+/// allocated or freed after mpmcq_init, so no thread can ever touch memory
+/// that another has released and no reclamation scheme is needed.
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The assumed size of a cache line. head and tail are kept this far apart so
+/// that producers and consumers do not invalidate each other's line.
+#define MPMCQ_CACHE_LINE 64
+
+/// One slot of the ring
+struct mpmcq_cell {
+    atomic_size_t seq;
+    void *data;
+};
+
+/// A bounded lock-free queue struct
+///
+/// This structure must be initialised with mpmcq_init() before use, and may
+/// not be shared between threads until it has been.
+struct mpmcq {
+    struct mpmcq_cell *buffer;
+    size_t mask;
+    _Alignas(MPMCQ_CACHE_LINE) atomic_size_t head;
+    _Alignas(MPMCQ_CACHE_LINE) atomic_size_t tail;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a queue. This operation must be called for an mpmcq before the
+/// mpmcq can be used with any other operation.
+///
+/// COMPLEXITY: O(n) in the capacity
+///
+/// @param mpmcq The mpmcq to initialise
+/// @param capacity The most elements the queue can hold. Rounded up to a power
+///                 of two, minimum 2
+///
+/// @return 0 on success, -1 on failure
+int mpmcq_init(/*@out@*/ struct mpmcq *mpmcq, size_t capacity);
+
+/// Destroys a queue. Any elements still queued are passed to destroy unless it
+/// is NULL. No other thread may be using the queue.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param mpmcq The mpmcq to destroy
+/// @param destroy Callback function for freeing each remaining element's data
+void mpmcq_destroy(/*@notnull@*/ struct mpmcq *mpmcq,
+                   /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the number of elements the queue can hold.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param mpmcq The mpmcq to return the capacity of
+///
+/// @return The capacity of the mpmcq
+size_t mpmcq_get_capacity(/*@notnull@*/ const struct mpmcq *mpmcq);
+
+/// Returns the number of elements in a queue. While other threads are using
+/// the queue this is only a snapshot and may be stale by the time it returns.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param mpmcq The mpmcq whose elements to count
+///
+/// @return Number of elements in mpmcq
+size_t mpmcq_get_size(/*@notnull@*/ struct mpmcq *mpmcq);
+
+/// Determine whether a queue is empty. Subject to the same caveat as
+/// mpmcq_get_size.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param mpmcq The mpmcq to test for emptiness
+///
+/// @return 1 if the mpmcq contains no elements, else 0
+int mpmcq_is_empty(/*@notnull@*/ struct mpmcq *mpmcq);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Adds data at the tail of a queue. Fails rather than waits if the queue is
+/// full. Safe to call from any number of threads at once.
+///
+/// COMPLEXITY: O(1), lock-free
+///
+/// @param mpmcq The mpmcq to insert at the tail of
+/// @param data The data to enqueue
+///
+/// @return 0 on success, -1 if the queue is full
+int mpmcq_ins_tail(/*@notnull@*/ struct mpmcq *mpmcq,
+                   /*@null@*/ void *data);
+
+/// Removes the element at the head of a queue and returns its data through
+/// data. Fails rather than waits if the queue is empty. Safe to call from any
+/// number of threads at once.
+///
+/// COMPLEXITY: O(1), lock-free
+///
+/// @param mpmcq The mpmcq to remove from the head of
+/// @param data Where to store the dequeued data
+///
+/// @return 0 on success, -1 if the queue is empty
+int mpmcq_rem_head(/*@notnull@*/ struct mpmcq *mpmcq,
+                   /*@notnull@*/ /*@out@*/ void **data);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // MPMCQ_H
@@ -0,0 +1,233 @@
+#ifndef OAHASHT_H
+#define OAHASHT_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    oahasht.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An open-addressed hash table mapping keys to data, laid out as a "Swiss
+/// table". Alongside the array of slots is an array of one-byte control
+/// values, one per slot, recording whether the slot is empty, deleted or full
+/// and, when full, seven bits of its key's hash. A lookup compares a whole
+/// group of control bytes against those seven bits at once (sixteen with SSE2,
+/// eight otherwise) and only touches the slots that match, so most misses
+/// never compare a key at all.
+///
+/// Keys and data are stored as pointers and neither is copied. Keys are never
+/// freed by the table; point them into the data they index, or manage them
+/// separately.
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// One entry of an oahasht
+struct oahasht_slot {
+    void *key;
+    void *data;
+};
+
+/// An open-addressed hash table struct
+///
+/// This structure must be initialised with oahasht_init() before use. Nothing
+/// is allocated until the first insertion or oahasht_reserve(). The table
+/// grows when it would otherwise be more than seven eighths full, so slot
+/// pointers are only valid until the next insertion.
+struct oahasht {
+    /*@null@*/ struct oahasht_slot *slots;
+    /*@null@*/ signed char *ctrl;
+    size_t capacity;
+    size_t size;
+    size_t growth_left;
+    size_t (*hash)(const void *key);
+    int (*cmp)(const void *a, const void *b);
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises an open-addressed hash table. This operation must be called for
+/// an oahasht before the oahasht can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param oahasht The oahasht to initialise
+/// @param hash Callback function hashing a key, e.g. hash_str from hash.h
+/// @param cmp Callback function returning 0 if two keys are equal
+void oahasht_init(/*@out@*/ struct oahasht *oahasht,
+                  /*@notnull@*/ size_t (*hash)(const void *key),
+                  /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Destroys an open-addressed hash table. If destroy is non-NULL it is called
+/// on the data of every entry. The table is left empty and may be reused.
+///
+/// COMPLEXITY: O(n) in the capacity
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param oahasht The oahasht to destroy
+/// @param destroy Callback function for freeing each entry's data
+void oahasht_destroy(/*@notnull@*/ struct oahasht *oahasht,
+                     /*@null@*/ void (*destroy)(void *data));
+
+/// Makes room for at least count entries, so that inserting up to that many
+/// never rehashes. Never shrinks the table.
+///
+/// COMPLEXITY: O(n) in the capacity
+///
+/// @param oahasht The oahasht to grow
+/// @param count The number of entries to make room for
+///
+/// @return 0 on success, -1 on failure
+int oahasht_reserve(/*@notnull@*/ struct oahasht *oahasht, size_t count);
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Looks up the entry for a key.
+///
+/// COMPLEXITY: O(1) on average
+///
+/// @param oahasht The oahasht to search
+/// @param key The key to look up
+///
+/// @return The entry for key, or NULL if there is none
+/*@null@*/
+struct oahasht_slot* oahasht_find(/*@notnull@*/ const struct oahasht *oahasht,
+                                  /*@null@*/ const void *key);
+
+/// Looks up the data stored under a key. Use oahasht_find instead if NULL may
+/// be stored as data.
+///
+/// COMPLEXITY: O(1) on average
+///
+/// @param oahasht The oahasht to search
+/// @param key The key to look up
+///
+/// @return The data stored under key, or NULL if there is none
+/*@null@*/
+void* oahasht_get(/*@notnull@*/ const struct oahasht *oahasht,
+                  /*@null@*/ const void *key);
+
+/// Returns the number of entries in an oahasht.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param oahasht The oahasht whose entries to count
+///
+/// @return Number of entries in oahasht
+size_t oahasht_get_size(/*@notnull@*/ const struct oahasht *oahasht);
+
+/// Determine whether an oahasht is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param oahasht The oahasht to test for emptiness
+///
+/// @return 1 if the oahasht contains no entries, else 0
+int oahasht_is_empty(/*@notnull@*/ const struct oahasht *oahasht);
+
+/// Returns the first entry of an oahasht in slot order, for use with
+/// oahasht_next. Entries are in no meaningful order.
+///
+/// COMPLEXITY: O(n) in the capacity, O(1) amortised over a full iteration
+///
+/// @param oahasht The oahasht to iterate over
+///
+/// @return The first entry, or NULL if the oahasht is empty
+/*@null@*/
+struct oahasht_slot* oahasht_first(/*@notnull@*/ const struct oahasht *oahasht);
+
+/// Returns the entry after slot in slot order.
+///
+/// COMPLEXITY: O(n) in the capacity, O(1) amortised over a full iteration
+///
+/// @param oahasht The oahasht being iterated over
+/// @param slot The current entry
+///
+/// @return The next entry, or NULL if slot was the last
+/*@null@*/
+struct oahasht_slot* oahasht_next(/*@notnull@*/ const struct oahasht *oahasht,
+                                  /*@notnull@*/ const struct oahasht_slot *slot);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Inserts data under a key. The table grows, rehashing every entry, if it
+/// has no room left.
+///
+/// COMPLEXITY: O(1) amortised
+///
+/// @param oahasht The oahasht to insert into
+/// @param key The key to store data under
+/// @param data The data to store
+///
+/// @return 0 on success, -1 if key is already present or on failure
+int oahasht_ins(/*@notnull@*/ struct oahasht *oahasht,
+                /*@null@*/ void *key,
+                /*@null@*/ void *data);
+
+/// Removes the entry for a key. If destroy is non-NULL it is called on the
+/// entry's data. Where no lookup could have probed past the slot, it is
+/// simply marked empty again; otherwise it becomes a tombstone that is
+/// cleared on the next rehash.
+///
+/// COMPLEXITY: O(1) on average
+///
+/// @param oahasht The oahasht to remove from
+/// @param key The key of the entry to remove
+/// @param destroy Callback function for freeing the entry's data
+///
+/// @return 0 on success, -1 if key is not present
+int oahasht_rem(/*@notnull@*/ struct oahasht *oahasht,
+                /*@null@*/ const void *key,
+                /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the entries of an oahasht
+///
+/// COMPLEXITY: O(n) in the capacity
+///
+/// @param oahasht The oahasht to iterate over
+/// @param name The name used for the iterator
+#define oahasht_for_each(oahasht, name)                                 \
+    for (struct oahasht_slot * name = oahasht_first(oahasht);           \
+         name;                                                          \
+         name = oahasht_next((oahasht), name))
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // OAHASHT_H
@@ -0,0 +1,149 @@
+#ifndef POOL_H
+#define POOL_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    pool.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A fixed-size node allocator. Nodes are carved out of large chunks and
+/// recycled through an internal free list, so that a list attached to a pool
+/// (see list_init_with_pool, dlist_init_with_pool, clist_init_with_pool and
+/// cdlist_init_with_pool) never calls malloc or free per element. A pool may be
+/// shared by any number of lists whose elements are no bigger than the pool's
+/// element size. Pools are not thread safe.
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// A single chunk of pool memory. Elements follow the header directly.
+///
+/// These are created and managed by the pool_ functions. You should never need
+/// to reference them.
+struct pool_chunk {
+    struct pool_chunk *next;
+};
+
+/// A fixed-size node pool
+///
+/// This structure must be initialised with pool_init() before use. When done
+/// with, use pool_destroy.
+struct pool {
+    struct pool_chunk *chunks;
+    void *free;
+    char *next;
+    char *end;
+    size_t elem_size;
+    size_t chunk_elems;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a pool handing out elements of elem_size bytes, allocated from
+/// the system chunk_elems at a time. No memory is allocated until the first
+/// call to pool_alloc.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param pool The pool to initialise
+/// @param elem_size The size of every element, e.g. sizeof(struct list_elem)
+/// @param chunk_elems The number of elements per chunk. 0 picks a default
+void pool_init(/*@out@*/ struct pool *pool,
+               size_t elem_size,
+               size_t chunk_elems);
+
+/// Destroys a pool, releasing every chunk at once. Every element handed out by
+/// the pool becomes invalid, so lists using the pool must be destroyed first.
+///
+/// COMPLEXITY: O(c) in the number of chunks
+///
+/// @param pool The pool to destroy
+void pool_destroy(/*@notnull@*/ struct pool *pool);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Takes an element from the pool, allocating a new chunk if required.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param pool The pool to allocate from
+///
+/// @return A pointer to an uninitialised element or NULL on failure
+/*@null@*/
+void* pool_alloc(/*@notnull@*/ struct pool *pool);
+
+/// Takes n elements from the pool at once, as a chain linked through the first
+/// pointer-sized member of each element, the layout pool_free_chain expects.
+/// Elements are reused from the free list first; the rest are carved from the
+/// current chunk and then from a single new chunk big enough for all of them,
+/// so a batch never costs more than one allocation from the system. The link
+/// stored in the last element is left uninitialised.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param pool The pool to allocate from
+/// @param n The number of elements to take, at least 1
+///
+/// @return The first element of the chain, or NULL on failure, in which case
+///         nothing is taken from the pool
+/*@null@*/
+void* pool_alloc_chain(/*@notnull@*/ struct pool *pool, size_t n);
+
+/// Returns an element to the pool for reuse. The memory is not given back to
+/// the system until pool_destroy is called.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param pool The pool elem was allocated from
+/// @param elem The element to release
+void pool_free(/*@notnull@*/ struct pool *pool,
+               /*@notnull@*/ void *elem);
+
+/// Returns a whole chain of elements to the pool at once. The chain must be
+/// linked through the first pointer-sized member of each element, from first
+/// through to last, which is how the next pointers of every list element type
+/// are laid out. The link stored in last is overwritten.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param pool The pool the elements were allocated from
+/// @param first The first element of the chain
+/// @param last The last element of the chain
+void pool_free_chain(/*@notnull@*/ struct pool *pool,
+                     /*@notnull@*/ void *first,
+                     /*@notnull@*/ void *last);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // POOL_H
@@ -0,0 +1,162 @@
+#ifndef PQUEUE_H
+#define PQUEUE_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    pqueue.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A priority queue built on heap. push returns a handle that can be passed to
+/// pqueue_update after the priority of its data changes, or to pqueue_remove
+/// to take it out of the queue early. pop always returns the data that cmp
+/// orders first.
+
+#include "heap.h"
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// A priority queue struct
+///
+/// This structure must be initialised with pqueue_init() before use. When done
+/// with, use pqueue_destroy.
+struct pqueue {
+    struct heap heap;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a priority queue. This operation must be called for a pqueue
+/// before the pqueue can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param pqueue The pqueue to initialise
+/// @param cmp Callback function comparing two elements' data. The element for
+///            which it returns less than zero is popped first
+void pqueue_init(/*@out@*/ struct pqueue *pqueue,
+                 /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Destroys a priority queue. This function removes all elements from the
+/// pqueue and calls the given destroy function on their data unless destroy is
+/// NULL.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param pqueue The pqueue to destroy
+/// @param destroy The function to use to free all the element data
+void pqueue_destroy(/*@notnull@*/ struct pqueue *pqueue,
+                    /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the number of elements in a pqueue.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param pqueue The pqueue whose elements to count
+///
+/// @return Number of elements in pqueue
+size_t pqueue_get_size(/*@notnull@*/ const struct pqueue *pqueue);
+
+/// Determine whether a pqueue is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param pqueue The pqueue to test for emptiness
+///
+/// @return 1 if the pqueue contains no elements, else 0
+int pqueue_is_empty(/*@notnull@*/ const struct pqueue *pqueue);
+
+/// Returns the data that would be popped next without removing it.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param pqueue The pqueue to peek into
+///
+/// @return The data at the front of the pqueue or NULL if it is empty
+/*@null@*/
+void* pqueue_peek(/*@notnull@*/ const struct pqueue *pqueue);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Adds data to a pqueue.
+///
+/// COMPLEXITY: O(log n), amortised
+///
+/// @param pqueue The pqueue to add to
+/// @param data The data to add
+///
+/// @return A handle for pqueue_update and pqueue_remove, valid until the data
+///         leaves the pqueue, or NULL on failure
+/*@null@*/
+struct heap_elem* pqueue_push(/*@notnull@*/ struct pqueue *pqueue,
+                              /*@null@*/ void *data);
+
+/// Removes and returns the data that cmp orders first.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param pqueue The pqueue to pop from
+///
+/// @return The popped data or NULL if the pqueue was empty
+/*@null@*/
+void* pqueue_pop(/*@notnull@*/ struct pqueue *pqueue);
+
+/// Moves an element back into place after the priority of its data changed.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param pqueue The parent pqueue
+/// @param elem The handle returned by pqueue_push
+void pqueue_update(/*@notnull@*/ struct pqueue *pqueue,
+                   /*@notnull@*/ struct heap_elem *elem);
+
+/// Removes an element from a pqueue before it is popped and returns its data.
+///
+/// COMPLEXITY: O(log n)
+///
+/// @param pqueue The parent pqueue
+/// @param elem The handle returned by pqueue_push
+///
+/// @return The removed element's data
+/*@null@*/
+void* pqueue_remove(/*@notnull@*/ struct pqueue *pqueue,
+                    /*@notnull@*/ struct heap_elem *elem);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // PQUEUE_H
@@ -0,0 +1,108 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    prefetch.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// Helpers behind the prefetching loop macros of the list types, such as
+/// list_for_each_prefetch. Those loops keep a second cursor running
+/// STRUCTURES_PREFETCH_DISTANCE elements ahead of the one the body sees, and
+/// prefetch the next element and the data of each element it passes, so that
+/// by the time the body reaches an element both are likely to be in cache.
+///
+/// Walking a list is one long chain of dependent loads, and prefetching cannot
+/// shorten that chain; what it hides is the cost of touching each element's
+/// data, and of the body's own work, behind the walk. Loops that never look at
+/// the data gain little.
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                   Macros
+// -----------------------------------------------------------------------------
+
+/// How many elements ahead of the loop body the prefetching loops run. Define
+/// it before including any list header to tune it; it must be at least 1.
+#ifndef STRUCTURES_PREFETCH_DISTANCE
+#define STRUCTURES_PREFETCH_DISTANCE 8
+#endif
+
+/// Hints that addr will soon be read. Does nothing on compilers without a
+/// prefetch builtin. Prefetching an invalid address, NULL included, is
+/// harmless.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param addr The address about to be read
+#if defined(__GNUC__) || defined(__clang__)
+#define structures_prefetch(addr) __builtin_prefetch(addr)
+#else
+#define structures_prefetch(addr) ((void)(addr))
+#endif
+
+/// Moves a prefetching cursor on by one element: prefetches the data of the
+/// element it is on and the element after that, then steps onto the next
+/// element. The cursor stays put once it reaches end.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ahead The cursor, an element pointer variable
+/// @param end The element that ends the list, NULL or the link of a circular
+///            list
+#define prefetch_step(ahead, end)                                   \
+    ((ahead) != (end)                                               \
+     ? (structures_prefetch((ahead)->data),                         \
+        structures_prefetch((ahead)->next),                         \
+        (ahead)->next)                                              \
+     : (ahead))
+
+// -----------------------------------------------------------------------------
+//                                 Traversal
+// -----------------------------------------------------------------------------
+
+/// Starts a prefetching cursor: walks distance elements on from elem,
+/// prefetching the data of each, and returns where it got to. Stops early at
+/// end.
+///
+/// COMPLEXITY: O(distance)
+///
+/// @param elem The element the loop starts on
+/// @param end The element that ends the list, NULL or the link of a circular
+///            list
+/// @param data_offset The offset of the data pointer within each element
+/// @param distance The number of elements to walk
+///
+/// @return The element distance on from elem, or end
+/*@null@*/
+void* prefetch_ahead(/*@null@*/ void *elem, /*@null@*/ const void *end,
+                     size_t data_offset, int distance);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // PREFETCH_H
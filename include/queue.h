@@ -0,0 +1,216 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    queue.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A first-in first-out queue of data pointers stored in a ring buffer. The
+/// ring doubles in size whenever it fills, so pushing and popping cost
+/// amortised O(1) with no allocation per element, unlike a cdlist used with
+/// cdlist_ins_tail and cdlist_rem_head. queue_from_list and queue_from_cdlist
+/// help move code over from such a list.
+///
+/// A queue is not safe to share between threads; see mpmcq for that.
+
+#include <stddef.h>
+
+struct cdlist;
+struct list;
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// A queue struct
+///
+/// This structure must be initialised with queue_init() before use. When done
+/// with, use queue_destroy. The front of the queue is items[head]; capacity
+/// is always zero or a power of two, so positions wrap with a mask.
+struct queue {
+    /*@null@*/ void **items;
+    size_t head;
+    size_t size;
+    size_t capacity;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a queue. This operation must be called for a queue before the
+/// queue can be used with any other operation. Nothing is allocated until the
+/// first push.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param queue The queue to initialise
+void queue_init(/*@out@*/ struct queue *queue);
+
+/// Destroys a queue. This function removes all elements from the queue and
+/// calls the given destroy function on their data unless destroy is NULL. The
+/// ring is freed and the queue may be reused.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param queue The queue to destroy
+/// @param destroy The function to use to free all the element data
+void queue_destroy(/*@notnull@*/ struct queue *queue,
+                   /*@null@*/ void (*destroy)(void *data));
+
+/// Makes room for at least count elements, so that pushing up to that many
+/// never reallocates.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param queue The queue to make room in
+/// @param count The number of elements to make room for
+///
+/// @return 0 on success, -1 on failure
+int queue_reserve(/*@notnull@*/ struct queue *queue,
+                  size_t count);
+
+/// Pushes the data of every element of a list onto the back of a queue, head
+/// first, so that a list used as a queue with list_ins_tail and list_rem_head
+/// becomes an equivalent queue. The list is left untouched.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param queue The queue to push onto
+/// @param list The list whose data to push
+///
+/// @return 0 on success, -1 on failure, in which case the queue is unchanged
+int queue_from_list(/*@notnull@*/ struct queue *queue,
+                    /*@notnull@*/ const struct list *list);
+
+/// Pushes the data of every element of a cdlist onto the back of a queue,
+/// head first, as queue_from_list does.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param queue The queue to push onto
+/// @param cdlist The cdlist whose data to push
+///
+/// @return 0 on success, -1 on failure, in which case the queue is unchanged
+int queue_from_cdlist(/*@notnull@*/ struct queue *queue,
+                      /*@notnull@*/ const struct cdlist *cdlist);
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the number of elements in a queue.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param queue The queue whose elements to count
+///
+/// @return Number of elements in queue
+size_t queue_get_size(/*@notnull@*/ const struct queue *queue);
+
+/// Determine whether a queue is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param queue The queue to test for emptiness
+///
+/// @return 1 if the queue contains no elements, else 0
+int queue_is_empty(/*@notnull@*/ const struct queue *queue);
+
+/// Returns the data at the front of a queue without removing it.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param queue The queue to peek into
+///
+/// @return The data at the front of the queue or NULL if it is empty
+/*@null@*/
+void* queue_peek(/*@notnull@*/ const struct queue *queue);
+
+/// Returns a pointer to the slot after pos in queue order, for use by
+/// queue_for_each.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param queue The queue being iterated over
+/// @param pos The current slot
+///
+/// @return The next slot, or NULL if pos was the back of the queue
+/*@null@*/
+void** queue_next(/*@notnull@*/ const struct queue *queue,
+                  /*@notnull@*/ void **pos);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Pushes data onto the back of a queue, doubling the ring if it is full.
+///
+/// COMPLEXITY: O(1) amortised
+///
+/// @param queue The queue to push onto
+/// @param data The data to push
+///
+/// @return 0 on success, -1 on failure
+int queue_push(/*@notnull@*/ struct queue *queue,
+               /*@null@*/ void *data);
+
+/// Pops the data at the front of a queue.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param queue The queue to pop from
+/// @param data Where to store the popped data. May be NULL to discard it
+///
+/// @return 0 on success, -1 if the queue was empty
+int queue_pop(/*@notnull@*/ struct queue *queue,
+              /*@null@*/ /*@out@*/ void **data);
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the elements of a queue
+/// from front to back. name is a void ** pointing at each element's data. The
+/// queue must not be pushed to or popped from during the loop.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param queue The queue to iterate over
+/// @param name The name used for the iterator
+#define queue_for_each(queue, name)                                     \
+    for (void **name = (queue)->size                                    \
+             ? (queue)->items + (queue)->head : NULL;                   \
+         name;                                                          \
+         name = queue_next(queue, name))
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // QUEUE_H
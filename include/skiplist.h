@@ -0,0 +1,298 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    skiplist.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An ordered set kept as a skip list. The bottom level is a doubly linked
+/// list in the style of dlist, ordered by a cmp callback on the data; every
+/// element also joins a random number of sparser express levels above it, so
+/// searches, insertions and removals take O(log n) expected time.
+///
+/// Any number of threads may search and iterate while other threads change
+/// the set. Readers take no lock: they bracket their accesses with
+/// skiplist_read_begin and skiplist_read_end, which only count the reader in
+/// the current epoch. Writers are serialised by a mutex inside the skiplist
+/// and publish each change with release stores, so a reader sees an element
+/// either fully linked or not at all. A removed element is unlinked at once
+/// but only freed (and its data destroyed) later, as a reader may still be
+/// standing on it.
+///
+/// Every write moves the epoch on if no reader from the epoch before the
+/// current one is left, and frees the elements removed two epochs ago: every
+/// reader that started before they were unlinked has finished by then. Readers
+/// that keep overlapping therefore do not hold back reclamation, as long as
+/// each of them finishes; removed elements wait for at most two more writes
+/// once the readers that could see them are done.
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The most levels any element can take part in. With each level holding a
+/// quarter of the elements of the one below, this covers far more elements
+/// than fit in memory.
+#define SKIPLIST_MAX_LEVEL 24
+
+/// The assumed size of a cache line. The reader counts are kept on their own
+/// line so that readers entering and leaving do not slow down the writers'
+/// lock.
+#define SKIPLIST_CACHE_LINE 64
+
+/// An element of a skiplist
+///
+/// These are created and managed by the skiplist_ functions. You should only
+/// read data from them. next[0] and prev link the bottom level as in a dlist;
+/// next[1] up to next[height - 1] are the express levels. retired and destroy
+/// are only used once the element has been removed, retired linking it into
+/// the list of elements removed in the same epoch.
+struct skiplist_elem {
+    void *data;
+    _Atomic(struct skiplist_elem *) prev;
+    /*@null@*/ struct skiplist_elem *retired;
+    /*@null@*/ void (*destroy)(void *data);
+    int height;
+    _Atomic(struct skiplist_elem *) next[];
+};
+
+/// A skip list struct
+///
+/// This structure must be initialised with skiplist_init() before use, and may
+/// not be shared between threads until it has been. head is a sentinel that
+/// takes part in every level and holds no data. Only writers change epoch.
+/// readers[e & 1] counts the readers that started in epoch e, and
+/// retired[e & 1] holds the elements removed in it.
+struct skiplist {
+    struct skiplist_elem *head;
+    _Atomic(struct skiplist_elem *) tail;
+    atomic_int level;
+    atomic_size_t size;
+    int (*cmp)(const void *a, const void *b);
+    pthread_mutex_t lock;
+    /*@null@*/ struct skiplist_elem *retired[2];
+    unsigned long seed;
+    atomic_uint epoch;
+    _Alignas(SKIPLIST_CACHE_LINE) atomic_uint readers[2];
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a skip list. This operation must be called for a skiplist
+/// before the skiplist can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param skiplist The skiplist to initialise
+/// @param cmp Callback function ordering two elements' data, returning less
+///            than, equal to or greater than zero as strcmp does
+///
+/// @return 0 on success, -1 on failure
+int skiplist_init(/*@out@*/ struct skiplist *skiplist,
+                  /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Destroys a skip list, freeing every element including those removed but
+/// not yet freed. destroy is called on the data of each element still in the
+/// set unless it is NULL; removed elements use the destroy given on removal.
+/// No other thread may be using the skiplist.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param skiplist The skiplist to destroy
+/// @param destroy The function to use to free all the element data
+void skiplist_destroy(/*@notnull@*/ struct skiplist *skiplist,
+                      /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                  Readers
+// -----------------------------------------------------------------------------
+
+/// Marks the start of a read. Every element and piece of data obtained from
+/// the skiplist stays valid until the matching skiplist_read_end, even if it
+/// is removed in the meantime. Reads may nest and overlap. A thread that is
+/// the only user of the skiplist need not call this.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param skiplist The skiplist about to be read
+///
+/// @return The epoch the read started in, to be passed to skiplist_read_end
+unsigned skiplist_read_begin(/*@notnull@*/ struct skiplist *skiplist);
+
+/// Marks the end of a read begun with skiplist_read_begin.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param skiplist The skiplist that was read
+/// @param epoch The epoch skiplist_read_begin returned for the read
+void skiplist_read_end(/*@notnull@*/ struct skiplist *skiplist,
+                       unsigned epoch);
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the first element of a skiplist, the one cmp orders first. Returns
+/// NULL if the skiplist is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param skiplist The skiplist to return the head element of
+///
+/// @return The first element of the skiplist or NULL for an empty skiplist
+/*@null@*/
+struct skiplist_elem* skiplist_get_head(/*@notnull@*/ const struct skiplist *skiplist);
+
+/// Returns the last element of a skiplist. Returns NULL if the skiplist is
+/// empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param skiplist The skiplist to return the tail element of
+///
+/// @return The last element of the skiplist or NULL for an empty skiplist
+/*@null@*/
+struct skiplist_elem* skiplist_get_tail(/*@notnull@*/ const struct skiplist *skiplist);
+
+/// Returns the number of elements in a skiplist. While writers are active the
+/// count may already be out of date when it is returned.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param skiplist The skiplist whose elements to count
+///
+/// @return Number of elements in skiplist
+size_t skiplist_get_size(/*@notnull@*/ const struct skiplist *skiplist);
+
+/// Determine whether a skiplist is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param skiplist The skiplist to test for emptiness
+///
+/// @return 1 if the skiplist contains no elements, else 0
+int skiplist_is_empty(/*@notnull@*/ const struct skiplist *skiplist);
+
+/// Finds the element whose data cmp considers equal to key.
+///
+/// COMPLEXITY: O(log n) expected
+///
+/// @param skiplist The skiplist to search
+/// @param key The data to look for, or anything cmp can compare with it
+///
+/// @return The matching element or NULL if there is none
+/*@null@*/
+struct skiplist_elem* skiplist_find(/*@notnull@*/ const struct skiplist *skiplist,
+                                    /*@null@*/ const void *key);
+
+/// Finds the first element whose data does not order before key.
+///
+/// COMPLEXITY: O(log n) expected
+///
+/// @param skiplist The skiplist to search
+/// @param key The bound
+///
+/// @return The element or NULL if every element orders before key
+/*@null@*/
+struct skiplist_elem* skiplist_lower_bound(/*@notnull@*/ const struct skiplist *skiplist,
+                                           /*@null@*/ const void *key);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Inserts data into a skiplist in order. Safe to call while other threads
+/// read or write.
+///
+/// COMPLEXITY: O(log n) expected
+///
+/// @param skiplist The skiplist to insert into
+/// @param data The data the new element should point to
+///
+/// @return 0 on success, -1 if equal data is already present or on failure
+int skiplist_ins(/*@notnull@*/ struct skiplist *skiplist,
+                 /*@null@*/ void *data);
+
+/// Removes the element whose data cmp considers equal to key. The element is
+/// freed, and destroy called on its data unless destroy is NULL, once no
+/// reader can still be using it. Safe to call while other threads read or
+/// write.
+///
+/// COMPLEXITY: O(log n) expected
+///
+/// @param skiplist The skiplist to remove from
+/// @param key The data to remove, or anything cmp can compare with it
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 if no element matched
+int skiplist_rem(/*@notnull@*/ struct skiplist *skiplist,
+                 /*@null@*/ const void *key,
+                 /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the elements of a
+/// skiplist in order. Other threads may change the skiplist during the loop;
+/// the loop then sees each element that stays in the set throughout, in
+/// order, and may or may not see the others.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param skiplist The skiplist to iterate over
+/// @param name The name used for the iterator
+#define skiplist_for_each(skiplist, name)                               \
+    for (struct skiplist_elem * name = skiplist_get_head(skiplist);     \
+         name;                                                          \
+         name = atomic_load_explicit(&name->next[0],                    \
+                                     memory_order_acquire))
+
+/// A macro for generating for loops - loop over all the elements of a
+/// skiplist backwards, starting with the tail and ending with the head
+///
+/// COMPLEXITY: O(n)
+///
+/// @param skiplist The skiplist to iterate over
+/// @param name The name used for the iterator
+#define skiplist_for_each_rev(skiplist, name)                           \
+    for (struct skiplist_elem * name = skiplist_get_tail(skiplist);     \
+         name;                                                          \
+         name = atomic_load_explicit(&name->prev, memory_order_acquire))
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // SKIPLIST_H
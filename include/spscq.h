@@ -0,0 +1,187 @@
+#ifndef SPSCQ_H
+#define SPSCQ_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    spscq.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A bounded wait-free single-producer/single-consumer queue. One thread may
+/// call the ins_tail functions while one other thread calls the rem_head
+/// functions, with no lock; elements come out in the order they went in, as
+/// with cdlist_ins_tail and cdlist_rem_head. Use an mpmcq if more threads
+/// need to share one end.
+///
+/// The queue is a power-of-two ring of data pointers. Each side owns one
+/// index and only ever reads the other's, keeping a private copy of it that
+/// is refreshed only when the ring looks full or empty, so in steady state
+/// neither side touches the other's cache line. Nothing is allocated or freed
+/// after spscq_init, and no operation ever waits or retries.
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The assumed size of a cache line. The consumer's and producer's fields are
+/// kept this far apart so that they do not invalidate each other's line.
+#define SPSCQ_CACHE_LINE 64
+
+/// A bounded single-producer/single-consumer queue struct
+///
+/// head and tail_cache belong to the consumer, tail and head_cache to the
+/// producer. This structure must be initialised with spscq_init() before use,
+/// and may not be shared between threads until it has been.
+struct spscq {
+    void **buffer;
+    size_t mask;
+    _Alignas(SPSCQ_CACHE_LINE) atomic_size_t head;
+    size_t tail_cache;
+    _Alignas(SPSCQ_CACHE_LINE) atomic_size_t tail;
+    size_t head_cache;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a queue. This operation must be called for an spscq before the
+/// spscq can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param spscq The spscq to initialise
+/// @param capacity The most elements the queue can hold. Rounded up to a power
+///                 of two, minimum 2
+///
+/// @return 0 on success, -1 on failure
+int spscq_init(/*@out@*/ struct spscq *spscq, size_t capacity);
+
+/// Destroys a queue. Any elements still queued are passed to destroy unless it
+/// is NULL. Neither thread may be using the queue.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param spscq The spscq to destroy
+/// @param destroy Callback function for freeing each remaining element's data
+void spscq_destroy(/*@notnull@*/ struct spscq *spscq,
+                   /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the number of elements the queue can hold.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param spscq The spscq to return the capacity of
+///
+/// @return The capacity of the spscq
+size_t spscq_get_capacity(/*@notnull@*/ const struct spscq *spscq);
+
+/// Returns the number of elements in a queue. While the queue is in use this
+/// is only a snapshot and may be stale by the time it returns.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param spscq The spscq whose elements to count
+///
+/// @return Number of elements in spscq
+size_t spscq_get_size(/*@notnull@*/ struct spscq *spscq);
+
+/// Determine whether a queue is empty. Subject to the same caveat as
+/// spscq_get_size.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param spscq The spscq to test for emptiness
+///
+/// @return 1 if the spscq contains no elements, else 0
+int spscq_is_empty(/*@notnull@*/ struct spscq *spscq);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Adds data at the tail of a queue. Fails rather than waits if the queue is
+/// full. Producer thread only.
+///
+/// COMPLEXITY: O(1), wait-free
+///
+/// @param spscq The spscq to insert at the tail of
+/// @param data The data to enqueue
+///
+/// @return 0 on success, -1 if the queue is full
+int spscq_ins_tail(/*@notnull@*/ struct spscq *spscq,
+                   /*@null@*/ void *data);
+
+/// Adds up to n elements at the tail of a queue, in order, publishing them to
+/// the consumer all at once. Inserts as many as there is room for. Producer
+/// thread only.
+///
+/// COMPLEXITY: O(n), wait-free
+///
+/// @param spscq The spscq to insert at the tail of
+/// @param data The n data pointers to enqueue
+/// @param n The number of elements in data
+///
+/// @return The number of elements inserted, from 0 to n
+size_t spscq_ins_tail_n(/*@notnull@*/ struct spscq *spscq,
+                        /*@notnull@*/ void *const *data, size_t n);
+
+/// Removes the element at the head of a queue and returns its data through
+/// data. Fails rather than waits if the queue is empty. Consumer thread only.
+///
+/// COMPLEXITY: O(1), wait-free
+///
+/// @param spscq The spscq to remove from the head of
+/// @param data Where to store the dequeued data
+///
+/// @return 0 on success, -1 if the queue is empty
+int spscq_rem_head(/*@notnull@*/ struct spscq *spscq,
+                   /*@notnull@*/ /*@out@*/ void **data);
+
+/// Removes up to n elements from the head of a queue into data, in order,
+/// handing their slots back to the producer all at once. Consumer thread
+/// only.
+///
+/// COMPLEXITY: O(n), wait-free
+///
+/// @param spscq The spscq to remove from the head of
+/// @param data Where to store the dequeued data, room for n pointers
+/// @param n The most elements to remove
+///
+/// @return The number of elements removed, from 0 to n
+size_t spscq_rem_head_n(/*@notnull@*/ struct spscq *spscq,
+                        /*@notnull@*/ /*@out@*/ void **data, size_t n);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // SPSCQ_H
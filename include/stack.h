@@ -0,0 +1,199 @@
+#ifndef STACK_H
+#define STACK_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    stack.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A last-in first-out stack of data pointers stored in one contiguous array.
+/// The array doubles in size whenever it fills, so pushing and popping cost
+/// amortised O(1) with no allocation per element, unlike a list used with
+/// list_ins_head and list_rem_head. stack_from_list and stack_from_cdlist
+/// help move code over from such a list.
+
+#include <stddef.h>
+
+struct cdlist;
+struct list;
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// A stack struct
+///
+/// This structure must be initialised with stack_init() before use. When done
+/// with, use stack_destroy. items[size - 1] is the top of the stack.
+struct stack {
+    /*@null@*/ void **items;
+    size_t size;
+    size_t capacity;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a stack. This operation must be called for a stack before the
+/// stack can be used with any other operation. Nothing is allocated until the
+/// first push.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param stack The stack to initialise
+void stack_init(/*@out@*/ struct stack *stack);
+
+/// Destroys a stack. This function removes all elements from the stack and
+/// calls the given destroy function on their data unless destroy is NULL. The
+/// array is freed and the stack may be reused.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param stack The stack to destroy
+/// @param destroy The function to use to free all the element data
+void stack_destroy(/*@notnull@*/ struct stack *stack,
+                   /*@null@*/ void (*destroy)(void *data));
+
+/// Makes room for at least count elements, so that pushing up to that many
+/// never reallocates.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param stack The stack to make room in
+/// @param count The number of elements to make room for
+///
+/// @return 0 on success, -1 on failure
+int stack_reserve(/*@notnull@*/ struct stack *stack,
+                  size_t count);
+
+/// Pushes the data of every element of a list onto a stack, so that the
+/// list's head ends up on top. A list used as a stack with list_ins_head and
+/// list_rem_head becomes an equivalent stack. The list is left untouched.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param stack The stack to push onto
+/// @param list The list whose data to push
+///
+/// @return 0 on success, -1 on failure, in which case the stack is unchanged
+int stack_from_list(/*@notnull@*/ struct stack *stack,
+                    /*@notnull@*/ const struct list *list);
+
+/// Pushes the data of every element of a cdlist onto a stack, so that the
+/// cdlist's head ends up on top, as stack_from_list does.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param stack The stack to push onto
+/// @param cdlist The cdlist whose data to push
+///
+/// @return 0 on success, -1 on failure, in which case the stack is unchanged
+int stack_from_cdlist(/*@notnull@*/ struct stack *stack,
+                      /*@notnull@*/ const struct cdlist *cdlist);
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the number of elements on a stack.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param stack The stack whose elements to count
+///
+/// @return Number of elements on stack
+size_t stack_get_size(/*@notnull@*/ const struct stack *stack);
+
+/// Determine whether a stack is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param stack The stack to test for emptiness
+///
+/// @return 1 if the stack contains no elements, else 0
+int stack_is_empty(/*@notnull@*/ const struct stack *stack);
+
+/// Returns the data on top of a stack without removing it.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param stack The stack to peek at
+///
+/// @return The data on top of the stack or NULL if it is empty
+/*@null@*/
+void* stack_peek(/*@notnull@*/ const struct stack *stack);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Pushes data onto a stack, doubling the array if it is full.
+///
+/// COMPLEXITY: O(1) amortised
+///
+/// @param stack The stack to push onto
+/// @param data The data to push
+///
+/// @return 0 on success, -1 on failure
+int stack_push(/*@notnull@*/ struct stack *stack,
+               /*@null@*/ void *data);
+
+/// Pops the data on top of a stack.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param stack The stack to pop from
+/// @param data Where to store the popped data. May be NULL to discard it
+///
+/// @return 0 on success, -1 if the stack was empty
+int stack_pop(/*@notnull@*/ struct stack *stack,
+              /*@null@*/ /*@out@*/ void **data);
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the elements of a stack
+/// from the top down. name is a void ** pointing at each element's data. The
+/// stack must not be pushed to or popped from during the loop.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param stack The stack to iterate over
+/// @param name The name used for the iterator
+#define stack_for_each(stack, name)                                     \
+    for (void **name = (stack)->size                                    \
+             ? (stack)->items + (stack)->size - 1 : NULL;               \
+         name;                                                          \
+         name = name != (stack)->items ? name - 1 : NULL)
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // STACK_H
@@ -0,0 +1,197 @@
+#ifndef STATS_H
+#define STATS_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    stats.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// Optional counters showing how the list types are used, for finding out what
+/// a program in production is really doing to its lists. For each of list,
+/// dlist, clist and cdlist they count the elements allocated and freed, and
+/// every walk an operation makes to find its way along a list: the walk from
+/// the head that list_rem_tail and clist_get_tail make, and the counts behind
+/// the size and tail functions when STRUCTURES_NO_SIZE_CACHE or
+/// STRUCTURES_NO_TAIL_CACHE is defined. Walk lengths go into a histogram, and
+/// each operation that walks is tallied on its own, so that an O(n) call made
+/// on a long list stands out.
+///
+/// Counting is compiled in only when STRUCTURES_STATS is defined for the whole
+/// build, e.g. with CFLAGS=-DSTRUCTURES_STATS make. Without it the hooks in the
+/// list code expand to nothing, and the functions below report zeros, so
+/// callers need not care how the library was built. The counters are global
+/// and may be updated from any thread.
+
+#include <stdint.h>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The number of buckets in a walk length histogram. Bucket 0 counts walks of
+/// no steps, and bucket i walks of 2^(i-1) up to 2^i - 1 steps, the last
+/// bucket taking everything longer.
+#define STATS_BUCKETS 32
+
+/// The most operations tallied per list type. Walks by any further operations
+/// still count towards the totals and histogram.
+#define STATS_OPS 16
+
+/// Walks of at least this many steps are counted as hot. Define it when
+/// building the library to change it.
+#ifndef STRUCTURES_STATS_HOT_STEPS
+#define STRUCTURES_STATS_HOT_STEPS 1024
+#endif
+
+/// The list types counted
+enum stats_type {
+    STATS_LIST,
+    STATS_DLIST,
+    STATS_CLIST,
+    STATS_CDLIST,
+    STATS_TYPES
+};
+
+/// The walks made by one operation, named by its function
+struct stats_op {
+    const char *name;
+    uint64_t walks;
+    uint64_t steps;
+    uint64_t longest;
+    uint64_t hot;
+};
+
+/// A snapshot of the counters of one list type. ops holds the operations seen
+/// so far, in the order they first walked, with a NULL name after the last.
+struct stats {
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t walks;
+    uint64_t steps;
+    uint64_t hot;
+    uint64_t histogram[STATS_BUCKETS];
+    struct stats_op ops[STATS_OPS];
+};
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Copies the counters of a list type into stats. Counters updated while the
+/// copy is taken may or may not be included.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param type The list type to report on
+/// @param stats Where to store the counters
+void stats_get(enum stats_type type,
+               /*@out@*/ /*@notnull@*/ struct stats *stats);
+
+/// Returns the name of a list type, such as "list"
+///
+/// COMPLEXITY: O(1)
+///
+/// @param type The list type to name
+///
+/// @return The name of the type
+/*@notnull@*/
+const char* stats_type_name(enum stats_type type);
+
+/// Returns whether the library was built with STRUCTURES_STATS
+///
+/// COMPLEXITY: O(1)
+///
+/// @return 1 if counting is compiled in, else 0
+int stats_enabled(void);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Sets every counter of every list type back to zero, and forgets the
+/// operations seen. Must not be called while lists are in use.
+///
+/// COMPLEXITY: O(1)
+void stats_reset(void);
+
+/// Writes the counters of every list type that has been used to file, as
+/// readable text. Operations with hot walks are marked HOT.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param file The file to write to, e.g. stderr
+///
+/// @return 0 on success, -1 if writing failed
+int stats_dump(/*@notnull@*/ FILE *file);
+
+/// Counts n elements of a list type allocated. Called through stats_alloc.
+void stats_record_alloc(enum stats_type type, uint64_t n);
+
+/// Counts n elements of a list type freed. Called through stats_free.
+void stats_record_free(enum stats_type type, uint64_t n);
+
+/// Counts a walk of steps steps made by the function named op, which must be
+/// a string that outlives the counters. Called through stats_walk.
+void stats_record_walk(enum stats_type type,
+                       /*@notnull@*/ const char *op,
+                       uint64_t steps);
+
+// -----------------------------------------------------------------------------
+//                                   Hooks
+// -----------------------------------------------------------------------------
+
+/// The calls placed in the list code. With STRUCTURES_STATS undefined they
+/// expand to nothing, their arguments left unevaluated; a step counter that
+/// only feeds stats_walk is then never incremented either. stats_walk names
+/// the walk after the function it is used in.
+#ifdef STRUCTURES_STATS
+#define stats_alloc(type, n) stats_record_alloc(type, (uint64_t)(n))
+#define stats_free(type, n) stats_record_free(type, (uint64_t)(n))
+#define stats_step(steps) (++(steps))
+#define stats_walk(type, steps)                                         \
+    stats_record_walk(type, __func__, (uint64_t)(steps))
+#else
+#define stats_alloc(type, n) ((void)sizeof(n))
+#define stats_free(type, n) ((void)sizeof(n))
+#define stats_step(steps) ((void)sizeof(steps))
+#define stats_walk(type, steps) ((void)sizeof(steps))
+#endif
+
+/// 1 if the list code has to count elements itself to report them freed,
+/// because counting is compiled in but sizes are not cached, else 0. The
+/// pooled destroy functions then walk a list they could otherwise hand back
+/// to the pool whole.
+#if defined(STRUCTURES_STATS) && defined(STRUCTURES_NO_SIZE_CACHE)
+#define STATS_COUNT_BY_WALK 1
+#else
+#define STATS_COUNT_BY_WALK 0
+#endif
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // STATS_H
@@ -0,0 +1,240 @@
+#ifndef TSDLIST_H
+#define TSDLIST_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    tsdlist.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A thread-safe doubly linked list with a lock in every element, so threads
+/// working at different positions do not serialise on one lock as they would
+/// around dlist_ins_next and dlist_rem_elem. Any number of threads may call
+/// any tsdlist function except tsdlist_init and tsdlist_destroy at once.
+///
+/// The list is bounded by two sentinel elements and every operation locks the
+/// elements it changes in list order, head to tail. Walks move hand over hand,
+/// locking the next element before letting go of the previous one, so an
+/// element can only be unlinked and freed by a thread holding both of its
+/// neighbours. Operations at the tail, which have to start from the wrong
+/// end, take the earlier locks with trylock and back off rather than wait.
+///
+/// Elements are never handed out, as another thread could free them at any
+/// moment. Data comes back from the rem functions, and tsdlist_for_each
+/// passes each element's data to a callback while the element is locked.
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// Individual elements within a tsdlist. These are only ever touched by the
+/// tsdlist_ functions.
+struct tsdlist_elem {
+    struct tsdlist_elem *next;
+    struct tsdlist_elem *prev;
+    void *data;
+    pthread_mutex_t lock;
+};
+
+/// A thread-safe doubly linked list struct
+///
+/// head and tail are sentinels that hold no data; the list is empty when
+/// head.next is &tail. tail is kept on its own cache line so that threads
+/// working at opposite ends do not share one. This structure must be
+/// initialised with tsdlist_init() before use, and may not be shared between
+/// threads until it has been.
+struct tsdlist {
+    struct tsdlist_elem head;
+    _Alignas(64) struct tsdlist_elem tail;
+    atomic_int size;
+};
+
+/// What a tsdlist_for_each callback wants done once it returns
+enum tsdlist_visit {
+    TSDLIST_CONTINUE,  ///< Move on to the next element
+    TSDLIST_REMOVE,    ///< Unlink and free this element, then move on
+    TSDLIST_STOP       ///< End the walk here
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a thread-safe doubly linked list. This operation must be called
+/// for a tsdlist before the tsdlist can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param tsdlist The tsdlist to initialise
+///
+/// @return 0 on success, -1 on failure
+int tsdlist_init(/*@out@*/ struct tsdlist *tsdlist);
+
+/// Destroys a thread-safe doubly linked list, calling destroy on every
+/// element's data unless destroy is NULL. No other thread may be using the
+/// tsdlist.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param tsdlist The tsdlist to destroy
+/// @param destroy Callback function for freeing each element's data
+void tsdlist_destroy(/*@notnull@*/ struct tsdlist *tsdlist,
+                     /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the number of elements in a tsdlist. While other threads are using
+/// the tsdlist this is only a snapshot and may be stale by the time it returns.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param tsdlist The tsdlist whose elements to count
+///
+/// @return Number of elements in tsdlist
+int tsdlist_get_size(/*@notnull@*/ struct tsdlist *tsdlist);
+
+/// Determine whether a tsdlist is empty. Subject to the same caveat as
+/// tsdlist_get_size.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param tsdlist The tsdlist to test for emptiness
+///
+/// @return 1 if the tsdlist contains no elements, else 0
+int tsdlist_is_empty(/*@notnull@*/ struct tsdlist *tsdlist);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Inserts data at the head of a tsdlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param tsdlist The tsdlist to insert at the head of
+/// @param data The data the newly created element should point to
+///
+/// @return 0 for success, -1 for failure
+int tsdlist_ins_head(/*@notnull@*/ struct tsdlist *tsdlist,
+                     /*@null@*/ void *data);
+
+/// Inserts data before the first element that cmp orders after it, walking
+/// from the head. A tsdlist only filled this way stays sorted, with equal
+/// elements in the order they were inserted.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param tsdlist The tsdlist to insert into
+/// @param data The data the newly created element should point to
+/// @param cmp Callback function comparing two elements' data
+///
+/// @return 0 for success, -1 for failure
+int tsdlist_ins_sorted(/*@notnull@*/ struct tsdlist *tsdlist,
+                       /*@null@*/ void *data,
+                       /*@notnull@*/ int (*cmp)(const void *a, const void *b));
+
+/// Inserts data at the tail of a tsdlist.
+///
+/// COMPLEXITY: O(1), retried while the tail is contended
+///
+/// @param tsdlist The tsdlist to insert at the tail of
+/// @param data The data the newly created element should point to
+///
+/// @return 0 for success, -1 for failure
+int tsdlist_ins_tail(/*@notnull@*/ struct tsdlist *tsdlist,
+                     /*@null@*/ void *data);
+
+/// Removes the element at the head of a tsdlist and returns its data through
+/// data.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param tsdlist The tsdlist to remove from the head of
+/// @param data Where to store the removed element's data
+///
+/// @return 0 on success, -1 if the tsdlist was empty
+int tsdlist_rem_head(/*@notnull@*/ struct tsdlist *tsdlist,
+                     /*@notnull@*/ /*@out@*/ void **data);
+
+/// Removes the first element, walking from the head, whose data cmp finds
+/// equal to key. The element's data is passed to destroy unless destroy is
+/// NULL.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param tsdlist The tsdlist to remove from
+/// @param key The data to compare each element's data with
+/// @param cmp Callback function comparing an element's data with key
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 if no element matched
+int tsdlist_rem_match(/*@notnull@*/ struct tsdlist *tsdlist,
+                      /*@null@*/ const void *key,
+                      /*@notnull@*/ int (*cmp)(const void *a, const void *b),
+                      /*@null@*/ void (*destroy)(void *data));
+
+/// Removes the element at the tail of a tsdlist and returns its data through
+/// data.
+///
+/// COMPLEXITY: O(1), retried while the tail is contended
+///
+/// @param tsdlist The tsdlist to remove from the tail of
+/// @param data Where to store the removed element's data
+///
+/// @return 0 on success, -1 if the tsdlist was empty
+int tsdlist_rem_tail(/*@notnull@*/ struct tsdlist *tsdlist,
+                     /*@notnull@*/ /*@out@*/ void **data);
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+/// Calls visit on the data of every element from head to tail. The element
+/// and the one before it are locked for the duration of each call, so other
+/// threads may insert and remove elsewhere in the list but never the element
+/// being visited. visit returns a tsdlist_visit to carry on, remove the
+/// element or stop; an element removed this way is freed without touching its
+/// data, which visit may have taken ownership of. visit must not call tsdlist
+/// functions on the same tsdlist.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param tsdlist The tsdlist to iterate over
+/// @param visit Callback function given each element's data and arg
+/// @param arg Passed through to visit
+void tsdlist_for_each(/*@notnull@*/ struct tsdlist *tsdlist,
+                      /*@notnull@*/ enum tsdlist_visit (*visit)(void *data,
+                                                                void *arg),
+                      /*@null@*/ void *arg);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // TSDLIST_H
@@ -0,0 +1,313 @@
+#ifndef ULIST_H
+#define ULIST_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    ulist.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// An unrolled doubly linked list. Each node holds a small array of data
+/// pointers, so walking the list is mostly sequential memory access and the
+/// cost of a node is shared by many elements. The API mirrors dlist.h, except
+/// that elements are positions (struct ulist_elem) rather than nodes, returned
+/// by value from ulist_get_head and ulist_get_tail. The looping macros hand out
+/// pointers to a position, so loops read elem->data as they do over a dlist.
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+struct pool;
+
+/// The number of data pointers held by each node. The default makes a node two
+/// cache lines wide on 64-bit builds.
+#ifndef ULIST_NODE_ELEMS
+#define ULIST_NODE_ELEMS 13
+#endif
+
+/// Individual nodes within an unrolled list
+///
+/// These are created and managed by the ulist_ functions. A node in a list
+/// always holds between 1 and ULIST_NODE_ELEMS elements.
+struct ulist_node {
+    struct ulist_node *next;
+    struct ulist_node *prev;
+    int count;
+    void *data[ULIST_NODE_ELEMS];
+};
+
+/// A position within an unrolled list
+///
+/// node is NULL for the position past either end of the list. data is a copy
+/// of node->data[index], refreshed as the position moves. Any insertion into or
+/// removal from a ulist invalidates every position other than the one passed
+/// to the operation.
+struct ulist_elem {
+    struct ulist_node *node;
+    int index;
+    void *data;
+};
+
+/// An unrolled list struct
+///
+/// When first initialised and when empty, head and tail are NULL. This
+/// structure must be initialised with ulist_init() or ulist_init_with_pool()
+/// before use. When done with, use ulist_destroy.
+struct ulist {
+    struct ulist_node *head;
+    struct ulist_node *tail;
+    struct pool *pool;
+    int size;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises an unrolled list. This operation must be called for a ulist
+/// before the ulist can be used with any other operation.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to initialise
+void ulist_init(/*@out@*/ struct ulist *ulist);
+
+/// Initialises an unrolled list whose nodes are allocated from pool. The pool
+/// must have been initialised with an element size of at least
+/// sizeof(struct ulist_node) and must outlive the ulist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to initialise
+/// @param pool The pool to allocate nodes from
+void ulist_init_with_pool(/*@out@*/ struct ulist *ulist,
+                          /*@notnull@*/ struct pool *pool);
+
+/// Destroys an unrolled list, calling destroy on every element's data unless
+/// destroy is NULL.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param ulist The ulist to destroy
+/// @param destroy The function to use to free all the element data
+void ulist_destroy(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the position of the first element of a ulist. The position's node
+/// is NULL if the ulist is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to return the head element of
+///
+/// @return The position of the first element
+struct ulist_elem ulist_get_head(/*@notnull@*/ const struct ulist *ulist);
+
+/// Returns the position of the last element of a ulist. The position's node is
+/// NULL if the ulist is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to return the tail element of
+///
+/// @return The position of the last element
+struct ulist_elem ulist_get_tail(/*@notnull@*/ const struct ulist *ulist);
+
+/// Returns the number of elements in a ulist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist whose elements to count
+///
+/// @return Number of elements in ulist.
+int ulist_get_size(/*@notnull@*/ const struct ulist *ulist);
+
+/// Determine whether a ulist is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to test for emptiness
+///
+/// @return 1 if the ulist contains no elements, else 0
+int ulist_is_empty(/*@notnull@*/ const struct ulist *ulist);
+
+/// Moves a position on to the following element. The node of the position
+/// becomes NULL when it moves past the tail. An index already past the end of
+/// its node moves straight on to the first element of the next node.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param elem The position to move
+void ulist_next(/*@notnull@*/ struct ulist_elem *elem);
+
+/// Moves a position back to the preceding element. The node of the position
+/// becomes NULL when it moves past the head. An index already before the start
+/// of its node moves straight on to the last element of the previous node.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param elem The position to move
+void ulist_prev(/*@notnull@*/ struct ulist_elem *elem);
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Inserts an element at the head of a ulist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to insert at the head of
+/// @param data The data the new element should point to
+///
+/// @return 0 for success, -1 for failure
+int ulist_ins_head(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void *data);
+
+/// Inserts an element at the tail of a ulist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to insert at the tail of
+/// @param data The data the new element should point to
+///
+/// @return 0 for success, -1 for failure
+int ulist_ins_tail(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void *data);
+
+/// Inserts an element after the given position.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The parent ulist
+/// @param elem The position to insert after
+/// @param data The data the new element should point to
+///
+/// @return 0 for success, -1 for failure
+int ulist_ins_next(/*@notnull@*/ struct ulist *ulist,
+                   /*@notnull@*/ const struct ulist_elem *elem,
+                   /*@null@*/ void *data);
+
+/// Inserts an element before the given position.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The parent ulist
+/// @param elem The position to insert before
+/// @param data The data the new element should point to
+///
+/// @return 0 for success, -1 for failure
+int ulist_ins_prev(/*@notnull@*/ struct ulist *ulist,
+                   /*@notnull@*/ const struct ulist_elem *elem,
+                   /*@null@*/ void *data);
+
+/// Removes the element at the given position. Afterwards elem refers to the
+/// element that followed the removed one, so a loop can carry on from it
+/// without calling ulist_next.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param ulist The parent ulist
+/// @param elem The position to remove
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 on failure
+int ulist_rem_elem(/*@notnull@*/ struct ulist *ulist,
+                   /*@notnull@*/ struct ulist_elem *elem,
+                   /*@null@*/ void (*destroy)(void *data));
+
+/// Removes the element at the head of a ulist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to remove from the head of
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 on failure
+int ulist_rem_head(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void (*destroy)(void *data));
+
+/// Removes the element at the tail of a ulist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param ulist The ulist to remove from the tail of
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 on failure
+int ulist_rem_tail(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the elements of a ulist.
+/// As with the other lists, name is an element pointer and the data is
+/// name->data; it points at a position kept by the loop, so it can be passed
+/// straight to ulist_ins_next and friends. Stepping within a node is done
+/// inline; ulist_next is only called to change node.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param ulist The ulist to iterate over
+/// @param name The name used for the iterator
+#define ulist_for_each(ulist, name)                                     \
+    for (struct ulist_elem __ulist_pos = ulist_get_head(ulist),         \
+             * name = &__ulist_pos;                                     \
+         name->node;                                                    \
+         ++name->index < name->node->count                              \
+             ? (void)(name->data = name->node->data[name->index])       \
+             : ulist_next(name))
+
+/// A macro for generating for loops - loop over all the elements of a ulist
+/// backwards, starting with the tail and ending with the head. name is an
+/// element pointer, as in ulist_for_each.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param ulist The ulist to iterate over
+/// @param name The name used for the iterator
+#define ulist_for_each_rev(ulist, name)                                 \
+    for (struct ulist_elem __ulist_pos = ulist_get_tail(ulist),         \
+             * name = &__ulist_pos;                                     \
+         name->node;                                                    \
+         --name->index >= 0                                             \
+             ? (void)(name->data = name->node->data[name->index])       \
+             : ulist_prev(name))
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // ULIST_H
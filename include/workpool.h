@@ -0,0 +1,148 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    workpool.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A fixed set of worker threads that run numbered tasks, started once and
+/// reused by every call, so a parallel for_each does not pay for creating
+/// threads. It is what list_for_each_parallel and friends run on.
+///
+/// workpool_run hands each worker an equal slice of the task numbers. A worker
+/// takes tasks from the front of its own slice and, once that is empty,
+/// steals the back half of whichever other worker's slice it finds first, so
+/// uneven tasks still keep every worker busy until the last one is taken.
+/// The calling thread works alongside the pool's threads until all the tasks
+/// are done.
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+/// The assumed size of a cache line. Each worker's slice sits on its own line
+/// so that taking a task does not disturb the other workers.
+#define WORKPOOL_CACHE_LINE 64
+
+/// One worker's share of the tasks
+///
+/// These are created and managed by the workpool_ functions. You should never
+/// need to reference them. range packs the worker's remaining task numbers,
+/// from the low 32 bits up to but not including the high 32 bits, so that
+/// the owner and thieves can both change it with one compare-and-swap.
+struct workpool_worker {
+    _Alignas(WORKPOOL_CACHE_LINE) _Atomic uint64_t range;
+    pthread_t thread;
+    struct workpool *pool;
+    int id;
+};
+
+/// A pool of worker threads
+///
+/// workers[0] stands for whichever thread calls workpool_run; the others each
+/// have a thread of their own. lock and the two conditions hand each run to
+/// the workers and report back when they have all finished it. This structure
+/// must be initialised with workpool_init() before use.
+struct workpool {
+    struct workpool_worker *workers;
+    int threads;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned long run;
+    int busy;
+    int stop;
+    /*@null@*/ void (*task)(void *arg, size_t index, int worker);
+    /*@null@*/ void *arg;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises a worker pool of threads workers, the calling thread of each
+/// workpool_run included, so threads - 1 threads are started. If some cannot
+/// be started the pool makes do with those that were.
+///
+/// COMPLEXITY: O(threads)
+///
+/// @param workpool The workpool to initialise
+/// @param threads The number of workers, minimum 1
+///
+/// @return 0 on success, -1 on failure
+int workpool_init(/*@out@*/ struct workpool *workpool, int threads);
+
+/// Destroys a worker pool, stopping and joining its threads.
+///
+/// COMPLEXITY: O(threads)
+///
+/// @param workpool The workpool to destroy
+void workpool_destroy(/*@notnull@*/ struct workpool *workpool);
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the number of workers in a pool, the calling thread included.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param workpool The workpool to count the workers of
+///
+/// @return Number of workers in workpool
+int workpool_get_threads(/*@notnull@*/ const struct workpool *workpool);
+
+// -----------------------------------------------------------------------------
+//                                  Running
+// -----------------------------------------------------------------------------
+
+/// Calls task once for every index from 0 up to count, spread over the
+/// workers, and returns once every call has returned. worker is the number,
+/// below workpool_get_threads, of the worker making the call, so that tasks
+/// can keep per-worker state without locking. Only one thread may run tasks
+/// on a pool at a time, and a task must not call workpool_run itself.
+///
+/// COMPLEXITY: O(count / threads) if the tasks take equal time
+///
+/// @param workpool The workpool to run the tasks on
+/// @param count The number of tasks, at most UINT32_MAX
+/// @param task Callback function run for each task. Called concurrently
+/// @param arg Passed through to task
+void workpool_run(/*@notnull@*/ struct workpool *workpool, size_t count,
+                  /*@notnull@*/ void (*task)(void *arg, size_t index,
+                                             int worker),
+                  /*@null@*/ void *arg);
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // WORKPOOL_H
@@ -0,0 +1,365 @@
+#ifndef XLIST_H
+#define XLIST_H
+
+// -----------------------------------------------------------------------------
+//                                    Info
+// -----------------------------------------------------------------------------
+
+/// @file    xlist.h
+/// @author  John Anthony <john@jo.hnanthony.com>
+/// @version 0.1
+///
+/// @section LICENSE
+///
+/// Copyright (C) 2013 John Anthony
+///
+/// This program is free software: you can redistribute it and/or modify it
+/// under the terms of the GNU General Public License as published by the Free
+/// Software Foundation, either version 3 of the License, or (at your option)
+/// any later version.
+///
+/// This program is distributed in the hope that it will be useful, but WITHOUT
+/// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+/// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+/// more details.
+///
+/// You should have received a copy of the GNU General Public License along with
+/// this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// @section DESCRIPTION
+///
+/// A doubly linked list whose elements hold one link word instead of separate
+/// next and prev pointers: the link is the address of the previous element
+/// XORed with the address of the next, NULL standing for either end. Knowing
+/// the address of one neighbour of an element is enough to find the other, so
+/// the list can be walked in either direction from either end. An element takes
+/// 16 bytes on a 64-bit build against the 24 of a dlist_elem.
+///
+/// Because an element alone does not say where its neighbours are, the
+/// functions that work on an element in the middle of the list also take one
+/// of its neighbours, as the looping macros have to hand. Every xlist_elem
+/// pointer stays valid until its element is removed.
+///
+/// The saving is only realised when elements are not padded out by the
+/// allocator. glibc's malloc rounds both a 16 and a 24 byte request up to the
+/// same 32 byte chunk, so large xlists should be given a pool with
+/// xlist_init_with_pool, where an element costs exactly its 16 bytes.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+//                                 Structures
+// -----------------------------------------------------------------------------
+
+struct pool;
+
+/// Individual elements within an xlist
+///
+/// These should almost universally be created and managed by the xlist_
+/// functions. You should only be referencing them. link is the address of the
+/// previous element XOR the address of the next.
+struct xlist_elem {
+    uintptr_t link;
+    void *data;
+};
+
+/// A generic XOR-linked list struct
+///
+/// When first initialised and when empty, head and tail are NULL. This
+/// structure must be initialised with xlist_init() or xlist_init_with_pool()
+/// before use. When done with, use xlist_destroy. pool is NULL unless elements
+/// come from a pool.
+struct xlist {
+    struct xlist_elem *head;
+    struct xlist_elem *tail;
+    struct pool *pool;
+    int size;
+};
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+/// Initialises an xlist. This operation must be called for an xlist before the
+/// xlist can be used with any other operation. Obligation to free is passed out
+/// to the caller through the xlist parameter.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing an initialised xlist to this function is undefined
+/// behaviour. Expect a memory leak.
+///
+/// @param xlist The xlist to initialise
+void xlist_init(/*@out@*/ /*@notnull@*/ struct xlist *xlist);
+
+/// Initialises an xlist whose elements are allocated from pool instead of with
+/// malloc. The pool must have been initialised with an element size of at
+/// least sizeof(struct xlist_elem) and must outlive the xlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing an initialised xlist to this function is undefined
+/// behaviour. Expect a memory leak.
+///
+/// @param xlist The xlist to initialise
+/// @param pool The pool to allocate elements from
+void xlist_init_with_pool(/*@out@*/ /*@notnull@*/ struct xlist *xlist,
+                          /*@notnull@*/ struct pool *pool);
+
+/// Destroys an xlist. No other operations are permitted after destroying
+/// unless xlist_init is called again. This function removes all elements from
+/// the xlist and calls the given destroy function on them unless destroy is
+/// set to NULL. The elements of a pooled xlist are handed back to the pool in
+/// one go rather than freed one at a time.
+///
+/// COMPLEXITY: O(n)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param xlist The xlist to destroy
+/// @param destroy The function to use to free all the xlist element data
+void xlist_destroy(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void (*destroy)(void *data));
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/// Returns the first element of an xlist. Returns NULL if the xlist is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The xlist to return the head element of
+///
+/// @return The first element of the xlist or NULL for an empty xlist
+/*@null@*/
+struct xlist_elem* xlist_get_head(/*@notnull@*/ const struct xlist *xlist);
+
+/// Returns the number of elements in an xlist.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The xlist whose elements to count
+///
+/// @return Number of elements in xlist.
+int xlist_get_size(/*@notnull@*/ const struct xlist *xlist);
+
+/// Returns the last element of an xlist. Returns NULL if the xlist is empty.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The xlist to return the tail element of
+///
+/// @return The last element of the xlist or NULL for an empty xlist
+/*@null@*/
+struct xlist_elem* xlist_get_tail(/*@notnull@*/ const struct xlist *xlist);
+
+/// Determine whether an xlist is empty
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The xlist to test for emptiness
+///
+/// @return 1 if the xlist contains no elements, else 0
+int xlist_is_empty(/*@notnull@*/ const struct xlist *xlist);
+
+/// Returns the element after elem, given the element before it, or NULL if
+/// elem is the tail
+///
+/// COMPLEXITY: O(1)
+///
+/// @param elem The element to step on from
+/// @param prev The element before elem, NULL if elem is the head
+#define xlist_elem_next(elem, prev)                                     \
+    ((struct xlist_elem *)((elem)->link ^ (uintptr_t)(prev)))
+
+/// Returns the element before elem, given the element after it, or NULL if
+/// elem is the head
+///
+/// COMPLEXITY: O(1)
+///
+/// @param elem The element to step back from
+/// @param next The element after elem, NULL if elem is the tail
+#define xlist_elem_prev(elem, next)                                     \
+    ((struct xlist_elem *)((elem)->link ^ (uintptr_t)(next)))
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/// Inserts an element into an xlist at the head.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The xlist to insert at the head of
+/// @param data The data the newly created element should point to
+///
+/// @return 0 for success, -1 for failure
+int xlist_ins_head(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void *data);
+
+/// Inserts an element into an xlist after the given element. The element
+/// before elem is needed to find the one after it.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The parent xlist
+/// @param prev The element before elem, NULL if elem is the head
+/// @param elem The element to insert after
+/// @param data The data the newly created element should point to
+///
+/// @return 0 for success, -1 for failure
+int xlist_ins_next(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ struct xlist_elem *prev,
+                   /*@notnull@*/ struct xlist_elem *elem,
+                   /*@null@*/ void *data);
+
+/// Inserts an element into an xlist before the given element. The element
+/// after elem is needed to find the one before it.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The parent xlist
+/// @param elem The element to insert before
+/// @param next The element after elem, NULL if elem is the tail
+/// @param data The data the newly created element should point to
+///
+/// @return 0 for success, -1 for failure
+int xlist_ins_prev(/*@notnull@*/ struct xlist *xlist,
+                   /*@notnull@*/ struct xlist_elem *elem,
+                   /*@null@*/ struct xlist_elem *next,
+                   /*@null@*/ void *data);
+
+/// Inserts an element at the end of an xlist
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The xlist to insert at the end of
+/// @param data The data the newly created element should point to
+///
+/// @return 0 for success, -1 for failure
+int xlist_ins_tail(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void *data);
+
+/// Removes an element from an xlist. Either neighbour of elem identifies the
+/// other, so prev may be the element before or the element after it, or NULL
+/// if elem is at that end. The destroyed element will have destroy() called
+/// upon elem->data to free it if destroy is non-NULL.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param xlist Parent xlist to remove from
+/// @param prev A neighbour of elem
+/// @param elem The element to remove
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 on failure
+int xlist_rem_elem(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ struct xlist_elem *prev,
+                   /*@notnull@*/ struct xlist_elem *elem,
+                   /*@null@*/ void (*destroy)(void *data));
+
+/// Removes an element from the head of an xlist. If destroy is non-NULL it
+/// will be used to free the element's data.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param xlist The xlist to remove from the head of
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 on failure
+int xlist_rem_head(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void (*destroy)(void *data));
+
+/// Removes an element from the tail of an xlist. If destroy is non-NULL it
+/// will be used to free the element's data.
+///
+/// COMPLEXITY: O(1)
+///
+/// @warning Passing NULL as destroy may leave you with leaky memory
+///
+/// @param xlist The xlist to remove from the tail of
+/// @param destroy Callback function for freeing the element's data
+///
+/// @return 0 on success, -1 on failure
+int xlist_rem_tail(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void (*destroy)(void *data));
+
+/// Reverses an xlist. As every link reads the same in either direction, only
+/// the head and tail are swapped.
+///
+/// COMPLEXITY: O(1)
+///
+/// @param xlist The xlist to reverse
+void xlist_reverse(/*@notnull@*/ struct xlist *xlist);
+
+// -----------------------------------------------------------------------------
+//                               Looping Macros
+// -----------------------------------------------------------------------------
+
+/// A macro for generating for loops - loop over all the elements of an xlist.
+/// The body must not remove the current element.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param xlist The xlist to iterate over
+/// @param name The name used for the iterator
+#define xlist_for_each(xlist, name)                                     \
+    xlist_for_each_elem((xlist)->head, NULL, name)
+
+/// A macro for generating for loops - loop over all the elements of an xlist
+/// from tail to head. The body must not remove the current element.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param xlist The xlist to iterate over
+/// @param name The name used for the iterator
+#define xlist_for_each_rev(xlist, name)                                 \
+    xlist_for_each_elem_rev((xlist)->tail, NULL, name)
+
+/// A macro for looping over an xlist from a given element towards the tail.
+/// The body must not remove the current element.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param elem The element to start with
+/// @param prev The element before elem, NULL if elem is the head
+/// @param name The label to use for the iterator
+#define xlist_for_each_elem(elem, prev, name)                           \
+    for (struct xlist_elem                                              \
+             * name = (elem),                                           \
+             * __prev_elem = (prev),                                    \
+             * __temp_elem;                                             \
+         name;                                                          \
+         __temp_elem = name,                                            \
+             name = xlist_elem_next(name, __prev_elem),                 \
+             __prev_elem = __temp_elem)
+
+/// A macro for looping over an xlist from a given element towards the head.
+/// The body must not remove the current element.
+///
+/// COMPLEXITY: O(n)
+///
+/// @param elem The element to start with
+/// @param next The element after elem, NULL if elem is the tail
+/// @param name The label to use for the iterator
+#define xlist_for_each_elem_rev(elem, next, name)                       \
+    for (struct xlist_elem                                              \
+             * name = (elem),                                           \
+             * __next_elem = (next),                                    \
+             * __temp_elem;                                             \
+         name;                                                          \
+         __temp_elem = name,                                            \
+             name = xlist_elem_prev(name, __next_elem),                 \
+             __next_elem = __temp_elem)
+
+// -----------------------------------------------------------------------------
+//                                    End
+// -----------------------------------------------------------------------------
+
+#endif // XLIST_H
@@ -0,0 +1,315 @@
+#include "adlist.h"
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// The capacity of the array when it is first allocated
+#define ADLIST_MIN_CAPACITY 16
+
+// The most elements an array can hold, keeping ADLIST_NIL out of range
+#define ADLIST_MAX_CAPACITY (ADLIST_NIL - 1)
+
+// Makes room for at least count more elements than are on the list now
+static int adlist_grow(/*@notnull@*/ struct adlist *adlist, uint32_t count) {
+    uint64_t need, capacity;
+
+    // Every slot below used that is not on the list is on the free list and
+    // is handed out before any fresh one, so the array only has to hold the
+    // elements on the list plus count
+    need = (uint64_t)adlist->size + count;
+    if (need <= adlist->capacity)
+        return 0;
+    if (need > ADLIST_MAX_CAPACITY)
+        return -1;
+    capacity = adlist->capacity ? adlist->capacity : ADLIST_MIN_CAPACITY;
+    while (capacity < need)
+        capacity *= 2;
+    if (capacity > ADLIST_MAX_CAPACITY)
+        capacity = ADLIST_MAX_CAPACITY;
+    return adlist_reserve(adlist, (uint32_t)capacity);
+}
+
+// Takes an element off the free list, or the next never used one
+//
+// @return The index of the element, or ADLIST_NIL if the array is full
+static uint32_t adlist_elem_alloc(/*@notnull@*/ struct adlist *adlist) {
+    uint32_t index;
+
+    if (adlist->free != ADLIST_NIL) {
+        index = adlist->free;
+        adlist->free = adlist->elems[index].next;
+        return index;
+    }
+    if (adlist->used == adlist->capacity && adlist_grow(adlist, 1) != 0)
+        return ADLIST_NIL;
+    return adlist->used++;
+}
+
+static void adlist_elem_free(/*@notnull@*/ struct adlist *adlist,
+                             uint32_t index) {
+    adlist->elems[index].next = adlist->free;
+    adlist->free = index;
+}
+
+// Links a fresh element holding data between prev and next, either of which
+// may be ADLIST_NIL for the ends of the list
+static int adlist_link(/*@notnull@*/ struct adlist *adlist, uint32_t prev,
+                       uint32_t next, /*@null@*/ void *data) {
+    struct adlist_elem *elem;
+    uint32_t index;
+
+    index = adlist_elem_alloc(adlist);
+    if (index == ADLIST_NIL)
+        return -1;
+    elem = &adlist->elems[index];
+    elem->prev = prev;
+    elem->next = next;
+    elem->data = data;
+    if (prev != ADLIST_NIL)
+        adlist->elems[prev].next = index;
+    else
+        adlist->head = index;
+    if (next != ADLIST_NIL)
+        adlist->elems[next].prev = index;
+    else
+        adlist->tail = index;
+    adlist->size++;
+    return 0;
+}
+
+// Stable merge sort of the indices in order[0..n), using scratch for merging
+static void adlist_sort_indices(/*@notnull@*/ const struct adlist *adlist,
+                                /*@notnull@*/ uint32_t *order,
+                                /*@notnull@*/ uint32_t *scratch, size_t n,
+                                /*@notnull@*/
+                                int (*cmp)(const void *a, const void *b)) {
+    size_t half = n / 2, i = 0, j = half, k = 0;
+
+    if (n < 2)
+        return;
+    adlist_sort_indices(adlist, order, scratch, half, cmp);
+    adlist_sort_indices(adlist, order + half, scratch, n - half, cmp);
+    if (cmp(adlist->elems[order[half - 1]].data,
+            adlist->elems[order[half]].data) <= 0)
+        return;
+
+    while (i < half && j < n) {
+        if (cmp(adlist->elems[order[j]].data,
+                adlist->elems[order[i]].data) < 0)
+            scratch[k++] = order[j++];
+        else
+            scratch[k++] = order[i++];
+    }
+    while (i < half)
+        scratch[k++] = order[i++];
+    memcpy(order, scratch, k * sizeof(*order));
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void adlist_init(/*@out@*/ /*@notnull@*/ struct adlist *adlist) {
+    adlist->elems = NULL;
+    adlist->head = ADLIST_NIL;
+    adlist->tail = ADLIST_NIL;
+    adlist->free = ADLIST_NIL;
+    adlist->used = 0;
+    adlist->capacity = 0;
+    adlist->size = 0;
+}
+
+void adlist_destroy(/*@notnull@*/ struct adlist *adlist,
+                    /*@null@*/ void (*destroy)(void *data)) {
+    if (destroy != NULL)
+        adlist_for_each(adlist, elem)
+            destroy(elem->data);
+    free(adlist->elems);
+    adlist_init(adlist);
+}
+
+int adlist_reserve(/*@notnull@*/ struct adlist *adlist,
+                   uint32_t capacity) {
+    struct adlist_elem *elems;
+
+    if (capacity <= adlist->capacity)
+        return 0;
+    if (capacity > ADLIST_MAX_CAPACITY)
+        return -1;
+    elems = realloc(adlist->elems, capacity * sizeof(*elems));
+    if (elems == NULL)
+        return -1;
+    adlist->elems = elems;
+    adlist->capacity = capacity;
+    return 0;
+}
+
+int adlist_compact(/*@notnull@*/ struct adlist *adlist) {
+    struct adlist_elem *elems = NULL;
+    uint32_t n = (uint32_t)adlist->size, i = 0;
+
+    if (n > 0) {
+        elems = malloc(n * sizeof(*elems));
+        if (elems == NULL)
+            return -1;
+    }
+    adlist_for_each(adlist, elem) {
+        elems[i].prev = i > 0 ? i - 1 : ADLIST_NIL;
+        elems[i].next = i + 1 < n ? i + 1 : ADLIST_NIL;
+        elems[i].data = elem->data;
+        ++i;
+    }
+    free(adlist->elems);
+    adlist->elems = elems;
+    adlist->head = n > 0 ? 0 : ADLIST_NIL;
+    adlist->tail = n > 0 ? n - 1 : ADLIST_NIL;
+    adlist->free = ADLIST_NIL;
+    adlist->used = n;
+    adlist->capacity = n;
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+uint32_t adlist_get_head(/*@notnull@*/ const struct adlist *adlist) {
+    return adlist->head;
+}
+
+int adlist_get_size(/*@notnull@*/ const struct adlist *adlist) {
+    return adlist->size;
+}
+
+uint32_t adlist_get_tail(/*@notnull@*/ const struct adlist *adlist) {
+    return adlist->tail;
+}
+
+int adlist_is_empty(/*@notnull@*/ const struct adlist *adlist) {
+    return adlist->head == ADLIST_NIL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int adlist_ins_head(/*@notnull@*/ struct adlist *adlist,
+                    /*@null@*/ void *data) {
+    return adlist_link(adlist, ADLIST_NIL, adlist->head, data);
+}
+
+int adlist_ins_next(/*@notnull@*/ struct adlist *adlist,
+                    uint32_t elem,
+                    /*@null@*/ void *data) {
+    return adlist_link(adlist, elem, adlist->elems[elem].next, data);
+}
+
+int adlist_ins_prev(/*@notnull@*/ struct adlist *adlist,
+                    uint32_t elem,
+                    /*@null@*/ void *data) {
+    return adlist_link(adlist, adlist->elems[elem].prev, elem, data);
+}
+
+int adlist_ins_tail(/*@notnull@*/ struct adlist *adlist,
+                    /*@null@*/ void *data) {
+    return adlist_link(adlist, adlist->tail, ADLIST_NIL, data);
+}
+
+int adlist_ins_tail_n(/*@notnull@*/ struct adlist *adlist,
+                      /*@notnull@*/ void **data,
+                      int n) {
+    if (n <= 0)
+        return 0;
+    if (adlist_grow(adlist, (uint32_t)n) != 0)
+        return -1;
+    for (int i = 0; i < n; ++i)
+        adlist_link(adlist, adlist->tail, ADLIST_NIL, data[i]);
+    return 0;
+}
+
+int adlist_rem_elem(/*@notnull@*/ struct adlist *adlist,
+                    uint32_t elem,
+                    /*@null@*/ void (*destroy)(void *data)) {
+    struct adlist_elem *target = &adlist->elems[elem];
+
+    if (target->next != ADLIST_NIL)
+        adlist->elems[target->next].prev = target->prev;
+    else
+        adlist->tail = target->prev;
+    if (target->prev != ADLIST_NIL)
+        adlist->elems[target->prev].next = target->next;
+    else
+        adlist->head = target->next;
+    adlist->size--;
+
+    if (destroy != NULL)
+        destroy(target->data);
+    adlist_elem_free(adlist, elem);
+    return 0;
+}
+
+int adlist_rem_head(/*@notnull@*/ struct adlist *adlist,
+                    /*@null@*/ void (*destroy)(void *data)) {
+    if (adlist->head == ADLIST_NIL)
+        return -1;
+    return adlist_rem_elem(adlist, adlist->head, destroy);
+}
+
+int adlist_rem_head_n(/*@notnull@*/ struct adlist *adlist,
+                      /*@null@*/ void **out,
+                      int n,
+                      /*@null@*/ void (*destroy)(void *data)) {
+    int count;
+
+    for (count = 0; count < n && adlist->head != ADLIST_NIL; ++count) {
+        if (out != NULL)
+            out[count] = adlist->elems[adlist->head].data;
+        adlist_rem_elem(adlist, adlist->head, destroy);
+    }
+    return count;
+}
+
+int adlist_rem_tail(/*@notnull@*/ struct adlist *adlist,
+                    /*@null@*/ void (*destroy)(void *data)) {
+    if (adlist->tail == ADLIST_NIL)
+        return -1;
+    return adlist_rem_elem(adlist, adlist->tail, destroy);
+}
+
+int adlist_concat(/*@notnull@*/ struct adlist *adlist,
+                  /*@notnull@*/ struct adlist *other) {
+    if (adlist == other
+        || adlist_grow(adlist, (uint32_t)other->size) != 0)
+        return -1;
+    adlist_for_each(other, elem)
+        adlist_link(adlist, adlist->tail, ADLIST_NIL, elem->data);
+    adlist_destroy(other, NULL);
+    return 0;
+}
+
+int adlist_sort(/*@notnull@*/ struct adlist *adlist,
+                /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    size_t n = (size_t)adlist->size, i = 0;
+    uint32_t *order;
+
+    if (n < 2)
+        return 0;
+    order = malloc(2 * n * sizeof(*order));
+    if (order == NULL)
+        return -1;
+    adlist_for_each(adlist, elem)
+        order[i++] = adlist_index(adlist, elem);
+    adlist_sort_indices(adlist, order, order + n, n, cmp);
+
+    for (i = 0; i < n; ++i) {
+        adlist->elems[order[i]].prev = i > 0 ? order[i - 1] : ADLIST_NIL;
+        adlist->elems[order[i]].next = i + 1 < n ? order[i + 1] : ADLIST_NIL;
+    }
+    adlist->head = order[0];
+    adlist->tail = order[n - 1];
+    free(order);
+    return 0;
+}
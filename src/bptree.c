@@ -0,0 +1,721 @@
+#include "bptree.h"
+#include "dlist.h"
+#include "list.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BPTREE_MAX_HEIGHT 64
+
+#define BPTREE_BRANCH_MIN (BPTREE_BRANCH_KEYS / 2)
+#define BPTREE_LEAF_MIN (BPTREE_LEAF_ENTRIES / 2)
+
+_Static_assert(BPTREE_BRANCH_KEYS >= 3 && BPTREE_LEAF_ENTRIES >= 2,
+               "BPTREE_NODE_SIZE is too small");
+
+#define branch_of(n) ((struct bptree_branch *)(n))
+#define leaf_of(n) ((struct bptree_leaf *)(n))
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+static void* bptree_node_alloc(size_t size, int leaf) {
+    struct bptree_node *node;
+
+    // aligned_alloc wants the size to be a multiple of the alignment
+    size = (size + BPTREE_CACHE_LINE - 1) / BPTREE_CACHE_LINE
+        * BPTREE_CACHE_LINE;
+    node = aligned_alloc(BPTREE_CACHE_LINE, size);
+    if (node == NULL)
+        return NULL;
+    node->count = 0;
+    node->leaf = (unsigned int)leaf;
+    return node;
+}
+
+/*@null@*/
+static struct bptree_leaf* bptree_leaf_alloc(void) {
+    struct bptree_leaf *leaf;
+
+    leaf = bptree_node_alloc(sizeof(struct bptree_leaf), 1);
+    if (leaf != NULL) {
+        leaf->prev = NULL;
+        leaf->next = NULL;
+    }
+    return leaf;
+}
+
+/*@null@*/
+static struct bptree_branch* bptree_branch_alloc(void) {
+    return bptree_node_alloc(sizeof(struct bptree_branch), 0);
+}
+
+static void bptree_node_free(/*@notnull@*/ struct bptree_node *node,
+                             /*@null@*/ void (*destroy)(void *data)) {
+    if (node->leaf) {
+        if (destroy != NULL)
+            for (unsigned int i = 0; i < node->count; ++i)
+                destroy(leaf_of(node)->entries[i].data);
+    } else {
+        for (unsigned int i = 0; i <= node->count; ++i)
+            bptree_node_free(branch_of(node)->children[i], destroy);
+    }
+    free(node);
+}
+
+// The index of the child of a branch that may hold key: the number of
+// separators that order at or before key
+static int bptree_child_index(/*@notnull@*/ const struct bptree *bptree,
+                              /*@notnull@*/ const struct bptree_branch *branch,
+                              /*@null@*/ const void *key) {
+    int lo = 0, hi = (int)branch->node.count, mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (bptree->cmp(branch->keys[mid], key) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// The index of the first entry of a leaf whose key does not order before key
+static int bptree_entry_index(/*@notnull@*/ const struct bptree *bptree,
+                              /*@notnull@*/ const struct bptree_leaf *leaf,
+                              /*@null@*/ const void *key) {
+    int lo = 0, hi = (int)leaf->node.count, mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (bptree->cmp(leaf->entries[mid].key, key) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static struct bptree_cursor bptree_at(/*@null@*/ struct bptree_leaf *leaf,
+                                      unsigned int index) {
+    struct bptree_cursor cursor;
+
+    // A position past the end of one leaf is the start of the next
+    if (leaf != NULL && index == leaf->node.count) {
+        leaf = leaf->next;
+        index = 0;
+    }
+    cursor.leaf = leaf;
+    cursor.entry = leaf ? &leaf->entries[index] : NULL;
+    return cursor;
+}
+
+static void bptree_branch_ins_at(/*@notnull@*/ struct bptree_branch *branch,
+                                 unsigned int index,
+                                 /*@null@*/ void *key,
+                                 /*@notnull@*/ struct bptree_node *child) {
+    unsigned int count = branch->node.count;
+
+    memmove(&branch->keys[index + 1], &branch->keys[index],
+            (count - index) * sizeof(branch->keys[0]));
+    memmove(&branch->children[index + 2], &branch->children[index + 1],
+            (count - index) * sizeof(branch->children[0]));
+    branch->keys[index] = key;
+    branch->children[index + 1] = child;
+    branch->node.count++;
+}
+
+static void bptree_branch_rem_at(/*@notnull@*/ struct bptree_branch *branch,
+                                 unsigned int index) {
+    unsigned int count = branch->node.count;
+
+    memmove(&branch->keys[index], &branch->keys[index + 1],
+            (count - index - 1) * sizeof(branch->keys[0]));
+    memmove(&branch->children[index + 1], &branch->children[index + 2],
+            (count - index - 1) * sizeof(branch->children[0]));
+    branch->node.count--;
+}
+
+static void bptree_leaf_ins_at(/*@notnull@*/ struct bptree_leaf *leaf,
+                               unsigned int index,
+                               /*@null@*/ void *key,
+                               /*@null@*/ void *data) {
+    memmove(&leaf->entries[index + 1], &leaf->entries[index],
+            (leaf->node.count - index) * sizeof(leaf->entries[0]));
+    leaf->entries[index].key = key;
+    leaf->entries[index].data = data;
+    leaf->node.count++;
+}
+
+// Splits a full leaf while inserting into it. right is a fresh leaf that
+// takes the upper half and is linked in after leaf.
+static void bptree_leaf_split(/*@notnull@*/ struct bptree *bptree,
+                              /*@notnull@*/ struct bptree_leaf *leaf,
+                              /*@notnull@*/ struct bptree_leaf *right,
+                              unsigned int index,
+                              /*@null@*/ void *key,
+                              /*@null@*/ void *data) {
+    const unsigned int keep = (BPTREE_LEAF_ENTRIES + 1) / 2;
+    unsigned int from = index < keep ? keep - 1 : keep;
+
+    right->node.count = (unsigned int)BPTREE_LEAF_ENTRIES - from;
+    memcpy(right->entries, &leaf->entries[from],
+           right->node.count * sizeof(leaf->entries[0]));
+    leaf->node.count = from;
+    if (index < keep)
+        bptree_leaf_ins_at(leaf, index, key, data);
+    else
+        bptree_leaf_ins_at(right, index - keep, key, data);
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (leaf->next != NULL)
+        leaf->next->prev = right;
+    else
+        bptree->tail = right;
+    leaf->next = right;
+}
+
+// Splits a full branch while inserting key and child after position index.
+// right is a fresh branch that takes the upper half. Returns the separator
+// that moves up to the parent.
+/*@null@*/
+static void* bptree_branch_split(/*@notnull@*/ struct bptree_branch *branch,
+                                 /*@notnull@*/ struct bptree_branch *right,
+                                 unsigned int index,
+                                 /*@null@*/ void *key,
+                                 /*@notnull@*/ struct bptree_node *child) {
+    void *keys[BPTREE_BRANCH_KEYS + 1];
+    struct bptree_node *children[BPTREE_BRANCH_KEYS + 2];
+    const unsigned int keep = (BPTREE_BRANCH_KEYS + 1) / 2;
+    unsigned int i;
+
+    memcpy(keys, branch->keys, index * sizeof(keys[0]));
+    keys[index] = key;
+    memcpy(&keys[index + 1], &branch->keys[index],
+           (BPTREE_BRANCH_KEYS - index) * sizeof(keys[0]));
+    memcpy(children, branch->children, (index + 1) * sizeof(children[0]));
+    children[index + 1] = child;
+    memcpy(&children[index + 2], &branch->children[index + 1],
+           (BPTREE_BRANCH_KEYS - index) * sizeof(children[0]));
+
+    branch->node.count = keep;
+    memcpy(branch->keys, keys, keep * sizeof(keys[0]));
+    memcpy(branch->children, children, (keep + 1) * sizeof(children[0]));
+    right->node.count = (unsigned int)BPTREE_BRANCH_KEYS - keep;
+    for (i = 0; i < right->node.count; ++i) {
+        right->keys[i] = keys[keep + 1 + i];
+        right->children[i] = children[keep + 1 + i];
+    }
+    right->children[i] = children[keep + 1 + i];
+    return keys[keep];
+}
+
+// Rewrites the separator naming the first key of a leaf after that key was
+// removed, so that no separator outlives its entry: the caller may free the
+// key as soon as the removal returns. The separator sits at the deepest level
+// of path where the walk went right of one. A leaf left empty takes its next
+// sibling's first key, which is what the borrow or merge that follows will
+// leave at its front. The leftmost leaf has no separator.
+static void bptree_leaf_renamed(/*@notnull@*/ struct bptree_leaf *leaf,
+                                /*@notnull@*/ struct bptree_branch **path,
+                                /*@notnull@*/ const unsigned int *slot,
+                                int depth) {
+    void *first;
+
+    while (depth > 0 && slot[depth - 1] == 0)
+        --depth;
+    if (depth == 0)
+        return;
+    if (leaf->node.count > 0)
+        first = leaf->entries[0].key;
+    else if (leaf->next != NULL)
+        first = leaf->next->entries[0].key;
+    else
+        return;
+    path[depth - 1]->keys[slot[depth - 1] - 1] = first;
+}
+
+// Rebalances a leaf left with too few entries by borrowing from or merging
+// with a sibling. Returns 1 if the parent lost a separator and may now be
+// short itself.
+static int bptree_leaf_fix(/*@notnull@*/ struct bptree *bptree,
+                           /*@notnull@*/ struct bptree_branch *parent,
+                           unsigned int index) {
+    struct bptree_leaf *leaf = leaf_of(parent->children[index]);
+    struct bptree_leaf *left, *right;
+
+    if (index > 0) {
+        left = leaf_of(parent->children[index - 1]);
+        if (left->node.count > BPTREE_LEAF_MIN) {
+            left->node.count--;
+            bptree_leaf_ins_at(leaf, 0, left->entries[left->node.count].key,
+                               left->entries[left->node.count].data);
+            parent->keys[index - 1] = leaf->entries[0].key;
+            return 0;
+        }
+    }
+    if (index < parent->node.count) {
+        right = leaf_of(parent->children[index + 1]);
+        if (right->node.count > BPTREE_LEAF_MIN) {
+            leaf->entries[leaf->node.count++] = right->entries[0];
+            memmove(right->entries, &right->entries[1],
+                    --right->node.count * sizeof(right->entries[0]));
+            parent->keys[index] = right->entries[0].key;
+            return 0;
+        }
+    }
+
+    // Neither sibling can spare an entry, so merge with one of them
+    if (index > 0) {
+        left = leaf_of(parent->children[index - 1]);
+        right = leaf;
+        index--;
+    } else {
+        left = leaf;
+        right = leaf_of(parent->children[index + 1]);
+    }
+    memcpy(&left->entries[left->node.count], right->entries,
+           right->node.count * sizeof(right->entries[0]));
+    left->node.count += right->node.count;
+    left->next = right->next;
+    if (right->next != NULL)
+        right->next->prev = left;
+    else
+        bptree->tail = left;
+    free(right);
+    bptree_branch_rem_at(parent, index);
+    return parent->node.count < BPTREE_BRANCH_MIN;
+}
+
+// As bptree_leaf_fix, for a branch left with too few separators. Separators
+// rotate through the parent rather than moving directly between siblings.
+static int bptree_branch_fix(/*@notnull@*/ struct bptree_branch *parent,
+                             unsigned int index) {
+    struct bptree_branch *branch = branch_of(parent->children[index]);
+    struct bptree_branch *left, *right;
+    unsigned int count;
+
+    if (index > 0) {
+        left = branch_of(parent->children[index - 1]);
+        if (left->node.count > BPTREE_BRANCH_MIN) {
+            count = branch->node.count;
+            memmove(&branch->keys[1], branch->keys,
+                    count * sizeof(branch->keys[0]));
+            memmove(&branch->children[1], branch->children,
+                    (count + 1) * sizeof(branch->children[0]));
+            branch->keys[0] = parent->keys[index - 1];
+            branch->children[0] = left->children[left->node.count];
+            branch->node.count++;
+            parent->keys[index - 1] = left->keys[--left->node.count];
+            return 0;
+        }
+    }
+    if (index < parent->node.count) {
+        right = branch_of(parent->children[index + 1]);
+        if (right->node.count > BPTREE_BRANCH_MIN) {
+            count = branch->node.count;
+            branch->keys[count] = parent->keys[index];
+            branch->children[count + 1] = right->children[0];
+            branch->node.count++;
+            parent->keys[index] = right->keys[0];
+            count = --right->node.count;
+            memmove(right->keys, &right->keys[1],
+                    count * sizeof(right->keys[0]));
+            memmove(right->children, &right->children[1],
+                    (count + 1) * sizeof(right->children[0]));
+            return 0;
+        }
+    }
+
+    if (index > 0) {
+        left = branch_of(parent->children[index - 1]);
+        right = branch;
+        index--;
+    } else {
+        left = branch;
+        right = branch_of(parent->children[index + 1]);
+    }
+    count = left->node.count;
+    left->keys[count] = parent->keys[index];
+    memcpy(&left->keys[count + 1], right->keys,
+           right->node.count * sizeof(right->keys[0]));
+    memcpy(&left->children[count + 1], right->children,
+           (right->node.count + 1) * sizeof(right->children[0]));
+    left->node.count += right->node.count + 1;
+    free(right);
+    bptree_branch_rem_at(parent, index);
+    return parent->node.count < BPTREE_BRANCH_MIN;
+}
+
+// Builds the tree from a chain of list elements whose next pointer is at
+// offset 0, as listsort_chain does
+static int bptree_load(/*@notnull@*/ struct bptree *bptree,
+                       /*@null@*/ void *head,
+                       size_t data_offset,
+                       /*@null@*/ void* (*key)(void *data)) {
+    struct bptree_node **level, **above;
+    struct bptree_branch *branch;
+    struct bptree_leaf *leaf;
+    void **mins, *data, *k;
+    size_t n = 0, nodes, parents, per, extra, i, j, c;
+
+    if (bptree->root != NULL)
+        return -1;
+    for (void *elem = head; elem != NULL; elem = *(void **)elem)
+        ++n;
+    if (n == 0)
+        return 0;
+
+    // Spread the entries evenly so that no leaf ends up below half full
+    nodes = (n + BPTREE_LEAF_ENTRIES - 1) / BPTREE_LEAF_ENTRIES;
+    level = malloc(nodes * sizeof(*level));
+    mins = malloc(nodes * sizeof(*mins));
+    if (level == NULL || mins == NULL)
+        goto fail_arrays;
+
+    per = n / nodes;
+    extra = n % nodes;
+    for (i = 0; i < nodes; ++i) {
+        leaf = bptree_leaf_alloc();
+        if (leaf == NULL)
+            goto fail_leaves;
+        level[i] = &leaf->node;
+        leaf->prev = bptree->tail;
+        if (bptree->tail != NULL)
+            bptree->tail->next = leaf;
+        else
+            bptree->head = leaf;
+        for (j = 0; j < per + (i < extra); ++j) {
+            data = *(void **)((char *)head + data_offset);
+            k = key ? key(data) : data;
+            if (bptree->size > 0 && bptree->cmp(k, bptree->tail->entries[
+                    bptree->tail->node.count - 1].key) <= 0) {
+                free(leaf);
+                goto fail_leaves;
+            }
+            leaf->entries[j].key = k;
+            leaf->entries[j].data = data;
+            leaf->node.count++;
+            bptree->tail = leaf;
+            bptree->size++;
+            head = *(void **)head;
+        }
+        mins[i] = leaf->entries[0].key;
+    }
+    bptree->height = 1;
+
+    // Each pass groups the nodes of one level under fresh branches
+    while (nodes > 1) {
+        parents = (nodes + BPTREE_BRANCH_KEYS) / (BPTREE_BRANCH_KEYS + 1);
+        above = malloc(parents * sizeof(*above));
+        if (above == NULL)
+            goto fail_level;
+        per = nodes / parents;
+        extra = nodes % parents;
+        for (i = 0, c = 0; i < parents; ++i) {
+            branch = bptree_branch_alloc();
+            if (branch == NULL) {
+                while (i-- > 0)
+                    free(above[i]);
+                free(above);
+                goto fail_level;
+            }
+            above[i] = &branch->node;
+            branch->children[0] = level[c];
+            mins[i] = mins[c];
+            for (j = 1, ++c; j < per + (i < extra); ++j, ++c) {
+                branch->keys[j - 1] = mins[c];
+                branch->children[j] = level[c];
+            }
+            branch->node.count = (unsigned int)j - 1;
+        }
+        free(level);
+        level = above;
+        nodes = parents;
+        bptree->height++;
+    }
+
+    bptree->root = level[0];
+    free(level);
+    free(mins);
+    return 0;
+
+fail_leaves:
+    nodes = i;
+fail_level:
+    for (i = 0; i < nodes; ++i)
+        bptree_node_free(level[i], NULL);
+fail_arrays:
+    free(level);
+    free(mins);
+    bptree_init(bptree, bptree->cmp);
+    return -1;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void bptree_init(/*@out@*/ struct bptree *bptree,
+                 /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    bptree->root = NULL;
+    bptree->head = NULL;
+    bptree->tail = NULL;
+    bptree->size = 0;
+    bptree->height = 0;
+    bptree->cmp = cmp;
+}
+
+void bptree_destroy(/*@notnull@*/ struct bptree *bptree,
+                    /*@null@*/ void (*destroy)(void *data)) {
+    if (bptree->root != NULL)
+        bptree_node_free(bptree->root, destroy);
+    bptree_init(bptree, bptree->cmp);
+}
+
+int bptree_load_dlist(/*@notnull@*/ struct bptree *bptree,
+                      /*@notnull@*/ const struct dlist *dlist,
+                      /*@null@*/ void* (*key)(void *data)) {
+    return bptree_load(bptree, dlist->head,
+                       offsetof(struct dlist_elem, data), key);
+}
+
+int bptree_load_list(/*@notnull@*/ struct bptree *bptree,
+                     /*@notnull@*/ const struct list *list,
+                     /*@null@*/ void* (*key)(void *data)) {
+    return bptree_load(bptree, list->head,
+                       offsetof(struct list_elem, data), key);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+size_t bptree_get_size(/*@notnull@*/ const struct bptree *bptree) {
+    return bptree->size;
+}
+
+int bptree_is_empty(/*@notnull@*/ const struct bptree *bptree) {
+    return bptree->size == 0;
+}
+
+struct bptree_cursor bptree_find(/*@notnull@*/ const struct bptree *bptree,
+                                 /*@null@*/ const void *key) {
+    struct bptree_cursor cursor = bptree_lower_bound(bptree, key);
+
+    if (cursor.entry != NULL && bptree->cmp(cursor.entry->key, key) != 0)
+        cursor.entry = NULL;
+    return cursor;
+}
+
+/*@null@*/
+void* bptree_get(/*@notnull@*/ const struct bptree *bptree,
+                 /*@null@*/ const void *key) {
+    struct bptree_cursor cursor = bptree_find(bptree, key);
+
+    return cursor.entry ? cursor.entry->data : NULL;
+}
+
+struct bptree_cursor bptree_lower_bound(/*@notnull@*/ const struct bptree *bptree,
+                                        /*@null@*/ const void *key) {
+    struct bptree_node *node = bptree->root;
+    struct bptree_leaf *leaf;
+
+    if (node == NULL)
+        return bptree_at(NULL, 0);
+    while (!node->leaf)
+        node = branch_of(node)->children[
+            bptree_child_index(bptree, branch_of(node), key)];
+    leaf = leaf_of(node);
+    return bptree_at(leaf, (unsigned int)bptree_entry_index(bptree, leaf, key));
+}
+
+struct bptree_cursor bptree_upper_bound(/*@notnull@*/ const struct bptree *bptree,
+                                        /*@null@*/ const void *key) {
+    struct bptree_cursor cursor = bptree_lower_bound(bptree, key);
+
+    if (cursor.entry != NULL && bptree->cmp(cursor.entry->key, key) == 0)
+        bptree_next(&cursor);
+    return cursor;
+}
+
+struct bptree_cursor bptree_first(/*@notnull@*/ const struct bptree *bptree) {
+    return bptree_at(bptree->head, 0);
+}
+
+struct bptree_cursor bptree_last(/*@notnull@*/ const struct bptree *bptree) {
+    struct bptree_cursor cursor;
+
+    cursor.leaf = bptree->tail;
+    cursor.entry = cursor.leaf
+        ? &cursor.leaf->entries[cursor.leaf->node.count - 1] : NULL;
+    return cursor;
+}
+
+void bptree_next(/*@notnull@*/ struct bptree_cursor *cursor) {
+    unsigned int index = (unsigned int)(cursor->entry - cursor->leaf->entries);
+
+    *cursor = bptree_at(cursor->leaf, index + 1);
+}
+
+void bptree_prev(/*@notnull@*/ struct bptree_cursor *cursor) {
+    if (cursor->entry != cursor->leaf->entries) {
+        cursor->entry--;
+        return;
+    }
+    cursor->leaf = cursor->leaf->prev;
+    cursor->entry = cursor->leaf
+        ? &cursor->leaf->entries[cursor->leaf->node.count - 1] : NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int bptree_ins(/*@notnull@*/ struct bptree *bptree,
+               /*@null@*/ void *key,
+               /*@null@*/ void *data) {
+    struct bptree_branch *path[BPTREE_MAX_HEIGHT];
+    unsigned int slot[BPTREE_MAX_HEIGHT];
+    struct bptree_node *spare[BPTREE_MAX_HEIGHT + 1];
+    struct bptree_node *node = bptree->root, *child;
+    struct bptree_leaf *leaf;
+    unsigned int index;
+    int depth = 0, splits, i;
+    void *up;
+
+    if (node == NULL) {
+        leaf = bptree_leaf_alloc();
+        if (leaf == NULL)
+            return -1;
+        bptree_leaf_ins_at(leaf, 0, key, data);
+        bptree->root = &leaf->node;
+        bptree->head = bptree->tail = leaf;
+        bptree->height = 1;
+        bptree->size = 1;
+        return 0;
+    }
+
+    while (!node->leaf) {
+        path[depth] = branch_of(node);
+        slot[depth] = bptree_child_index(bptree, path[depth], key);
+        node = path[depth]->children[slot[depth]];
+        ++depth;
+    }
+    leaf = leaf_of(node);
+    index = bptree_entry_index(bptree, leaf, key);
+    if (index < leaf->node.count
+        && bptree->cmp(leaf->entries[index].key, key) == 0)
+        return -1;
+
+    if (leaf->node.count < BPTREE_LEAF_ENTRIES) {
+        bptree_leaf_ins_at(leaf, index, key, data);
+        bptree->size++;
+        return 0;
+    }
+
+    // Every node that will split is allocated for up front, so that running
+    // out of memory leaves the tree as it was
+    splits = 1;
+    while (splits <= depth
+           && path[depth - splits]->node.count == BPTREE_BRANCH_KEYS)
+        ++splits;
+    for (i = 0; i <= splits; ++i) {
+        if (i == splits && splits <= depth)
+            break;
+        spare[i] = i == 0 ? (void *)bptree_leaf_alloc()
+                          : (void *)bptree_branch_alloc();
+        if (spare[i] == NULL) {
+            while (i-- > 0)
+                free(spare[i]);
+            return -1;
+        }
+    }
+
+    bptree_leaf_split(bptree, leaf, leaf_of(spare[0]), index, key, data);
+    up = leaf_of(spare[0])->entries[0].key;
+    child = spare[0];
+    for (i = 1; i < splits; ++i) {
+        --depth;
+        up = bptree_branch_split(path[depth], branch_of(spare[i]),
+                                 slot[depth], up, child);
+        child = spare[i];
+    }
+    if (depth > 0) {
+        --depth;
+        bptree_branch_ins_at(path[depth], slot[depth], up, child);
+    } else {
+        // The root split, so the tree grows a level
+        branch_of(spare[splits])->keys[0] = up;
+        branch_of(spare[splits])->children[0] = bptree->root;
+        branch_of(spare[splits])->children[1] = child;
+        spare[splits]->count = 1;
+        bptree->root = spare[splits];
+        bptree->height++;
+    }
+    bptree->size++;
+    return 0;
+}
+
+int bptree_rem(/*@notnull@*/ struct bptree *bptree,
+               /*@null@*/ const void *key,
+               /*@null@*/ void (*destroy)(void *data)) {
+    struct bptree_branch *path[BPTREE_MAX_HEIGHT];
+    unsigned int slot[BPTREE_MAX_HEIGHT];
+    struct bptree_node *node = bptree->root;
+    struct bptree_leaf *leaf;
+    unsigned int index;
+    int depth = 0, short_node;
+    void *data;
+
+    if (node == NULL)
+        return -1;
+    while (!node->leaf) {
+        path[depth] = branch_of(node);
+        slot[depth] = bptree_child_index(bptree, path[depth], key);
+        node = path[depth]->children[slot[depth]];
+        ++depth;
+    }
+    leaf = leaf_of(node);
+    index = bptree_entry_index(bptree, leaf, key);
+    if (index == leaf->node.count
+        || bptree->cmp(leaf->entries[index].key, key) != 0)
+        return -1;
+
+    data = leaf->entries[index].data;
+    memmove(&leaf->entries[index], &leaf->entries[index + 1],
+            (--leaf->node.count - index) * sizeof(leaf->entries[0]));
+    bptree->size--;
+    if (index == 0)
+        bptree_leaf_renamed(leaf, path, slot, depth);
+    if (destroy != NULL)
+        destroy(data);
+
+    if (depth == 0) {
+        if (leaf->node.count == 0) {
+            free(leaf);
+            bptree_init(bptree, bptree->cmp);
+        }
+        return 0;
+    }
+    if (leaf->node.count >= BPTREE_LEAF_MIN)
+        return 0;
+
+    --depth;
+    short_node = bptree_leaf_fix(bptree, path[depth], slot[depth]);
+    while (short_node && depth > 0) {
+        --depth;
+        short_node = bptree_branch_fix(path[depth], slot[depth]);
+    }
+
+    // A root branch left with a single child is replaced by that child
+    node = bptree->root;
+    if (!node->leaf && node->count == 0) {
+        bptree->root = branch_of(node)->children[0];
+        bptree->height--;
+        free(node);
+    }
+    return 0;
+}
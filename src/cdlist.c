@@ -1,6 +1,116 @@
 #include "cdlist.h"
+#include "ebr.h"
+#include "listio.h"
+#include "listpar.h"
+#include "listsort.h"
+#include "pool.h"
+#include "stats.h"
 #include <stdlib.h>
 
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+#define cdlist_size_add(cdlist, n) ((cdlist)->size += (n))
+#define cdlist_size_reset(cdlist) ((cdlist)->size = 0)
+#else
+#define cdlist_size_add(cdlist, n) ((void)0)
+#define cdlist_size_reset(cdlist) ((void)0)
+#endif
+
+/*@null@*/
+static struct cdlist_elem* cdlist_elem_alloc(/*@notnull@*/ struct cdlist *cdlist) {
+    struct cdlist_elem *elem;
+
+    if (cdlist->pool != NULL)
+        elem = pool_alloc(cdlist->pool);
+    else
+        elem = malloc(sizeof(struct cdlist_elem));
+    if (elem != NULL)
+        stats_alloc(STATS_CDLIST, 1);
+    return elem;
+}
+
+static void cdlist_elem_free(/*@notnull@*/ struct cdlist *cdlist,
+                             /*@notnull@*/ struct cdlist_elem *elem) {
+    stats_free(STATS_CDLIST, 1);
+    if (cdlist->pool != NULL)
+        pool_free(cdlist->pool, elem);
+    else
+        free(elem);
+}
+
+// Frees elem and destroys its data, or hands both to the cdlist's ebr to be
+// released once no reader can still be standing on elem
+static void cdlist_elem_release(/*@notnull@*/ struct cdlist *cdlist,
+                                /*@notnull@*/ struct cdlist_elem *elem,
+                                /*@null@*/ void (*destroy)(void *data)) {
+    if (cdlist->ebr != NULL) {
+        stats_free(STATS_CDLIST, 1);
+        ebr_retire(cdlist->ebr, elem, cdlist->pool, elem->data, destroy);
+        return;
+    }
+    if (destroy != NULL)
+        destroy(elem->data);
+    cdlist_elem_free(cdlist, elem);
+}
+
+// Allocates n elements as a chain linked through next, from one block of the
+// cdlist's pool if it has one. The next pointer of the last is left unset.
+/*@null@*/
+static struct cdlist_elem* cdlist_elem_alloc_chain(/*@notnull@*/ struct cdlist *cdlist,
+                                                   int n) {
+    struct cdlist_elem *first = NULL, **link = &first, *elem;
+
+    if (cdlist->pool != NULL) {
+        first = pool_alloc_chain(cdlist->pool, (size_t)n);
+        if (first != NULL)
+            stats_alloc(STATS_CDLIST, n);
+        return first;
+    }
+    for (int i = 0; i < n; ++i) {
+        *link = malloc(sizeof(struct cdlist_elem));
+        if (*link == NULL) {
+            for (; i > 0; --i, first = elem) {
+                elem = first->next;
+                free(first);
+            }
+            return NULL;
+        }
+        link = &(*link)->next;
+    }
+    stats_alloc(STATS_CDLIST, n);
+    return first;
+}
+
+// Releases the first count elements of a chain already unlinked from the
+// cdlist, storing their data in out if it is non-NULL
+static void cdlist_elem_release_chain(/*@notnull@*/ struct cdlist *cdlist,
+                                      /*@notnull@*/ struct cdlist_elem *first,
+                                      int count,
+                                      /*@null@*/ void **out,
+                                      /*@null@*/ void (*destroy)(void *data)) {
+    struct cdlist_elem *elem = first, *next, *last = first;
+
+    for (int i = 0; i < count; ++i, elem = next) {
+        next = elem->next;
+        if (out != NULL)
+            out[i] = elem->data;
+        if (cdlist->pool == NULL || cdlist->ebr != NULL) {
+            cdlist_elem_release(cdlist, elem, destroy);
+            continue;
+        }
+        if (destroy != NULL)
+            destroy(elem->data);
+        last = elem;
+    }
+    if (cdlist->pool != NULL && cdlist->ebr == NULL) {
+        stats_free(STATS_CDLIST, count);
+        pool_free_chain(cdlist->pool, first, last);
+    }
+}
+
 // -----------------------------------------------------------------------------
 //                                 Management
 // -----------------------------------------------------------------------------
@@ -8,15 +118,56 @@
 void cdlist_init(/*@out@*/ struct cdlist *cdlist) {
     cdlist->link.next = &cdlist->link;
     cdlist->link.prev = &cdlist->link;
+    cdlist->pool = NULL;
+    cdlist->ebr = NULL;
+    cdlist_size_reset(cdlist);
+}
+
+void cdlist_init_with_pool(/*@out@*/ struct cdlist *cdlist,
+                           /*@notnull@*/ struct pool *pool) {
+    cdlist_init(cdlist);
+    cdlist->pool = pool;
 }
 
 void cdlist_destroy(/*@notnull@*/ struct cdlist *cdlist,
                    /*@null@*/ void (*destroy)(void *data)) {
-    cdlist_for_each_safe(cdlist, elem) {
-        if (destroy != NULL)
-            destroy(elem->data);
-        free(elem);
+    int count = 0;
+
+    // Without a cached size the elements are counted on the walk destroy
+    // makes anyway, rather than on a walk of their own
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    stats_free(STATS_CDLIST, cdlist->size);
+#endif
+    if (cdlist->pool != NULL) {
+        if (cdlist_is_empty(cdlist))
+            return;
+        if (destroy != NULL || STATS_COUNT_BY_WALK)
+            cdlist_for_each_prefetch(cdlist, elem) {
+                if (destroy != NULL)
+                    destroy(elem->data);
+                stats_step(count);
+            }
+        pool_free_chain(cdlist->pool, cdlist->link.next, cdlist->link.prev);
+    }
+    else {
+        cdlist_for_each_safe_prefetch(cdlist, elem) {
+            if (destroy != NULL)
+                destroy(elem->data);
+            free(elem);
+            stats_step(count);
+        }
     }
+    cdlist->link.next = &cdlist->link;
+    cdlist->link.prev = &cdlist->link;
+    cdlist_size_reset(cdlist);
+#ifdef STRUCTURES_NO_SIZE_CACHE
+    stats_free(STATS_CDLIST, count);
+#endif
+}
+
+void cdlist_set_ebr(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@notnull@*/ struct ebr *ebr) {
+    cdlist->ebr = ebr;
 }
 
 // -----------------------------------------------------------------------------
@@ -29,17 +180,22 @@ struct cdlist_elem* cdlist_get_head(/*@notnull@*/ const struct cdlist *cdlist) {
 }
 
 int cdlist_get_size(/*@notnull@*/ const struct cdlist *cdlist) {
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    return cdlist->size;
+#else
     int count = 0;
 
     cdlist_for_each(cdlist, elem)
         count++;
 
+    stats_walk(STATS_CDLIST, count);
     return count;
+#endif
 }
 
 /*@null@*/
 struct cdlist_elem* cdlist_get_tail(/*@notnull@*/ const struct cdlist *cdlist) {
-    return cdlist_is_empty(cdlist) ? NULL : cdlist->link.next;
+    return cdlist_is_empty(cdlist) ? NULL : cdlist->link.prev;
 }
 
 int cdlist_is_empty(/*@notnull@*/ const struct cdlist *cdlist) {
@@ -52,55 +208,84 @@ int cdlist_is_empty(/*@notnull@*/ const struct cdlist *cdlist) {
 
 int cdlist_ins_head(/*@notnull@*/ struct cdlist *cdlist,
                    /*@null@*/ void *data) {
-    return cdlist_ins_next(&cdlist->link, data);
+    return cdlist_ins_next(cdlist, &cdlist->link, data);
 }
 
-int cdlist_ins_next(/*@notnull@*/ struct cdlist_elem *elem,
-                   /*@null@*/ void *data) {
+int cdlist_ins_next(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@notnull@*/ struct cdlist_elem *elem,
+                    /*@null@*/ void *data) {
     struct cdlist_elem *elem_new;
 
-    elem_new = malloc(sizeof(struct cdlist_elem));
+    elem_new = cdlist_elem_alloc(cdlist);
     if (elem_new == NULL)
         return -1;
 
     elem_new->next = elem->next;
     elem_new->prev = elem;
-    elem_new->next->prev = elem_new;
-    elem_new->prev->next = elem_new;
-
     elem_new->data = data;
+    elem_new->next->prev = elem_new;
+    ebr_store(elem_new->prev->next, elem_new);
+    cdlist_size_add(cdlist, 1);
     return 0;
 }
 
-int cdlist_ins_prev(/*@notnull@*/ struct cdlist_elem *elem,
-                   /*@null@*/ void *data) {
+int cdlist_ins_prev(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@notnull@*/ struct cdlist_elem *elem,
+                    /*@null@*/ void *data) {
     struct cdlist_elem *elem_new;
 
-    elem_new = malloc(sizeof(struct cdlist_elem));
+    elem_new = cdlist_elem_alloc(cdlist);
     if (elem_new == NULL)
         return -1;
 
     elem_new->next = elem;
     elem_new->prev = elem->prev;
-    elem_new->next->prev = elem_new;
-    elem_new->prev->next = elem_new;
-
     elem_new->data = data;
+    elem_new->next->prev = elem_new;
+    ebr_store(elem_new->prev->next, elem_new);
+    cdlist_size_add(cdlist, 1);
     return 0;
 }
 
 int cdlist_ins_tail(/*@notnull@*/ struct cdlist *cdlist,
                    /*@null@*/ void *data) {
-    return cdlist_ins_prev(&cdlist->link, data);
+    return cdlist_ins_prev(cdlist, &cdlist->link, data);
 }
 
-int cdlist_rem_elem(/*@notnull@*/ struct cdlist_elem *elem,
-                   /*@null@*/ void (*destroy)(void *data)) {
+int cdlist_ins_tail_n(/*@notnull@*/ struct cdlist *cdlist,
+                      /*@notnull@*/ void **data,
+                      int n) {
+    struct cdlist_elem *first, *elem, *tail;
+
+    if (n <= 0)
+        return 0;
+    first = cdlist_elem_alloc_chain(cdlist, n);
+    if (first == NULL)
+        return -1;
+
+    tail = cdlist->link.prev;
+    elem = first;
+    elem->prev = tail;
+    elem->data = data[0];
+    for (int i = 1; i < n; ++i) {
+        elem->next->prev = elem;
+        elem = elem->next;
+        elem->data = data[i];
+    }
+    elem->next = &cdlist->link;
+    ebr_store(tail->next, first);
+    cdlist->link.prev = elem;
+    cdlist_size_add(cdlist, n);
+    return 0;
+}
+
+int cdlist_rem_elem(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@notnull@*/ struct cdlist_elem *elem,
+                    /*@null@*/ void (*destroy)(void *data)) {
     elem->next->prev = elem->prev;
-    elem->prev->next = elem->next;
-    if (destroy)
-        destroy(elem->data);
-    free(elem);
+    ebr_store(elem->prev->next, elem->next);
+    cdlist_size_add(cdlist, -1);
+    cdlist_elem_release(cdlist, elem, destroy);
 
     return 0;
 }
@@ -113,7 +298,27 @@ int cdlist_rem_head(/*@notnull@*/ struct cdlist *cdlist,
     if (head == NULL)
         return -1;
 
-    return cdlist_rem_elem(head, destroy);
+    return cdlist_rem_elem(cdlist, head, destroy);
+}
+
+int cdlist_rem_head_n(/*@notnull@*/ struct cdlist *cdlist,
+                      /*@null@*/ void **out,
+                      int n,
+                      /*@null@*/ void (*destroy)(void *data)) {
+    struct cdlist_elem *first, *elem;
+    int count;
+
+    first = cdlist->link.next;
+    for (count = 0, elem = first; count < n && elem != &cdlist->link; ++count)
+        elem = elem->next;
+    if (count == 0)
+        return 0;
+
+    ebr_store(cdlist->link.next, elem);
+    elem->prev = &cdlist->link;
+    cdlist_size_add(cdlist, -count);
+    cdlist_elem_release_chain(cdlist, first, count, out, destroy);
+    return count;
 }
 
 int cdlist_rem_tail(/*@notnull@*/ struct cdlist *cdlist,
@@ -124,5 +329,146 @@ int cdlist_rem_tail(/*@notnull@*/ struct cdlist *cdlist,
     if (tail == NULL)
         return -1;
 
-    return cdlist_rem_elem(tail, destroy);
+    return cdlist_rem_elem(cdlist, tail, destroy);
+}
+
+int cdlist_concat(/*@notnull@*/ struct cdlist *cdlist,
+                  /*@notnull@*/ struct cdlist *other) {
+    return cdlist_splice(cdlist, cdlist->link.prev, other);
+}
+
+int cdlist_splice(/*@notnull@*/ struct cdlist *cdlist,
+                  /*@null@*/ struct cdlist_elem *elem,
+                  /*@notnull@*/ struct cdlist *other) {
+    struct cdlist_elem *first, *last;
+
+    if (cdlist == other || cdlist->pool != other->pool)
+        return -1;
+    if (cdlist_is_empty(other))
+        return 0;
+    if (elem == NULL)
+        elem = &cdlist->link;
+
+    first = other->link.next;
+    last = other->link.prev;
+    first->prev = elem;
+    last->next = elem->next;
+    elem->next->prev = last;
+    elem->next = first;
+    cdlist_size_add(cdlist, other->size);
+
+    other->link.next = &other->link;
+    other->link.prev = &other->link;
+    cdlist_size_reset(other);
+    return 0;
+}
+
+int cdlist_split_at(/*@notnull@*/ struct cdlist *cdlist,
+                    /*@null@*/ struct cdlist_elem *elem,
+                    /*@notnull@*/ struct cdlist *other) {
+    struct cdlist_elem *first, *last;
+
+    if (cdlist->pool != other->pool || !cdlist_is_empty(other))
+        return -1;
+    if (elem == NULL)
+        elem = &cdlist->link;
+    if (elem->next == &cdlist->link)
+        return 0;
+
+    first = elem->next;
+    last = cdlist->link.prev;
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    for (struct cdlist_elem *e = first; e != &cdlist->link; e = e->next)
+        other->size++;
+    cdlist->size -= other->size;
+#endif
+
+    elem->next = &cdlist->link;
+    cdlist->link.prev = elem;
+    first->prev = &other->link;
+    last->next = &other->link;
+    other->link.next = first;
+    other->link.prev = last;
+    return 0;
+}
+
+// Opens the ring into a NULL terminated chain for sorting
+/*@null@*/
+static struct cdlist_elem* cdlist_sort_start(/*@notnull@*/ struct cdlist *cdlist) {
+    if (cdlist_is_empty(cdlist))
+        return NULL;
+    cdlist->link.prev->next = NULL;
+    return cdlist->link.next;
+}
+
+// Closes a sorted chain back into the ring, repairing the prev links
+static void cdlist_sort_finish(/*@notnull@*/ struct cdlist *cdlist,
+                               /*@null@*/ struct cdlist_elem *head) {
+    struct cdlist_elem *prev = &cdlist->link;
+
+    if (head == NULL)
+        return;
+    for (struct cdlist_elem *elem = head; elem; elem = elem->next) {
+        elem->prev = prev;
+        prev->next = elem;
+        prev = elem;
+    }
+    prev->next = &cdlist->link;
+    cdlist->link.prev = prev;
+}
+
+void cdlist_sort(/*@notnull@*/ struct cdlist *cdlist,
+                 /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    cdlist_sort_finish(cdlist,
+                       listsort_chain(cdlist_sort_start(cdlist),
+                                      offsetof(struct cdlist_elem, data),
+                                      cmp));
+}
+
+void cdlist_sort_parallel(/*@notnull@*/ struct cdlist *cdlist,
+                          /*@notnull@*/
+                          int (*cmp)(const void *a, const void *b),
+                          int threads) {
+    cdlist_sort_finish(cdlist,
+                       listsort_chain_parallel(cdlist_sort_start(cdlist),
+                                               offsetof(struct cdlist_elem,
+                                                        data),
+                                               cmp, threads));
+}
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+void cdlist_for_each_parallel(/*@notnull@*/ struct cdlist *cdlist,
+                              /*@notnull@*/ void (*fn)(void *data, void *arg),
+                              /*@null@*/ void *arg,
+                              /*@null@*/ struct workpool *workpool) {
+    listpar_for_each(cdlist->link.next, (size_t)cdlist_get_size(cdlist),
+                     offsetof(struct cdlist_elem, data), fn, arg, workpool);
+}
+
+void cdlist_reduce_parallel(/*@notnull@*/ struct cdlist *cdlist,
+                            /*@notnull@*/
+                            void (*fold)(void *acc, void *data, void *arg),
+                            /*@notnull@*/
+                            void (*combine)(void *acc, const void *part,
+                                            void *arg),
+                            /*@notnull@*/ void *acc, size_t acc_size,
+                            /*@null@*/ void *arg,
+                            /*@null@*/ struct workpool *workpool) {
+    listpar_reduce(cdlist->link.next, (size_t)cdlist_get_size(cdlist),
+                   offsetof(struct cdlist_elem, data), fold, combine, acc,
+                   acc_size, arg, workpool);
+}
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+int cdlist_write(/*@notnull@*/ const struct cdlist *cdlist,
+                 /*@notnull@*/ const char *path,
+                 /*@notnull@*/ const struct listio_codec *codec) {
+    return listio_write(path, LISTIO_CDLIST, cdlist->link.next, &cdlist->link,
+                        offsetof(struct cdlist_elem, data), codec);
 }
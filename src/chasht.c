@@ -0,0 +1,242 @@
+#include "chasht.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Buckets in the first bucket array
+#define CHASHT_MIN_BUCKETS 16
+
+// Entries allocated from the system at a time
+#define CHASHT_POOL_CHUNK 256
+
+// Spreads the user's hash so that its low bits, which pick the bucket, depend
+// on every bit of it
+static size_t chasht_mix(/*@notnull@*/ const struct chasht *chasht,
+                         /*@null@*/ const void *key) {
+    uint64_t hash = (uint64_t)chasht->hash(key);
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdu;
+    hash ^= hash >> 33;
+    return (size_t)hash;
+}
+
+// Returns the bucket a hash currently lives in, old or new
+static struct idlist* chasht_bucket(/*@notnull@*/ const struct chasht *chasht,
+                                    size_t hash) {
+    size_t index;
+
+    if (chasht->old != NULL) {
+        index = hash & (chasht->old_nbuckets - 1);
+        if (index >= chasht->migrated)
+            return &chasht->old[index];
+    }
+    return &chasht->buckets[hash & (chasht->nbuckets - 1)];
+}
+
+// Moves up to count old buckets into the new bucket array by relinking their
+// entries. Frees the old array once it is empty.
+static void chasht_migrate(/*@notnull@*/ struct chasht *chasht, size_t count) {
+    struct chasht_entry *entry;
+    struct idlist_elem *elem;
+    struct idlist *bucket;
+
+    if (chasht->old == NULL)
+        return;
+    for (; count && chasht->migrated < chasht->old_nbuckets; --count) {
+        bucket = &chasht->old[chasht->migrated++];
+        while ((elem = idlist_rem_head(bucket)) != NULL) {
+            entry = idlist_entry(elem, struct chasht_entry, link);
+            idlist_ins_head(&chasht->buckets[entry->hash
+                                             & (chasht->nbuckets - 1)],
+                            elem);
+        }
+    }
+    if (chasht->migrated == chasht->old_nbuckets) {
+        free(chasht->old);
+        chasht->old = NULL;
+    }
+}
+
+// Starts moving to a bucket array twice the size. calloc leaves every bucket
+// all zero, which is an initialised empty idlist, and lets the system hand
+// over zeroed pages lazily rather than clearing them all here.
+static int chasht_grow(/*@notnull@*/ struct chasht *chasht) {
+    size_t nbuckets = chasht->nbuckets ? chasht->nbuckets * 2
+                                       : CHASHT_MIN_BUCKETS;
+    struct idlist *buckets;
+
+    // Only reachable if removals kept the table from finishing the last move
+    chasht_migrate(chasht, SIZE_MAX);
+
+    buckets = calloc(nbuckets, sizeof(struct idlist));
+    if (buckets == NULL)
+        return -1;
+    if (chasht->buckets != NULL) {
+        chasht->old = chasht->buckets;
+        chasht->old_nbuckets = chasht->nbuckets;
+        chasht->migrated = 0;
+    }
+    chasht->buckets = buckets;
+    chasht->nbuckets = nbuckets;
+    return 0;
+}
+
+// Returns the first entry in buckets from index on, continuing from the old
+// array into the new one
+/*@null@*/
+static struct chasht_entry* chasht_scan(/*@notnull@*/ const struct chasht *chasht,
+                                        int in_old, size_t index) {
+    if (in_old) {
+        for (; index < chasht->old_nbuckets; ++index)
+            if (!idlist_is_empty(&chasht->old[index]))
+                return idlist_entry(idlist_get_head(&chasht->old[index]),
+                                    struct chasht_entry, link);
+        index = 0;
+    }
+    for (; index < chasht->nbuckets; ++index)
+        if (!idlist_is_empty(&chasht->buckets[index]))
+            return idlist_entry(idlist_get_head(&chasht->buckets[index]),
+                                struct chasht_entry, link);
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void chasht_init(/*@out@*/ struct chasht *chasht,
+                 /*@notnull@*/ size_t (*hash)(const void *key),
+                 /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    chasht->buckets = NULL;
+    chasht->nbuckets = 0;
+    chasht->old = NULL;
+    chasht->old_nbuckets = 0;
+    chasht->migrated = 0;
+    chasht->size = 0;
+    pool_init(&chasht->pool, sizeof(struct chasht_entry), CHASHT_POOL_CHUNK);
+    chasht->hash = hash;
+    chasht->cmp = cmp;
+}
+
+void chasht_destroy(/*@notnull@*/ struct chasht *chasht,
+                    /*@null@*/ void (*destroy)(void *data)) {
+    // Entries all live in the pool, so only their data needs visiting
+    if (destroy != NULL)
+        chasht_for_each(chasht, entry)
+            destroy(entry->data);
+    free(chasht->buckets);
+    free(chasht->old);
+    pool_destroy(&chasht->pool);
+    chasht_init(chasht, chasht->hash, chasht->cmp);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct chasht_entry* chasht_find(/*@notnull@*/ const struct chasht *chasht,
+                                 /*@null@*/ const void *key) {
+    struct chasht_entry *entry;
+    size_t hash;
+
+    if (chasht->size == 0)
+        return NULL;
+
+    hash = chasht_mix(chasht, key);
+    idlist_for_each(chasht_bucket(chasht, hash), elem) {
+        entry = idlist_entry(elem, struct chasht_entry, link);
+        if (entry->hash == hash && chasht->cmp(entry->key, key) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+/*@null@*/
+void* chasht_get(/*@notnull@*/ const struct chasht *chasht,
+                 /*@null@*/ const void *key) {
+    struct chasht_entry *entry;
+
+    entry = chasht_find(chasht, key);
+    return entry ? entry->data : NULL;
+}
+
+size_t chasht_get_size(/*@notnull@*/ const struct chasht *chasht) {
+    return chasht->size;
+}
+
+int chasht_is_empty(/*@notnull@*/ const struct chasht *chasht) {
+    return chasht->size == 0;
+}
+
+/*@null@*/
+struct chasht_entry* chasht_first(/*@notnull@*/ const struct chasht *chasht) {
+    if (chasht->old != NULL)
+        return chasht_scan(chasht, 1, chasht->migrated);
+    return chasht_scan(chasht, 0, 0);
+}
+
+/*@null@*/
+struct chasht_entry* chasht_next(/*@notnull@*/ const struct chasht *chasht,
+                                 /*@notnull@*/ const struct chasht_entry *entry) {
+    size_t index;
+
+    if (entry->link.next != NULL)
+        return idlist_entry(entry->link.next, struct chasht_entry, link);
+
+    if (chasht->old != NULL) {
+        index = entry->hash & (chasht->old_nbuckets - 1);
+        if (index >= chasht->migrated)
+            return chasht_scan(chasht, 1, index + 1);
+    }
+    return chasht_scan(chasht, 0, (entry->hash & (chasht->nbuckets - 1)) + 1);
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int chasht_ins(/*@notnull@*/ struct chasht *chasht,
+               /*@null@*/ void *key,
+               /*@null@*/ void *data) {
+    struct chasht_entry *entry;
+
+    if (chasht_find(chasht, key) != NULL)
+        return -1;
+    if (chasht->size >= chasht->nbuckets && chasht_grow(chasht) != 0)
+        return -1;
+    chasht_migrate(chasht, CHASHT_MIGRATE_STEP);
+
+    entry = pool_alloc(&chasht->pool);
+    if (entry == NULL)
+        return -1;
+    entry->hash = chasht_mix(chasht, key);
+    entry->key = key;
+    entry->data = data;
+    idlist_ins_head(chasht_bucket(chasht, entry->hash), &entry->link);
+    chasht->size++;
+    return 0;
+}
+
+int chasht_rem(/*@notnull@*/ struct chasht *chasht,
+               /*@null@*/ const void *key,
+               /*@null@*/ void (*destroy)(void *data)) {
+    struct chasht_entry *entry;
+
+    entry = chasht_find(chasht, key);
+    if (entry == NULL)
+        return -1;
+
+    idlist_rem_elem(chasht_bucket(chasht, entry->hash), &entry->link);
+    chasht->size--;
+    if (destroy != NULL)
+        destroy(entry->data);
+    pool_free(&chasht->pool, entry);
+
+    chasht_migrate(chasht, CHASHT_MIGRATE_STEP);
+    return 0;
+}
@@ -1,21 +1,173 @@
 #include "clist.h"
+#include "ebr.h"
+#include "listio.h"
+#include "listpar.h"
+#include "listsort.h"
+#include "pool.h"
+#include "stats.h"
 #include <stdlib.h>
 
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+#define clist_size_add(clist, n) ((clist)->size += (n))
+#define clist_size_reset(clist) ((clist)->size = 0)
+#else
+#define clist_size_add(clist, n) ((void)0)
+#define clist_size_reset(clist) ((void)0)
+#endif
+
+/*@null@*/
+static struct clist_elem* clist_elem_alloc(/*@notnull@*/ struct clist *clist) {
+    struct clist_elem *elem;
+
+    if (clist->pool != NULL)
+        elem = pool_alloc(clist->pool);
+    else
+        elem = malloc(sizeof(struct clist_elem));
+    if (elem != NULL)
+        stats_alloc(STATS_CLIST, 1);
+    return elem;
+}
+
+static void clist_elem_free(/*@notnull@*/ struct clist *clist,
+                            /*@notnull@*/ struct clist_elem *elem) {
+    stats_free(STATS_CLIST, 1);
+    if (clist->pool != NULL)
+        pool_free(clist->pool, elem);
+    else
+        free(elem);
+}
+
+// Frees elem and destroys its data, or hands both to the clist's ebr to be
+// released once no reader can still be standing on elem
+static void clist_elem_release(/*@notnull@*/ struct clist *clist,
+                               /*@notnull@*/ struct clist_elem *elem,
+                               /*@null@*/ void (*destroy)(void *data)) {
+    if (clist->ebr != NULL) {
+        stats_free(STATS_CLIST, 1);
+        ebr_retire(clist->ebr, elem, clist->pool, elem->data, destroy);
+        return;
+    }
+    if (destroy != NULL)
+        destroy(elem->data);
+    clist_elem_free(clist, elem);
+}
+
+// Allocates n elements as a chain linked through next, from one block of the
+// clist's pool if it has one. The next pointer of the last is left unset.
+/*@null@*/
+static struct clist_elem* clist_elem_alloc_chain(/*@notnull@*/ struct clist *clist,
+                                                 int n) {
+    struct clist_elem *first = NULL, **link = &first, *elem;
+
+    if (clist->pool != NULL) {
+        first = pool_alloc_chain(clist->pool, (size_t)n);
+        if (first != NULL)
+            stats_alloc(STATS_CLIST, n);
+        return first;
+    }
+    for (int i = 0; i < n; ++i) {
+        *link = malloc(sizeof(struct clist_elem));
+        if (*link == NULL) {
+            for (; i > 0; --i, first = elem) {
+                elem = first->next;
+                free(first);
+            }
+            return NULL;
+        }
+        link = &(*link)->next;
+    }
+    stats_alloc(STATS_CLIST, n);
+    return first;
+}
+
+// Releases the first count elements of a chain already unlinked from the
+// clist, storing their data in out if it is non-NULL
+static void clist_elem_release_chain(/*@notnull@*/ struct clist *clist,
+                                     /*@notnull@*/ struct clist_elem *first,
+                                     int count,
+                                     /*@null@*/ void **out,
+                                     /*@null@*/ void (*destroy)(void *data)) {
+    struct clist_elem *elem = first, *next, *last = first;
+
+    for (int i = 0; i < count; ++i, elem = next) {
+        next = elem->next;
+        if (out != NULL)
+            out[i] = elem->data;
+        if (clist->pool == NULL || clist->ebr != NULL) {
+            clist_elem_release(clist, elem, destroy);
+            continue;
+        }
+        if (destroy != NULL)
+            destroy(elem->data);
+        last = elem;
+    }
+    if (clist->pool != NULL && clist->ebr == NULL) {
+        stats_free(STATS_CLIST, count);
+        pool_free_chain(clist->pool, first, last);
+    }
+}
+
 // -----------------------------------------------------------------------------
 //                                 Management
 // -----------------------------------------------------------------------------
 
 void clist_init(/*@out@*/ struct clist *clist) {
     clist->link.next = &clist->link;
+    clist->pool = NULL;
+    clist->ebr = NULL;
+    clist_size_reset(clist);
+}
+
+void clist_init_with_pool(/*@out@*/ struct clist *clist,
+                          /*@notnull@*/ struct pool *pool) {
+    clist_init(clist);
+    clist->pool = pool;
 }
 
 void clist_destroy(/*@notnull@*/ struct clist *clist,
                    /*@null@*/ void (*destroy)(void *data)) {
-    clist_for_each_safe(clist, elem) {
-        if (destroy != NULL)
-            destroy(elem->data);
-        free(elem);
+    struct clist_elem *tail;
+    int count = 0;
+
+    // Without a cached size the elements are counted on the walk destroy
+    // makes anyway, rather than on a walk of their own
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    stats_free(STATS_CLIST, clist->size);
+#endif
+    if (clist->pool != NULL) {
+        if (clist_is_empty(clist))
+            return;
+        tail = clist->link.next;
+        clist_for_each_prefetch(clist, elem) {
+            if (destroy != NULL)
+                destroy(elem->data);
+            tail = elem;
+            stats_step(count);
+        }
+        pool_free_chain(clist->pool, clist->link.next, tail);
     }
+    else {
+        clist_for_each_safe_prefetch(clist, elem) {
+            if (destroy != NULL)
+                destroy(elem->data);
+            free(elem);
+            stats_step(count);
+        }
+    }
+    clist->link.next = &clist->link;
+    clist_size_reset(clist);
+#ifdef STRUCTURES_NO_SIZE_CACHE
+    stats_free(STATS_CLIST, count);
+#endif
+}
+
+void clist_set_ebr(/*@notnull@*/ struct clist *clist,
+                   /*@notnull@*/ struct ebr *ebr) {
+    clist->ebr = ebr;
 }
 
 // -----------------------------------------------------------------------------
@@ -28,22 +180,30 @@ struct clist_elem* clist_get_head(/*@notnull@*/ const struct clist *clist) {
 }
 
 int clist_get_size(/*@notnull@*/ const struct clist *clist) {
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    return clist->size;
+#else
     int count = 0;
 
     clist_for_each(clist, elem)
         count++;
 
+    stats_walk(STATS_CLIST, count);
     return count;
+#endif
 }
 
 /*@null@*/
 struct clist_elem* clist_get_tail(/*@notnull@*/ const struct clist *clist) {
     struct clist_elem *elem;
-    
+    int steps = 0;
+
     if (clist_is_empty(clist))
         return NULL;
 
-    for(elem = clist->link.next; elem->next != &clist->link; elem = elem->next);
+    for(elem = clist->link.next; elem->next != &clist->link; elem = elem->next)
+        stats_step(steps);
+    stats_walk(STATS_CLIST, steps);
 
     return elem;
 }
@@ -58,20 +218,22 @@ int clist_is_empty(/*@notnull@*/ const struct clist *clist) {
 
 int clist_ins_head(/*@notnull@*/ struct clist *clist,
                    /*@null@*/ void *data) {
-    return clist_ins_next(&clist->link, data);
+    return clist_ins_next(clist, &clist->link, data);
 }
 
-int clist_ins_next(/*@notnull@*/ struct clist_elem *elem,
+int clist_ins_next(/*@notnull@*/ struct clist *clist,
+                   /*@notnull@*/ struct clist_elem *elem,
                    /*@null@*/ void *data) {
     struct clist_elem *elem_new;
 
-    elem_new = malloc(sizeof(struct clist_elem));
+    elem_new = clist_elem_alloc(clist);
     if (elem_new == NULL)
         return -1;
 
     elem_new->next = elem->next;
-    elem->next = elem_new;
     elem_new->data = data;
+    ebr_store(elem->next, elem_new);
+    clist_size_add(clist, 1);
     return 0;
 }
 
@@ -81,9 +243,35 @@ int clist_ins_tail(/*@notnull@*/ struct clist *clist,
 
     elem = clist_get_tail(clist);
     if (elem == NULL)
+        elem = &clist->link;
+
+    return clist_ins_next(clist, elem, data);
+}
+
+int clist_ins_tail_n(/*@notnull@*/ struct clist *clist,
+                     /*@notnull@*/ void **data,
+                     int n) {
+    struct clist_elem *first, *elem, *tail;
+
+    if (n <= 0)
+        return 0;
+    first = clist_elem_alloc_chain(clist, n);
+    if (first == NULL)
         return -1;
 
-    return clist_ins_next(elem, data);
+    tail = clist_get_tail(clist);
+    if (tail == NULL)
+        tail = &clist->link;
+    elem = first;
+    elem->data = data[0];
+    for (int i = 1; i < n; ++i) {
+        elem = elem->next;
+        elem->data = data[i];
+    }
+    elem->next = &clist->link;
+    ebr_store(tail->next, first);
+    clist_size_add(clist, n);
+    return 0;
 }
 
 int clist_rem_head(/*@notnull@*/ struct clist *clist,
@@ -94,31 +282,132 @@ int clist_rem_head(/*@notnull@*/ struct clist *clist,
     return clist_rem_next(clist, &clist->link, destroy);
 }
 
+int clist_rem_head_n(/*@notnull@*/ struct clist *clist,
+                     /*@null@*/ void **out,
+                     int n,
+                     /*@null@*/ void (*destroy)(void *data)) {
+    struct clist_elem *first, *elem;
+    int count;
+
+    first = clist->link.next;
+    for (count = 0, elem = first; count < n && elem != &clist->link; ++count)
+        elem = elem->next;
+    if (count == 0)
+        return 0;
+
+    ebr_store(clist->link.next, elem);
+    clist_size_add(clist, -count);
+    clist_elem_release_chain(clist, first, count, out, destroy);
+    return count;
+}
+
 int clist_rem_next(/*@notnull@*/ struct clist *clist,
                    /*@notnull@*/ struct clist_elem *elem,
                    /*@null@*/ void (*destroy)(void *data)) {
-    if (clist_is_empty(clist))
+    struct clist_elem *target;
+
+    target = elem->next;
+    if (target == &clist->link)
         return -1;
 
-    elem->next->next = elem;
-    elem->next = elem->next->next;
+    ebr_store(elem->next, target->next);
+    clist_size_add(clist, -1);
+
+    clist_elem_release(clist, target, destroy);
 
-    if (destroy != NULL)
-        destroy(elem->next->data);
-    free(elem->next);
-    
     return 0;
 }
 
 int clist_rem_tail(/*@notnull@*/ struct clist *clist,
                    /*@null@*/ void (*destroy)(void *data)) {
     struct clist_elem *pretail;
+    int steps = 0;
 
     if (clist_is_empty(clist))
         return -1;
 
-    for(pretail = clist->link.next;
+    for(pretail = &clist->link;
         pretail->next->next != &clist->link;
-        pretail = pretail->next);
+        pretail = pretail->next)
+        stats_step(steps);
+    stats_walk(STATS_CLIST, steps);
     return clist_rem_next(clist, pretail, destroy);
 }
+
+// Opens the ring into a NULL terminated chain for sorting
+/*@null@*/
+static struct clist_elem* clist_sort_start(/*@notnull@*/ struct clist *clist) {
+    struct clist_elem *tail;
+
+    tail = clist_get_tail(clist);
+    if (tail == NULL)
+        return NULL;
+    tail->next = NULL;
+    return clist->link.next;
+}
+
+// Closes a sorted chain back into the ring
+static void clist_sort_finish(/*@notnull@*/ struct clist *clist,
+                              /*@null@*/ struct clist_elem *head) {
+    struct clist_elem *elem;
+
+    if (head == NULL)
+        return;
+    clist->link.next = head;
+    for (elem = head; elem->next; elem = elem->next);
+    elem->next = &clist->link;
+}
+
+void clist_sort(/*@notnull@*/ struct clist *clist,
+                /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    clist_sort_finish(clist, listsort_chain(clist_sort_start(clist),
+                                            offsetof(struct clist_elem, data),
+                                            cmp));
+}
+
+void clist_sort_parallel(/*@notnull@*/ struct clist *clist,
+                         /*@notnull@*/
+                         int (*cmp)(const void *a, const void *b),
+                         int threads) {
+    clist_sort_finish(clist,
+                      listsort_chain_parallel(clist_sort_start(clist),
+                                              offsetof(struct clist_elem, data),
+                                              cmp, threads));
+}
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+void clist_for_each_parallel(/*@notnull@*/ struct clist *clist,
+                             /*@notnull@*/ void (*fn)(void *data, void *arg),
+                             /*@null@*/ void *arg,
+                             /*@null@*/ struct workpool *workpool) {
+    listpar_for_each(clist->link.next, (size_t)clist_get_size(clist),
+                     offsetof(struct clist_elem, data), fn, arg, workpool);
+}
+
+void clist_reduce_parallel(/*@notnull@*/ struct clist *clist,
+                           /*@notnull@*/
+                           void (*fold)(void *acc, void *data, void *arg),
+                           /*@notnull@*/
+                           void (*combine)(void *acc, const void *part,
+                                           void *arg),
+                           /*@notnull@*/ void *acc, size_t acc_size,
+                           /*@null@*/ void *arg,
+                           /*@null@*/ struct workpool *workpool) {
+    listpar_reduce(clist->link.next, (size_t)clist_get_size(clist),
+                   offsetof(struct clist_elem, data), fold, combine, acc,
+                   acc_size, arg, workpool);
+}
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+int clist_write(/*@notnull@*/ const struct clist *clist,
+                /*@notnull@*/ const char *path,
+                /*@notnull@*/ const struct listio_codec *codec) {
+    return listio_write(path, LISTIO_CLIST, clist->link.next, &clist->link,
+                        offsetof(struct clist_elem, data), codec);
+}
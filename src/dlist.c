@@ -1,21 +1,186 @@
 #include "dlist.h"
+#include "ebr.h"
+#include "listio.h"
+#include "listpar.h"
+#include "listsort.h"
+#include "pool.h"
+#include "stats.h"
 #include <stdlib.h>
 
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+#define dlist_size_add(dlist, n) ((dlist)->size += (n))
+#define dlist_size_reset(dlist) ((dlist)->size = 0)
+#else
+#define dlist_size_add(dlist, n) ((void)0)
+#define dlist_size_reset(dlist) ((void)0)
+#endif
+
+/*@null@*/
+static struct dlist_elem* dlist_elem_alloc(/*@notnull@*/ struct dlist *dlist) {
+    struct dlist_elem *elem;
+
+    if (dlist->pool != NULL)
+        elem = pool_alloc(dlist->pool);
+    else
+        elem = malloc(sizeof(struct dlist_elem));
+    if (elem != NULL)
+        stats_alloc(STATS_DLIST, 1);
+    return elem;
+}
+
+static void dlist_elem_free(/*@notnull@*/ struct dlist *dlist,
+                            /*@notnull@*/ struct dlist_elem *elem) {
+    stats_free(STATS_DLIST, 1);
+    if (dlist->pool != NULL)
+        pool_free(dlist->pool, elem);
+    else
+        free(elem);
+}
+
+// Frees elem and destroys its data, or hands both to the dlist's ebr to be
+// released once no reader can still be standing on elem
+static void dlist_elem_release(/*@notnull@*/ struct dlist *dlist,
+                               /*@notnull@*/ struct dlist_elem *elem,
+                               /*@null@*/ void (*destroy)(void *data)) {
+    if (dlist->ebr != NULL) {
+        stats_free(STATS_DLIST, 1);
+        ebr_retire(dlist->ebr, elem, dlist->pool, elem->data, destroy);
+        return;
+    }
+    if (destroy != NULL)
+        destroy(elem->data);
+    dlist_elem_free(dlist, elem);
+}
+
+// Allocates n elements as a chain linked through next, from one block of the
+// dlist's pool if it has one. The next pointer of the last is left unset.
+/*@null@*/
+static struct dlist_elem* dlist_elem_alloc_chain(/*@notnull@*/ struct dlist *dlist,
+                                                 int n) {
+    struct dlist_elem *first = NULL, **link = &first, *elem;
+
+    if (dlist->pool != NULL) {
+        first = pool_alloc_chain(dlist->pool, (size_t)n);
+        if (first != NULL)
+            stats_alloc(STATS_DLIST, n);
+        return first;
+    }
+    for (int i = 0; i < n; ++i) {
+        *link = malloc(sizeof(struct dlist_elem));
+        if (*link == NULL) {
+            for (; i > 0; --i, first = elem) {
+                elem = first->next;
+                free(first);
+            }
+            return NULL;
+        }
+        link = &(*link)->next;
+    }
+    stats_alloc(STATS_DLIST, n);
+    return first;
+}
+
+// Releases the first count elements of a chain already unlinked from the
+// dlist, storing their data in out if it is non-NULL
+static void dlist_elem_release_chain(/*@notnull@*/ struct dlist *dlist,
+                                     /*@notnull@*/ struct dlist_elem *first,
+                                     int count,
+                                     /*@null@*/ void **out,
+                                     /*@null@*/ void (*destroy)(void *data)) {
+    struct dlist_elem *elem = first, *next, *last = first;
+
+    for (int i = 0; i < count; ++i, elem = next) {
+        next = elem->next;
+        if (out != NULL)
+            out[i] = elem->data;
+        if (dlist->pool == NULL || dlist->ebr != NULL) {
+            dlist_elem_release(dlist, elem, destroy);
+            continue;
+        }
+        if (destroy != NULL)
+            destroy(elem->data);
+        last = elem;
+    }
+    if (dlist->pool != NULL && dlist->ebr == NULL) {
+        stats_free(STATS_DLIST, count);
+        pool_free_chain(dlist->pool, first, last);
+    }
+}
+
 // -----------------------------------------------------------------------------
 //                                 Management
 // -----------------------------------------------------------------------------
 
 void dlist_init(/*@out@*/ struct dlist *dlist) {
     dlist->head = NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    dlist->tail = NULL;
+#endif
+    dlist->pool = NULL;
+    dlist->ebr = NULL;
+    dlist_size_reset(dlist);
+}
+
+void dlist_init_with_pool(/*@out@*/ struct dlist *dlist,
+                          /*@notnull@*/ struct pool *pool) {
+    dlist_init(dlist);
+    dlist->pool = pool;
 }
 
 void dlist_destroy(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void (*destroy)(void *data)) {
-    dlist_for_each_safe(dlist, elem) {
-        if (destroy != NULL)
-            destroy(elem->data);
-        free(elem);
+    struct dlist_elem *tail;
+    int count = 0;
+
+    // Without a cached size the elements are counted on the walk destroy
+    // makes anyway, rather than on a walk of their own
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    stats_free(STATS_DLIST, dlist->size);
+#endif
+    if (dlist->pool != NULL) {
+        if (dlist->head == NULL)
+            return;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+        tail = dlist->tail;
+        if (destroy != NULL || STATS_COUNT_BY_WALK)
+            dlist_for_each_prefetch(dlist, elem) {
+                if (destroy != NULL)
+                    destroy(elem->data);
+                stats_step(count);
+            }
+#else
+        tail = dlist->head;
+        dlist_for_each_prefetch(dlist, elem) {
+            if (destroy != NULL)
+                destroy(elem->data);
+            tail = elem;
+            stats_step(count);
+        }
+#endif
+        pool_free_chain(dlist->pool, dlist->head, tail);
+        dlist_init_with_pool(dlist, dlist->pool);
     }
+    else {
+        dlist_for_each_safe_prefetch(dlist, elem) {
+            if (destroy != NULL)
+                destroy(elem->data);
+            free(elem);
+            stats_step(count);
+        }
+        dlist_init(dlist);
+    }
+#ifdef STRUCTURES_NO_SIZE_CACHE
+    stats_free(STATS_DLIST, count);
+#endif
+}
+
+void dlist_set_ebr(/*@notnull@*/ struct dlist *dlist,
+                   /*@notnull@*/ struct ebr *ebr) {
+    dlist->ebr = ebr;
 }
 
 // -----------------------------------------------------------------------------
@@ -28,24 +193,39 @@ struct dlist_elem* dlist_get_head(/*@notnull@*/ const struct dlist *dlist) {
 }
 
 int dlist_get_size(/*@notnull@*/ const struct dlist *dlist) {
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    return dlist->size;
+#else
     int count = 0;
 
     dlist_for_each(dlist, elem)
         count++;
 
+    stats_walk(STATS_DLIST, count);
     return count;
+#endif
 }
 
 /*@null@*/
 struct dlist_elem* dlist_get_tail(/*@notnull@*/ const struct dlist *dlist) {
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    return dlist->tail;
+#else
     struct dlist_elem *elem;
+    int steps = 0;
 
-    for (elem = dlist->head; elem->next; elem = elem->next);
+    if (dlist->head == NULL)
+        return NULL;
+
+    for (elem = dlist->head; elem->next; elem = elem->next)
+        stats_step(steps);
+    stats_walk(STATS_DLIST, steps);
     return elem;
+#endif
 }
 
 int dlist_is_empty(/*@notnull@*/ const struct dlist *dlist) {
-    return !! dlist->head;
+    return dlist->head == NULL;
 }
 
 // -----------------------------------------------------------------------------
@@ -56,31 +236,44 @@ int dlist_ins_head(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void *data) {
     struct dlist_elem *elem;
 
-    elem = malloc(sizeof(struct dlist_elem));
+    elem = dlist_elem_alloc(dlist);
     if (elem == NULL)
         return -1;
     elem->next = dlist->head;
     elem->prev = NULL;
     elem->data = data;
-    dlist->head = elem;
+    if (dlist->head != NULL)
+        dlist->head->prev = elem;
+    ebr_store(dlist->head, elem);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (dlist->tail == NULL)
+        dlist->tail = elem;
+#endif
+    dlist_size_add(dlist, 1);
 
     return 0;
 }
 
-int dlist_ins_next(/*@notnull@*/ struct dlist_elem *elem,
+int dlist_ins_next(/*@notnull@*/ struct dlist *dlist,
+                   /*@notnull@*/ struct dlist_elem *elem,
                    /*@null@*/ void *data) {
     struct dlist_elem *elem_new;
 
-    elem_new = malloc(sizeof(struct dlist_elem));
+    elem_new = dlist_elem_alloc(dlist);
     if (elem_new == NULL)
         return -1;
 
     elem_new->next = elem->next;
     elem_new->prev = elem;
-    elem_new->next->prev = elem_new;
-    elem_new->prev->next = elem_new;
-
     elem_new->data = data;
+    if (elem_new->next != NULL)
+        elem_new->next->prev = elem_new;
+    ebr_store(elem->next, elem_new);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (dlist->tail == elem)
+        dlist->tail = elem_new;
+#endif
+    dlist_size_add(dlist, 1);
     return 0;
 }
 
@@ -89,25 +282,63 @@ int dlist_ins_prev(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void *data) {
     struct dlist_elem *elem_new;
 
-    elem_new = malloc(sizeof(struct dlist_elem));
+    elem_new = dlist_elem_alloc(dlist);
     if (elem_new == NULL)
         return -1;
 
-    if (dlist->head == elem)
-        dlist->head = elem_new;
-
     elem_new->next = elem;
     elem_new->prev = elem->prev;
-    elem_new->next->prev = elem_new;
-    elem_new->prev->next = elem_new;
-
     elem_new->data = data;
+    if (dlist->head == elem)
+        ebr_store(dlist->head, elem_new);
+    if (elem_new->prev != NULL)
+        ebr_store(elem_new->prev->next, elem_new);
+    elem->prev = elem_new;
+    dlist_size_add(dlist, 1);
     return 0;
 }
 
 int dlist_ins_tail(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void *data) {
-    return dlist_ins_next(dlist_get_tail(dlist), data);
+    struct dlist_elem *tail;
+
+    tail = dlist_get_tail(dlist);
+    if (tail == NULL)
+        return dlist_ins_head(dlist, data);
+
+    return dlist_ins_next(dlist, tail, data);
+}
+
+int dlist_ins_tail_n(/*@notnull@*/ struct dlist *dlist,
+                     /*@notnull@*/ void **data,
+                     int n) {
+    struct dlist_elem *first, *elem, *tail;
+
+    if (n <= 0)
+        return 0;
+    first = dlist_elem_alloc_chain(dlist, n);
+    if (first == NULL)
+        return -1;
+
+    tail = dlist_get_tail(dlist);
+    elem = first;
+    elem->prev = tail;
+    elem->data = data[0];
+    for (int i = 1; i < n; ++i) {
+        elem->next->prev = elem;
+        elem = elem->next;
+        elem->data = data[i];
+    }
+    elem->next = NULL;
+    if (tail == NULL)
+        ebr_store(dlist->head, first);
+    else
+        ebr_store(tail->next, first);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    dlist->tail = elem;
+#endif
+    dlist_size_add(dlist, n);
+    return 0;
 }
 
 int dlist_rem_elem(/*@notnull@*/ struct dlist *dlist,
@@ -116,13 +347,16 @@ int dlist_rem_elem(/*@notnull@*/ struct dlist *dlist,
     if (elem->next)
         elem->next->prev = elem->prev;
     if (elem->prev)
-        elem->prev->next = elem->next;
+        ebr_store(elem->prev->next, elem->next);
 
     if (dlist->head == elem)
-        dlist->head = elem->next;
-    if (destroy)
-        destroy(elem->data);
-    free(elem);
+        ebr_store(dlist->head, elem->next);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (dlist->tail == elem)
+        dlist->tail = elem->prev;
+#endif
+    dlist_size_add(dlist, -1);
+    dlist_elem_release(dlist, elem, destroy);
 
     return 0;
 }
@@ -135,17 +369,188 @@ int dlist_rem_head(/*@notnull@*/ struct dlist *dlist,
     if (elem == NULL)
         return -1;
 
-    dlist->head = elem->next;
+    ebr_store(dlist->head, elem->next);
     if (dlist->head != NULL)
         dlist->head->prev = NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (dlist->tail == elem)
+        dlist->tail = NULL;
+#endif
+    dlist_size_add(dlist, -1);
 
-    if (destroy)
-        destroy(elem->data);
-    free(elem);
+    dlist_elem_release(dlist, elem, destroy);
     return 0;
 }
 
+int dlist_rem_head_n(/*@notnull@*/ struct dlist *dlist,
+                     /*@null@*/ void **out,
+                     int n,
+                     /*@null@*/ void (*destroy)(void *data)) {
+    struct dlist_elem *first, *elem;
+    int count;
+
+    first = dlist->head;
+    for (count = 0, elem = first; count < n && elem != NULL; ++count)
+        elem = elem->next;
+    if (count == 0)
+        return 0;
+
+    ebr_store(dlist->head, elem);
+    if (dlist->head != NULL)
+        dlist->head->prev = NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (dlist->head == NULL)
+        dlist->tail = NULL;
+#endif
+    dlist_size_add(dlist, -count);
+    dlist_elem_release_chain(dlist, first, count, out, destroy);
+    return count;
+}
+
 int dlist_rem_tail(/*@notnull@*/ struct dlist *dlist,
                    /*@null@*/ void (*destroy)(void *data)) {
-    return dlist_rem_elem(dlist, dlist_get_tail(dlist), destroy);
+    struct dlist_elem *tail;
+
+    tail = dlist_get_tail(dlist);
+    if (tail == NULL)
+        return -1;
+
+    return dlist_rem_elem(dlist, tail, destroy);
+}
+
+int dlist_concat(/*@notnull@*/ struct dlist *dlist,
+                 /*@notnull@*/ struct dlist *other) {
+    return dlist_splice(dlist, dlist_get_tail(dlist), other);
+}
+
+int dlist_splice(/*@notnull@*/ struct dlist *dlist,
+                 /*@null@*/ struct dlist_elem *elem,
+                 /*@notnull@*/ struct dlist *other) {
+    struct dlist_elem *first, *last;
+
+    if (dlist == other || dlist->pool != other->pool)
+        return -1;
+    if (other->head == NULL)
+        return 0;
+
+    first = other->head;
+    last = dlist_get_tail(other);
+    first->prev = elem;
+    last->next = elem ? elem->next : dlist->head;
+    if (last->next != NULL)
+        last->next->prev = last;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    else
+        dlist->tail = last;
+#endif
+    if (elem != NULL)
+        elem->next = first;
+    else
+        dlist->head = first;
+    dlist_size_add(dlist, other->size);
+
+    other->head = NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    other->tail = NULL;
+#endif
+    dlist_size_reset(other);
+    return 0;
+}
+
+int dlist_split_at(/*@notnull@*/ struct dlist *dlist,
+                   /*@null@*/ struct dlist_elem *elem,
+                   /*@notnull@*/ struct dlist *other) {
+    struct dlist_elem *first;
+
+    if (dlist->pool != other->pool || other->head != NULL)
+        return -1;
+    first = elem ? elem->next : dlist->head;
+    if (first == NULL)
+        return 0;
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    for (struct dlist_elem *e = first; e != NULL; e = e->next)
+        other->size++;
+    dlist->size -= other->size;
+#endif
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    other->tail = dlist->tail;
+    dlist->tail = elem;
+#endif
+    other->head = first;
+    first->prev = NULL;
+    if (elem != NULL)
+        elem->next = NULL;
+    else
+        dlist->head = NULL;
+    return 0;
+}
+
+// Installs a sorted chain as the dlist's contents, repairing the prev links
+static void dlist_sort_finish(/*@notnull@*/ struct dlist *dlist,
+                              /*@null@*/ struct dlist_elem *head) {
+    struct dlist_elem *prev = NULL;
+
+    dlist->head = head;
+    dlist_for_each(dlist, elem) {
+        elem->prev = prev;
+        prev = elem;
+    }
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    dlist->tail = prev;
+#endif
+}
+
+void dlist_sort(/*@notnull@*/ struct dlist *dlist,
+                /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    dlist_sort_finish(dlist, listsort_chain(dlist->head,
+                                            offsetof(struct dlist_elem, data),
+                                            cmp));
+}
+
+void dlist_sort_parallel(/*@notnull@*/ struct dlist *dlist,
+                         /*@notnull@*/
+                         int (*cmp)(const void *a, const void *b),
+                         int threads) {
+    dlist_sort_finish(dlist,
+                      listsort_chain_parallel(dlist->head,
+                                              offsetof(struct dlist_elem, data),
+                                              cmp, threads));
+}
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+void dlist_for_each_parallel(/*@notnull@*/ struct dlist *dlist,
+                             /*@notnull@*/ void (*fn)(void *data, void *arg),
+                             /*@null@*/ void *arg,
+                             /*@null@*/ struct workpool *workpool) {
+    listpar_for_each(dlist->head, (size_t)dlist_get_size(dlist),
+                     offsetof(struct dlist_elem, data), fn, arg, workpool);
+}
+
+void dlist_reduce_parallel(/*@notnull@*/ struct dlist *dlist,
+                           /*@notnull@*/
+                           void (*fold)(void *acc, void *data, void *arg),
+                           /*@notnull@*/
+                           void (*combine)(void *acc, const void *part,
+                                           void *arg),
+                           /*@notnull@*/ void *acc, size_t acc_size,
+                           /*@null@*/ void *arg,
+                           /*@null@*/ struct workpool *workpool) {
+    listpar_reduce(dlist->head, (size_t)dlist_get_size(dlist),
+                   offsetof(struct dlist_elem, data), fold, combine, acc,
+                   acc_size, arg, workpool);
+}
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+int dlist_write(/*@notnull@*/ const struct dlist *dlist,
+                /*@notnull@*/ const char *path,
+                /*@notnull@*/ const struct listio_codec *codec) {
+    return listio_write(path, LISTIO_DLIST, dlist->head, NULL,
+                        offsetof(struct dlist_elem, data), codec);
 }
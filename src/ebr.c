@@ -0,0 +1,195 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ebr.h"
+#include "pool.h"
+#include <sched.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// A reader stores the epoch it read and then fences, and the collector fences
+// before reading the readers' epochs. Either the collector sees the reader's
+// announcement, or the reader sees every unlink made before the collector's
+// fence, so a reader that the collector missed cannot reach anything the
+// advance releases.
+
+#define EBR_ACTIVE 1u
+
+static void ebr_release(/*@notnull@*/ struct ebr_retired *retired) {
+    if (retired->destroy != NULL)
+        retired->destroy(retired->data);
+    if (retired->pool != NULL)
+        pool_free(retired->pool, retired->elem);
+    else
+        free(retired->elem);
+}
+
+// Moves the epoch on if every active reader has seen it, releasing the limbo
+// list that was retired two epochs ago. Called with the lock held.
+//
+// @return 0 if the epoch advanced, -1 if a reader is behind
+static int ebr_advance(/*@notnull@*/ struct ebr *ebr) {
+    struct ebr_retired *retired;
+    unsigned epoch, seen;
+
+    epoch = atomic_load_explicit(&ebr->epoch, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    for (struct ebr_reader *r = ebr->readers; r != NULL; r = r->next) {
+        seen = atomic_load_explicit(&r->epoch, memory_order_acquire);
+        if (seen != 0 && seen != (epoch | EBR_ACTIVE))
+            return -1;
+    }
+
+    ebr->bucket = (ebr->bucket + 1) % 3;
+    while (ebr->limbo[ebr->bucket] != NULL) {
+        retired = ebr->limbo[ebr->bucket];
+        ebr->limbo[ebr->bucket] = retired->next;
+        ebr_release(retired);
+        retired->next = ebr->spare;
+        ebr->spare = retired;
+    }
+    atomic_store_explicit(&ebr->epoch, epoch + 2, memory_order_release);
+    ebr->pending = 0;
+    return 0;
+}
+
+// Advances the epoch three times, which releases every limbo list, dropping
+// the lock while waiting on readers. Called with the lock held.
+static void ebr_flush_locked(/*@notnull@*/ struct ebr *ebr) {
+    for (int advanced = 0; advanced < 3; ) {
+        if (ebr_advance(ebr) == 0) {
+            ++advanced;
+            continue;
+        }
+        pthread_mutex_unlock(&ebr->lock);
+        sched_yield();
+        pthread_mutex_lock(&ebr->lock);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+int ebr_init(/*@out@*/ struct ebr *ebr) {
+    if (pthread_mutex_init(&ebr->lock, NULL) != 0)
+        return -1;
+    atomic_init(&ebr->epoch, 0);
+    ebr->readers = NULL;
+    for (int i = 0; i < 3; ++i)
+        ebr->limbo[i] = NULL;
+    ebr->spare = NULL;
+    ebr->bucket = 0;
+    ebr->pending = 0;
+    return 0;
+}
+
+void ebr_destroy(/*@notnull@*/ struct ebr *ebr) {
+    struct ebr_retired *retired;
+
+    for (int i = 0; i < 3; ++i)
+        while (ebr->limbo[i] != NULL) {
+            retired = ebr->limbo[i];
+            ebr->limbo[i] = retired->next;
+            ebr_release(retired);
+            free(retired);
+        }
+    while (ebr->spare != NULL) {
+        retired = ebr->spare;
+        ebr->spare = retired->next;
+        free(retired);
+    }
+    ebr->readers = NULL;
+    pthread_mutex_destroy(&ebr->lock);
+}
+
+void ebr_reader_register(/*@notnull@*/ struct ebr *ebr,
+                         /*@notnull@*/ struct ebr_reader *reader) {
+    atomic_init(&reader->epoch, 0);
+    reader->ebr = ebr;
+    pthread_mutex_lock(&ebr->lock);
+    reader->next = ebr->readers;
+    ebr->readers = reader;
+    pthread_mutex_unlock(&ebr->lock);
+}
+
+void ebr_reader_unregister(/*@notnull@*/ struct ebr_reader *reader) {
+    struct ebr *ebr = reader->ebr;
+    struct ebr_reader **link;
+
+    pthread_mutex_lock(&ebr->lock);
+    for (link = &ebr->readers; *link != NULL; link = &(*link)->next)
+        if (*link == reader) {
+            *link = reader->next;
+            break;
+        }
+    pthread_mutex_unlock(&ebr->lock);
+}
+
+// -----------------------------------------------------------------------------
+//                                  Reading
+// -----------------------------------------------------------------------------
+
+void ebr_read_begin(/*@notnull@*/ struct ebr_reader *reader) {
+    unsigned epoch;
+
+    epoch = atomic_load_explicit(&reader->ebr->epoch, memory_order_relaxed);
+    atomic_store_explicit(&reader->epoch, epoch | EBR_ACTIVE,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+void ebr_read_end(/*@notnull@*/ struct ebr_reader *reader) {
+    atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+//                                Reclamation
+// -----------------------------------------------------------------------------
+
+void ebr_retire(/*@notnull@*/ struct ebr *ebr,
+                /*@notnull@*/ void *elem,
+                /*@null@*/ struct pool *pool,
+                /*@null@*/ void *data,
+                /*@null@*/ void (*destroy)(void *data)) {
+    struct ebr_retired *retired;
+
+    pthread_mutex_lock(&ebr->lock);
+    retired = ebr->spare;
+    if (retired != NULL)
+        ebr->spare = retired->next;
+    else
+        retired = malloc(sizeof(struct ebr_retired));
+
+    // With no record to hold it, wait out every reader instead. The flush
+    // leaves spare records behind, but none are needed now.
+    if (retired == NULL) {
+        ebr_flush_locked(ebr);
+        pthread_mutex_unlock(&ebr->lock);
+        if (destroy != NULL)
+            destroy(data);
+        if (pool != NULL)
+            pool_free(pool, elem);
+        else
+            free(elem);
+        return;
+    }
+
+    retired->elem = elem;
+    retired->pool = pool;
+    retired->data = data;
+    retired->destroy = destroy;
+    retired->next = ebr->limbo[ebr->bucket];
+    ebr->limbo[ebr->bucket] = retired;
+    if (++ebr->pending >= EBR_COLLECT_BATCH)
+        ebr_advance(ebr);
+    pthread_mutex_unlock(&ebr->lock);
+}
+
+void ebr_flush(/*@notnull@*/ struct ebr *ebr) {
+    pthread_mutex_lock(&ebr->lock);
+    ebr_flush_locked(ebr);
+    pthread_mutex_unlock(&ebr->lock);
+}
@@ -0,0 +1,29 @@
+#include "hash.h"
+#include <stdint.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+//                                 Functions
+// -----------------------------------------------------------------------------
+
+size_t hash_str(/*@notnull@*/ const void *key) {
+    uint64_t hash = 0xcbf29ce484222325u;
+
+    for (const unsigned char *c = key; *c; ++c) {
+        hash ^= *c;
+        hash *= 0x100000001b3u;
+    }
+    return (size_t)hash;
+}
+
+int hash_str_cmp(/*@notnull@*/ const void *a, /*@notnull@*/ const void *b) {
+    return strcmp(a, b);
+}
+
+size_t hash_ptr(/*@null@*/ const void *key) {
+    return (size_t)(uintptr_t)key;
+}
+
+int hash_ptr_cmp(/*@null@*/ const void *a, /*@null@*/ const void *b) {
+    return a != b;
+}
@@ -0,0 +1,258 @@
+#include "heap.h"
+#include "dlist.h"
+#include "list.h"
+#include "pool.h"
+#include <stdlib.h>
+
+#define HEAP_MIN_CAPACITY 16
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+static struct heap_elem* heap_elem_alloc(/*@notnull@*/ struct heap *heap) {
+    if (heap->pool != NULL)
+        return pool_alloc(heap->pool);
+    return malloc(sizeof(struct heap_elem));
+}
+
+static void heap_elem_free(/*@notnull@*/ struct heap *heap,
+                           /*@notnull@*/ struct heap_elem *elem) {
+    if (heap->pool != NULL)
+        pool_free(heap->pool, elem);
+    else
+        free(elem);
+}
+
+static int heap_reserve(/*@notnull@*/ struct heap *heap,
+                        size_t count) {
+    struct heap_elem **elems;
+    size_t capacity;
+
+    if (count <= heap->capacity)
+        return 0;
+
+    capacity = heap->capacity ? heap->capacity : HEAP_MIN_CAPACITY;
+    while (capacity < count)
+        capacity *= 2;
+
+    elems = realloc(heap->elems, capacity * sizeof(*elems));
+    if (elems == NULL)
+        return -1;
+    heap->elems = elems;
+    heap->capacity = capacity;
+    return 0;
+}
+
+// Both sifts carry the moving element in a local and only write it back once
+// its final position is known, so each level costs one store instead of a swap.
+static void heap_sift_up(/*@notnull@*/ struct heap *heap,
+                         size_t index) {
+    struct heap_elem **elems = heap->elems;
+    struct heap_elem *elem = elems[index];
+    size_t parent;
+
+    while (index > 0) {
+        parent = (index - 1) / HEAP_ARITY;
+        if (heap->cmp(elem->data, elems[parent]->data) >= 0)
+            break;
+        elems[index] = elems[parent];
+        elems[index]->index = index;
+        index = parent;
+    }
+    elems[index] = elem;
+    elem->index = index;
+}
+
+static void heap_sift_down(/*@notnull@*/ struct heap *heap,
+                           size_t index) {
+    struct heap_elem **elems = heap->elems;
+    struct heap_elem *elem = elems[index];
+    size_t child, last, best;
+
+    for (;;) {
+        child = index * HEAP_ARITY + 1;
+        if (child >= heap->size)
+            break;
+        last = child + HEAP_ARITY;
+        if (last > heap->size)
+            last = heap->size;
+        best = child;
+        for (++child; child < last; ++child)
+            if (heap->cmp(elems[child]->data, elems[best]->data) < 0)
+                best = child;
+        if (heap->cmp(elems[best]->data, elem->data) >= 0)
+            break;
+        elems[index] = elems[best];
+        elems[index]->index = index;
+        index = best;
+    }
+    elems[index] = elem;
+    elem->index = index;
+}
+
+// Floyd's bottom-up construction: sifting down every internal node from the
+// last one back to the root costs O(n) in total.
+static void heap_heapify(/*@notnull@*/ struct heap *heap) {
+    size_t i;
+
+    if (heap->size < 2)
+        return;
+    for (i = (heap->size - 2) / HEAP_ARITY + 1; i-- > 0; )
+        heap_sift_down(heap, i);
+}
+
+// Appends a new handle without restoring the heap order.
+static int heap_append(/*@notnull@*/ struct heap *heap,
+                       /*@null@*/ void *data) {
+    struct heap_elem *elem;
+
+    elem = heap_elem_alloc(heap);
+    if (elem == NULL)
+        return -1;
+    elem->data = data;
+    elem->index = heap->size;
+    heap->elems[heap->size++] = elem;
+    return 0;
+}
+
+// Drops the handles appended after the first size elements, for bulk
+// insertions that fail part way through.
+static void heap_truncate(/*@notnull@*/ struct heap *heap,
+                          size_t size) {
+    while (heap->size > size)
+        heap_elem_free(heap, heap->elems[--heap->size]);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void heap_init(/*@out@*/ struct heap *heap,
+               /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    heap->elems = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+    heap->cmp = cmp;
+    heap->pool = NULL;
+}
+
+void heap_init_with_pool(/*@out@*/ struct heap *heap,
+                         /*@notnull@*/ int (*cmp)(const void *a, const void *b),
+                         /*@notnull@*/ struct pool *pool) {
+    heap_init(heap, cmp);
+    heap->pool = pool;
+}
+
+void heap_destroy(/*@notnull@*/ struct heap *heap,
+                  /*@null@*/ void (*destroy)(void *data)) {
+    heap_for_each(heap, elem) {
+        if (destroy != NULL)
+            destroy(elem->data);
+        heap_elem_free(heap, elem);
+    }
+    free(heap->elems);
+    heap->elems = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct heap_elem* heap_get_top(/*@notnull@*/ const struct heap *heap) {
+    return heap->size ? heap->elems[0] : NULL;
+}
+
+size_t heap_get_size(/*@notnull@*/ const struct heap *heap) {
+    return heap->size;
+}
+
+int heap_is_empty(/*@notnull@*/ const struct heap *heap) {
+    return heap->size == 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct heap_elem* heap_ins(/*@notnull@*/ struct heap *heap,
+                           /*@null@*/ void *data) {
+    struct heap_elem *elem;
+
+    if (heap_reserve(heap, heap->size + 1) != 0
+        || heap_append(heap, data) != 0)
+        return NULL;
+    elem = heap->elems[heap->size - 1];
+    heap_sift_up(heap, heap->size - 1);
+    return elem;
+}
+
+int heap_ins_dlist(/*@notnull@*/ struct heap *heap,
+                   /*@notnull@*/ const struct dlist *dlist) {
+    size_t size = heap->size;
+
+    if (heap_reserve(heap, size + (size_t)dlist_get_size(dlist)) != 0)
+        return -1;
+    dlist_for_each(dlist, elem) {
+        if (heap_append(heap, elem->data) != 0) {
+            heap_truncate(heap, size);
+            return -1;
+        }
+    }
+    heap_heapify(heap);
+    return 0;
+}
+
+int heap_ins_list(/*@notnull@*/ struct heap *heap,
+                  /*@notnull@*/ const struct list *list) {
+    size_t size = heap->size;
+
+    if (heap_reserve(heap, size + (size_t)list_get_size(list)) != 0)
+        return -1;
+    list_for_each(list, elem) {
+        if (heap_append(heap, elem->data) != 0) {
+            heap_truncate(heap, size);
+            return -1;
+        }
+    }
+    heap_heapify(heap);
+    return 0;
+}
+
+void heap_update(/*@notnull@*/ struct heap *heap,
+                 /*@notnull@*/ struct heap_elem *elem) {
+    size_t index = elem->index;
+
+    heap_sift_up(heap, index);
+    if (elem->index == index)
+        heap_sift_down(heap, index);
+}
+
+void heap_rem_elem(/*@notnull@*/ struct heap *heap,
+                   /*@notnull@*/ struct heap_elem *elem,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    size_t index = elem->index;
+
+    // The last element fills the hole and may need to move either way.
+    if (index != --heap->size) {
+        heap->elems[index] = heap->elems[heap->size];
+        heap->elems[index]->index = index;
+        heap_update(heap, heap->elems[index]);
+    }
+    if (destroy != NULL)
+        destroy(elem->data);
+    heap_elem_free(heap, elem);
+}
+
+int heap_rem_top(/*@notnull@*/ struct heap *heap,
+                 /*@null@*/ void (*destroy)(void *data)) {
+    if (heap->size == 0)
+        return -1;
+    heap_rem_elem(heap, heap->elems[0], destroy);
+    return 0;
+}
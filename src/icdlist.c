@@ -0,0 +1,124 @@
+#include "icdlist.h"
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+#define icdlist_size_add(icdlist, n) ((icdlist)->size += (n))
+#define icdlist_size_reset(icdlist) ((icdlist)->size = 0)
+#else
+#define icdlist_size_add(icdlist, n) ((void)0)
+#define icdlist_size_reset(icdlist) ((void)0)
+#endif
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void icdlist_init(/*@out@*/ struct icdlist *icdlist) {
+    icdlist->link.next = &icdlist->link;
+    icdlist->link.prev = &icdlist->link;
+    icdlist_size_reset(icdlist);
+}
+
+void icdlist_destroy(/*@notnull@*/ struct icdlist *icdlist,
+                     /*@null@*/ void (*destroy)(struct icdlist_elem *elem)) {
+    if (destroy != NULL)
+        icdlist_for_each_safe(icdlist, elem)
+            destroy(elem);
+    icdlist_init(icdlist);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct icdlist_elem* icdlist_get_head(/*@notnull@*/ const struct icdlist *icdlist) {
+    return icdlist_is_empty(icdlist) ? NULL : icdlist->link.next;
+}
+
+int icdlist_get_size(/*@notnull@*/ const struct icdlist *icdlist) {
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    return icdlist->size;
+#else
+    int count = 0;
+
+    icdlist_for_each(icdlist, elem)
+        count++;
+
+    return count;
+#endif
+}
+
+/*@null@*/
+struct icdlist_elem* icdlist_get_tail(/*@notnull@*/ const struct icdlist *icdlist) {
+    return icdlist_is_empty(icdlist) ? NULL : icdlist->link.prev;
+}
+
+int icdlist_is_empty(/*@notnull@*/ const struct icdlist *icdlist) {
+    return icdlist->link.next == &icdlist->link;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+void icdlist_ins_head(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem) {
+    icdlist_ins_next(icdlist, &icdlist->link, elem);
+}
+
+void icdlist_ins_next(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem,
+                      /*@notnull@*/ struct icdlist_elem *elem_new) {
+    elem_new->next = elem->next;
+    elem_new->prev = elem;
+    elem_new->next->prev = elem_new;
+    elem_new->prev->next = elem_new;
+    icdlist_size_add(icdlist, 1);
+}
+
+void icdlist_ins_prev(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem,
+                      /*@notnull@*/ struct icdlist_elem *elem_new) {
+    elem_new->next = elem;
+    elem_new->prev = elem->prev;
+    elem_new->next->prev = elem_new;
+    elem_new->prev->next = elem_new;
+    icdlist_size_add(icdlist, 1);
+}
+
+void icdlist_ins_tail(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem) {
+    icdlist_ins_prev(icdlist, &icdlist->link, elem);
+}
+
+void icdlist_rem_elem(/*@notnull@*/ struct icdlist *icdlist,
+                      /*@notnull@*/ struct icdlist_elem *elem) {
+    elem->next->prev = elem->prev;
+    elem->prev->next = elem->next;
+    icdlist_size_add(icdlist, -1);
+}
+
+/*@null@*/
+struct icdlist_elem* icdlist_rem_head(/*@notnull@*/ struct icdlist *icdlist) {
+    struct icdlist_elem *elem;
+
+    elem = icdlist_get_head(icdlist);
+    if (elem != NULL)
+        icdlist_rem_elem(icdlist, elem);
+    return elem;
+}
+
+/*@null@*/
+struct icdlist_elem* icdlist_rem_tail(/*@notnull@*/ struct icdlist *icdlist) {
+    struct icdlist_elem *elem;
+
+    elem = icdlist_get_tail(icdlist);
+    if (elem != NULL)
+        icdlist_rem_elem(icdlist, elem);
+    return elem;
+}
@@ -0,0 +1,131 @@
+#include "iclist.h"
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+#define iclist_size_add(iclist, n) ((iclist)->size += (n))
+#define iclist_size_reset(iclist) ((iclist)->size = 0)
+#else
+#define iclist_size_add(iclist, n) ((void)0)
+#define iclist_size_reset(iclist) ((void)0)
+#endif
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void iclist_init(/*@out@*/ struct iclist *iclist) {
+    iclist->link.next = &iclist->link;
+    iclist_size_reset(iclist);
+}
+
+void iclist_destroy(/*@notnull@*/ struct iclist *iclist,
+                    /*@null@*/ void (*destroy)(struct iclist_elem *elem)) {
+    if (destroy != NULL)
+        iclist_for_each_safe(iclist, elem)
+            destroy(elem);
+    iclist_init(iclist);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct iclist_elem* iclist_get_head(/*@notnull@*/ const struct iclist *iclist) {
+    return iclist_is_empty(iclist) ? NULL : iclist->link.next;
+}
+
+int iclist_get_size(/*@notnull@*/ const struct iclist *iclist) {
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    return iclist->size;
+#else
+    int count = 0;
+
+    iclist_for_each(iclist, elem)
+        count++;
+
+    return count;
+#endif
+}
+
+/*@null@*/
+struct iclist_elem* iclist_get_tail(/*@notnull@*/ const struct iclist *iclist) {
+    struct iclist_elem *elem;
+
+    if (iclist_is_empty(iclist))
+        return NULL;
+
+    for (elem = iclist->link.next;
+         elem->next != &iclist->link;
+         elem = elem->next);
+
+    return elem;
+}
+
+int iclist_is_empty(/*@notnull@*/ const struct iclist *iclist) {
+    return iclist->link.next == &iclist->link;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+void iclist_ins_head(/*@notnull@*/ struct iclist *iclist,
+                     /*@notnull@*/ struct iclist_elem *elem) {
+    iclist_ins_next(iclist, &iclist->link, elem);
+}
+
+void iclist_ins_next(/*@notnull@*/ struct iclist *iclist,
+                     /*@notnull@*/ struct iclist_elem *elem,
+                     /*@notnull@*/ struct iclist_elem *elem_new) {
+    elem_new->next = elem->next;
+    elem->next = elem_new;
+    iclist_size_add(iclist, 1);
+}
+
+void iclist_ins_tail(/*@notnull@*/ struct iclist *iclist,
+                     /*@notnull@*/ struct iclist_elem *elem) {
+    struct iclist_elem *tail;
+
+    tail = iclist_get_tail(iclist);
+    if (tail == NULL)
+        tail = &iclist->link;
+
+    iclist_ins_next(iclist, tail, elem);
+}
+
+/*@null@*/
+struct iclist_elem* iclist_rem_head(/*@notnull@*/ struct iclist *iclist) {
+    return iclist_rem_next(iclist, &iclist->link);
+}
+
+/*@null@*/
+struct iclist_elem* iclist_rem_next(/*@notnull@*/ struct iclist *iclist,
+                                    /*@notnull@*/ struct iclist_elem *elem) {
+    struct iclist_elem *target;
+
+    target = elem->next;
+    if (target == &iclist->link)
+        return NULL;
+
+    elem->next = target->next;
+    iclist_size_add(iclist, -1);
+    return target;
+}
+
+/*@null@*/
+struct iclist_elem* iclist_rem_tail(/*@notnull@*/ struct iclist *iclist) {
+    struct iclist_elem *pretail;
+
+    if (iclist_is_empty(iclist))
+        return NULL;
+
+    for (pretail = &iclist->link;
+         pretail->next->next != &iclist->link;
+         pretail = pretail->next);
+    return iclist_rem_next(iclist, pretail);
+}
@@ -0,0 +1,169 @@
+#include "idlist.h"
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+#define idlist_size_add(idlist, n) ((idlist)->size += (n))
+#define idlist_size_reset(idlist) ((idlist)->size = 0)
+#else
+#define idlist_size_add(idlist, n) ((void)0)
+#define idlist_size_reset(idlist) ((void)0)
+#endif
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void idlist_init(/*@out@*/ struct idlist *idlist) {
+    idlist->head = NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    idlist->tail = NULL;
+#endif
+    idlist_size_reset(idlist);
+}
+
+void idlist_destroy(/*@notnull@*/ struct idlist *idlist,
+                    /*@null@*/ void (*destroy)(struct idlist_elem *elem)) {
+    if (destroy != NULL)
+        idlist_for_each_safe(idlist, elem)
+            destroy(elem);
+    idlist_init(idlist);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct idlist_elem* idlist_get_head(/*@notnull@*/ const struct idlist *idlist) {
+    return idlist->head;
+}
+
+int idlist_get_size(/*@notnull@*/ const struct idlist *idlist) {
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    return idlist->size;
+#else
+    int count = 0;
+
+    idlist_for_each(idlist, elem)
+        count++;
+
+    return count;
+#endif
+}
+
+/*@null@*/
+struct idlist_elem* idlist_get_tail(/*@notnull@*/ const struct idlist *idlist) {
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    return idlist->tail;
+#else
+    struct idlist_elem *elem;
+
+    if (idlist->head == NULL)
+        return NULL;
+
+    for (elem = idlist->head; elem->next; elem = elem->next);
+    return elem;
+#endif
+}
+
+int idlist_is_empty(/*@notnull@*/ const struct idlist *idlist) {
+    return idlist->head == NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+void idlist_ins_head(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem) {
+    elem->next = idlist->head;
+    elem->prev = NULL;
+    if (idlist->head != NULL)
+        idlist->head->prev = elem;
+    idlist->head = elem;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (idlist->tail == NULL)
+        idlist->tail = elem;
+#endif
+    idlist_size_add(idlist, 1);
+}
+
+void idlist_ins_next(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem,
+                     /*@notnull@*/ struct idlist_elem *elem_new) {
+    elem_new->next = elem->next;
+    elem_new->prev = elem;
+    if (elem_new->next != NULL)
+        elem_new->next->prev = elem_new;
+    elem->next = elem_new;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (idlist->tail == elem)
+        idlist->tail = elem_new;
+#endif
+    idlist_size_add(idlist, 1);
+}
+
+void idlist_ins_prev(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem,
+                     /*@notnull@*/ struct idlist_elem *elem_new) {
+    if (idlist->head == elem)
+        idlist->head = elem_new;
+
+    elem_new->next = elem;
+    elem_new->prev = elem->prev;
+    if (elem_new->prev != NULL)
+        elem_new->prev->next = elem_new;
+    elem->prev = elem_new;
+    idlist_size_add(idlist, 1);
+}
+
+void idlist_ins_tail(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem) {
+    struct idlist_elem *tail;
+
+    tail = idlist_get_tail(idlist);
+    if (tail == NULL)
+        idlist_ins_head(idlist, elem);
+    else
+        idlist_ins_next(idlist, tail, elem);
+}
+
+void idlist_rem_elem(/*@notnull@*/ struct idlist *idlist,
+                     /*@notnull@*/ struct idlist_elem *elem) {
+    if (elem->next)
+        elem->next->prev = elem->prev;
+    if (elem->prev)
+        elem->prev->next = elem->next;
+
+    if (idlist->head == elem)
+        idlist->head = elem->next;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (idlist->tail == elem)
+        idlist->tail = elem->prev;
+#endif
+    idlist_size_add(idlist, -1);
+}
+
+/*@null@*/
+struct idlist_elem* idlist_rem_head(/*@notnull@*/ struct idlist *idlist) {
+    struct idlist_elem *elem;
+
+    elem = idlist->head;
+    if (elem != NULL)
+        idlist_rem_elem(idlist, elem);
+    return elem;
+}
+
+/*@null@*/
+struct idlist_elem* idlist_rem_tail(/*@notnull@*/ struct idlist *idlist) {
+    struct idlist_elem *elem;
+
+    elem = idlist_get_tail(idlist);
+    if (elem != NULL)
+        idlist_rem_elem(idlist, elem);
+    return elem;
+}
@@ -0,0 +1,163 @@
+#include "ilist.h"
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+#define ilist_size_add(ilist, n) ((ilist)->size += (n))
+#define ilist_size_reset(ilist) ((ilist)->size = 0)
+#else
+#define ilist_size_add(ilist, n) ((void)0)
+#define ilist_size_reset(ilist) ((void)0)
+#endif
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void ilist_init(/*@out@*/ struct ilist *ilist) {
+    ilist->head = NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    ilist->tail = NULL;
+#endif
+    ilist_size_reset(ilist);
+}
+
+void ilist_destroy(/*@notnull@*/ struct ilist *ilist,
+                   /*@null@*/ void (*destroy)(struct ilist_elem *elem)) {
+    if (destroy != NULL)
+        ilist_for_each_safe(ilist, elem)
+            destroy(elem);
+    ilist_init(ilist);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct ilist_elem* ilist_get_head(/*@notnull@*/ const struct ilist *ilist) {
+    return ilist->head;
+}
+
+int ilist_get_size(/*@notnull@*/ const struct ilist *ilist) {
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    return ilist->size;
+#else
+    int count = 0;
+
+    ilist_for_each(ilist, elem)
+        count++;
+
+    return count;
+#endif
+}
+
+/*@null@*/
+struct ilist_elem* ilist_get_tail(/*@notnull@*/ const struct ilist *ilist) {
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    return ilist->tail;
+#else
+    struct ilist_elem *elem;
+
+    if (ilist->head == NULL)
+        return NULL;
+
+    for (elem = ilist->head; elem->next; elem = elem->next);
+    return elem;
+#endif
+}
+
+int ilist_is_empty(/*@notnull@*/ const struct ilist *ilist) {
+    return ilist->head == NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+void ilist_ins_head(/*@notnull@*/ struct ilist *ilist,
+                    /*@notnull@*/ struct ilist_elem *elem) {
+    elem->next = ilist->head;
+    ilist->head = elem;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (ilist->tail == NULL)
+        ilist->tail = elem;
+#endif
+    ilist_size_add(ilist, 1);
+}
+
+void ilist_ins_next(/*@notnull@*/ struct ilist *ilist,
+                    /*@notnull@*/ struct ilist_elem *elem,
+                    /*@notnull@*/ struct ilist_elem *elem_new) {
+    elem_new->next = elem->next;
+    elem->next = elem_new;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (ilist->tail == elem)
+        ilist->tail = elem_new;
+#endif
+    ilist_size_add(ilist, 1);
+}
+
+void ilist_ins_tail(/*@notnull@*/ struct ilist *ilist,
+                    /*@notnull@*/ struct ilist_elem *elem) {
+    struct ilist_elem *tail;
+
+    tail = ilist_get_tail(ilist);
+    if (tail == NULL)
+        ilist_ins_head(ilist, elem);
+    else
+        ilist_ins_next(ilist, tail, elem);
+}
+
+/*@null@*/
+struct ilist_elem* ilist_rem_head(/*@notnull@*/ struct ilist *ilist) {
+    struct ilist_elem *elem;
+
+    elem = ilist->head;
+    if (elem == NULL)
+        return NULL;
+
+    ilist->head = elem->next;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (ilist->tail == elem)
+        ilist->tail = NULL;
+#endif
+    ilist_size_add(ilist, -1);
+    return elem;
+}
+
+/*@null@*/
+struct ilist_elem* ilist_rem_next(/*@notnull@*/ struct ilist *ilist,
+                                  /*@notnull@*/ struct ilist_elem *elem) {
+    struct ilist_elem *target;
+
+    target = elem->next;
+    if (target == NULL)
+        return NULL;
+
+    elem->next = target->next;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (ilist->tail == target)
+        ilist->tail = elem;
+#endif
+    ilist_size_add(ilist, -1);
+    return target;
+}
+
+/*@null@*/
+struct ilist_elem* ilist_rem_tail(/*@notnull@*/ struct ilist *ilist) {
+    struct ilist_elem *elem;
+
+    elem = ilist->head;
+    if (elem == NULL)
+        return NULL;
+    if (elem->next == NULL)
+        return ilist_rem_head(ilist);
+
+    while (elem->next->next != NULL)
+        elem = elem->next;
+    return ilist_rem_next(ilist, elem);
+}
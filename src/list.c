@@ -1,21 +1,186 @@
 #include "list.h"
+#include "ebr.h"
+#include "listio.h"
+#include "listpar.h"
+#include "listsort.h"
+#include "pool.h"
+#include "stats.h"
 #include <stdlib.h>
 
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+#define list_size_add(list, n) ((list)->size += (n))
+#define list_size_reset(list) ((list)->size = 0)
+#else
+#define list_size_add(list, n) ((void)0)
+#define list_size_reset(list) ((void)0)
+#endif
+
+/*@null@*/
+static struct list_elem* list_elem_alloc(/*@notnull@*/ struct list *list) {
+    struct list_elem *elem;
+
+    if (list->pool != NULL)
+        elem = pool_alloc(list->pool);
+    else
+        elem = malloc(sizeof(struct list_elem));
+    if (elem != NULL)
+        stats_alloc(STATS_LIST, 1);
+    return elem;
+}
+
+static void list_elem_free(/*@notnull@*/ struct list *list,
+                           /*@notnull@*/ struct list_elem *elem) {
+    stats_free(STATS_LIST, 1);
+    if (list->pool != NULL)
+        pool_free(list->pool, elem);
+    else
+        free(elem);
+}
+
+// Frees elem and destroys its data, or hands both to the list's ebr to be
+// released once no reader can still be standing on elem
+static void list_elem_release(/*@notnull@*/ struct list *list,
+                              /*@notnull@*/ struct list_elem *elem,
+                              /*@null@*/ void (*destroy)(void *data)) {
+    if (list->ebr != NULL) {
+        stats_free(STATS_LIST, 1);
+        ebr_retire(list->ebr, elem, list->pool, elem->data, destroy);
+        return;
+    }
+    if (destroy != NULL)
+        destroy(elem->data);
+    list_elem_free(list, elem);
+}
+
+// Allocates n elements as a chain linked through next, from one block of the
+// list's pool if it has one. The next pointer of the last is left unset.
+/*@null@*/
+static struct list_elem* list_elem_alloc_chain(/*@notnull@*/ struct list *list,
+                                               int n) {
+    struct list_elem *first = NULL, **link = &first, *elem;
+
+    if (list->pool != NULL) {
+        first = pool_alloc_chain(list->pool, (size_t)n);
+        if (first != NULL)
+            stats_alloc(STATS_LIST, n);
+        return first;
+    }
+    for (int i = 0; i < n; ++i) {
+        *link = malloc(sizeof(struct list_elem));
+        if (*link == NULL) {
+            for (; i > 0; --i, first = elem) {
+                elem = first->next;
+                free(first);
+            }
+            return NULL;
+        }
+        link = &(*link)->next;
+    }
+    stats_alloc(STATS_LIST, n);
+    return first;
+}
+
+// Releases the first count elements of a chain already unlinked from the
+// list, storing their data in out if it is non-NULL
+static void list_elem_release_chain(/*@notnull@*/ struct list *list,
+                                    /*@notnull@*/ struct list_elem *first,
+                                    int count,
+                                    /*@null@*/ void **out,
+                                    /*@null@*/ void (*destroy)(void *data)) {
+    struct list_elem *elem = first, *next, *last = first;
+
+    for (int i = 0; i < count; ++i, elem = next) {
+        next = elem->next;
+        if (out != NULL)
+            out[i] = elem->data;
+        if (list->pool == NULL || list->ebr != NULL) {
+            list_elem_release(list, elem, destroy);
+            continue;
+        }
+        if (destroy != NULL)
+            destroy(elem->data);
+        last = elem;
+    }
+    if (list->pool != NULL && list->ebr == NULL) {
+        stats_free(STATS_LIST, count);
+        pool_free_chain(list->pool, first, last);
+    }
+}
+
 // -----------------------------------------------------------------------------
 //                                 Management
 // -----------------------------------------------------------------------------
 
 void list_init(/*@out@*/ struct list *list) {
     list->head = NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    list->tail = NULL;
+#endif
+    list->pool = NULL;
+    list->ebr = NULL;
+    list_size_reset(list);
+}
+
+void list_init_with_pool(/*@out@*/ struct list *list,
+                         /*@notnull@*/ struct pool *pool) {
+    list_init(list);
+    list->pool = pool;
 }
 
 void list_destroy(/*@notnull@*/ struct list *list,
                   /*@null@*/ void (*destroy)(void *data)) {
-    list_for_each_safe(list, elem) {
-        if (destroy != NULL)
-            destroy(elem->data);
-        free(elem);
+    struct list_elem *tail;
+    int count = 0;
+
+    // Without a cached size the elements are counted on the walk destroy
+    // makes anyway, rather than on a walk of their own
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    stats_free(STATS_LIST, list->size);
+#endif
+    if (list->pool != NULL) {
+        if (list->head == NULL)
+            return;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+        tail = list->tail;
+        if (destroy != NULL || STATS_COUNT_BY_WALK)
+            list_for_each_prefetch(list, elem) {
+                if (destroy != NULL)
+                    destroy(elem->data);
+                stats_step(count);
+            }
+#else
+        tail = list->head;
+        list_for_each_prefetch(list, elem) {
+            if (destroy != NULL)
+                destroy(elem->data);
+            tail = elem;
+            stats_step(count);
+        }
+#endif
+        pool_free_chain(list->pool, list->head, tail);
+        list_init_with_pool(list, list->pool);
+    }
+    else {
+        list_for_each_safe_prefetch(list, elem) {
+            if (destroy != NULL)
+                destroy(elem->data);
+            free(elem);
+            stats_step(count);
+        }
+        list_init(list);
     }
+#ifdef STRUCTURES_NO_SIZE_CACHE
+    stats_free(STATS_LIST, count);
+#endif
+}
+
+void list_set_ebr(/*@notnull@*/ struct list *list,
+                  /*@notnull@*/ struct ebr *ebr) {
+    list->ebr = ebr;
 }
 
 // -----------------------------------------------------------------------------
@@ -28,27 +193,39 @@ struct list_elem* list_get_head(/*@notnull@*/ const struct list *list) {
 }
 
 int list_get_size(/*@notnull@*/ const struct list *list) {
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    return list->size;
+#else
     int count = 0;
 
     list_for_each(list, elem)
         count++;
 
+    stats_walk(STATS_LIST, count);
     return count;
+#endif
 }
 
 /*@null@*/
 struct list_elem* list_get_tail(/*@notnull@*/ const struct list *list) {
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    return list->tail;
+#else
     struct list_elem *elem;
+    int steps = 0;
 
     if (list->head == NULL)
         return NULL;
 
-    for (elem = list->head; elem->next; elem = elem->next);
+    for (elem = list->head; elem->next; elem = elem->next)
+        stats_step(steps);
+    stats_walk(STATS_LIST, steps);
     return elem;
+#endif
 }
 
 int list_is_empty(/*@notnull@*/ const struct list *list) {
-    return !! list->head;
+    return list->head == NULL;
 }
 
 // -----------------------------------------------------------------------------
@@ -59,31 +236,78 @@ int list_ins_head(/*@notnull@*/ struct list *list,
                   /*@null@*/ void *data) {
     struct list_elem *elem;
 
-    elem = malloc(sizeof(struct list_elem));
+    elem = list_elem_alloc(list);
     if (elem == NULL)
         return -1;
     elem->next = list->head;
     elem->data = data;
-    list->head = elem;
+    ebr_store(list->head, elem);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (list->tail == NULL)
+        list->tail = elem;
+#endif
+    list_size_add(list, 1);
 
     return 0;
 }
 
 int list_ins_tail(/*@notnull@*/ struct list *list,
                   /*@null@*/ void *data) {
-    return list_ins_next(list_get_tail(list), data);
+    struct list_elem *tail;
+
+    tail = list_get_tail(list);
+    if (tail == NULL)
+        return list_ins_head(list, data);
+
+    return list_ins_next(list, tail, data);
+}
+
+int list_ins_tail_n(/*@notnull@*/ struct list *list,
+                    /*@notnull@*/ void **data,
+                    int n) {
+    struct list_elem *first, *elem, *tail;
+
+    if (n <= 0)
+        return 0;
+    first = list_elem_alloc_chain(list, n);
+    if (first == NULL)
+        return -1;
+
+    tail = list_get_tail(list);
+    elem = first;
+    elem->data = data[0];
+    for (int i = 1; i < n; ++i) {
+        elem = elem->next;
+        elem->data = data[i];
+    }
+    elem->next = NULL;
+    if (tail == NULL)
+        ebr_store(list->head, first);
+    else
+        ebr_store(tail->next, first);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    list->tail = elem;
+#endif
+    list_size_add(list, n);
+    return 0;
 }
 
-int list_ins_next(/*@notnull@*/ struct list_elem *elem,
+int list_ins_next(/*@notnull@*/ struct list *list,
+                  /*@notnull@*/ struct list_elem *elem,
                   /*@null@*/ void *data) {
     struct list_elem *elem_new;
 
-    elem_new = malloc(sizeof(struct list_elem));
+    elem_new = list_elem_alloc(list);
     if (elem_new == NULL)
         return -1;
     elem_new->next = elem->next;
     elem_new->data = data;
-    elem->next = elem_new;
+    ebr_store(elem->next, elem_new);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (list->tail == elem)
+        list->tail = elem_new;
+#endif
+    list_size_add(list, 1);
 
     return 0;
 }
@@ -96,16 +320,43 @@ int list_rem_head(/*@notnull@*/ struct list *list,
         return -1;
 
     elem = list->head;
-    list->head = elem->next;
-    if (destroy != NULL)
-        destroy(elem->data);
-    free(elem);
+    ebr_store(list->head, elem->next);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (list->tail == elem)
+        list->tail = NULL;
+#endif
+    list_size_add(list, -1);
+    list_elem_release(list, elem, destroy);
     return 0;
 }
 
+int list_rem_head_n(/*@notnull@*/ struct list *list,
+                    /*@null@*/ void **out,
+                    int n,
+                    /*@null@*/ void (*destroy)(void *data)) {
+    struct list_elem *first, *elem;
+    int count;
+
+    first = list->head;
+    for (count = 0, elem = first; count < n && elem != NULL; ++count)
+        elem = elem->next;
+    if (count == 0)
+        return 0;
+
+    ebr_store(list->head, elem);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (list->head == NULL)
+        list->tail = NULL;
+#endif
+    list_size_add(list, -count);
+    list_elem_release_chain(list, first, count, out, destroy);
+    return count;
+}
+
 int list_rem_tail(/*@notnull@*/ struct list *list,
                   /*@null@*/ void (*destroy)(void *data)){
     struct list_elem *elem;
+    int steps = 0;
 
     elem = list_get_head(list);
     if (elem == NULL)
@@ -113,12 +364,16 @@ int list_rem_tail(/*@notnull@*/ struct list *list,
     if (elem->next == NULL)
         return list_rem_head(list, destroy);
 
-    while(elem->next->next != NULL)
+    while(elem->next->next != NULL) {
         elem = elem->next;
-    return list_rem_next(elem, destroy);
+        stats_step(steps);
+    }
+    stats_walk(STATS_LIST, steps);
+    return list_rem_next(list, elem, destroy);
 }
 
-int list_rem_next(/*@notnull@*/ struct list_elem *elem,
+int list_rem_next(/*@notnull@*/ struct list *list,
+                  /*@notnull@*/ struct list_elem *elem,
                   /*@null@*/ void (*destroy)(void *data)) {
     struct list_elem *target;
 
@@ -126,9 +381,138 @@ int list_rem_next(/*@notnull@*/ struct list_elem *elem,
     if (target == NULL)
         return -1;
 
-    elem->next = target->next;
-    if (destroy)
-        destroy(elem->data);
-    free(target);
+    ebr_store(elem->next, target->next);
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (list->tail == target)
+        list->tail = elem;
+#endif
+    list_size_add(list, -1);
+    list_elem_release(list, target, destroy);
+    return 0;
+}
+
+int list_concat(/*@notnull@*/ struct list *list,
+                /*@notnull@*/ struct list *other) {
+    return list_splice(list, list_get_tail(list), other);
+}
+
+int list_splice(/*@notnull@*/ struct list *list,
+                /*@null@*/ struct list_elem *elem,
+                /*@notnull@*/ struct list *other) {
+    struct list_elem *last;
+
+    if (list == other || list->pool != other->pool)
+        return -1;
+    if (other->head == NULL)
+        return 0;
+
+    last = list_get_tail(other);
+    last->next = elem ? elem->next : list->head;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    if (last->next == NULL)
+        list->tail = last;
+#endif
+    if (elem != NULL)
+        elem->next = other->head;
+    else
+        list->head = other->head;
+    list_size_add(list, other->size);
+
+    other->head = NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    other->tail = NULL;
+#endif
+    list_size_reset(other);
+    return 0;
+}
+
+int list_split_at(/*@notnull@*/ struct list *list,
+                  /*@null@*/ struct list_elem *elem,
+                  /*@notnull@*/ struct list *other) {
+    struct list_elem *first;
+
+    if (list->pool != other->pool || other->head != NULL)
+        return -1;
+    first = elem ? elem->next : list->head;
+    if (first == NULL)
+        return 0;
+
+#ifndef STRUCTURES_NO_SIZE_CACHE
+    for (struct list_elem *e = first; e != NULL; e = e->next)
+        other->size++;
+    list->size -= other->size;
+#endif
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    other->tail = list->tail;
+    list->tail = elem;
+#endif
+    other->head = first;
+    if (elem != NULL)
+        elem->next = NULL;
+    else
+        list->head = NULL;
     return 0;
 }
+
+// Installs a sorted chain as the list's contents
+static void list_sort_finish(/*@notnull@*/ struct list *list,
+                             /*@null@*/ struct list_elem *head) {
+    list->head = head;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+    list_for_each(list, elem)
+        list->tail = elem;
+#endif
+}
+
+void list_sort(/*@notnull@*/ struct list *list,
+               /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    list_sort_finish(list, listsort_chain(list->head,
+                                          offsetof(struct list_elem, data),
+                                          cmp));
+}
+
+void list_sort_parallel(/*@notnull@*/ struct list *list,
+                        /*@notnull@*/ int (*cmp)(const void *a, const void *b),
+                        int threads) {
+    list_sort_finish(list,
+                     listsort_chain_parallel(list->head,
+                                             offsetof(struct list_elem, data),
+                                             cmp, threads));
+}
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+void list_for_each_parallel(/*@notnull@*/ struct list *list,
+                            /*@notnull@*/ void (*fn)(void *data, void *arg),
+                            /*@null@*/ void *arg,
+                            /*@null@*/ struct workpool *workpool) {
+    listpar_for_each(list->head, (size_t)list_get_size(list),
+                     offsetof(struct list_elem, data), fn, arg, workpool);
+}
+
+void list_reduce_parallel(/*@notnull@*/ struct list *list,
+                          /*@notnull@*/
+                          void (*fold)(void *acc, void *data, void *arg),
+                          /*@notnull@*/
+                          void (*combine)(void *acc, const void *part,
+                                          void *arg),
+                          /*@notnull@*/ void *acc, size_t acc_size,
+                          /*@null@*/ void *arg,
+                          /*@null@*/ struct workpool *workpool) {
+    listpar_reduce(list->head, (size_t)list_get_size(list),
+                   offsetof(struct list_elem, data), fold, combine, acc,
+                   acc_size, arg, workpool);
+}
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+int list_write(/*@notnull@*/ const struct list *list,
+               /*@notnull@*/ const char *path,
+               /*@notnull@*/ const struct listio_codec *codec) {
+    return listio_write(path, LISTIO_LIST, list->head, NULL,
+                        offsetof(struct list_elem, data), codec);
+}
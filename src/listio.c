@@ -0,0 +1,280 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "listio.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Elements are linked through their first member, as in pool_free_chain
+#define chain_next(elem) (*(void **)(elem))
+#define chain_data(elem, offset) (*(void **)((char *)(elem) + (offset)))
+
+// Written as a number so that a file from a machine of the other byte order
+// reads back as 0x04030201
+#define LISTIO_BYTE_ORDER 0x01020304u
+
+// Records and their data start on multiples of this
+#define LISTIO_ALIGN 8
+
+// The space a record with size bytes of data takes in the file
+#define listio_span(size)                                               \
+    (sizeof(struct listio_record)                                       \
+     + ((size) + LISTIO_ALIGN - 1) / LISTIO_ALIGN * LISTIO_ALIGN)
+
+#define listio_header(view) ((const struct listio_header *)(view)->base)
+
+// Whether a record of unknown size could start at offset
+static int listio_record_fits(/*@notnull@*/ const struct listio_view *view,
+                              uint64_t offset) {
+    return offset >= sizeof(struct listio_header)
+        && offset % LISTIO_ALIGN == 0
+        && offset <= view->length - sizeof(struct listio_record);
+}
+
+// Encodes data into *buf after room for its record, growing *buf if the
+// record and its padding do not fit
+//
+// @return The size of the encoding, or (size_t)-1 if *buf could not grow
+static size_t listio_encode(/*@notnull@*/ const struct listio_codec *codec,
+                            /*@null@*/ const void *data,
+                            /*@notnull@*/ char **buf,
+                            /*@notnull@*/ size_t *cap) {
+    size_t size, need;
+    char *grown;
+
+    size = codec->encode(data, *buf + sizeof(struct listio_record),
+                         *cap - listio_span(0) - LISTIO_ALIGN, codec->arg);
+    need = listio_span(size);
+    if (need <= *cap - LISTIO_ALIGN)
+        return size;
+
+    need = need + LISTIO_ALIGN > *cap * 2 ? need + LISTIO_ALIGN : *cap * 2;
+    grown = realloc(*buf, need);
+    if (grown == NULL)
+        return (size_t)-1;
+    *buf = grown;
+    *cap = need;
+
+    // A codec that asks for more room the second time round is not trusted
+    // with the buffer: the record would be written from past its end
+    size = codec->encode(data, *buf + sizeof(struct listio_record),
+                         *cap - listio_span(0) - LISTIO_ALIGN, codec->arg);
+    if (size > *cap || listio_span(size) > *cap - LISTIO_ALIGN)
+        return (size_t)-1;
+    return size;
+}
+
+// Syncs the directory holding path, so that a rename into it survives a crash.
+// Best effort: not every file system lets a directory be opened and synced.
+static void listio_sync_dir(/*@notnull@*/ const char *path) {
+    const char *slash = strrchr(path, '/');
+    char *dir;
+    int fd;
+
+    if (slash == NULL) {
+        fd = open(".", O_RDONLY);
+    } else {
+        dir = strndup(path, slash == path ? 1 : (size_t)(slash - path));
+        if (dir == NULL)
+            return;
+        fd = open(dir, O_RDONLY);
+        free(dir);
+    }
+    if (fd < 0)
+        return;
+    fsync(fd);
+    close(fd);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+int listio_map(/*@out@*/ struct listio_view *view,
+               /*@notnull@*/ const char *path) {
+    const struct listio_header *header;
+    struct stat st;
+    void *base;
+    int fd;
+
+    view->base = NULL;
+    view->length = 0;
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) != 0
+        || (size_t)st.st_size < sizeof(struct listio_header)) {
+        close(fd);
+        return -1;
+    }
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return -1;
+
+    view->base = base;
+    view->length = (size_t)st.st_size;
+    header = listio_header(view);
+    if (memcmp(header->magic, LISTIO_MAGIC, sizeof(LISTIO_MAGIC)) != 0
+        || header->byte_order != LISTIO_BYTE_ORDER
+        || header->version != LISTIO_VERSION
+        || header->kind > LISTIO_CDLIST
+        || header->length != view->length
+        || (header->count == 0) != (header->head == 0)
+        || (header->count == 0) != (header->tail == 0)
+        || (header->count != 0 && (!listio_record_fits(view, header->head)
+                                   || !listio_record_fits(view,
+                                                          header->tail)))) {
+        listio_unmap(view);
+        return -1;
+    }
+    return 0;
+}
+
+void listio_unmap(/*@notnull@*/ struct listio_view *view) {
+    if (view->base != NULL)
+        munmap((void *)view->base, view->length);
+    view->base = NULL;
+    view->length = 0;
+}
+
+int listio_view_check(/*@notnull@*/ const struct listio_view *view) {
+    const struct listio_header *header = listio_header(view);
+    const struct listio_record *rec;
+    uint64_t offset = header->head, count = 0;
+    int64_t prev = 0;
+
+    while (offset != 0) {
+        if (!listio_record_fits(view, offset) || ++count > header->count)
+            return -1;
+        rec = (const struct listio_record *)(view->base + offset);
+        if (rec->prev != prev
+            || rec->size > view->length - offset
+            || listio_span(rec->size) > view->length - offset)
+            return -1;
+        if (rec->next == 0) {
+            if (offset != header->tail)
+                return -1;
+            break;
+        }
+        if (rec->next < 0 || (uint64_t)rec->next < listio_span(rec->size))
+            return -1;
+        prev = -rec->next;
+        offset += (uint64_t)rec->next;
+    }
+    return count == header->count ? 0 : -1;
+}
+
+// -----------------------------------------------------------------------------
+//                                  Accessors
+// -----------------------------------------------------------------------------
+
+enum listio_kind listio_view_get_kind(/*@notnull@*/
+                                      const struct listio_view *view) {
+    return (enum listio_kind)listio_header(view)->kind;
+}
+
+size_t listio_view_get_size(/*@notnull@*/ const struct listio_view *view) {
+    return (size_t)listio_header(view)->count;
+}
+
+/*@null@*/
+const struct listio_record* listio_view_get_head(/*@notnull@*/
+                                                 const struct listio_view *view) {
+    uint64_t head = listio_header(view)->head;
+
+    return head ? (const struct listio_record *)(view->base + head) : NULL;
+}
+
+/*@null@*/
+const struct listio_record* listio_view_get_tail(/*@notnull@*/
+                                                 const struct listio_view *view) {
+    uint64_t tail = listio_header(view)->tail;
+
+    return tail ? (const struct listio_record *)(view->base + tail) : NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Serialization
+// -----------------------------------------------------------------------------
+
+int listio_write(/*@notnull@*/ const char *path, enum listio_kind kind,
+                 /*@null@*/ void *head, /*@null@*/ const void *end,
+                 size_t data_offset,
+                 /*@notnull@*/ const struct listio_codec *codec) {
+    struct listio_header header;
+    struct listio_record rec = { 0, 0, 0 };
+    uint64_t offset = sizeof(header);
+    size_t cap = 256, size;
+    char *buf, *temp;
+    FILE *file = NULL;
+    int ok, fd = -1;
+
+    // The list is written to a temporary file beside path and renamed over it
+    // only once complete and on disk, so whatever was at path survives any
+    // failure, a crash included
+    memset(&header, 0, sizeof(header));
+    buf = malloc(cap);
+    temp = malloc(strlen(path) + sizeof(".XXXXXX"));
+    if (temp != NULL) {
+        strcpy(temp, path);
+        strcat(temp, ".XXXXXX");
+        fd = mkstemp(temp);
+    }
+    if (fd >= 0) {
+        file = fdopen(fd, "wb");
+        if (file == NULL)
+            close(fd);
+    }
+    ok = buf != NULL && file != NULL
+        && fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // Records are written back to back, so each one's next offset is its own
+    // span and its prev offset the span of the one before. Each goes out in
+    // one write, the record, data and padding laid out together in buf.
+    for (void *elem = head; ok && elem != end; elem = chain_next(elem)) {
+        size = listio_encode(codec, chain_data(elem, data_offset), &buf, &cap);
+        if (size == (size_t)-1) {
+            ok = 0;
+            break;
+        }
+        rec.prev = -rec.next;
+        rec.next = chain_next(elem) != end ? (int64_t)listio_span(size) : 0;
+        rec.size = size;
+        memcpy(buf, &rec, sizeof(rec));
+        memset(buf + sizeof(rec) + size, 0, LISTIO_ALIGN);
+        ok = fwrite(buf, listio_span(size), 1, file) == 1;
+        if (header.count++ == 0)
+            header.head = offset;
+        header.tail = offset;
+        offset += listio_span(size);
+        rec.next = (int64_t)listio_span(size);
+    }
+
+    memcpy(header.magic, LISTIO_MAGIC, sizeof(LISTIO_MAGIC));
+    header.byte_order = LISTIO_BYTE_ORDER;
+    header.version = LISTIO_VERSION;
+    header.kind = (uint16_t)kind;
+    header.length = offset;
+    ok = ok && fseek(file, 0, SEEK_SET) == 0
+        && fwrite(&header, sizeof(header), 1, file) == 1
+        && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (file != NULL && fclose(file) != 0)
+        ok = 0;
+    ok = ok && rename(temp, path) == 0;
+    if (ok)
+        listio_sync_dir(path);
+    else if (fd >= 0)
+        remove(temp);
+    free(temp);
+    free(buf);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,118 @@
+#include "listpar.h"
+#include "workpool.h"
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Elements are linked through their first member, as in pool_free_chain
+#define chain_next(elem) (*(void **)(elem))
+#define chain_data(elem, offset) (*(void **)((char *)(elem) + (offset)))
+
+// One parallel walk. chunks[i] is the first element of chunk i, and parts,
+// for a reduce, holds one accumulator per chunk.
+struct listpar_walk {
+    void **chunks;
+    size_t n;
+    size_t offset;
+    void (*fn)(void *data, void *arg);
+    void (*fold)(void *acc, void *data, void *arg);
+    char *parts;
+    size_t acc_size;
+    void *arg;
+};
+
+// Records the first element of every chunk in one pass
+//
+// @return The number of chunks, or 0 if they would not fit in memory
+static size_t listpar_index(/*@notnull@*/ struct listpar_walk *walk,
+                            /*@notnull@*/ void *head) {
+    size_t count = (walk->n + LISTPAR_CHUNK - 1) / LISTPAR_CHUNK, i = 0;
+
+    walk->chunks = malloc(count * sizeof(void *));
+    if (walk->chunks == NULL)
+        return 0;
+    for (size_t seen = 0; seen < walk->n; ++seen, head = chain_next(head))
+        if (seen % LISTPAR_CHUNK == 0)
+            walk->chunks[i++] = head;
+    return count;
+}
+
+static size_t listpar_chunk_len(/*@notnull@*/ const struct listpar_walk *walk,
+                                size_t index) {
+    size_t left = walk->n - index * LISTPAR_CHUNK;
+
+    return left < LISTPAR_CHUNK ? left : LISTPAR_CHUNK;
+}
+
+static void listpar_for_each_task(void *arg, size_t index, int worker) {
+    struct listpar_walk *walk = arg;
+    void *elem = walk->chunks[index];
+
+    (void)worker;
+    for (size_t i = listpar_chunk_len(walk, index); i > 0; --i) {
+        walk->fn(chain_data(elem, walk->offset), walk->arg);
+        elem = chain_next(elem);
+    }
+}
+
+static void listpar_reduce_task(void *arg, size_t index, int worker) {
+    struct listpar_walk *walk = arg;
+    void *elem = walk->chunks[index], *acc;
+
+    (void)worker;
+    acc = walk->parts + index * walk->acc_size;
+    for (size_t i = listpar_chunk_len(walk, index); i > 0; --i) {
+        walk->fold(acc, chain_data(elem, walk->offset), walk->arg);
+        elem = chain_next(elem);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+void listpar_for_each(void *head, size_t n, size_t data_offset,
+                      void (*fn)(void *data, void *arg), void *arg,
+                      struct workpool *workpool) {
+    struct listpar_walk walk = { NULL, n, data_offset, fn, NULL, NULL, 0,
+                                 arg };
+    size_t count;
+
+    if (workpool != NULL && n > LISTPAR_CHUNK
+        && (count = listpar_index(&walk, head)) > 0) {
+        workpool_run(workpool, count, listpar_for_each_task, &walk);
+        free(walk.chunks);
+        return;
+    }
+    for (; n > 0; --n, head = chain_next(head))
+        fn(chain_data(head, data_offset), arg);
+}
+
+void listpar_reduce(void *head, size_t n, size_t data_offset,
+                    void (*fold)(void *acc, void *data, void *arg),
+                    void (*combine)(void *acc, const void *part, void *arg),
+                    void *acc, size_t acc_size, void *arg,
+                    struct workpool *workpool) {
+    struct listpar_walk walk = { NULL, n, data_offset, NULL, fold, NULL,
+                                 acc_size, arg };
+    size_t count = 0;
+
+    if (workpool != NULL && n > LISTPAR_CHUNK
+        && (count = listpar_index(&walk, head)) > 0
+        && (walk.parts = malloc(count * acc_size)) != NULL) {
+        for (size_t i = 0; i < count; ++i)
+            memcpy(walk.parts + i * acc_size, acc, acc_size);
+        workpool_run(workpool, count, listpar_reduce_task, &walk);
+        for (size_t i = 0; i < count; ++i)
+            combine(acc, walk.parts + i * acc_size, arg);
+        free(walk.parts);
+        free(walk.chunks);
+        return;
+    }
+    free(walk.chunks);
+    for (; n > 0; --n, head = chain_next(head))
+        fold(acc, chain_data(head, data_offset), arg);
+}
@@ -0,0 +1,165 @@
+#include "listsort.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Elements are linked through their first member, as in pool_free_chain
+#define chain_next(elem) (*(void **)(elem))
+#define chain_data(elem, offset) (*(void **)((char *)(elem) + (offset)))
+
+// Enough bins for any chain that fits in memory
+#define LISTSORT_BINS 64
+
+// Merges two sorted chains. Ties go to a, which must hold the earlier
+// elements, so that the sort is stable.
+/*@null@*/
+static void* listsort_merge(/*@null@*/ void *a, /*@null@*/ void *b,
+                            size_t offset,
+                            /*@notnull@*/
+                            int (*cmp)(const void *a, const void *b)) {
+    void *head = NULL;
+    void **link = &head;
+
+    while (a != NULL && b != NULL) {
+        if (cmp(chain_data(a, offset), chain_data(b, offset)) <= 0) {
+            *link = a;
+            a = chain_next(a);
+        }
+        else {
+            *link = b;
+            b = chain_next(b);
+        }
+        link = &chain_next(*link);
+    }
+    *link = a ? a : b;
+    return head;
+}
+
+struct listsort_task {
+    void *a;
+    void *b;
+    size_t offset;
+    int (*cmp)(const void *a, const void *b);
+};
+
+/*@null@*/
+static void* listsort_sort_task(/*@notnull@*/ void *arg) {
+    struct listsort_task *task = arg;
+
+    task->a = listsort_chain(task->a, task->offset, task->cmp);
+    return NULL;
+}
+
+/*@null@*/
+static void* listsort_merge_task(/*@notnull@*/ void *arg) {
+    struct listsort_task *task = arg;
+
+    task->a = listsort_merge(task->a, task->b, task->offset, task->cmp);
+    return NULL;
+}
+
+// Runs fn over tasks, one thread each. Any task whose thread cannot be started
+// is run on the calling thread instead.
+static void listsort_run(/*@notnull@*/ struct listsort_task *tasks, int count,
+                         /*@notnull@*/ void* (*fn)(void *arg)) {
+    pthread_t threads[count];
+    int started[count];
+
+    for (int i = 0; i < count; ++i) {
+        started[i] = i > 0
+            && pthread_create(&threads[i], NULL, fn, &tasks[i]) == 0;
+        if (i > 0 && !started[i])
+            fn(&tasks[i]);
+    }
+    fn(&tasks[0]);
+    for (int i = 1; i < count; ++i)
+        if (started[i])
+            pthread_join(threads[i], NULL);
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+// Bottom-up: bin i holds a sorted run of 2^i elements, and runs in higher bins
+// are older. Each new element is carried up through the full bins like a
+// binary counter, then the leftovers are merged from the youngest up.
+/*@null@*/
+void* listsort_chain(/*@null@*/ void *head, size_t data_offset,
+                     /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    void *bins[LISTSORT_BINS] = { NULL };
+    void *run, *sorted = NULL;
+    int i, used = 0;
+
+    while (head != NULL) {
+        run = head;
+        head = chain_next(head);
+        chain_next(run) = NULL;
+
+        for (i = 0; i < LISTSORT_BINS - 1 && bins[i] != NULL; ++i) {
+            run = listsort_merge(bins[i], run, data_offset, cmp);
+            bins[i] = NULL;
+        }
+        if (bins[i] != NULL)
+            run = listsort_merge(bins[i], run, data_offset, cmp);
+        bins[i] = run;
+        if (i >= used)
+            used = i + 1;
+    }
+
+    for (i = 0; i < used; ++i)
+        if (bins[i] != NULL)
+            sorted = listsort_merge(bins[i], sorted, data_offset, cmp);
+    return sorted;
+}
+
+/*@null@*/
+void* listsort_chain_parallel(/*@null@*/ void *head, size_t data_offset,
+                              /*@notnull@*/
+                              int (*cmp)(const void *a, const void *b),
+                              int threads) {
+    long n = 0, per, i;
+    void *elem;
+    int runs;
+
+    for (elem = head; elem != NULL; elem = chain_next(elem))
+        n++;
+    if (threads > n / LISTSORT_PARALLEL_MIN)
+        threads = (int)(n / LISTSORT_PARALLEL_MIN);
+    if (threads < 2)
+        return listsort_chain(head, data_offset, cmp);
+
+    struct listsort_task tasks[threads];
+
+    // Cut the chain into equal runs and sort each on its own thread
+    per = n / threads;
+    elem = head;
+    for (runs = 0; runs < threads; ++runs) {
+        tasks[runs].a = elem;
+        tasks[runs].offset = data_offset;
+        tasks[runs].cmp = cmp;
+        if (runs == threads - 1)
+            break;
+        for (i = 1; i < per; ++i)
+            elem = chain_next(elem);
+        head = chain_next(elem);
+        chain_next(elem) = NULL;
+        elem = head;
+    }
+    listsort_run(tasks, threads, listsort_sort_task);
+
+    // Merge neighbouring runs in rounds, keeping them in order for stability
+    for (runs = threads; runs > 1; runs = (runs + 1) / 2) {
+        for (i = 0; i < runs / 2; ++i) {
+            tasks[i].a = tasks[2 * i].a;
+            tasks[i].b = tasks[2 * i + 1].a;
+        }
+        listsort_run(tasks, runs / 2, listsort_merge_task);
+        if (runs % 2)
+            tasks[runs / 2].a = tasks[runs - 1].a;
+    }
+    return tasks[0].a;
+}
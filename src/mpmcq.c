@@ -0,0 +1,125 @@
+#include "mpmcq.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+// A cell whose seq equals a producer's position is free for it to write; once
+// written its seq becomes position + 1, which is what the consumer at that
+// position waits for. The consumer then sets it a full lap ahead.
+
+int mpmcq_init(/*@out@*/ struct mpmcq *mpmcq, size_t capacity) {
+    size_t cap = 2;
+
+    while (cap < capacity) {
+        if (cap > SIZE_MAX / 2 / sizeof(struct mpmcq_cell))
+            return -1;
+        cap <<= 1;
+    }
+    mpmcq->buffer = malloc(cap * sizeof(struct mpmcq_cell));
+    if (mpmcq->buffer == NULL)
+        return -1;
+    for (size_t i = 0; i < cap; ++i)
+        atomic_init(&mpmcq->buffer[i].seq, i);
+    mpmcq->mask = cap - 1;
+    atomic_init(&mpmcq->head, 0);
+    atomic_init(&mpmcq->tail, 0);
+    return 0;
+}
+
+void mpmcq_destroy(/*@notnull@*/ struct mpmcq *mpmcq,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    void *data;
+
+    while (mpmcq_rem_head(mpmcq, &data) == 0)
+        if (destroy)
+            destroy(data);
+    free(mpmcq->buffer);
+    mpmcq->buffer = NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+size_t mpmcq_get_capacity(/*@notnull@*/ const struct mpmcq *mpmcq) {
+    return mpmcq->mask + 1;
+}
+
+size_t mpmcq_get_size(/*@notnull@*/ struct mpmcq *mpmcq) {
+    size_t head = atomic_load_explicit(&mpmcq->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&mpmcq->tail, memory_order_acquire);
+
+    // head is read first so tail can only be ahead of it, but producers may
+    // have lapped the ring in between
+    if (tail - head > mpmcq->mask + 1)
+        return mpmcq->mask + 1;
+    return tail - head;
+}
+
+int mpmcq_is_empty(/*@notnull@*/ struct mpmcq *mpmcq) {
+    return mpmcq_get_size(mpmcq) == 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int mpmcq_ins_tail(/*@notnull@*/ struct mpmcq *mpmcq,
+                   /*@null@*/ void *data) {
+    struct mpmcq_cell *cell;
+    size_t pos, seq;
+    intptr_t dif;
+
+    pos = atomic_load_explicit(&mpmcq->tail, memory_order_relaxed);
+    for (;;) {
+        cell = &mpmcq->buffer[pos & mpmcq->mask];
+        seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mpmcq->tail, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (dif < 0)
+            return -1;
+        else
+            pos = atomic_load_explicit(&mpmcq->tail, memory_order_relaxed);
+    }
+    cell->data = data;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return 0;
+}
+
+int mpmcq_rem_head(/*@notnull@*/ struct mpmcq *mpmcq,
+                   /*@notnull@*/ /*@out@*/ void **data) {
+    struct mpmcq_cell *cell;
+    size_t pos, seq;
+    intptr_t dif;
+
+    pos = atomic_load_explicit(&mpmcq->head, memory_order_relaxed);
+    for (;;) {
+        cell = &mpmcq->buffer[pos & mpmcq->mask];
+        seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mpmcq->head, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (dif < 0)
+            return -1;
+        else
+            pos = atomic_load_explicit(&mpmcq->head, memory_order_relaxed);
+    }
+    *data = cell->data;
+    atomic_store_explicit(&cell->seq, pos + mpmcq->mask + 1,
+                          memory_order_release);
+    return 0;
+}
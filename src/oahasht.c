@@ -0,0 +1,357 @@
+#include "oahasht.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) && !defined(STRUCTURES_NO_SIMD)
+#include <emmintrin.h>
+#endif
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Control byte values. A full slot holds the low seven bits of its hash, so
+// the sign bit alone tells full slots from the rest.
+#define CTRL_EMPTY   ((signed char)-128)
+#define CTRL_DELETED ((signed char)-2)
+
+static unsigned oahasht_ctz(uint64_t x) {
+#ifdef __GNUC__
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+
+    for (; !(x & 1); x >>= 1)
+        n++;
+    return n;
+#endif
+}
+
+static unsigned oahasht_clz(uint64_t x) {
+#ifdef __GNUC__
+    return (unsigned)__builtin_clzll(x);
+#else
+    unsigned n = 0;
+
+    for (; !(x & 0x8000000000000000u); x <<= 1)
+        n++;
+    return n;
+#endif
+}
+
+// A group is the run of control bytes examined at once. Each match returns a
+// mask of the bytes in the group that match; group_index turns the lowest set
+// bit into an offset within the group. The clones of the first GROUP_WIDTH - 1
+// control bytes kept past the end let a group start at any slot.
+#if defined(__SSE2__) && !defined(STRUCTURES_NO_SIMD)
+
+#define GROUP_WIDTH 16
+#define GROUP_SHIFT 0
+
+static __m128i group_load(const signed char *ctrl) {
+    return _mm_loadu_si128((const __m128i *)(const void *)ctrl);
+}
+
+static uint64_t group_match(const signed char *ctrl, signed char h2) {
+    return (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group_load(ctrl),
+                                                      _mm_set1_epi8(h2)));
+}
+
+static uint64_t group_match_empty(const signed char *ctrl) {
+    return group_match(ctrl, CTRL_EMPTY);
+}
+
+static uint64_t group_match_free(const signed char *ctrl) {
+    return (uint64_t)_mm_movemask_epi8(group_load(ctrl));
+}
+
+#define group_leading(mask) (oahasht_clz(mask) - (64 - GROUP_WIDTH))
+
+#else
+
+// Eight control bytes at a time in a 64 bit word. group_match may report a
+// false positive next to a true one, so callers check the byte itself.
+#define GROUP_WIDTH 8
+#define GROUP_SHIFT 3
+#define GROUP_LSBS 0x0101010101010101u
+#define GROUP_MSBS 0x8080808080808080u
+
+static uint64_t group_load(const signed char *ctrl) {
+    uint64_t word = 0;
+
+    for (int i = 0; i < GROUP_WIDTH; ++i)
+        word |= (uint64_t)(unsigned char)ctrl[i] << (8 * i);
+    return word;
+}
+
+static uint64_t group_match(const signed char *ctrl, signed char h2) {
+    uint64_t x = group_load(ctrl) ^ (GROUP_LSBS * (unsigned char)h2);
+
+    return (x - GROUP_LSBS) & ~x & GROUP_MSBS;
+}
+
+// Empty is the only value with the sign bit set and bit 1 clear
+static uint64_t group_match_empty(const signed char *ctrl) {
+    uint64_t word = group_load(ctrl);
+
+    return word & ~(word << 6) & GROUP_MSBS;
+}
+
+static uint64_t group_match_free(const signed char *ctrl) {
+    return group_load(ctrl) & GROUP_MSBS;
+}
+
+#define group_leading(mask) (oahasht_clz(mask) >> GROUP_SHIFT)
+
+#endif
+
+#define group_index(mask) (oahasht_ctz(mask) >> GROUP_SHIFT)
+#define group_trailing(mask) group_index(mask)
+
+// Spreads the user's hash over every bit, so that weak hashes such as
+// hash_ptr still give independent h1 and h2 values
+static uint64_t oahasht_mix(const struct oahasht *oahasht, const void *key) {
+    uint64_t hash = (uint64_t)oahasht->hash(key) * 0x9e3779b97f4a7c15u;
+
+    return hash ^ (hash >> 32);
+}
+
+#define hash_h1(hash) ((size_t)((hash) >> 7))
+#define hash_h2(hash) ((signed char)((hash) & 0x7f))
+
+// The most entries a table of the given capacity may hold: seven eighths
+#define oahasht_max_load(capacity) ((capacity) - (capacity) / 8)
+
+static void oahasht_set_ctrl(/*@notnull@*/ struct oahasht *oahasht,
+                             size_t index, signed char value) {
+    oahasht->ctrl[index] = value;
+    if (index < GROUP_WIDTH - 1)
+        oahasht->ctrl[oahasht->capacity + index] = value;
+}
+
+// Returns the first empty or deleted slot on the probe sequence for hash
+static size_t oahasht_find_free(/*@notnull@*/ const struct oahasht *oahasht,
+                                uint64_t hash) {
+    size_t mask = oahasht->capacity - 1;
+    size_t pos = hash_h1(hash) & mask;
+    uint64_t match;
+
+    for (size_t step = GROUP_WIDTH; ; step += GROUP_WIDTH) {
+        match = group_match_free(oahasht->ctrl + pos);
+        if (match)
+            return (pos + group_index(match)) & mask;
+        pos = (pos + step) & mask;
+    }
+}
+
+// Moves every entry into a fresh table of the given capacity, dropping all
+// tombstones on the way
+static int oahasht_rehash(/*@notnull@*/ struct oahasht *oahasht,
+                          size_t capacity) {
+    struct oahasht old = *oahasht;
+    size_t index;
+    uint64_t hash;
+    void *mem;
+
+    if (capacity > (SIZE_MAX - GROUP_WIDTH)
+                   / (sizeof(struct oahasht_slot) + 1))
+        return -1;
+    mem = malloc(capacity * sizeof(struct oahasht_slot)
+                 + capacity + GROUP_WIDTH);
+    if (mem == NULL)
+        return -1;
+
+    oahasht->slots = mem;
+    oahasht->ctrl = (signed char *)(oahasht->slots + capacity);
+    oahasht->capacity = capacity;
+    memset(oahasht->ctrl, (unsigned char)CTRL_EMPTY, capacity + GROUP_WIDTH);
+
+    for (size_t i = 0; i < old.capacity; ++i) {
+        if (old.ctrl[i] < 0)
+            continue;
+        hash = oahasht_mix(oahasht, old.slots[i].key);
+        index = oahasht_find_free(oahasht, hash);
+        oahasht_set_ctrl(oahasht, index, hash_h2(hash));
+        oahasht->slots[index] = old.slots[i];
+    }
+    oahasht->growth_left = oahasht_max_load(capacity) - oahasht->size;
+    free(old.slots);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void oahasht_init(/*@out@*/ struct oahasht *oahasht,
+                  /*@notnull@*/ size_t (*hash)(const void *key),
+                  /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    oahasht->slots = NULL;
+    oahasht->ctrl = NULL;
+    oahasht->capacity = 0;
+    oahasht->size = 0;
+    oahasht->growth_left = 0;
+    oahasht->hash = hash;
+    oahasht->cmp = cmp;
+}
+
+void oahasht_destroy(/*@notnull@*/ struct oahasht *oahasht,
+                     /*@null@*/ void (*destroy)(void *data)) {
+    if (destroy != NULL)
+        oahasht_for_each(oahasht, slot)
+            destroy(slot->data);
+    free(oahasht->slots);
+    oahasht_init(oahasht, oahasht->hash, oahasht->cmp);
+}
+
+int oahasht_reserve(/*@notnull@*/ struct oahasht *oahasht, size_t count) {
+    size_t capacity = GROUP_WIDTH;
+
+    while (oahasht_max_load(capacity) < count) {
+        if (capacity > SIZE_MAX / 2)
+            return -1;
+        capacity *= 2;
+    }
+    if (capacity <= oahasht->capacity)
+        return 0;
+    return oahasht_rehash(oahasht, capacity);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct oahasht_slot* oahasht_find(/*@notnull@*/ const struct oahasht *oahasht,
+                                  /*@null@*/ const void *key) {
+    size_t mask, pos, index;
+    uint64_t hash, match;
+    signed char h2;
+
+    if (oahasht->size == 0)
+        return NULL;
+
+    hash = oahasht_mix(oahasht, key);
+    h2 = hash_h2(hash);
+    mask = oahasht->capacity - 1;
+    pos = hash_h1(hash) & mask;
+    for (size_t step = GROUP_WIDTH; ; step += GROUP_WIDTH) {
+        for (match = group_match(oahasht->ctrl + pos, h2); match;
+             match &= match - 1) {
+            index = (pos + group_index(match)) & mask;
+            if (oahasht->ctrl[index] == h2
+                && oahasht->cmp(oahasht->slots[index].key, key) == 0)
+                return &oahasht->slots[index];
+        }
+        // Insertion would have used an empty slot here, so key is absent
+        if (group_match_empty(oahasht->ctrl + pos))
+            return NULL;
+        pos = (pos + step) & mask;
+    }
+}
+
+/*@null@*/
+void* oahasht_get(/*@notnull@*/ const struct oahasht *oahasht,
+                  /*@null@*/ const void *key) {
+    struct oahasht_slot *slot;
+
+    slot = oahasht_find(oahasht, key);
+    return slot ? slot->data : NULL;
+}
+
+size_t oahasht_get_size(/*@notnull@*/ const struct oahasht *oahasht) {
+    return oahasht->size;
+}
+
+int oahasht_is_empty(/*@notnull@*/ const struct oahasht *oahasht) {
+    return oahasht->size == 0;
+}
+
+/*@null@*/
+struct oahasht_slot* oahasht_first(/*@notnull@*/ const struct oahasht *oahasht) {
+    for (size_t i = 0; i < oahasht->capacity; ++i)
+        if (oahasht->ctrl[i] >= 0)
+            return &oahasht->slots[i];
+    return NULL;
+}
+
+/*@null@*/
+struct oahasht_slot* oahasht_next(/*@notnull@*/ const struct oahasht *oahasht,
+                                  /*@notnull@*/ const struct oahasht_slot *slot) {
+    for (size_t i = (size_t)(slot - oahasht->slots) + 1;
+         i < oahasht->capacity; ++i)
+        if (oahasht->ctrl[i] >= 0)
+            return &oahasht->slots[i];
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int oahasht_ins(/*@notnull@*/ struct oahasht *oahasht,
+                /*@null@*/ void *key,
+                /*@null@*/ void *data) {
+    size_t index, capacity;
+    uint64_t hash;
+
+    if (oahasht_find(oahasht, key) != NULL)
+        return -1;
+
+    hash = oahasht_mix(oahasht, key);
+    index = oahasht->capacity ? oahasht_find_free(oahasht, hash) : 0;
+    if (oahasht->capacity == 0
+        || (oahasht->growth_left == 0 && oahasht->ctrl[index] == CTRL_EMPTY)) {
+        // Out of room. Double unless most of the load is tombstones, in which
+        // case rebuilding at the same size is enough
+        capacity = oahasht->capacity;
+        if (capacity == 0)
+            capacity = GROUP_WIDTH;
+        else if (oahasht->size >= oahasht_max_load(capacity) / 2)
+            capacity *= 2;
+        if (oahasht_rehash(oahasht, capacity) != 0)
+            return -1;
+        index = oahasht_find_free(oahasht, hash);
+    }
+
+    if (oahasht->ctrl[index] == CTRL_EMPTY)
+        oahasht->growth_left--;
+    oahasht_set_ctrl(oahasht, index, hash_h2(hash));
+    oahasht->slots[index].key = key;
+    oahasht->slots[index].data = data;
+    oahasht->size++;
+    return 0;
+}
+
+int oahasht_rem(/*@notnull@*/ struct oahasht *oahasht,
+                /*@null@*/ const void *key,
+                /*@null@*/ void (*destroy)(void *data)) {
+    struct oahasht_slot *slot;
+    size_t index, before;
+    uint64_t empty_before, empty_after;
+
+    slot = oahasht_find(oahasht, key);
+    if (slot == NULL)
+        return -1;
+    index = (size_t)(slot - oahasht->slots);
+    before = (index - GROUP_WIDTH) & (oahasht->capacity - 1);
+
+    // If no window of GROUP_WIDTH slots through this one was ever entirely
+    // full, no probe can have passed over it and it may become empty again
+    empty_before = group_match_empty(oahasht->ctrl + before);
+    empty_after = group_match_empty(oahasht->ctrl + index);
+    if (empty_before && empty_after
+        && group_leading(empty_before) + group_trailing(empty_after)
+           < GROUP_WIDTH) {
+        oahasht_set_ctrl(oahasht, index, CTRL_EMPTY);
+        oahasht->growth_left++;
+    }
+    else
+        oahasht_set_ctrl(oahasht, index, CTRL_DELETED);
+
+    oahasht->size--;
+    if (destroy != NULL)
+        destroy(slot->data);
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "pool.h"
+#include <stdlib.h>
+
+#define POOL_DEFAULT_CHUNK_ELEMS 1024
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void pool_init(/*@out@*/ struct pool *pool,
+               size_t elem_size,
+               size_t chunk_elems) {
+    // Every element must be able to hold a free list link, and rounding up to
+    // a multiple of the pointer size keeps every element pointer aligned.
+    if (elem_size < sizeof(void *))
+        elem_size = sizeof(void *);
+    elem_size = (elem_size + sizeof(void *) - 1) / sizeof(void *)
+        * sizeof(void *);
+
+    pool->chunks = NULL;
+    pool->free = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->elem_size = elem_size;
+    pool->chunk_elems = chunk_elems ? chunk_elems : POOL_DEFAULT_CHUNK_ELEMS;
+}
+
+void pool_destroy(/*@notnull@*/ struct pool *pool) {
+    struct pool_chunk *chunk;
+
+    while (pool->chunks != NULL) {
+        chunk = pool->chunks;
+        pool->chunks = chunk->next;
+        free(chunk);
+    }
+    pool->free = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+void* pool_alloc(/*@notnull@*/ struct pool *pool) {
+    struct pool_chunk *chunk;
+    void *elem;
+
+    if (pool->free != NULL) {
+        elem = pool->free;
+        pool->free = *(void **)elem;
+        return elem;
+    }
+
+    if (pool->next == pool->end) {
+        chunk = malloc(sizeof(struct pool_chunk)
+                       + pool->elem_size * pool->chunk_elems);
+        if (chunk == NULL)
+            return NULL;
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        pool->next = (char *)(chunk + 1);
+        pool->end = pool->next + pool->elem_size * pool->chunk_elems;
+    }
+
+    elem = pool->next;
+    pool->next += pool->elem_size;
+    return elem;
+}
+
+/*@null@*/
+void* pool_alloc_chain(/*@notnull@*/ struct pool *pool, size_t n) {
+    struct pool_chunk *chunk = NULL;
+    size_t avail, chunk_elems = 0;
+    void *first = NULL, **link = &first;
+
+    for (; n > 0 && pool->free != NULL; --n) {
+        *link = pool->free;
+        link = pool->free;
+        pool->free = *(void **)pool->free;
+    }
+
+    // Allocate before carving anything, so that failure can hand back just
+    // what came off the free list
+    avail = (size_t)(pool->end - pool->next) / pool->elem_size;
+    if (n > avail) {
+        chunk_elems = n - avail > pool->chunk_elems ? n - avail
+                                                    : pool->chunk_elems;
+        chunk = malloc(sizeof(struct pool_chunk)
+                       + pool->elem_size * chunk_elems);
+        if (chunk == NULL) {
+            if (first != NULL) {
+                *link = pool->free;
+                pool->free = first;
+            }
+            return NULL;
+        }
+    }
+
+    for (; n > 0; --n) {
+        if (pool->next == pool->end) {
+            chunk->next = pool->chunks;
+            pool->chunks = chunk;
+            pool->next = (char *)(chunk + 1);
+            pool->end = pool->next + pool->elem_size * chunk_elems;
+        }
+        *link = pool->next;
+        link = (void **)pool->next;
+        pool->next += pool->elem_size;
+    }
+    return first;
+}
+
+void pool_free(/*@notnull@*/ struct pool *pool,
+               /*@notnull@*/ void *elem) {
+    *(void **)elem = pool->free;
+    pool->free = elem;
+}
+
+void pool_free_chain(/*@notnull@*/ struct pool *pool,
+                     /*@notnull@*/ void *first,
+                     /*@notnull@*/ void *last) {
+    *(void **)last = pool->free;
+    pool->free = first;
+}
@@ -0,0 +1,65 @@
+#include "pqueue.h"
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void pqueue_init(/*@out@*/ struct pqueue *pqueue,
+                 /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    heap_init(&pqueue->heap, cmp);
+}
+
+void pqueue_destroy(/*@notnull@*/ struct pqueue *pqueue,
+                    /*@null@*/ void (*destroy)(void *data)) {
+    heap_destroy(&pqueue->heap, destroy);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+size_t pqueue_get_size(/*@notnull@*/ const struct pqueue *pqueue) {
+    return heap_get_size(&pqueue->heap);
+}
+
+int pqueue_is_empty(/*@notnull@*/ const struct pqueue *pqueue) {
+    return heap_is_empty(&pqueue->heap);
+}
+
+/*@null@*/
+void* pqueue_peek(/*@notnull@*/ const struct pqueue *pqueue) {
+    struct heap_elem *top = heap_get_top(&pqueue->heap);
+
+    return top ? top->data : NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct heap_elem* pqueue_push(/*@notnull@*/ struct pqueue *pqueue,
+                              /*@null@*/ void *data) {
+    return heap_ins(&pqueue->heap, data);
+}
+
+/*@null@*/
+void* pqueue_pop(/*@notnull@*/ struct pqueue *pqueue) {
+    struct heap_elem *top = heap_get_top(&pqueue->heap);
+
+    return top ? pqueue_remove(pqueue, top) : NULL;
+}
+
+void pqueue_update(/*@notnull@*/ struct pqueue *pqueue,
+                   /*@notnull@*/ struct heap_elem *elem) {
+    heap_update(&pqueue->heap, elem);
+}
+
+/*@null@*/
+void* pqueue_remove(/*@notnull@*/ struct pqueue *pqueue,
+                    /*@notnull@*/ struct heap_elem *elem) {
+    void *data = elem->data;
+
+    heap_rem_elem(&pqueue->heap, elem, NULL);
+    return data;
+}
@@ -0,0 +1,23 @@
+#include "prefetch.h"
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Elements are linked through their first member, as in pool_free_chain
+#define chain_next(elem) (*(void **)(elem))
+#define chain_data(elem, offset) (*(void **)((char *)(elem) + (offset)))
+
+// -----------------------------------------------------------------------------
+//                                 Traversal
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+void* prefetch_ahead(/*@null@*/ void *elem, /*@null@*/ const void *end,
+                     size_t data_offset, int distance) {
+    for (; distance > 0 && elem != end; --distance) {
+        structures_prefetch(chain_data(elem, data_offset));
+        elem = chain_next(elem);
+    }
+    return elem;
+}
@@ -0,0 +1,135 @@
+#include "queue.h"
+#include "cdlist.h"
+#include "list.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define QUEUE_MIN_CAPACITY 16
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#define queue_slot(queue, i) ((queue)->items[((queue)->head + (i))         \
+                                             & ((queue)->capacity - 1)])
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void queue_init(/*@out@*/ struct queue *queue) {
+    queue->items = NULL;
+    queue->head = 0;
+    queue->size = 0;
+    queue->capacity = 0;
+}
+
+void queue_destroy(/*@notnull@*/ struct queue *queue,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    if (destroy != NULL)
+        queue_for_each(queue, item)
+            destroy(*item);
+    free(queue->items);
+    queue_init(queue);
+}
+
+int queue_reserve(/*@notnull@*/ struct queue *queue,
+                  size_t count) {
+    void **items;
+    size_t capacity, wrapped;
+
+    if (count <= queue->capacity)
+        return 0;
+
+    capacity = queue->capacity ? queue->capacity : QUEUE_MIN_CAPACITY;
+    while (capacity < count)
+        capacity *= 2;
+
+    items = realloc(queue->items, capacity * sizeof(*items));
+    if (items == NULL)
+        return -1;
+
+    // Elements that had wrapped round to the start of the old ring move to
+    // just past its end, where the bigger ring expects them
+    if (queue->head + queue->size > queue->capacity) {
+        wrapped = queue->head + queue->size - queue->capacity;
+        memcpy(&items[queue->capacity], items, wrapped * sizeof(*items));
+    }
+    queue->items = items;
+    queue->capacity = capacity;
+    return 0;
+}
+
+int queue_from_list(/*@notnull@*/ struct queue *queue,
+                    /*@notnull@*/ const struct list *list) {
+    size_t size = queue->size;
+
+    if (queue_reserve(queue, size + (size_t)list_get_size(list)) != 0)
+        return -1;
+    list_for_each(list, elem)
+        queue_slot(queue, size++) = elem->data;
+    queue->size = size;
+    return 0;
+}
+
+int queue_from_cdlist(/*@notnull@*/ struct queue *queue,
+                      /*@notnull@*/ const struct cdlist *cdlist) {
+    size_t size = queue->size;
+
+    if (queue_reserve(queue, size + (size_t)cdlist_get_size(cdlist)) != 0)
+        return -1;
+    cdlist_for_each(cdlist, elem)
+        queue_slot(queue, size++) = elem->data;
+    queue->size = size;
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+size_t queue_get_size(/*@notnull@*/ const struct queue *queue) {
+    return queue->size;
+}
+
+int queue_is_empty(/*@notnull@*/ const struct queue *queue) {
+    return queue->size == 0;
+}
+
+/*@null@*/
+void* queue_peek(/*@notnull@*/ const struct queue *queue) {
+    return queue->size ? queue->items[queue->head] : NULL;
+}
+
+/*@null@*/
+void** queue_next(/*@notnull@*/ const struct queue *queue,
+                  /*@notnull@*/ void **pos) {
+    if (++pos == queue->items + queue->capacity)
+        pos = queue->items;
+    return pos == &queue_slot(queue, queue->size) ? NULL : pos;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int queue_push(/*@notnull@*/ struct queue *queue,
+               /*@null@*/ void *data) {
+    if (queue->size == queue->capacity
+        && queue_reserve(queue, queue->size + 1) != 0)
+        return -1;
+    queue_slot(queue, queue->size) = data;
+    queue->size++;
+    return 0;
+}
+
+int queue_pop(/*@notnull@*/ struct queue *queue,
+              /*@null@*/ /*@out@*/ void **data) {
+    if (queue->size == 0)
+        return -1;
+    if (data != NULL)
+        *data = queue->items[queue->head];
+    queue->head = (queue->head + 1) & (queue->capacity - 1);
+    queue->size--;
+    return 0;
+}
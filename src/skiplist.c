@@ -0,0 +1,290 @@
+#include "skiplist.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define load_relaxed(p) atomic_load_explicit(p, memory_order_relaxed)
+#define load_acquire(p) atomic_load_explicit(p, memory_order_acquire)
+#define store_relaxed(p, v) atomic_store_explicit(p, v, memory_order_relaxed)
+#define store_release(p, v) atomic_store_explicit(p, v, memory_order_release)
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+static struct skiplist_elem* skiplist_elem_alloc(int height) {
+    struct skiplist_elem *elem;
+
+    elem = malloc(sizeof(struct skiplist_elem)
+                  + (size_t)height * sizeof(elem->next[0]));
+    if (elem == NULL)
+        return NULL;
+    elem->height = height;
+    elem->retired = NULL;
+    elem->destroy = NULL;
+    for (int i = 0; i < height; ++i)
+        store_relaxed(&elem->next[i], NULL);
+    store_relaxed(&elem->prev, NULL);
+    return elem;
+}
+
+// Picks the height of a new element: each extra level with probability 1/4,
+// which keeps searches short while averaging 1.33 links per element. Called
+// with the lock held, as the seed is shared.
+static int skiplist_random_height(/*@notnull@*/ struct skiplist *skiplist) {
+    unsigned long x = skiplist->seed;
+    int height = 1;
+
+    // xorshift64*
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    skiplist->seed = x;
+    x *= 0x2545F4914F6CDD1DUL;
+    for (x >>= 16; (x & 3) == 0 && height < SKIPLIST_MAX_LEVEL; x >>= 2)
+        ++height;
+    return height;
+}
+
+// Walks down from the top level, recording in preds the last element at each
+// level that orders before key. Returns the candidate at the bottom level.
+/*@null@*/
+static struct skiplist_elem* skiplist_search(/*@notnull@*/ const struct skiplist *skiplist,
+                                             /*@null@*/ const void *key,
+                                             /*@null@*/ struct skiplist_elem **preds) {
+    struct skiplist_elem *x = skiplist->head, *next = NULL;
+
+    for (int level = load_relaxed(&skiplist->level) - 1; level >= 0; --level) {
+        while ((next = load_acquire(&x->next[level])) != NULL
+               && skiplist->cmp(next->data, key) < 0)
+            x = next;
+        if (preds != NULL)
+            preds[level] = x;
+    }
+    return next;
+}
+
+static void skiplist_elem_free(/*@notnull@*/ struct skiplist_elem *elem,
+                               /*@null@*/ void (*destroy)(void *data)) {
+    if (destroy != NULL)
+        destroy(elem->data);
+    free(elem);
+}
+
+static void skiplist_free_retired(/*@notnull@*/ struct skiplist *skiplist,
+                                  unsigned epoch) {
+    struct skiplist_elem *elem;
+
+    while ((elem = skiplist->retired[epoch & 1]) != NULL) {
+        skiplist->retired[epoch & 1] = elem->retired;
+        skiplist_elem_free(elem, elem->destroy);
+    }
+}
+
+// Moves the epoch on from e to e + 1 if every reader that started in e - 1 has
+// left, and frees the elements removed in e - 1. Every reader that started
+// before they were unlinked started in e - 2 or e - 1, and those of e - 2 were
+// gone before the epoch reached e. Called with the lock held. The fence pairs
+// with the one in skiplist_read_begin: a reader either shows up in the count
+// here or sees the new epoch and counts itself in that instead. The acquire
+// pairs with skiplist_read_end, so readers that have left are done with the
+// elements before they are freed.
+static void skiplist_reclaim(/*@notnull@*/ struct skiplist *skiplist) {
+    unsigned epoch = load_relaxed(&skiplist->epoch);
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (load_acquire(&skiplist->readers[(epoch + 1) & 1]) != 0)
+        return;
+    skiplist_free_retired(skiplist, epoch + 1);
+    store_release(&skiplist->epoch, epoch + 1);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+int skiplist_init(/*@out@*/ struct skiplist *skiplist,
+                  /*@notnull@*/ int (*cmp)(const void *a, const void *b)) {
+    skiplist->head = skiplist_elem_alloc(SKIPLIST_MAX_LEVEL);
+    if (skiplist->head == NULL)
+        return -1;
+    if (pthread_mutex_init(&skiplist->lock, NULL) != 0) {
+        free(skiplist->head);
+        return -1;
+    }
+    skiplist->head->data = NULL;
+    store_relaxed(&skiplist->tail, NULL);
+    store_relaxed(&skiplist->level, 1);
+    store_relaxed(&skiplist->size, 0);
+    skiplist->cmp = cmp;
+    skiplist->retired[0] = skiplist->retired[1] = NULL;
+    skiplist->seed = (unsigned long)(uintptr_t)skiplist | 1;
+    store_relaxed(&skiplist->epoch, 0);
+    store_relaxed(&skiplist->readers[0], 0);
+    store_relaxed(&skiplist->readers[1], 0);
+    return 0;
+}
+
+void skiplist_destroy(/*@notnull@*/ struct skiplist *skiplist,
+                      /*@null@*/ void (*destroy)(void *data)) {
+    struct skiplist_elem *elem, *next;
+
+    for (elem = load_relaxed(&skiplist->head->next[0]); elem; elem = next) {
+        next = load_relaxed(&elem->next[0]);
+        skiplist_elem_free(elem, destroy);
+    }
+    skiplist_free_retired(skiplist, 0);
+    skiplist_free_retired(skiplist, 1);
+    free(skiplist->head);
+    skiplist->head = NULL;
+    pthread_mutex_destroy(&skiplist->lock);
+}
+
+// -----------------------------------------------------------------------------
+//                                  Readers
+// -----------------------------------------------------------------------------
+
+// A reader that counted itself in an epoch the writers have already moved on
+// from takes itself back out and tries again, so a writer that found the old
+// epoch's count at zero can rely on it staying there.
+unsigned skiplist_read_begin(/*@notnull@*/ struct skiplist *skiplist) {
+    unsigned epoch = load_relaxed(&skiplist->epoch), now;
+
+    for (;;) {
+        atomic_fetch_add_explicit(&skiplist->readers[epoch & 1], 1,
+                                  memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        now = load_acquire(&skiplist->epoch);
+        if (now == epoch)
+            return epoch;
+        atomic_fetch_sub_explicit(&skiplist->readers[epoch & 1], 1,
+                                  memory_order_relaxed);
+        epoch = now;
+    }
+}
+
+void skiplist_read_end(/*@notnull@*/ struct skiplist *skiplist,
+                       unsigned epoch) {
+    atomic_fetch_sub_explicit(&skiplist->readers[epoch & 1], 1,
+                              memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct skiplist_elem* skiplist_get_head(/*@notnull@*/ const struct skiplist *skiplist) {
+    return load_acquire(&skiplist->head->next[0]);
+}
+
+/*@null@*/
+struct skiplist_elem* skiplist_get_tail(/*@notnull@*/ const struct skiplist *skiplist) {
+    return load_acquire(&skiplist->tail);
+}
+
+size_t skiplist_get_size(/*@notnull@*/ const struct skiplist *skiplist) {
+    return load_relaxed(&skiplist->size);
+}
+
+int skiplist_is_empty(/*@notnull@*/ const struct skiplist *skiplist) {
+    return skiplist_get_head(skiplist) == NULL;
+}
+
+/*@null@*/
+struct skiplist_elem* skiplist_find(/*@notnull@*/ const struct skiplist *skiplist,
+                                    /*@null@*/ const void *key) {
+    struct skiplist_elem *elem = skiplist_search(skiplist, key, NULL);
+
+    return elem && skiplist->cmp(elem->data, key) == 0 ? elem : NULL;
+}
+
+/*@null@*/
+struct skiplist_elem* skiplist_lower_bound(/*@notnull@*/ const struct skiplist *skiplist,
+                                           /*@null@*/ const void *key) {
+    return skiplist_search(skiplist, key, NULL);
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int skiplist_ins(/*@notnull@*/ struct skiplist *skiplist,
+                 /*@null@*/ void *data) {
+    struct skiplist_elem *preds[SKIPLIST_MAX_LEVEL];
+    struct skiplist_elem *elem, *next;
+    int height, level;
+
+    pthread_mutex_lock(&skiplist->lock);
+    next = skiplist_search(skiplist, data, preds);
+    if (next != NULL && skiplist->cmp(next->data, data) == 0)
+        goto fail;
+
+    height = skiplist_random_height(skiplist);
+    elem = skiplist_elem_alloc(height);
+    if (elem == NULL)
+        goto fail;
+    elem->data = data;
+    level = load_relaxed(&skiplist->level);
+    for (; level < height; ++level)
+        preds[level] = skiplist->head;
+
+    // The element is private until the first release store below, so its own
+    // links need no ordering. Linking bottom-up means a reader that finds it
+    // on an express level can always follow it down.
+    for (int i = 0; i < height; ++i)
+        store_relaxed(&elem->next[i], load_relaxed(&preds[i]->next[i]));
+    store_relaxed(&elem->prev,
+                  preds[0] == skiplist->head ? NULL : preds[0]);
+    for (int i = 0; i < height; ++i)
+        store_release(&preds[i]->next[i], elem);
+    if (next != NULL)
+        store_release(&next->prev, elem);
+    else
+        store_release(&skiplist->tail, elem);
+    if (height > load_relaxed(&skiplist->level))
+        store_relaxed(&skiplist->level, height);
+    atomic_fetch_add_explicit(&skiplist->size, 1, memory_order_relaxed);
+    skiplist_reclaim(skiplist);
+    pthread_mutex_unlock(&skiplist->lock);
+    return 0;
+
+fail:
+    pthread_mutex_unlock(&skiplist->lock);
+    return -1;
+}
+
+int skiplist_rem(/*@notnull@*/ struct skiplist *skiplist,
+                 /*@null@*/ const void *key,
+                 /*@null@*/ void (*destroy)(void *data)) {
+    struct skiplist_elem *preds[SKIPLIST_MAX_LEVEL];
+    struct skiplist_elem *elem, *next;
+    unsigned epoch;
+
+    pthread_mutex_lock(&skiplist->lock);
+    elem = skiplist_search(skiplist, key, preds);
+    if (elem == NULL || skiplist->cmp(elem->data, key) != 0) {
+        pthread_mutex_unlock(&skiplist->lock);
+        return -1;
+    }
+
+    // Unlinking top-down keeps the element reachable from the bottom level
+    // for as long as it is on any level above. Its own links are left intact
+    // for readers already standing on it.
+    for (int i = elem->height - 1; i >= 0; --i)
+        store_release(&preds[i]->next[i], load_relaxed(&elem->next[i]));
+    next = load_relaxed(&elem->next[0]);
+    if (next != NULL)
+        store_release(&next->prev, load_relaxed(&elem->prev));
+    else
+        store_release(&skiplist->tail, load_relaxed(&elem->prev));
+    atomic_fetch_sub_explicit(&skiplist->size, 1, memory_order_relaxed);
+
+    epoch = load_relaxed(&skiplist->epoch);
+    elem->destroy = destroy;
+    elem->retired = skiplist->retired[epoch & 1];
+    skiplist->retired[epoch & 1] = elem;
+    skiplist_reclaim(skiplist);
+    pthread_mutex_unlock(&skiplist->lock);
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "spscq.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define load_relaxed(p) atomic_load_explicit(p, memory_order_relaxed)
+#define load_acquire(p) atomic_load_explicit(p, memory_order_acquire)
+#define store_release(p, v) atomic_store_explicit(p, v, memory_order_release)
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// head and tail count every element ever removed and inserted, so tail - head
+// is the size even after they wrap. The producer's release store of tail
+// publishes the slots it wrote; the consumer's release store of head hands
+// slots back once it has read them.
+
+// Copies n pointers between the ring, starting at index pos, and a flat
+// array, splitting the copy where the ring wraps
+static void spscq_copy_in(/*@notnull@*/ struct spscq *spscq, size_t pos,
+                          /*@notnull@*/ void *const *data, size_t n) {
+    size_t i = pos & spscq->mask, first = spscq->mask + 1 - i;
+
+    if (first > n)
+        first = n;
+    memcpy(&spscq->buffer[i], data, first * sizeof(void *));
+    memcpy(spscq->buffer, data + first, (n - first) * sizeof(void *));
+}
+
+static void spscq_copy_out(/*@notnull@*/ const struct spscq *spscq,
+                           size_t pos, /*@notnull@*/ void **data, size_t n) {
+    size_t i = pos & spscq->mask, first = spscq->mask + 1 - i;
+
+    if (first > n)
+        first = n;
+    memcpy(data, &spscq->buffer[i], first * sizeof(void *));
+    memcpy(data + first, spscq->buffer, (n - first) * sizeof(void *));
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+int spscq_init(/*@out@*/ struct spscq *spscq, size_t capacity) {
+    size_t cap = 2;
+
+    while (cap < capacity) {
+        if (cap > SIZE_MAX / 2 / sizeof(void *))
+            return -1;
+        cap <<= 1;
+    }
+    spscq->buffer = malloc(cap * sizeof(void *));
+    if (spscq->buffer == NULL)
+        return -1;
+    spscq->mask = cap - 1;
+    atomic_init(&spscq->head, 0);
+    atomic_init(&spscq->tail, 0);
+    spscq->tail_cache = 0;
+    spscq->head_cache = 0;
+    return 0;
+}
+
+void spscq_destroy(/*@notnull@*/ struct spscq *spscq,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    void *data;
+
+    while (spscq_rem_head(spscq, &data) == 0)
+        if (destroy)
+            destroy(data);
+    free(spscq->buffer);
+    spscq->buffer = NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+size_t spscq_get_capacity(/*@notnull@*/ const struct spscq *spscq) {
+    return spscq->mask + 1;
+}
+
+size_t spscq_get_size(/*@notnull@*/ struct spscq *spscq) {
+    size_t head = load_acquire(&spscq->head);
+    size_t tail = load_acquire(&spscq->tail);
+
+    // head is read first so tail can only be ahead of it, but the producer may
+    // have refilled the ring in between
+    if (tail - head > spscq->mask + 1)
+        return spscq->mask + 1;
+    return tail - head;
+}
+
+int spscq_is_empty(/*@notnull@*/ struct spscq *spscq) {
+    return spscq_get_size(spscq) == 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int spscq_ins_tail(/*@notnull@*/ struct spscq *spscq,
+                   /*@null@*/ void *data) {
+    size_t tail = load_relaxed(&spscq->tail);
+
+    if (tail - spscq->head_cache > spscq->mask) {
+        spscq->head_cache = load_acquire(&spscq->head);
+        if (tail - spscq->head_cache > spscq->mask)
+            return -1;
+    }
+    spscq->buffer[tail & spscq->mask] = data;
+    store_release(&spscq->tail, tail + 1);
+    return 0;
+}
+
+size_t spscq_ins_tail_n(/*@notnull@*/ struct spscq *spscq,
+                        /*@notnull@*/ void *const *data, size_t n) {
+    size_t tail = load_relaxed(&spscq->tail);
+    size_t room = spscq->mask + 1 - (tail - spscq->head_cache);
+
+    if (room < n) {
+        spscq->head_cache = load_acquire(&spscq->head);
+        room = spscq->mask + 1 - (tail - spscq->head_cache);
+        if (room < n)
+            n = room;
+    }
+    if (n == 0)
+        return 0;
+    spscq_copy_in(spscq, tail, data, n);
+    store_release(&spscq->tail, tail + n);
+    return n;
+}
+
+int spscq_rem_head(/*@notnull@*/ struct spscq *spscq,
+                   /*@notnull@*/ /*@out@*/ void **data) {
+    size_t head = load_relaxed(&spscq->head);
+
+    if (head == spscq->tail_cache) {
+        spscq->tail_cache = load_acquire(&spscq->tail);
+        if (head == spscq->tail_cache)
+            return -1;
+    }
+    *data = spscq->buffer[head & spscq->mask];
+    store_release(&spscq->head, head + 1);
+    return 0;
+}
+
+size_t spscq_rem_head_n(/*@notnull@*/ struct spscq *spscq,
+                        /*@notnull@*/ /*@out@*/ void **data, size_t n) {
+    size_t head = load_relaxed(&spscq->head);
+    size_t avail = spscq->tail_cache - head;
+
+    if (avail < n) {
+        spscq->tail_cache = load_acquire(&spscq->tail);
+        avail = spscq->tail_cache - head;
+        if (avail < n)
+            n = avail;
+    }
+    if (n == 0)
+        return 0;
+    spscq_copy_out(spscq, head, data, n);
+    store_release(&spscq->head, head + n);
+    return n;
+}
@@ -0,0 +1,110 @@
+#include "stack.h"
+#include "cdlist.h"
+#include "list.h"
+#include <stdlib.h>
+
+#define STACK_MIN_CAPACITY 16
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void stack_init(/*@out@*/ struct stack *stack) {
+    stack->items = NULL;
+    stack->size = 0;
+    stack->capacity = 0;
+}
+
+void stack_destroy(/*@notnull@*/ struct stack *stack,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    if (destroy != NULL)
+        stack_for_each(stack, item)
+            destroy(*item);
+    free(stack->items);
+    stack_init(stack);
+}
+
+int stack_reserve(/*@notnull@*/ struct stack *stack,
+                  size_t count) {
+    void **items;
+    size_t capacity;
+
+    if (count <= stack->capacity)
+        return 0;
+
+    capacity = stack->capacity ? stack->capacity : STACK_MIN_CAPACITY;
+    while (capacity < count)
+        capacity *= 2;
+
+    items = realloc(stack->items, capacity * sizeof(*items));
+    if (items == NULL)
+        return -1;
+    stack->items = items;
+    stack->capacity = capacity;
+    return 0;
+}
+
+// The list's head goes on top, so the list is copied in from the top down
+int stack_from_list(/*@notnull@*/ struct stack *stack,
+                    /*@notnull@*/ const struct list *list) {
+    size_t top = stack->size + (size_t)list_get_size(list);
+
+    if (stack_reserve(stack, top) != 0)
+        return -1;
+    stack->size = top;
+    list_for_each(list, elem)
+        stack->items[--top] = elem->data;
+    return 0;
+}
+
+int stack_from_cdlist(/*@notnull@*/ struct stack *stack,
+                      /*@notnull@*/ const struct cdlist *cdlist) {
+    size_t top = stack->size + (size_t)cdlist_get_size(cdlist);
+
+    if (stack_reserve(stack, top) != 0)
+        return -1;
+    stack->size = top;
+    cdlist_for_each(cdlist, elem)
+        stack->items[--top] = elem->data;
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+size_t stack_get_size(/*@notnull@*/ const struct stack *stack) {
+    return stack->size;
+}
+
+int stack_is_empty(/*@notnull@*/ const struct stack *stack) {
+    return stack->size == 0;
+}
+
+/*@null@*/
+void* stack_peek(/*@notnull@*/ const struct stack *stack) {
+    return stack->size ? stack->items[stack->size - 1] : NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int stack_push(/*@notnull@*/ struct stack *stack,
+               /*@null@*/ void *data) {
+    if (stack->size == stack->capacity
+        && stack_reserve(stack, stack->size + 1) != 0)
+        return -1;
+    stack->items[stack->size++] = data;
+    return 0;
+}
+
+int stack_pop(/*@notnull@*/ struct stack *stack,
+              /*@null@*/ /*@out@*/ void **data) {
+    if (stack->size == 0)
+        return -1;
+    --stack->size;
+    if (data != NULL)
+        *data = stack->items[stack->size];
+    return 0;
+}
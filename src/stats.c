@@ -0,0 +1,230 @@
+#include "stats.h"
+#include <stdatomic.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+struct stats_op_counters {
+    _Atomic(const char *) name;
+    _Atomic uint64_t walks;
+    _Atomic uint64_t steps;
+    _Atomic uint64_t longest;
+    _Atomic uint64_t hot;
+};
+
+struct stats_counters {
+    _Atomic uint64_t allocs;
+    _Atomic uint64_t frees;
+    _Atomic uint64_t walks;
+    _Atomic uint64_t steps;
+    _Atomic uint64_t hot;
+    _Atomic uint64_t histogram[STATS_BUCKETS];
+    struct stats_op_counters ops[STATS_OPS];
+};
+
+static struct stats_counters stats_counters[STATS_TYPES];
+
+static const char *stats_type_names[STATS_TYPES] = {
+    "list", "dlist", "clist", "cdlist"
+};
+
+#define stats_add(counter, n)                                           \
+    atomic_fetch_add_explicit(&(counter), (n), memory_order_relaxed)
+#define stats_load(counter)                                             \
+    atomic_load_explicit(&(counter), memory_order_relaxed)
+#define stats_clear(counter)                                            \
+    atomic_store_explicit(&(counter), 0, memory_order_relaxed)
+
+// The histogram bucket of a walk: the number of bits in its length
+static int stats_bucket(uint64_t steps) {
+    int bucket = 0;
+
+    for (; steps != 0 && bucket < STATS_BUCKETS - 1; steps >>= 1)
+        ++bucket;
+    return bucket;
+}
+
+// Finds the slot of op, claiming a free one the first time op is seen
+//
+// @return The slot, or NULL if every slot is taken by other operations
+/*@null@*/
+static struct stats_op_counters* stats_op(/*@notnull@*/
+                                          struct stats_counters *counters,
+                                          /*@notnull@*/ const char *op) {
+    struct stats_op_counters *slot;
+    const char *name;
+
+    for (int i = 0; i < STATS_OPS; ++i) {
+        slot = &counters->ops[i];
+        name = atomic_load_explicit(&slot->name, memory_order_acquire);
+        if (name == NULL) {
+            if (atomic_compare_exchange_strong(&slot->name, &name, op))
+                return slot;
+        }
+        if (name == op || strcmp(name, op) == 0)
+            return slot;
+    }
+    return NULL;
+}
+
+// Writes the bounds of a histogram bucket
+static int stats_dump_bucket(/*@notnull@*/ FILE *file, int bucket,
+                             uint64_t count) {
+    uint64_t low = bucket > 0 ? (uint64_t)1 << (bucket - 1) : 0;
+
+    if (bucket <= 1)
+        return fprintf(file, " %llu:%llu", (unsigned long long)low,
+                       (unsigned long long)count);
+    if (bucket == STATS_BUCKETS - 1)
+        return fprintf(file, " %llu+:%llu", (unsigned long long)low,
+                       (unsigned long long)count);
+    return fprintf(file, " %llu-%llu:%llu", (unsigned long long)low,
+                   (unsigned long long)(low * 2 - 1),
+                   (unsigned long long)count);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+void stats_get(enum stats_type type,
+               /*@out@*/ /*@notnull@*/ struct stats *stats) {
+    struct stats_counters *counters = &stats_counters[type];
+    struct stats_op_counters *slot;
+
+    stats->allocs = stats_load(counters->allocs);
+    stats->frees = stats_load(counters->frees);
+    stats->walks = stats_load(counters->walks);
+    stats->steps = stats_load(counters->steps);
+    stats->hot = stats_load(counters->hot);
+    for (int i = 0; i < STATS_BUCKETS; ++i)
+        stats->histogram[i] = stats_load(counters->histogram[i]);
+    for (int i = 0; i < STATS_OPS; ++i) {
+        slot = &counters->ops[i];
+        stats->ops[i].name = atomic_load_explicit(&slot->name,
+                                                  memory_order_acquire);
+        stats->ops[i].walks = stats_load(slot->walks);
+        stats->ops[i].steps = stats_load(slot->steps);
+        stats->ops[i].longest = stats_load(slot->longest);
+        stats->ops[i].hot = stats_load(slot->hot);
+    }
+}
+
+/*@notnull@*/
+const char* stats_type_name(enum stats_type type) {
+    return stats_type_names[type];
+}
+
+int stats_enabled(void) {
+#ifdef STRUCTURES_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+void stats_reset(void) {
+    struct stats_counters *counters;
+
+    for (int type = 0; type < STATS_TYPES; ++type) {
+        counters = &stats_counters[type];
+        stats_clear(counters->allocs);
+        stats_clear(counters->frees);
+        stats_clear(counters->walks);
+        stats_clear(counters->steps);
+        stats_clear(counters->hot);
+        for (int i = 0; i < STATS_BUCKETS; ++i)
+            stats_clear(counters->histogram[i]);
+        for (int i = 0; i < STATS_OPS; ++i) {
+            atomic_store(&counters->ops[i].name, NULL);
+            stats_clear(counters->ops[i].walks);
+            stats_clear(counters->ops[i].steps);
+            stats_clear(counters->ops[i].longest);
+            stats_clear(counters->ops[i].hot);
+        }
+    }
+}
+
+int stats_dump(/*@notnull@*/ FILE *file) {
+    struct stats stats;
+    int ok = 1;
+
+    if (!stats_enabled())
+        ok &= fprintf(file, "stats: not compiled in, build with "
+                      "-DSTRUCTURES_STATS\n") >= 0;
+    for (int type = 0; type < STATS_TYPES; ++type) {
+        stats_get((enum stats_type)type, &stats);
+        if (stats.allocs == 0 && stats.frees == 0 && stats.walks == 0)
+            continue;
+        ok &= fprintf(file, "%s: %llu allocs, %llu frees, %llu walks of "
+                      "%llu steps, %llu hot\n",
+                      stats_type_names[type],
+                      (unsigned long long)stats.allocs,
+                      (unsigned long long)stats.frees,
+                      (unsigned long long)stats.walks,
+                      (unsigned long long)stats.steps,
+                      (unsigned long long)stats.hot) >= 0;
+        if (stats.walks == 0)
+            continue;
+
+        ok &= fprintf(file, "  walk lengths:") >= 0;
+        for (int i = 0; i < STATS_BUCKETS; ++i)
+            if (stats.histogram[i] != 0)
+                ok &= stats_dump_bucket(file, i, stats.histogram[i]) >= 0;
+        ok &= fprintf(file, "\n") >= 0;
+        for (int i = 0; i < STATS_OPS && stats.ops[i].name != NULL; ++i)
+            ok &= fprintf(file, "  %s: %llu walks of %llu steps, longest "
+                          "%llu, %llu hot%s\n",
+                          stats.ops[i].name,
+                          (unsigned long long)stats.ops[i].walks,
+                          (unsigned long long)stats.ops[i].steps,
+                          (unsigned long long)stats.ops[i].longest,
+                          (unsigned long long)stats.ops[i].hot,
+                          stats.ops[i].hot != 0 ? " HOT" : "") >= 0;
+    }
+    return ok ? 0 : -1;
+}
+
+void stats_record_alloc(enum stats_type type, uint64_t n) {
+    stats_add(stats_counters[type].allocs, n);
+}
+
+void stats_record_free(enum stats_type type, uint64_t n) {
+    stats_add(stats_counters[type].frees, n);
+}
+
+void stats_record_walk(enum stats_type type,
+                       /*@notnull@*/ const char *op,
+                       uint64_t steps) {
+    struct stats_counters *counters = &stats_counters[type];
+    struct stats_op_counters *slot;
+    uint64_t longest;
+    int hot = steps >= STRUCTURES_STATS_HOT_STEPS;
+
+    stats_add(counters->walks, 1);
+    stats_add(counters->steps, steps);
+    stats_add(counters->histogram[stats_bucket(steps)], 1);
+    if (hot)
+        stats_add(counters->hot, 1);
+
+    slot = stats_op(counters, op);
+    if (slot == NULL)
+        return;
+    stats_add(slot->walks, 1);
+    stats_add(slot->steps, steps);
+    if (hot)
+        stats_add(slot->hot, 1);
+    longest = stats_load(slot->longest);
+    while (steps > longest
+           && !atomic_compare_exchange_weak_explicit(&slot->longest, &longest,
+                                                     steps,
+                                                     memory_order_relaxed,
+                                                     memory_order_relaxed))
+        ;
+}
@@ -0,0 +1,292 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tsdlist.h"
+#include <sched.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// Locking rules: locks are only ever waited on in list order, so two threads
+// can never each hold a lock the other wants. An element is only unlinked by
+// a thread holding it and both its neighbours, which means no other thread
+// can be holding it or waiting for it, and it can be freed straight away.
+
+/*@null@*/
+static struct tsdlist_elem* tsdlist_elem_new(/*@null@*/ void *data) {
+    struct tsdlist_elem *elem = malloc(sizeof(struct tsdlist_elem));
+
+    if (elem == NULL)
+        return NULL;
+    if (pthread_mutex_init(&elem->lock, NULL) != 0) {
+        free(elem);
+        return NULL;
+    }
+    elem->data = data;
+    return elem;
+}
+
+static void tsdlist_elem_free(/*@notnull@*/ struct tsdlist_elem *elem) {
+    pthread_mutex_destroy(&elem->lock);
+    free(elem);
+}
+
+// Links elem in between prev and next, which must both be locked
+static void tsdlist_link(/*@notnull@*/ struct tsdlist *tsdlist,
+                         /*@notnull@*/ struct tsdlist_elem *prev,
+                         /*@notnull@*/ struct tsdlist_elem *elem,
+                         /*@notnull@*/ struct tsdlist_elem *next) {
+    elem->prev = prev;
+    elem->next = next;
+    prev->next = elem;
+    next->prev = elem;
+    atomic_fetch_add_explicit(&tsdlist->size, 1, memory_order_relaxed);
+}
+
+// Unlinks and frees elem, which must be locked along with both neighbours.
+// prev and next stay locked.
+static void tsdlist_unlink(/*@notnull@*/ struct tsdlist *tsdlist,
+                           /*@notnull@*/ struct tsdlist_elem *prev,
+                           /*@notnull@*/ struct tsdlist_elem *elem,
+                           /*@notnull@*/ struct tsdlist_elem *next) {
+    prev->next = next;
+    next->prev = prev;
+    atomic_fetch_sub_explicit(&tsdlist->size, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&elem->lock);
+    tsdlist_elem_free(elem);
+}
+
+// Locks the tail sentinel and the count elements before it, nearest first.
+// Those are behind the tail in list order so they are only tried; on failure
+// everything is dropped and the attempt starts again. Returns the earliest
+// element locked, or NULL with nothing locked if the head sentinel comes
+// before count elements have been found.
+/*@null@*/
+static struct tsdlist_elem* tsdlist_lock_tail(/*@notnull@*/ struct tsdlist *tsdlist,
+                                              int count) {
+    struct tsdlist_elem *locked[2], *elem;
+    int i, short_list;
+
+    for (;;) {
+        pthread_mutex_lock(&tsdlist->tail.lock);
+        elem = &tsdlist->tail;
+        short_list = 0;
+        for (i = 0; i < count; ++i) {
+            if (elem->prev == &tsdlist->head && i < count - 1) {
+                short_list = 1;
+                break;
+            }
+            if (pthread_mutex_trylock(&elem->prev->lock) != 0)
+                break;
+            elem = locked[i] = elem->prev;
+        }
+        if (i == count)
+            return elem;
+        while (i > 0)
+            pthread_mutex_unlock(&locked[--i]->lock);
+        pthread_mutex_unlock(&tsdlist->tail.lock);
+        if (short_list)
+            return NULL;
+        sched_yield();
+    }
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+int tsdlist_init(struct tsdlist *tsdlist) {
+    if (pthread_mutex_init(&tsdlist->head.lock, NULL) != 0)
+        return -1;
+    if (pthread_mutex_init(&tsdlist->tail.lock, NULL) != 0) {
+        pthread_mutex_destroy(&tsdlist->head.lock);
+        return -1;
+    }
+    tsdlist->head.prev = NULL;
+    tsdlist->head.next = &tsdlist->tail;
+    tsdlist->head.data = NULL;
+    tsdlist->tail.prev = &tsdlist->head;
+    tsdlist->tail.next = NULL;
+    tsdlist->tail.data = NULL;
+    atomic_init(&tsdlist->size, 0);
+    return 0;
+}
+
+void tsdlist_destroy(struct tsdlist *tsdlist, void (*destroy)(void *data)) {
+    struct tsdlist_elem *elem, *next;
+
+    for (elem = tsdlist->head.next; elem != &tsdlist->tail; elem = next) {
+        next = elem->next;
+        if (destroy)
+            destroy(elem->data);
+        tsdlist_elem_free(elem);
+    }
+    tsdlist->head.next = &tsdlist->tail;
+    tsdlist->tail.prev = &tsdlist->head;
+    atomic_store_explicit(&tsdlist->size, 0, memory_order_relaxed);
+    pthread_mutex_destroy(&tsdlist->head.lock);
+    pthread_mutex_destroy(&tsdlist->tail.lock);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+int tsdlist_get_size(struct tsdlist *tsdlist) {
+    return atomic_load_explicit(&tsdlist->size, memory_order_relaxed);
+}
+
+int tsdlist_is_empty(struct tsdlist *tsdlist) {
+    return tsdlist_get_size(tsdlist) == 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int tsdlist_ins_head(struct tsdlist *tsdlist, void *data) {
+    struct tsdlist_elem *elem = tsdlist_elem_new(data), *next;
+
+    if (elem == NULL)
+        return -1;
+    pthread_mutex_lock(&tsdlist->head.lock);
+    next = tsdlist->head.next;
+    pthread_mutex_lock(&next->lock);
+    tsdlist_link(tsdlist, &tsdlist->head, elem, next);
+    pthread_mutex_unlock(&next->lock);
+    pthread_mutex_unlock(&tsdlist->head.lock);
+    return 0;
+}
+
+int tsdlist_ins_sorted(struct tsdlist *tsdlist, void *data,
+                       int (*cmp)(const void *a, const void *b)) {
+    struct tsdlist_elem *elem = tsdlist_elem_new(data), *prev, *cur;
+
+    if (elem == NULL)
+        return -1;
+    prev = &tsdlist->head;
+    pthread_mutex_lock(&prev->lock);
+    cur = prev->next;
+    pthread_mutex_lock(&cur->lock);
+    while (cur != &tsdlist->tail && cmp(cur->data, data) <= 0) {
+        pthread_mutex_unlock(&prev->lock);
+        prev = cur;
+        cur = cur->next;
+        pthread_mutex_lock(&cur->lock);
+    }
+    tsdlist_link(tsdlist, prev, elem, cur);
+    pthread_mutex_unlock(&cur->lock);
+    pthread_mutex_unlock(&prev->lock);
+    return 0;
+}
+
+int tsdlist_ins_tail(struct tsdlist *tsdlist, void *data) {
+    struct tsdlist_elem *elem = tsdlist_elem_new(data), *prev;
+
+    if (elem == NULL)
+        return -1;
+    // The head sentinel always counts, so this cannot fail
+    prev = tsdlist_lock_tail(tsdlist, 1);
+    tsdlist_link(tsdlist, prev, elem, &tsdlist->tail);
+    pthread_mutex_unlock(&prev->lock);
+    pthread_mutex_unlock(&tsdlist->tail.lock);
+    return 0;
+}
+
+int tsdlist_rem_head(struct tsdlist *tsdlist, void **data) {
+    struct tsdlist_elem *elem, *next;
+
+    pthread_mutex_lock(&tsdlist->head.lock);
+    elem = tsdlist->head.next;
+    if (elem == &tsdlist->tail) {
+        pthread_mutex_unlock(&tsdlist->head.lock);
+        return -1;
+    }
+    pthread_mutex_lock(&elem->lock);
+    next = elem->next;
+    pthread_mutex_lock(&next->lock);
+    *data = elem->data;
+    tsdlist_unlink(tsdlist, &tsdlist->head, elem, next);
+    pthread_mutex_unlock(&next->lock);
+    pthread_mutex_unlock(&tsdlist->head.lock);
+    return 0;
+}
+
+int tsdlist_rem_match(struct tsdlist *tsdlist, const void *key,
+                      int (*cmp)(const void *a, const void *b),
+                      void (*destroy)(void *data)) {
+    struct tsdlist_elem *prev, *cur, *next;
+    void *data;
+
+    prev = &tsdlist->head;
+    pthread_mutex_lock(&prev->lock);
+    cur = prev->next;
+    pthread_mutex_lock(&cur->lock);
+    while (cur != &tsdlist->tail) {
+        if (cmp(cur->data, key) == 0) {
+            next = cur->next;
+            pthread_mutex_lock(&next->lock);
+            data = cur->data;
+            tsdlist_unlink(tsdlist, prev, cur, next);
+            pthread_mutex_unlock(&next->lock);
+            pthread_mutex_unlock(&prev->lock);
+            if (destroy)
+                destroy(data);
+            return 0;
+        }
+        pthread_mutex_unlock(&prev->lock);
+        prev = cur;
+        cur = cur->next;
+        pthread_mutex_lock(&cur->lock);
+    }
+    pthread_mutex_unlock(&cur->lock);
+    pthread_mutex_unlock(&prev->lock);
+    return -1;
+}
+
+int tsdlist_rem_tail(struct tsdlist *tsdlist, void **data) {
+    struct tsdlist_elem *prev, *elem;
+
+    prev = tsdlist_lock_tail(tsdlist, 2);
+    if (prev == NULL)
+        return -1;
+    elem = prev->next;
+    *data = elem->data;
+    tsdlist_unlink(tsdlist, prev, elem, &tsdlist->tail);
+    pthread_mutex_unlock(&prev->lock);
+    pthread_mutex_unlock(&tsdlist->tail.lock);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Iteration
+// -----------------------------------------------------------------------------
+
+void tsdlist_for_each(struct tsdlist *tsdlist,
+                      enum tsdlist_visit (*visit)(void *data, void *arg),
+                      void *arg) {
+    struct tsdlist_elem *prev, *cur, *next;
+    enum tsdlist_visit action;
+
+    prev = &tsdlist->head;
+    pthread_mutex_lock(&prev->lock);
+    cur = prev->next;
+    pthread_mutex_lock(&cur->lock);
+    while (cur != &tsdlist->tail) {
+        action = visit(cur->data, arg);
+        if (action == TSDLIST_STOP)
+            break;
+        next = cur->next;
+        pthread_mutex_lock(&next->lock);
+        if (action == TSDLIST_REMOVE)
+            tsdlist_unlink(tsdlist, prev, cur, next);
+        else {
+            pthread_mutex_unlock(&prev->lock);
+            prev = cur;
+        }
+        cur = next;
+    }
+    pthread_mutex_unlock(&cur->lock);
+    pthread_mutex_unlock(&prev->lock);
+}
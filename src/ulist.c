@@ -0,0 +1,275 @@
+#include "ulist.h"
+#include "pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+static struct ulist_node* ulist_node_alloc(/*@notnull@*/ struct ulist *ulist) {
+    struct ulist_node *node;
+
+    if (ulist->pool != NULL)
+        node = pool_alloc(ulist->pool);
+    else
+        node = malloc(sizeof(struct ulist_node));
+    if (node != NULL)
+        node->count = 0;
+    return node;
+}
+
+static void ulist_node_free(/*@notnull@*/ struct ulist *ulist,
+                            /*@notnull@*/ struct ulist_node *node) {
+    if (ulist->pool != NULL)
+        pool_free(ulist->pool, node);
+    else
+        free(node);
+}
+
+// Links node into the ulist after prev, or at the head if prev is NULL
+static void ulist_node_link(/*@notnull@*/ struct ulist *ulist,
+                            /*@null@*/ struct ulist_node *prev,
+                            /*@notnull@*/ struct ulist_node *node) {
+    node->prev = prev;
+    node->next = prev ? prev->next : ulist->head;
+    if (node->next != NULL)
+        node->next->prev = node;
+    else
+        ulist->tail = node;
+    if (prev != NULL)
+        prev->next = node;
+    else
+        ulist->head = node;
+}
+
+static void ulist_node_unlink(/*@notnull@*/ struct ulist *ulist,
+                              /*@notnull@*/ struct ulist_node *node) {
+    if (node->next != NULL)
+        node->next->prev = node->prev;
+    else
+        ulist->tail = node->prev;
+    if (node->prev != NULL)
+        node->prev->next = node->next;
+    else
+        ulist->head = node->next;
+}
+
+// Inserts data at index within node, splitting the node first if it is full
+static int ulist_ins_at(/*@notnull@*/ struct ulist *ulist,
+                        /*@notnull@*/ struct ulist_node *node,
+                        int index,
+                        /*@null@*/ void *data) {
+    struct ulist_node *node_new;
+    int half = ULIST_NODE_ELEMS / 2;
+
+    if (node->count == ULIST_NODE_ELEMS) {
+        node_new = ulist_node_alloc(ulist);
+        if (node_new == NULL)
+            return -1;
+        node_new->count = ULIST_NODE_ELEMS - half;
+        memcpy(node_new->data, node->data + half,
+               sizeof(void *) * node_new->count);
+        node->count = half;
+        ulist_node_link(ulist, node, node_new);
+        if (index > half) {
+            node = node_new;
+            index -= half;
+        }
+    }
+
+    memmove(node->data + index + 1, node->data + index,
+            sizeof(void *) * (node->count - index));
+    node->data[index] = data;
+    node->count++;
+    ulist->size++;
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void ulist_init(/*@out@*/ struct ulist *ulist) {
+    ulist->head = NULL;
+    ulist->tail = NULL;
+    ulist->pool = NULL;
+    ulist->size = 0;
+}
+
+void ulist_init_with_pool(/*@out@*/ struct ulist *ulist,
+                          /*@notnull@*/ struct pool *pool) {
+    ulist_init(ulist);
+    ulist->pool = pool;
+}
+
+void ulist_destroy(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    struct ulist_node *node;
+
+    while ((node = ulist->head) != NULL) {
+        ulist->head = node->next;
+        if (destroy != NULL)
+            for (int i = 0; i < node->count; ++i)
+                destroy(node->data[i]);
+        ulist_node_free(ulist, node);
+    }
+    ulist->tail = NULL;
+    ulist->size = 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+struct ulist_elem ulist_get_head(/*@notnull@*/ const struct ulist *ulist) {
+    struct ulist_elem elem = { ulist->head, 0, NULL };
+
+    if (elem.node != NULL)
+        elem.data = elem.node->data[0];
+    return elem;
+}
+
+struct ulist_elem ulist_get_tail(/*@notnull@*/ const struct ulist *ulist) {
+    struct ulist_elem elem = { ulist->tail, 0, NULL };
+
+    if (elem.node != NULL) {
+        elem.index = elem.node->count - 1;
+        elem.data = elem.node->data[elem.index];
+    }
+    return elem;
+}
+
+int ulist_get_size(/*@notnull@*/ const struct ulist *ulist) {
+    return ulist->size;
+}
+
+int ulist_is_empty(/*@notnull@*/ const struct ulist *ulist) {
+    return ulist->head == NULL;
+}
+
+void ulist_next(/*@notnull@*/ struct ulist_elem *elem) {
+    if (++elem->index >= elem->node->count) {
+        elem->node = elem->node->next;
+        elem->index = 0;
+    }
+    elem->data = elem->node ? elem->node->data[elem->index] : NULL;
+}
+
+void ulist_prev(/*@notnull@*/ struct ulist_elem *elem) {
+    if (--elem->index < 0) {
+        elem->node = elem->node->prev;
+        elem->index = elem->node ? elem->node->count - 1 : 0;
+    }
+    elem->data = elem->node ? elem->node->data[elem->index] : NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int ulist_ins_head(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void *data) {
+    struct ulist_node *node;
+
+    node = ulist->head;
+    if (node == NULL || node->count == ULIST_NODE_ELEMS) {
+        node = ulist_node_alloc(ulist);
+        if (node == NULL)
+            return -1;
+        ulist_node_link(ulist, NULL, node);
+    }
+
+    return ulist_ins_at(ulist, node, 0, data);
+}
+
+int ulist_ins_tail(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void *data) {
+    struct ulist_node *node;
+
+    node = ulist->tail;
+    if (node == NULL || node->count == ULIST_NODE_ELEMS) {
+        node = ulist_node_alloc(ulist);
+        if (node == NULL)
+            return -1;
+        ulist_node_link(ulist, ulist->tail, node);
+    }
+
+    return ulist_ins_at(ulist, node, node->count, data);
+}
+
+int ulist_ins_next(/*@notnull@*/ struct ulist *ulist,
+                   /*@notnull@*/ const struct ulist_elem *elem,
+                   /*@null@*/ void *data) {
+    if (elem->node == NULL)
+        return -1;
+
+    return ulist_ins_at(ulist, elem->node, elem->index + 1, data);
+}
+
+int ulist_ins_prev(/*@notnull@*/ struct ulist *ulist,
+                   /*@notnull@*/ const struct ulist_elem *elem,
+                   /*@null@*/ void *data) {
+    if (elem->node == NULL)
+        return -1;
+
+    return ulist_ins_at(ulist, elem->node, elem->index, data);
+}
+
+int ulist_rem_elem(/*@notnull@*/ struct ulist *ulist,
+                   /*@notnull@*/ struct ulist_elem *elem,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    struct ulist_node *node, *next;
+
+    node = elem->node;
+    if (node == NULL)
+        return -1;
+
+    if (destroy != NULL)
+        destroy(node->data[elem->index]);
+    node->count--;
+    ulist->size--;
+    memmove(node->data + elem->index, node->data + elem->index + 1,
+            sizeof(void *) * (node->count - elem->index));
+
+    next = node->next;
+    if (node->count == 0) {
+        ulist_node_unlink(ulist, node);
+        ulist_node_free(ulist, node);
+        elem->node = next;
+        elem->index = 0;
+    } else if (next != NULL
+               && node->count < ULIST_NODE_ELEMS / 2
+               && node->count + next->count <= ULIST_NODE_ELEMS) {
+        // Keep nodes dense by folding the next node into this one. elem stays
+        // valid as the next node's elements land after this node's.
+        memcpy(node->data + node->count, next->data,
+               sizeof(void *) * next->count);
+        node->count += next->count;
+        ulist_node_unlink(ulist, next);
+        ulist_node_free(ulist, next);
+    } else if (elem->index == node->count) {
+        elem->node = next;
+        elem->index = 0;
+    }
+
+    elem->data = elem->node ? elem->node->data[elem->index] : NULL;
+    return 0;
+}
+
+int ulist_rem_head(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    struct ulist_elem elem;
+
+    elem = ulist_get_head(ulist);
+    return ulist_rem_elem(ulist, &elem, destroy);
+}
+
+int ulist_rem_tail(/*@notnull@*/ struct ulist *ulist,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    struct ulist_elem elem;
+
+    elem = ulist_get_tail(ulist);
+    return ulist_rem_elem(ulist, &elem, destroy);
+}
@@ -0,0 +1,204 @@
+#include "workpool.h"
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+// A range is the whole state of a slice, so a compare-and-swap that succeeds
+// on a value read earlier is always right: the same task numbers are still
+// there to take, whatever happened in between. Only the owner ever refills
+// its range, and only once it is empty, which no thief will touch.
+
+#define range_make(lo, hi) ((uint64_t)(hi) << 32 | (uint32_t)(lo))
+#define range_lo(range) ((uint32_t)(range))
+#define range_hi(range) ((uint32_t)((range) >> 32))
+
+// Takes the first task from worker's own slice
+//
+// @return 1 with the task in index, or 0 if the slice was empty
+static int workpool_take(/*@notnull@*/ struct workpool_worker *worker,
+                         /*@notnull@*/ uint32_t *index) {
+    uint64_t range = atomic_load_explicit(&worker->range,
+                                          memory_order_relaxed);
+
+    do {
+        if (range_lo(range) >= range_hi(range))
+            return 0;
+    } while (!atomic_compare_exchange_weak_explicit(
+                 &worker->range, &range,
+                 range_make(range_lo(range) + 1, range_hi(range)),
+                 memory_order_relaxed, memory_order_relaxed));
+    *index = range_lo(range);
+    return 1;
+}
+
+// Moves the back half of another worker's slice, rounded up, into thief's own
+// empty one, trying each other worker in turn
+//
+// @return 1 if anything was stolen, or 0 if every slice was empty
+static int workpool_steal(/*@notnull@*/ struct workpool *workpool,
+                          /*@notnull@*/ struct workpool_worker *thief) {
+    struct workpool_worker *victim;
+    uint64_t range;
+    uint32_t mid = 0;
+
+    for (int i = 1; i < workpool->threads; ++i) {
+        victim = &workpool->workers[(thief->id + i) % workpool->threads];
+        range = atomic_load_explicit(&victim->range, memory_order_relaxed);
+        do {
+            if (range_lo(range) >= range_hi(range))
+                break;
+            mid = range_lo(range) + (range_hi(range) - range_lo(range)) / 2;
+        } while (!atomic_compare_exchange_weak_explicit(
+                     &victim->range, &range, range_make(range_lo(range), mid),
+                     memory_order_relaxed, memory_order_relaxed));
+        if (range_lo(range) < range_hi(range)) {
+            atomic_store_explicit(&thief->range,
+                                  range_make(mid, range_hi(range)),
+                                  memory_order_relaxed);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void workpool_work(/*@notnull@*/ struct workpool_worker *worker) {
+    struct workpool *workpool = worker->pool;
+    uint32_t index;
+
+    do {
+        while (workpool_take(worker, &index))
+            workpool->task(workpool->arg, index, worker->id);
+    } while (workpool_steal(workpool, worker));
+}
+
+static void* workpool_thread(void *arg) {
+    struct workpool_worker *worker = arg;
+    struct workpool *workpool = worker->pool;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&workpool->lock);
+    for (;;) {
+        while (workpool->run == seen && !workpool->stop)
+            pthread_cond_wait(&workpool->start, &workpool->lock);
+        if (workpool->stop)
+            break;
+        seen = workpool->run;
+        pthread_mutex_unlock(&workpool->lock);
+        workpool_work(worker);
+        pthread_mutex_lock(&workpool->lock);
+        if (--workpool->busy == 0)
+            pthread_cond_signal(&workpool->done);
+    }
+    pthread_mutex_unlock(&workpool->lock);
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+int workpool_init(/*@out@*/ struct workpool *workpool, int threads) {
+    if (threads < 1)
+        threads = 1;
+    workpool->workers = aligned_alloc(WORKPOOL_CACHE_LINE,
+                                      sizeof(struct workpool_worker)
+                                      * (size_t)threads);
+    if (workpool->workers == NULL)
+        return -1;
+    if (pthread_mutex_init(&workpool->lock, NULL) != 0)
+        goto fail_lock;
+    if (pthread_cond_init(&workpool->start, NULL) != 0)
+        goto fail_start;
+    if (pthread_cond_init(&workpool->done, NULL) != 0)
+        goto fail_done;
+
+    workpool->threads = 1;
+    workpool->run = 0;
+    workpool->busy = 0;
+    workpool->stop = 0;
+    workpool->task = NULL;
+    workpool->arg = NULL;
+    for (int i = 0; i < threads; ++i) {
+        atomic_init(&workpool->workers[i].range, 0);
+        workpool->workers[i].pool = workpool;
+        workpool->workers[i].id = i;
+        if (i > 0 && pthread_create(&workpool->workers[i].thread, NULL,
+                                    workpool_thread,
+                                    &workpool->workers[i]) != 0)
+            break;
+        workpool->threads = i + 1;
+    }
+    return 0;
+
+fail_done:
+    pthread_cond_destroy(&workpool->start);
+fail_start:
+    pthread_mutex_destroy(&workpool->lock);
+fail_lock:
+    free(workpool->workers);
+    return -1;
+}
+
+void workpool_destroy(/*@notnull@*/ struct workpool *workpool) {
+    pthread_mutex_lock(&workpool->lock);
+    workpool->stop = 1;
+    pthread_cond_broadcast(&workpool->start);
+    pthread_mutex_unlock(&workpool->lock);
+    for (int i = 1; i < workpool->threads; ++i)
+        pthread_join(workpool->workers[i].thread, NULL);
+    pthread_cond_destroy(&workpool->done);
+    pthread_cond_destroy(&workpool->start);
+    pthread_mutex_destroy(&workpool->lock);
+    free(workpool->workers);
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+int workpool_get_threads(/*@notnull@*/ const struct workpool *workpool) {
+    return workpool->threads;
+}
+
+// -----------------------------------------------------------------------------
+//                                  Running
+// -----------------------------------------------------------------------------
+
+void workpool_run(/*@notnull@*/ struct workpool *workpool, size_t count,
+                  /*@notnull@*/ void (*task)(void *arg, size_t index,
+                                             int worker),
+                  /*@null@*/ void *arg) {
+    size_t threads = (size_t)workpool->threads;
+
+    if (count == 0)
+        return;
+    // Not worth waking anyone for a single task
+    if (threads == 1 || count == 1) {
+        for (size_t i = 0; i < count; ++i)
+            task(arg, i, 0);
+        return;
+    }
+
+    // The slices are published to the threads by the lock
+    pthread_mutex_lock(&workpool->lock);
+    for (size_t i = 0; i < threads; ++i)
+        atomic_store_explicit(&workpool->workers[i].range,
+                              range_make(count * i / threads,
+                                         count * (i + 1) / threads),
+                              memory_order_relaxed);
+    workpool->task = task;
+    workpool->arg = arg;
+    workpool->busy = (int)threads - 1;
+    workpool->run++;
+    pthread_cond_broadcast(&workpool->start);
+    pthread_mutex_unlock(&workpool->lock);
+
+    workpool_work(&workpool->workers[0]);
+
+    pthread_mutex_lock(&workpool->lock);
+    while (workpool->busy > 0)
+        pthread_cond_wait(&workpool->done, &workpool->lock);
+    pthread_mutex_unlock(&workpool->lock);
+}
@@ -0,0 +1,185 @@
+#include "xlist.h"
+#include "pool.h"
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+//                                  Internal
+// -----------------------------------------------------------------------------
+
+#define xlist_xor(a, b) ((uintptr_t)(a) ^ (uintptr_t)(b))
+
+/*@null@*/
+static struct xlist_elem* xlist_elem_alloc(/*@notnull@*/ struct xlist *xlist) {
+    if (xlist->pool != NULL)
+        return pool_alloc(xlist->pool);
+    return malloc(sizeof(struct xlist_elem));
+}
+
+static void xlist_elem_free(/*@notnull@*/ struct xlist *xlist,
+                            /*@notnull@*/ struct xlist_elem *elem) {
+    if (xlist->pool != NULL)
+        pool_free(xlist->pool, elem);
+    else
+        free(elem);
+}
+
+// Links a fresh element holding data between prev and next, which must be
+// adjacent, either of them NULL for the ends of the list
+static int xlist_link(/*@notnull@*/ struct xlist *xlist,
+                      /*@null@*/ struct xlist_elem *prev,
+                      /*@null@*/ struct xlist_elem *next,
+                      /*@null@*/ void *data) {
+    struct xlist_elem *elem;
+
+    elem = xlist_elem_alloc(xlist);
+    if (elem == NULL)
+        return -1;
+    elem->link = xlist_xor(prev, next);
+    elem->data = data;
+    if (prev != NULL)
+        prev->link ^= xlist_xor(next, elem);
+    else
+        xlist->head = elem;
+    if (next != NULL)
+        next->link ^= xlist_xor(prev, elem);
+    else
+        xlist->tail = elem;
+    xlist->size++;
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Management
+// -----------------------------------------------------------------------------
+
+void xlist_init(/*@out@*/ /*@notnull@*/ struct xlist *xlist) {
+    xlist->head = NULL;
+    xlist->tail = NULL;
+    xlist->pool = NULL;
+    xlist->size = 0;
+}
+
+void xlist_init_with_pool(/*@out@*/ /*@notnull@*/ struct xlist *xlist,
+                          /*@notnull@*/ struct pool *pool) {
+    xlist_init(xlist);
+    xlist->pool = pool;
+}
+
+void xlist_destroy(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    struct xlist_elem *elem = xlist->head, *prev = NULL, *next;
+
+    // A pooled xlist is relinked through plain next pointers as it is walked,
+    // the chain pool_free_chain takes, and handed back whole
+    while (elem != NULL) {
+        next = xlist_elem_next(elem, prev);
+        if (destroy != NULL)
+            destroy(elem->data);
+        if (xlist->pool != NULL)
+            elem->link = (uintptr_t)next;
+        else
+            free(elem);
+        prev = elem;
+        elem = next;
+    }
+    if (xlist->pool != NULL && xlist->head != NULL)
+        pool_free_chain(xlist->pool, xlist->head, xlist->tail);
+    xlist->head = NULL;
+    xlist->tail = NULL;
+    xlist->size = 0;
+}
+
+// -----------------------------------------------------------------------------
+//                                 Accessors
+// -----------------------------------------------------------------------------
+
+/*@null@*/
+struct xlist_elem* xlist_get_head(/*@notnull@*/ const struct xlist *xlist) {
+    return xlist->head;
+}
+
+int xlist_get_size(/*@notnull@*/ const struct xlist *xlist) {
+    return xlist->size;
+}
+
+/*@null@*/
+struct xlist_elem* xlist_get_tail(/*@notnull@*/ const struct xlist *xlist) {
+    return xlist->tail;
+}
+
+int xlist_is_empty(/*@notnull@*/ const struct xlist *xlist) {
+    return xlist->head == NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                                Manipulation
+// -----------------------------------------------------------------------------
+
+int xlist_ins_head(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void *data) {
+    return xlist_link(xlist, NULL, xlist->head, data);
+}
+
+int xlist_ins_next(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ struct xlist_elem *prev,
+                   /*@notnull@*/ struct xlist_elem *elem,
+                   /*@null@*/ void *data) {
+    return xlist_link(xlist, elem, xlist_elem_next(elem, prev), data);
+}
+
+int xlist_ins_prev(/*@notnull@*/ struct xlist *xlist,
+                   /*@notnull@*/ struct xlist_elem *elem,
+                   /*@null@*/ struct xlist_elem *next,
+                   /*@null@*/ void *data) {
+    return xlist_link(xlist, xlist_elem_prev(elem, next), elem, data);
+}
+
+int xlist_ins_tail(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void *data) {
+    return xlist_link(xlist, xlist->tail, NULL, data);
+}
+
+int xlist_rem_elem(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ struct xlist_elem *prev,
+                   /*@notnull@*/ struct xlist_elem *elem,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    struct xlist_elem *next = xlist_elem_next(elem, prev);
+
+    // prev and next may be either way round, so the ends are matched against
+    // elem itself. At an end the link is just the one neighbour.
+    if (xlist->head == elem)
+        xlist->head = (struct xlist_elem *)elem->link;
+    if (xlist->tail == elem)
+        xlist->tail = (struct xlist_elem *)elem->link;
+    if (prev != NULL)
+        prev->link ^= xlist_xor(elem, next);
+    if (next != NULL)
+        next->link ^= xlist_xor(elem, prev);
+    xlist->size--;
+
+    if (destroy != NULL)
+        destroy(elem->data);
+    xlist_elem_free(xlist, elem);
+    return 0;
+}
+
+int xlist_rem_head(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    if (xlist->head == NULL)
+        return -1;
+    return xlist_rem_elem(xlist, NULL, xlist->head, destroy);
+}
+
+int xlist_rem_tail(/*@notnull@*/ struct xlist *xlist,
+                   /*@null@*/ void (*destroy)(void *data)) {
+    if (xlist->tail == NULL)
+        return -1;
+    return xlist_rem_elem(xlist, NULL, xlist->tail, destroy);
+}
+
+void xlist_reverse(/*@notnull@*/ struct xlist *xlist) {
+    struct xlist_elem *head = xlist->head;
+
+    xlist->head = xlist->tail;
+    xlist->tail = head;
+}
@@ -1,23 +1,101 @@
+#include "adlist.h"
+#include "bptree.h"
+#include "cdlist.h"
+#include "chasht.h"
+#include "clist.h"
 #include "dlist.h"
+#include "ebr.h"
+#include "hash.h"
+#include "heap.h"
+#include "icdlist.h"
+#include "ilist.h"
 #include "list.h"
+#include "listio.h"
+#include "listpar.h"
+#include "listsort.h"
+#include "mpmcq.h"
+#include "oahasht.h"
+#include "pool.h"
+#include "pqueue.h"
+#include "queue.h"
+#include "skiplist.h"
+#include "spscq.h"
+#include "stack.h"
+#include "stats.h"
+#include "tsdlist.h"
+#include "ulist.h"
+#include "workpool.h"
+#include "xlist.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 // -----------------------------------------------------------------------------
 
+bool test_adlist(void);
+bool test_batch(void);
+bool test_bptree(void);
+bool test_chasht(void);
 bool test_clist(void);
 bool test_dlist(void);
+bool test_ebr(void);
+bool test_heap(void);
+bool test_intrusive(void);
 bool test_list(void);
+bool test_listio(void);
+bool test_mpmcq(void);
+bool test_oahasht(void);
+bool test_parallel(void);
+bool test_pool(void);
+bool test_prefetch(void);
+bool test_skiplist(void);
+bool test_sort(void);
+bool test_spscq(void);
+bool test_stack_queue(void);
+bool test_stats(void);
+bool test_tsdlist(void);
+bool test_splice(void);
+bool test_ulist(void);
+bool test_xlist(void);
 
 // -----------------------------------------------------------------------------
 
 int main(void) {
-    test_list();
-    test_dlist();
-    test_clist();
-    return 0;
+    bool ok = true;
+
+    ok &= test_list();
+    ok &= test_dlist();
+    ok &= test_clist();
+    ok &= test_pool();
+    ok &= test_splice();
+    ok &= test_sort();
+    ok &= test_intrusive();
+    ok &= test_ulist();
+    ok &= test_mpmcq();
+    ok &= test_oahasht();
+    ok &= test_chasht();
+    ok &= test_heap();
+    ok &= test_bptree();
+    ok &= test_skiplist();
+    ok &= test_stack_queue();
+    ok &= test_spscq();
+    ok &= test_tsdlist();
+    ok &= test_ebr();
+    ok &= test_parallel();
+    ok &= test_prefetch();
+    ok &= test_batch();
+    ok &= test_listio();
+    ok &= test_adlist();
+    ok &= test_xlist();
+    ok &= test_stats();
+    return ok ? 0 : 1;
 }
 
 // -----------------------------------------------------------------------------
@@ -27,6 +105,26 @@ bool test_clist(void) {
 }
 
 bool test_dlist(void) {
+    struct dlist l;
+    int values[] = { 1, 2, 3, 4 };
+
+    dlist_init(&l);
+    for (int i = 0; i < 4; ++i)
+        dlist_ins_tail(&l, &values[i]);
+    if (dlist_get_tail(&l)->data != &values[3])
+        return false;
+
+    dlist_rem_tail(&l, NULL);
+    dlist_rem_elem(&l, dlist_get_head(&l)->next, NULL);
+    if (dlist_get_size(&l) != 2 || dlist_get_tail(&l)->data != &values[2])
+        return false;
+
+    dlist_rem_head(&l, NULL);
+    dlist_rem_head(&l, NULL);
+    if (dlist_get_tail(&l) != NULL)
+        return false;
+
+    dlist_destroy(&l, NULL);
     return true;
 }
 
@@ -35,6 +133,7 @@ bool test_list(void) {
     char *string1;
     char *string2;
     char *string3;
+    int values[] = { 1, 2, 3 };
 
     string1 = strdup("Pushed first");
     string2 = strdup("Pushed second");
@@ -55,6 +154,1648 @@ bool test_list(void) {
     
     list_destroy(&l, free);
 
+    // Used as a FIFO, the tail must follow appends and removals
+    list_init(&l);
+    list_ins_tail(&l, &values[0]);
+    list_ins_tail(&l, &values[1]);
+    list_rem_head(&l, NULL);
+    list_rem_head(&l, NULL);
+    if (list_get_tail(&l) != NULL)
+        return false;
+    list_ins_tail(&l, &values[2]);
+    if (list_get_head(&l) != list_get_tail(&l))
+        return false;
+    list_destroy(&l, NULL);
+
+    return true;
+}
+
+
+bool test_pool(void) {
+    struct pool pool;
+    struct cdlist l;
+    void *first;
+    int values[] = { 1, 2, 3, 4, 5 };
+    int sum = 0;
+
+    pool_init(&pool, sizeof(struct cdlist_elem), 2);
+    cdlist_init_with_pool(&l, &pool);
+
+    for (int i = 0; i < 5; ++i)
+        if (cdlist_ins_tail(&l, &values[i]) != 0)
+            return false;
+    cdlist_for_each(&l, elem)
+        sum += *(int *)elem->data;
+
+    // A removed element must be the next one handed out again
+    first = cdlist_get_head(&l);
+    cdlist_rem_head(&l, NULL);
+    cdlist_ins_head(&l, &values[0]);
+    if (cdlist_get_head(&l) != first)
+        return false;
+
+    cdlist_destroy(&l, NULL);
+    pool_destroy(&pool);
+
+    printf("pool: sum %d\n", sum);
+    return sum == 15;
+}
+
+struct item {
+    int value;
+    struct ilist_elem queue;
+    struct icdlist_elem ring;
+};
+
+bool test_intrusive(void) {
+    struct item items[4];
+    struct ilist queue;
+    struct icdlist ring;
+    int sum = 0;
+
+    ilist_init(&queue);
+    icdlist_init(&ring);
+    for (int i = 0; i < 4; ++i) {
+        items[i].value = i + 1;
+        ilist_ins_tail(&queue, &items[i].queue);
+        icdlist_ins_head(&ring, &items[i].ring);
+    }
+
+    // The same objects sit on both lists at once, in opposite orders
+    if (ilist_entry(ilist_get_head(&queue), struct item, queue)
+        != icdlist_entry(icdlist_get_tail(&ring), struct item, ring))
+        return false;
+
+    icdlist_rem_elem(&ring, &items[1].ring);
+    icdlist_for_each(&ring, elem)
+        sum += icdlist_entry(elem, struct item, ring)->value;
+    if (sum != 8 || icdlist_get_size(&ring) != 3)
+        return false;
+
+    if (ilist_rem_tail(&queue) != &items[3].queue
+        || ilist_get_tail(&queue) != &items[2].queue)
+        return false;
+
+    ilist_destroy(&queue, NULL);
+    icdlist_destroy(&ring, NULL);
+    return true;
+}
+
+bool test_splice(void) {
+    int values[6] = { 0, 1, 2, 3, 4, 5 };
+    struct cdlist a, b;
+    struct dlist d, e;
+    struct list l, m;
+    struct pool pool;
+    int expect = 0;
+
+    // Build 0..5 out of pieces, then cut it back apart
+    cdlist_init(&a);
+    cdlist_init(&b);
+    cdlist_ins_tail(&a, &values[2]);
+    cdlist_ins_tail(&a, &values[5]);
+    cdlist_ins_tail(&b, &values[3]);
+    cdlist_ins_tail(&b, &values[4]);
+    cdlist_splice(&a, cdlist_get_head(&a), &b);
+    cdlist_ins_tail(&b, &values[0]);
+    cdlist_ins_tail(&b, &values[1]);
+    cdlist_splice(&a, NULL, &b);
+    if (!cdlist_is_empty(&b) || cdlist_get_size(&a) != 6)
+        return false;
+    cdlist_for_each(&a, elem)
+        if (*(int *)elem->data != expect++)
+            return false;
+
+    cdlist_split_at(&a, cdlist_get_head(&a)->next, &b);
+    if (cdlist_get_size(&a) != 2 || cdlist_get_size(&b) != 4
+        || *(int *)cdlist_get_tail(&a)->data != 1
+        || *(int *)cdlist_get_head(&b)->data != 2)
+        return false;
+    cdlist_concat(&b, &a);
+    if (*(int *)cdlist_get_tail(&b)->data != 1 || !cdlist_is_empty(&a))
+        return false;
+    cdlist_destroy(&b, NULL);
+
+    dlist_init(&d);
+    dlist_init(&e);
+    for (int i = 0; i < 6; ++i)
+        dlist_ins_tail(i < 3 ? &d : &e, &values[i]);
+    dlist_concat(&d, &e);
+    dlist_split_at(&d, dlist_get_head(&d), &e);
+    if (dlist_get_size(&d) != 1 || dlist_get_size(&e) != 5
+        || dlist_get_tail(&d) != dlist_get_head(&d)
+        || *(int *)dlist_get_tail(&e)->data != 5
+        || dlist_get_head(&e)->prev != NULL)
+        return false;
+    dlist_splice(&d, NULL, &e);
+    if (*(int *)dlist_get_tail(&d)->data != 0
+        || dlist_get_tail(&d)->prev->next != dlist_get_tail(&d))
+        return false;
+    dlist_destroy(&d, NULL);
+
+    // Lists on different pools cannot trade elements
+    pool_init(&pool, sizeof(struct list_elem), 0);
+    list_init_with_pool(&l, &pool);
+    list_init(&m);
+    list_ins_tail(&l, &values[0]);
+    list_ins_tail(&m, &values[1]);
+    if (list_concat(&l, &m) != -1 || list_get_size(&l) != 1)
+        return false;
+    list_destroy(&m, NULL);
+    list_init_with_pool(&m, &pool);
+    list_ins_tail(&m, &values[1]);
+    list_concat(&l, &m);
+    list_split_at(&l, NULL, &m);
+    if (!list_is_empty(&l) || list_get_size(&m) != 2
+        || *(int *)list_get_tail(&m)->data != 1)
+        return false;
+    list_destroy(&m, NULL);
+    pool_destroy(&pool);
+    return true;
+}
+
+struct sort_key {
+    int key;
+    int order;
+};
+
+static int sort_key_cmp(const void *a, const void *b) {
+    return ((const struct sort_key *)a)->key - ((const struct sort_key *)b)->key;
+}
+
+// Sorted by key, and equal keys still in insertion order
+static bool sort_key_ordered(const struct sort_key *a,
+                             const struct sort_key *b) {
+    return a->key < b->key || (a->key == b->key && a->order < b->order);
+}
+
+bool test_sort(void) {
+    const int n = LISTSORT_PARALLEL_MIN * 4 + 3;
+    struct sort_key *keys;
+    struct sort_key *prev = NULL;
+    struct cdlist c;
+    struct clist s;
+    struct dlist d;
+    struct list l;
+    int count = 0;
+
+    keys = malloc(n * sizeof(struct sort_key));
+    if (keys == NULL)
+        return false;
+    for (int i = 0; i < n; ++i) {
+        keys[i].key = (i * 7919) % 101;
+        keys[i].order = i;
+    }
+
+    list_init(&l);
+    for (int i = n - 1; i >= 0; --i)
+        list_ins_head(&l, &keys[i]);
+    list_sort_parallel(&l, sort_key_cmp, 4);
+    list_for_each(&l, elem) {
+        if (prev && !sort_key_ordered(prev, elem->data))
+            return false;
+        prev = elem->data;
+        count++;
+    }
+    if (count != n || list_get_tail(&l)->data != prev)
+        return false;
+    list_destroy(&l, NULL);
+
+    dlist_init(&d);
+    for (int i = 0; i < 50; ++i)
+        dlist_ins_head(&d, &keys[i]);
+    dlist_sort(&d, sort_key_cmp);
+    // Inserted at the head, so equal keys come out in reverse order
+    for (struct dlist_elem *elem = dlist_get_tail(&d); elem->prev;
+         elem = elem->prev)
+        if (sort_key_cmp(elem->prev->data, elem->data) > 0
+            || sort_key_ordered(elem->prev->data, elem->data)
+               != (sort_key_cmp(elem->prev->data, elem->data) < 0))
+            return false;
+    dlist_destroy(&d, NULL);
+
+    cdlist_init(&c);
+    clist_init(&s);
+    for (int i = 0; i < 50; ++i) {
+        cdlist_ins_tail(&c, &keys[i]);
+        clist_ins_head(&s, &keys[i]);
+    }
+    cdlist_sort_parallel(&c, sort_key_cmp, 2);
+    clist_sort(&s, sort_key_cmp);
+    prev = NULL;
+    cdlist_for_each_rev(&c, elem) {
+        if (prev && sort_key_cmp(elem->data, prev) > 0)
+            return false;
+        prev = elem->data;
+    }
+    if (cdlist_get_head(&c)->data != prev
+        || clist_get_tail(&s)->data != cdlist_get_tail(&c)->data)
+        return false;
+    cdlist_destroy(&c, NULL);
+    clist_destroy(&s, NULL);
+
+    free(keys);
+    return true;
+}
+
+bool test_ulist(void) {
+    struct ulist l;
+    int values[100];
+    int expect = 0;
+    int i = 0;
+
+    ulist_init(&l);
+    for (i = 0; i < 100; ++i) {
+        values[i] = i;
+        ulist_ins_tail(&l, &values[i]);
+    }
+
+    // Drop every odd element while walking, then check what is left
+    for (struct ulist_elem elem = ulist_get_head(&l); elem.node; ) {
+        if (*(int *)elem.data % 2)
+            ulist_rem_elem(&l, &elem, NULL);
+        else
+            ulist_next(&elem);
+    }
+    ulist_for_each(&l, elem) {
+        if (*(int *)elem->data != expect)
+            return false;
+        expect += 2;
+    }
+    if (expect != 100 || ulist_get_size(&l) != 50)
+        return false;
+
+    ulist_ins_head(&l, &values[1]);
+    ulist_for_each_rev(&l, elem)
+        i = *(int *)elem->data;
+    if (i != 1)
+        return false;
+
+    ulist_destroy(&l, NULL);
+    return true;
+}
+
+#define MPMCQ_TEST_ITEMS 100000
+
+static void* mpmcq_test_producer(void *arg) {
+    struct mpmcq *q = arg;
+
+    for (uintptr_t i = 1; i <= MPMCQ_TEST_ITEMS; ++i)
+        while (mpmcq_ins_tail(q, (void *)i) != 0)
+            sched_yield();
+    return NULL;
+}
+
+static void* mpmcq_test_consumer(void *arg) {
+    struct mpmcq *q = arg;
+    uintptr_t sum = 0;
+    void *data;
+
+    for (int i = 0; i < MPMCQ_TEST_ITEMS; ) {
+        if (mpmcq_rem_head(q, &data) == 0) {
+            sum += (uintptr_t)data;
+            ++i;
+        }
+        else
+            sched_yield();
+    }
+    return (void *)sum;
+}
+
+bool test_mpmcq(void) {
+    struct mpmcq q;
+    pthread_t threads[4];
+    uintptr_t sum = 0;
+    void *data;
+
+    if (mpmcq_init(&q, 3) != 0 || mpmcq_get_capacity(&q) != 4)
+        return false;
+
+    // Single threaded, it behaves like a bounded cdlist used as a FIFO
+    for (uintptr_t i = 0; i < 4; ++i)
+        if (mpmcq_ins_tail(&q, (void *)i) != 0)
+            return false;
+    if (mpmcq_ins_tail(&q, NULL) != -1 || mpmcq_get_size(&q) != 4)
+        return false;
+    for (uintptr_t i = 0; i < 4; ++i)
+        if (mpmcq_rem_head(&q, &data) != 0 || (uintptr_t)data != i)
+            return false;
+    if (mpmcq_rem_head(&q, &data) != -1 || !mpmcq_is_empty(&q))
+        return false;
+    mpmcq_destroy(&q, NULL);
+
+    // Two producers and two consumers through a small ring
+    if (mpmcq_init(&q, 64) != 0)
+        return false;
+    for (int i = 0; i < 4; ++i)
+        pthread_create(&threads[i], NULL,
+                       i % 2 ? mpmcq_test_consumer : mpmcq_test_producer, &q);
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], &data);
+        sum += (uintptr_t)data;
+    }
+    mpmcq_destroy(&q, NULL);
+    return sum == (uintptr_t)MPMCQ_TEST_ITEMS * (MPMCQ_TEST_ITEMS + 1);
+}
+
+bool test_oahasht(void) {
+    const char *words[] = { "alpha", "beta", "gamma", "delta", "epsilon" };
+    struct oahasht h;
+    char copy[8];
+    size_t count = 0;
+
+    oahasht_init(&h, hash_str, hash_str_cmp);
+    for (int i = 0; i < 5; ++i)
+        if (oahasht_ins(&h, (void *)words[i], (void *)words[i]) != 0)
+            return false;
+    if (oahasht_ins(&h, (void *)words[2], NULL) != -1)
+        return false;
+
+    // Keys are compared by value, not by address
+    strcpy(copy, "gamma");
+    if (oahasht_get(&h, copy) != words[2] || oahasht_get(&h, "zeta") != NULL)
+        return false;
+    if (oahasht_rem(&h, copy, NULL) != 0 || oahasht_rem(&h, copy, NULL) != -1)
+        return false;
+    oahasht_destroy(&h, NULL);
+
+    // Enough integer keys to grow several times, with churn in between
+    oahasht_init(&h, hash_ptr, hash_ptr_cmp);
+    if (oahasht_reserve(&h, 100) != 0 || h.capacity < 100)
+        return false;
+    for (uintptr_t i = 1; i <= 10000; ++i)
+        oahasht_ins(&h, (void *)i, (void *)(i * 2));
+    for (uintptr_t i = 1; i <= 10000; i += 2)
+        oahasht_rem(&h, (void *)i, NULL);
+    for (uintptr_t i = 1; i <= 10000; ++i)
+        if ((uintptr_t)oahasht_get(&h, (void *)i) != (i % 2 ? 0 : i * 2))
+            return false;
+    oahasht_for_each(&h, slot)
+        count += (uintptr_t)slot->key % 2 == 0;
+    if (count != 5000 || oahasht_get_size(&h) != 5000)
+        return false;
+    oahasht_destroy(&h, NULL);
+    return oahasht_is_empty(&h);
+}
+
+bool test_chasht(void) {
+    struct chasht h;
+    size_t count = 0;
+
+    chasht_init(&h, hash_ptr, hash_ptr_cmp);
+    for (uintptr_t i = 1; i <= 1100; ++i)
+        if (chasht_ins(&h, (void *)i, (void *)(i + 1)) != 0)
+            return false;
+    if (chasht_ins(&h, (void *)1, NULL) != -1)
+        return false;
+
+    // Growth is spread over later operations, so an old bucket array is still
+    // being emptied here; lookups and iteration must see both
+    if (h.old == NULL)
+        return false;
+    for (uintptr_t i = 1; i <= 1100; ++i)
+        if ((uintptr_t)chasht_get(&h, (void *)i) != i + 1)
+            return false;
+    chasht_for_each(&h, entry)
+        count++;
+    if (count != 1100)
+        return false;
+
+    for (uintptr_t i = 1; i <= 1100; i += 3)
+        chasht_rem(&h, (void *)i, NULL);
+    if (chasht_get(&h, (void *)4) != NULL || chasht_get_size(&h) != 733)
+        return false;
+    chasht_destroy(&h, NULL);
+    return chasht_is_empty(&h);
+}
+
+static int heap_test_cmp(const void *a, const void *b) {
+    return *(const int *)a - *(const int *)b;
+}
+
+bool test_heap(void) {
+    int prio[200];
+    struct heap_elem *elems[200];
+    struct dlist dlist;
+    struct heap heap;
+    struct pqueue pq;
+    int last = -5;
+    int *data;
+
+    // Pop order, with one priority raised and one lowered after insertion
+    pqueue_init(&pq, heap_test_cmp);
+    for (int i = 0; i < 200; ++i) {
+        prio[i] = (i * 37) % 200;
+        if ((elems[i] = pqueue_push(&pq, &prio[i])) == NULL)
+            return false;
+    }
+    prio[150] = -5;
+    pqueue_update(&pq, elems[150]);
+    prio[0] = 500;
+    pqueue_update(&pq, elems[0]);
+    if (pqueue_peek(&pq) != &prio[150]
+        || pqueue_remove(&pq, elems[7]) != &prio[7])
+        return false;
+    while ((data = pqueue_pop(&pq)) != NULL) {
+        if (*data < last)
+            return false;
+        last = *data;
+    }
+    if (last != 500 || !pqueue_is_empty(&pq))
+        return false;
+    pqueue_destroy(&pq, NULL);
+
+    // Bulk heapify on top of existing elements
+    heap_init(&heap, heap_test_cmp);
+    dlist_init(&dlist);
+    for (int i = 0; i < 100; ++i)
+        heap_ins(&heap, &prio[i]);
+    for (int i = 100; i < 200; ++i)
+        dlist_ins_head(&dlist, &prio[i]);
+    if (heap_ins_dlist(&heap, &dlist) != 0 || heap_get_size(&heap) != 200)
+        return false;
+    last = -5;
+    while (!heap_is_empty(&heap)) {
+        data = heap_get_top(&heap)->data;
+        if (*data < last)
+            return false;
+        last = *data;
+        heap_rem_top(&heap, NULL);
+    }
+    dlist_destroy(&dlist, NULL);
+    heap_destroy(&heap, NULL);
+    return heap_rem_top(&heap, NULL) == -1;
+}
+
+static int bptree_test_cmp(const void *a, const void *b) {
+    return ((uintptr_t)a > (uintptr_t)b) - ((uintptr_t)a < (uintptr_t)b);
+}
+
+static int bptree_test_cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+bool test_bptree(void) {
+    struct bptree tree;
+    struct list list;
+    uintptr_t expect, count = 0;
+    size_t size;
+    int *key;
+
+    // Scattered insertions deep enough for several levels of splits
+    bptree_init(&tree, bptree_test_cmp);
+    for (uintptr_t i = 0; i < 5000; ++i)
+        if (bptree_ins(&tree, (void *)((i * 7919) % 5000 * 2), NULL) != 0)
+            return false;
+    if (bptree_ins(&tree, (void *)4, NULL) != -1 || tree.height < 3)
+        return false;
+    expect = 0;
+    bptree_for_each(&tree, cur) {
+        if ((uintptr_t)cur.entry->key != expect)
+            return false;
+        expect += 2;
+    }
+    if (expect != 10000
+        || (uintptr_t)bptree_lower_bound(&tree, (void *)101).entry->key != 102
+        || (uintptr_t)bptree_upper_bound(&tree, (void *)102).entry->key != 104
+        || bptree_upper_bound(&tree, (void *)9998).entry != NULL)
+        return false;
+    bptree_for_each_range(&tree, (void *)1000, (void *)2000, cur)
+        count++;
+    if (count != 500)
+        return false;
+
+    // Remove most keys to force borrowing, merging and root collapse
+    for (uintptr_t i = 0; i < 5000; ++i)
+        if (i % 50 != 0 && bptree_rem(&tree, (void *)(i * 2), NULL) != 0)
+            return false;
+    if (bptree_get_size(&tree) != 100
+        || bptree_rem(&tree, (void *)2, NULL) != -1)
+        return false;
+    expect = 9900;
+    bptree_for_each_rev(&tree, cur) {
+        if ((uintptr_t)cur.entry->key != expect)
+            return false;
+        expect -= 100;
+    }
+    bptree_destroy(&tree, NULL);
+
+    // Bulk load, which must refuse a list out of order
+    list_init(&list);
+    for (uintptr_t i = 3000; i > 0; --i)
+        list_ins_head(&list, (void *)i);
+    if (bptree_load_list(&tree, &list, NULL) != 0
+        || bptree_get(&tree, (void *)1234) != (void *)1234
+        || bptree_find(&tree, (void *)3001).entry != NULL
+        || bptree_ins(&tree, (void *)3001, NULL) != 0)
+        return false;
+    bptree_destroy(&tree, NULL);
+    list_ins_head(&list, (void *)5);
+    if (bptree_load_list(&tree, &list, NULL) != -1 || !bptree_is_empty(&tree))
+        return false;
+    list_destroy(&list, NULL);
+
+    // Keys that live on the heap and are freed with their entries, in strides
+    // that remove many a leaf's first key. No separator may keep naming one.
+    bptree_init(&tree, bptree_test_cmp_int);
+    for (int i = 0; i < 2000; ++i) {
+        key = malloc(sizeof(*key));
+        if (key == NULL)
+            return false;
+        *key = i * 7919 % 2000;
+        if (bptree_ins(&tree, key, key) != 0)
+            return false;
+    }
+    size = 2000;
+    for (int stride = 7; stride > 0; stride -= 3) {
+        for (int i = 0; i < 2000; i += stride)
+            if (bptree_get(&tree, &i) != NULL) {
+                if (bptree_rem(&tree, &i, free) != 0)
+                    return false;
+                --size;
+            }
+        for (int i = 0; i < 2000; ++i)
+            if ((bptree_get(&tree, &i) != NULL)
+                != (i % 7 != 0 && (stride > 4 || i % 4 != 0) && stride > 1))
+                return false;
+        if (bptree_get_size(&tree) != size)
+            return false;
+    }
+    return bptree_is_empty(&tree);
+}
+
+#define SKIPLIST_TEST_KEYS 2000
+
+static atomic_bool skiplist_test_done;
+static atomic_uint skiplist_test_freed;
+
+static int skiplist_test_cmp(const void *a, const void *b) {
+    return ((uintptr_t)a > (uintptr_t)b) - ((uintptr_t)a < (uintptr_t)b);
+}
+
+// Checks that every pass sees the list in order and always finds the odd
+// keys, which are never removed, while even keys come and go
+static void* skiplist_test_reader(void *arg) {
+    struct skiplist *sl = arg;
+    uintptr_t prev, bad = 0;
+    unsigned epoch;
+
+    while (!atomic_load(&skiplist_test_done)) {
+        epoch = skiplist_read_begin(sl);
+        prev = 0;
+        skiplist_for_each(sl, elem) {
+            bad += (uintptr_t)elem->data <= prev;
+            prev = (uintptr_t)elem->data;
+        }
+        for (uintptr_t i = 1; i < SKIPLIST_TEST_KEYS; i += 2)
+            bad += skiplist_find(sl, (void *)i) == NULL;
+        skiplist_read_end(sl, epoch);
+        sched_yield();
+    }
+    return (void *)bad;
+}
+
+static void skiplist_test_free(void *data) {
+    (void)data;
+    atomic_fetch_add(&skiplist_test_freed, 1);
+}
+
+// Starts each read before ending the last, so that from start to finish there
+// is never a moment without a reader inside
+static void* skiplist_test_overlap(void *arg) {
+    struct skiplist *sl = arg;
+    unsigned epoch, last;
+
+    last = skiplist_read_begin(sl);
+    while (!atomic_load(&skiplist_test_done)) {
+        epoch = skiplist_read_begin(sl);
+        skiplist_read_end(sl, last);
+        last = epoch;
+        sched_yield();
+    }
+    skiplist_read_end(sl, last);
+    return NULL;
+}
+
+bool test_skiplist(void) {
+    struct skiplist sl;
+    pthread_t readers[2];
+    uintptr_t expect = SKIPLIST_TEST_KEYS - 1;
+    void *bad;
+    bool ok = true;
+
+    if (skiplist_init(&sl, skiplist_test_cmp) != 0)
+        return false;
+    for (uintptr_t i = SKIPLIST_TEST_KEYS - 1; i > 0; --i)
+        if (skiplist_ins(&sl, (void *)i) != 0)
+            return false;
+    if (skiplist_ins(&sl, (void *)5) != -1
+        || skiplist_lower_bound(&sl, (void *)0)->data != (void *)1)
+        return false;
+    skiplist_for_each_rev(&sl, elem)
+        if ((uintptr_t)elem->data != expect--)
+            return false;
+
+    atomic_store(&skiplist_test_done, false);
+    for (int i = 0; i < 2; ++i)
+        pthread_create(&readers[i], NULL, skiplist_test_reader, &sl);
+    for (int round = 0; round < 20; ++round) {
+        for (uintptr_t i = 2; i < SKIPLIST_TEST_KEYS; i += 2)
+            skiplist_rem(&sl, (void *)i, NULL);
+        for (uintptr_t i = 2; i < SKIPLIST_TEST_KEYS; i += 2)
+            skiplist_ins(&sl, (void *)i);
+        sched_yield();
+    }
+    atomic_store(&skiplist_test_done, true);
+    for (int i = 0; i < 2; ++i) {
+        pthread_join(readers[i], &bad);
+        ok &= bad == NULL;
+    }
+
+    ok &= skiplist_get_size(&sl) == SKIPLIST_TEST_KEYS - 1;
+    ok &= skiplist_rem(&sl, (void *)7, NULL) == 0
+        && skiplist_find(&sl, (void *)7) == NULL;
+
+    // Removed elements are still freed while readers overlap without a break
+    atomic_store(&skiplist_test_done, false);
+    atomic_store(&skiplist_test_freed, 0);
+    for (int i = 0; i < 2; ++i)
+        pthread_create(&readers[i], NULL, skiplist_test_overlap, &sl);
+    for (int round = 0;
+         round < 100 * SKIPLIST_TEST_KEYS
+             && atomic_load(&skiplist_test_freed) < SKIPLIST_TEST_KEYS;
+         ++round) {
+        skiplist_ins(&sl, (void *)SKIPLIST_TEST_KEYS);
+        skiplist_rem(&sl, (void *)SKIPLIST_TEST_KEYS, skiplist_test_free);
+        sched_yield();
+    }
+    ok &= atomic_load(&skiplist_test_freed) >= SKIPLIST_TEST_KEYS;
+    atomic_store(&skiplist_test_done, true);
+    for (int i = 0; i < 2; ++i)
+        pthread_join(readers[i], NULL);
+    skiplist_destroy(&sl, NULL);
+    return ok;
+}
+
+bool test_stack_queue(void) {
+    struct stack stack;
+    struct queue queue;
+    struct cdlist cdlist;
+    struct list list;
+    void *data;
+    uintptr_t expect;
+
+    // Both lists hold 1..50 from head to tail
+    list_init(&list);
+    cdlist_init(&cdlist);
+    for (uintptr_t i = 50; i > 0; --i) {
+        list_ins_head(&list, (void *)i);
+        cdlist_ins_head(&cdlist, (void *)i);
+    }
+
+    // The list's head must come off the stack first, as with list_rem_head
+    stack_init(&stack);
+    if (stack_push(&stack, (void *)99) != 0
+        || stack_from_list(&stack, &list) != 0
+        || stack_from_cdlist(&stack, &cdlist) != 0
+        || stack_get_size(&stack) != 101 || stack_peek(&stack) != (void *)1)
+        return false;
+    for (int pass = 0; pass < 2; ++pass)
+        for (expect = 1; expect <= 50; ++expect)
+            if (stack_pop(&stack, &data) != 0 || data != (void *)expect)
+                return false;
+    if (stack_pop(&stack, &data) != 0 || data != (void *)99
+        || stack_pop(&stack, NULL) != -1)
+        return false;
+    stack_destroy(&stack, NULL);
+
+    // Keep the ring half full while cycling, so it grows while wrapped
+    queue_init(&queue);
+    expect = 1;
+    for (uintptr_t i = 1; i <= 1000; ++i) {
+        if (queue_push(&queue, (void *)i) != 0)
+            return false;
+        if (i % 2 == 0) {
+            if (queue_pop(&queue, &data) != 0 || data != (void *)expect++)
+                return false;
+        }
+    }
+    queue_for_each(&queue, item)
+        if (*item != (void *)expect++)
+            return false;
+    if (expect != 1001 || queue_from_cdlist(&queue, &cdlist) != 0
+        || queue_from_list(&queue, &list) != 0
+        || queue_get_size(&queue) != 600 || queue_peek(&queue) != (void *)501)
+        return false;
+    for (int i = 0; i < 500; ++i)
+        queue_pop(&queue, NULL);
+    for (int pass = 0; pass < 2; ++pass)
+        for (expect = 1; expect <= 50; ++expect)
+            if (queue_pop(&queue, &data) != 0 || data != (void *)expect)
+                return false;
+    if (!queue_is_empty(&queue) || queue_pop(&queue, NULL) != -1)
+        return false;
+    queue_destroy(&queue, NULL);
+    list_destroy(&list, NULL);
+    cdlist_destroy(&cdlist, NULL);
     return true;
 }
 
+#define SPSCQ_TEST_ITEMS 100000
+
+// Alternates batches of one to seven with single inserts
+static void* spscq_test_producer(void *arg) {
+    struct spscq *q = arg;
+    void *batch[7];
+    uintptr_t next = 1;
+    size_t n, done;
+
+    while (next <= SPSCQ_TEST_ITEMS) {
+        n = next % 7 + 1;
+        if (n > SPSCQ_TEST_ITEMS - next + 1)
+            n = SPSCQ_TEST_ITEMS - next + 1;
+        for (size_t i = 0; i < n; ++i)
+            batch[i] = (void *)(next + i);
+        for (done = 0; done < n; )
+            if ((done += spscq_ins_tail_n(q, batch + done, n - done)) < n)
+                sched_yield();
+        next += n;
+        if (next <= SPSCQ_TEST_ITEMS) {
+            while (spscq_ins_tail(q, (void *)next) != 0)
+                sched_yield();
+            ++next;
+        }
+    }
+    return NULL;
+}
+
+bool test_spscq(void) {
+    struct spscq q;
+    pthread_t producer;
+    void *data[16];
+    uintptr_t expect = 1;
+    size_t n;
+
+    if (spscq_init(&q, 5) != 0 || spscq_get_capacity(&q) != 8)
+        return false;
+
+    // Batches stop at the capacity and wrap round the end of the ring
+    for (uintptr_t i = 0; i < 10; ++i)
+        data[i] = (void *)i;
+    if (spscq_ins_tail_n(&q, data, 10) != 8 || spscq_ins_tail(&q, NULL) != -1)
+        return false;
+    if (spscq_rem_head_n(&q, data, 3) != 3 || (uintptr_t)data[2] != 2)
+        return false;
+    for (uintptr_t i = 8; i < 11; ++i)
+        if (spscq_ins_tail(&q, (void *)i) != 0)
+            return false;
+    if (spscq_get_size(&q) != 8 || spscq_rem_head_n(&q, data, 16) != 8)
+        return false;
+    for (uintptr_t i = 0; i < 8; ++i)
+        if ((uintptr_t)data[i] != i + 3)
+            return false;
+    if (spscq_rem_head(&q, data) != -1 || !spscq_is_empty(&q))
+        return false;
+    spscq_destroy(&q, NULL);
+
+    // Across threads every element arrives exactly once and in order
+    if (spscq_init(&q, 16) != 0)
+        return false;
+    pthread_create(&producer, NULL, spscq_test_producer, &q);
+    while (expect <= SPSCQ_TEST_ITEMS) {
+        n = expect % 2 ? spscq_rem_head_n(&q, data, 5)
+                       : (size_t)(spscq_rem_head(&q, data) == 0);
+        if (n == 0)
+            sched_yield();
+        for (size_t i = 0; i < n; ++i)
+            if ((uintptr_t)data[i] != expect++)
+                return false;
+    }
+    pthread_join(producer, NULL);
+    spscq_destroy(&q, NULL);
+    return true;
+}
+
+#define TSDLIST_TEST_ITEMS 20000
+
+static int tsdlist_test_cmp(const void *a, const void *b) {
+    return (uintptr_t)a < (uintptr_t)b ? -1 : (uintptr_t)a > (uintptr_t)b;
+}
+
+// Takes every multiple of three it passes, adding it to arg
+static enum tsdlist_visit tsdlist_test_take(void *data, void *arg) {
+    if ((uintptr_t)data % 3 != 0)
+        return TSDLIST_CONTINUE;
+    atomic_fetch_add((atomic_uintptr_t *)arg, (uintptr_t)data);
+    return TSDLIST_REMOVE;
+}
+
+// Each worker puts the numbers in at either end or in order and takes one
+// back out from either end or by value after each, so that every kind of
+// operation runs against every other while the list stays short
+static void* tsdlist_test_worker(void *arg) {
+    struct tsdlist *l = arg;
+    uintptr_t sum = 0;
+    void *data;
+
+    for (uintptr_t i = 1; i <= TSDLIST_TEST_ITEMS; ++i) {
+        if (i % 3 == 0)
+            tsdlist_ins_sorted(l, (void *)i, tsdlist_test_cmp);
+        else if (i % 2)
+            tsdlist_ins_tail(l, (void *)i);
+        else
+            tsdlist_ins_head(l, (void *)i);
+        if (i % 3 == 0 && tsdlist_rem_head(l, &data) == 0)
+            sum += (uintptr_t)data;
+        else if (i % 3 == 1 && tsdlist_rem_tail(l, &data) == 0)
+            sum += (uintptr_t)data;
+        else if (i % 3 == 2
+                 && tsdlist_rem_match(l, (void *)(i - 1), tsdlist_test_cmp,
+                                      NULL) == 0)
+            sum += i - 1;
+    }
+    return (void *)sum;
+}
+
+bool test_tsdlist(void) {
+    struct tsdlist l;
+    pthread_t threads[3];
+    atomic_uintptr_t taken = 0;
+    uintptr_t sum = 0;
+    void *data;
+
+    if (tsdlist_init(&l) != 0)
+        return false;
+    if (tsdlist_rem_head(&l, &data) != -1 || tsdlist_rem_tail(&l, &data) != -1)
+        return false;
+
+    // On one thread it is a plain deque and sorted list
+    tsdlist_ins_tail(&l, (void *)2);
+    tsdlist_ins_head(&l, (void *)1);
+    tsdlist_ins_sorted(&l, (void *)3, tsdlist_test_cmp);
+    tsdlist_ins_tail(&l, (void *)5);
+    tsdlist_ins_sorted(&l, (void *)4, tsdlist_test_cmp);
+    if (tsdlist_get_size(&l) != 5
+        || tsdlist_rem_match(&l, (void *)6, tsdlist_test_cmp, NULL) != -1
+        || tsdlist_rem_match(&l, (void *)4, tsdlist_test_cmp, NULL) != 0)
+        return false;
+    for (uintptr_t i = 1; i <= 3; ++i)
+        if (tsdlist_rem_head(&l, &data) != 0 || (uintptr_t)data != i)
+            return false;
+    if (tsdlist_rem_tail(&l, &data) != 0 || (uintptr_t)data != 5
+        || !tsdlist_is_empty(&l))
+        return false;
+
+    // A walk taking elements out runs alongside the workers; whatever is
+    // left at the end accounts for the rest of the numbers
+    for (int i = 0; i < 3; ++i)
+        pthread_create(&threads[i], NULL, tsdlist_test_worker, &l);
+    for (int i = 0; i < 20; ++i)
+        tsdlist_for_each(&l, tsdlist_test_take, &taken);
+    for (int i = 0; i < 3; ++i) {
+        pthread_join(threads[i], &data);
+        sum += (uintptr_t)data;
+    }
+    while (tsdlist_rem_head(&l, &data) == 0)
+        sum += (uintptr_t)data;
+    tsdlist_destroy(&l, NULL);
+    return sum + taken
+        == (uintptr_t)3 * TSDLIST_TEST_ITEMS * (TSDLIST_TEST_ITEMS + 1) / 2;
+}
+
+#define EBR_TEST_ITEMS 20000
+#define EBR_TEST_LIVE 0x11u
+
+static atomic_bool ebr_test_done;
+static atomic_int ebr_test_destroyed;
+
+static void ebr_test_count(void *data) {
+    (void)data;
+    atomic_fetch_add(&ebr_test_destroyed, 1);
+}
+
+// Poisons an item before freeing it, so a reader that reaches it too late
+// has a chance of noticing
+static void ebr_test_kill(void *data) {
+    *(unsigned *)data = 0;
+    free(data);
+    atomic_fetch_add(&ebr_test_destroyed, 1);
+}
+
+// Walks the list without a lock while the writer replaces its items,
+// counting any item found dead
+static void* ebr_test_reader(void *arg) {
+    struct cdlist *l = arg;
+    struct ebr_reader reader;
+    uintptr_t bad = 0;
+
+    ebr_reader_register(l->ebr, &reader);
+    while (!atomic_load(&ebr_test_done)) {
+        ebr_read_begin(&reader);
+        cdlist_for_each_ebr(l, elem)
+            bad += *(volatile unsigned *)elem->data != EBR_TEST_LIVE;
+        ebr_read_end(&reader);
+    }
+    ebr_reader_unregister(&reader);
+    return (void *)bad;
+}
+
+bool test_ebr(void) {
+    struct ebr ebr;
+    struct ebr_reader reader;
+    struct pool pool;
+    struct list list;
+    struct dlist dlist;
+    struct clist clist;
+    struct cdlist cdlist;
+    pthread_t readers[2];
+    unsigned *item;
+    void *bad;
+    bool ok = true;
+
+    if (ebr_init(&ebr) != 0)
+        return false;
+    ebr_reader_register(&ebr, &reader);
+
+    // Removals from every list type wait for the open read section
+    pool_init(&pool, sizeof(struct dlist_elem), 0);
+    list_init(&list);
+    dlist_init_with_pool(&dlist, &pool);
+    clist_init(&clist);
+    cdlist_init(&cdlist);
+    list_set_ebr(&list, &ebr);
+    dlist_set_ebr(&dlist, &ebr);
+    clist_set_ebr(&clist, &ebr);
+    cdlist_set_ebr(&cdlist, &ebr);
+    for (uintptr_t i = 1; i <= 2; ++i) {
+        list_ins_tail(&list, (void *)i);
+        dlist_ins_tail(&dlist, (void *)i);
+        clist_ins_tail(&clist, (void *)i);
+        cdlist_ins_tail(&cdlist, (void *)i);
+    }
+    atomic_store(&ebr_test_destroyed, 0);
+    ebr_read_begin(&reader);
+    list_rem_head(&list, ebr_test_count);
+    dlist_rem_head(&dlist, ebr_test_count);
+    clist_rem_head(&clist, ebr_test_count);
+    cdlist_rem_head(&cdlist, ebr_test_count);
+    ok &= atomic_load(&ebr_test_destroyed) == 0;
+    ok &= (uintptr_t)list_get_head(&list)->data == 2
+        && (uintptr_t)cdlist_get_head(&cdlist)->data == 2;
+    ebr_read_end(&reader);
+    ebr_flush(&ebr);
+    ok &= atomic_load(&ebr_test_destroyed) == 4;
+    list_destroy(&list, NULL);
+    dlist_destroy(&dlist, NULL);
+    clist_destroy(&clist, NULL);
+    cdlist_destroy(&cdlist, NULL);
+    pool_destroy(&pool);
+    ebr_reader_unregister(&reader);
+
+    // Readers walk while every item is replaced many times over
+    cdlist_init(&cdlist);
+    cdlist_set_ebr(&cdlist, &ebr);
+    for (int i = 0; i < 64; ++i) {
+        item = malloc(sizeof(unsigned));
+        *item = EBR_TEST_LIVE;
+        cdlist_ins_tail(&cdlist, item);
+    }
+    atomic_store(&ebr_test_done, false);
+    atomic_store(&ebr_test_destroyed, 0);
+    for (int i = 0; i < 2; ++i)
+        pthread_create(&readers[i], NULL, ebr_test_reader, &cdlist);
+    for (int i = 0; i < EBR_TEST_ITEMS; ++i) {
+        item = malloc(sizeof(unsigned));
+        *item = EBR_TEST_LIVE;
+        cdlist_ins_tail(&cdlist, item);
+        cdlist_rem_head(&cdlist, ebr_test_kill);
+        if (i % 1000 == 0)
+            sched_yield();
+    }
+    atomic_store(&ebr_test_done, true);
+    for (int i = 0; i < 2; ++i) {
+        pthread_join(readers[i], &bad);
+        ok &= bad == NULL;
+    }
+    ebr_flush(&ebr);
+    ok &= atomic_load(&ebr_test_destroyed) == EBR_TEST_ITEMS;
+    cdlist_destroy(&cdlist, free);
+    ebr_destroy(&ebr);
+    return ok;
+}
+
+#define PARALLEL_TEST_ITEMS 100000
+
+// Checks that the chunks come back in order: each holds the first and last
+// value folded in, and whether every step so far went up by one
+struct parallel_test_acc {
+    uintptr_t first;
+    uintptr_t last;
+    bool ok;
+};
+
+static void parallel_test_run(void *arg, size_t index, int worker) {
+    atomic_int *hits = arg;
+
+    (void)worker;
+    // Uneven tasks, so that some slices run dry early and steal
+    if (index % 7 == 0)
+        for (volatile int i = 0; i < 1000; ++i);
+    atomic_fetch_add(&hits[index], 1);
+}
+
+static void parallel_test_double(void *data, void *arg) {
+    (void)arg;
+    *(uintptr_t *)data *= 2;
+}
+
+static void parallel_test_fold(void *acc, void *data, void *arg) {
+    struct parallel_test_acc *a = acc;
+    uintptr_t value = *(uintptr_t *)data / 16;
+
+    (void)arg;
+    if (a->first == 0)
+        a->first = value;
+    else
+        a->ok &= value == a->last + 1;
+    a->last = value;
+}
+
+static void parallel_test_combine(void *acc, const void *part, void *arg) {
+    struct parallel_test_acc *a = acc;
+    const struct parallel_test_acc *p = part;
+
+    (void)arg;
+    if (a->first == 0) {
+        *a = *p;
+        return;
+    }
+    a->ok &= p->ok && p->first == a->last + 1;
+    a->last = p->last;
+}
+
+bool test_parallel(void) {
+    static atomic_int hits[PARALLEL_TEST_ITEMS];
+    static uintptr_t values[PARALLEL_TEST_ITEMS];
+    struct workpool workpool;
+    struct list list;
+    struct dlist dlist;
+    struct clist clist;
+    struct cdlist cdlist;
+    struct parallel_test_acc acc;
+    bool ok = true;
+
+    if (workpool_init(&workpool, 4) != 0)
+        return false;
+    workpool_run(&workpool, PARALLEL_TEST_ITEMS, parallel_test_run, hits);
+    for (int i = 0; i < PARALLEL_TEST_ITEMS; ++i)
+        ok &= atomic_load(&hits[i]) == 1;
+
+    // Every type visits every element once, and reduces in order
+    list_init(&list);
+    dlist_init(&dlist);
+    clist_init(&clist);
+    cdlist_init(&cdlist);
+    for (uintptr_t i = 0; i < PARALLEL_TEST_ITEMS; ++i) {
+        values[i] = i + 1;
+        list_ins_tail(&list, &values[i]);
+        dlist_ins_tail(&dlist, &values[i]);
+        clist_ins_tail(&clist, &values[i]);
+        cdlist_ins_tail(&cdlist, &values[i]);
+    }
+    list_for_each_parallel(&list, parallel_test_double, NULL, &workpool);
+    dlist_for_each_parallel(&dlist, parallel_test_double, NULL, &workpool);
+    clist_for_each_parallel(&clist, parallel_test_double, NULL, NULL);
+    cdlist_for_each_parallel(&cdlist, parallel_test_double, NULL, &workpool);
+    for (uintptr_t i = 0; i < PARALLEL_TEST_ITEMS; ++i)
+        ok &= values[i] == (i + 1) * 16;
+
+    acc = (struct parallel_test_acc){ 0, 0, true };
+    list_reduce_parallel(&list, parallel_test_fold, parallel_test_combine,
+                         &acc, sizeof(acc), NULL, &workpool);
+    ok &= acc.ok && acc.first == 1 && acc.last == PARALLEL_TEST_ITEMS;
+    acc = (struct parallel_test_acc){ 0, 0, true };
+    dlist_reduce_parallel(&dlist, parallel_test_fold, parallel_test_combine,
+                          &acc, sizeof(acc), NULL, NULL);
+    ok &= acc.ok && acc.first == 1 && acc.last == PARALLEL_TEST_ITEMS;
+    acc = (struct parallel_test_acc){ 0, 0, true };
+    clist_reduce_parallel(&clist, parallel_test_fold, parallel_test_combine,
+                          &acc, sizeof(acc), NULL, &workpool);
+    ok &= acc.ok && acc.first == 1 && acc.last == PARALLEL_TEST_ITEMS;
+    acc = (struct parallel_test_acc){ 0, 0, true };
+    cdlist_reduce_parallel(&cdlist, parallel_test_fold, parallel_test_combine,
+                           &acc, sizeof(acc), NULL, &workpool);
+    ok &= acc.ok && acc.first == 1 && acc.last == PARALLEL_TEST_ITEMS;
+
+    list_destroy(&list, NULL);
+    dlist_destroy(&dlist, NULL);
+    clist_destroy(&clist, NULL);
+    cdlist_destroy(&cdlist, NULL);
+    workpool_destroy(&workpool);
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
+// Longer than the prefetch distance, so the cursor ahead reaches the end
+// before the loop does
+#define PREFETCH_TEST_ITEMS (STRUCTURES_PREFETCH_DISTANCE * 3 + 1)
+
+bool test_prefetch(void) {
+    int values[PREFETCH_TEST_ITEMS];
+    struct list list;
+    struct dlist dlist;
+    struct clist clist;
+    struct cdlist cdlist;
+    int seen[4] = { 0 };
+    bool ok = true;
+
+    list_init(&list);
+    dlist_init(&dlist);
+    clist_init(&clist);
+    cdlist_init(&cdlist);
+    for (int i = 0; i < PREFETCH_TEST_ITEMS; ++i) {
+        values[i] = i;
+        list_ins_tail(&list, &values[i]);
+        dlist_ins_tail(&dlist, &values[i]);
+        clist_ins_tail(&clist, &values[i]);
+        cdlist_ins_tail(&cdlist, &values[i]);
+    }
+
+    // Every element is visited, in order
+    list_for_each_prefetch(&list, elem)
+        ok &= *(int *)elem->data == seen[0]++;
+    dlist_for_each_prefetch(&dlist, elem)
+        ok &= *(int *)elem->data == seen[1]++;
+    clist_for_each_prefetch(&clist, elem)
+        ok &= *(int *)elem->data == seen[2]++;
+    cdlist_for_each_prefetch(&cdlist, elem)
+        ok &= *(int *)elem->data == seen[3]++;
+    for (int i = 0; i < 4; ++i)
+        ok &= seen[i] == PREFETCH_TEST_ITEMS;
+
+    // The safe versions survive removing the element the body is on
+    dlist_for_each_safe_prefetch(&dlist, elem)
+        if (*(int *)elem->data % 2 == 1)
+            dlist_rem_elem(&dlist, elem, NULL);
+    cdlist_for_each_safe_prefetch(&cdlist, elem)
+        if (*(int *)elem->data % 2 == 1)
+            cdlist_rem_elem(&cdlist, elem, NULL);
+    ok &= dlist_get_size(&dlist) == PREFETCH_TEST_ITEMS / 2 + 1;
+    ok &= cdlist_get_size(&cdlist) == PREFETCH_TEST_ITEMS / 2 + 1;
+    cdlist_for_each_prefetch(&cdlist, elem)
+        ok &= *(int *)elem->data % 2 == 0;
+
+    list_destroy(&list, NULL);
+    dlist_destroy(&dlist, NULL);
+    clist_destroy(&clist, NULL);
+    cdlist_destroy(&cdlist, NULL);
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
+#define BATCH_TEST_ITEMS 100
+
+static int batch_test_destroyed;
+
+static void batch_test_destroy(void *data) {
+    (void)data;
+    ++batch_test_destroyed;
+}
+
+bool test_batch(void) {
+    static int values[BATCH_TEST_ITEMS];
+    void *data[BATCH_TEST_ITEMS], *out[BATCH_TEST_ITEMS];
+    struct pool pool;
+    struct list list;
+    struct dlist dlist;
+    struct clist clist;
+    struct cdlist cdlist;
+    int i;
+    bool ok = true;
+
+    for (i = 0; i < BATCH_TEST_ITEMS; ++i) {
+        values[i] = i;
+        data[i] = &values[i];
+    }
+
+    // Batches land after what is already there, in order. The pool is made
+    // with small chunks so that a batch needs more than one of them.
+    pool_init(&pool, sizeof(struct cdlist_elem), 16);
+    list_init_with_pool(&list, &pool);
+    dlist_init(&dlist);
+    clist_init(&clist);
+    cdlist_init_with_pool(&cdlist, &pool);
+    list_ins_tail(&list, data[0]);
+    dlist_ins_tail(&dlist, data[0]);
+    clist_ins_tail(&clist, data[0]);
+    cdlist_ins_tail(&cdlist, data[0]);
+    ok &= list_ins_tail_n(&list, data + 1, BATCH_TEST_ITEMS - 1) == 0;
+    ok &= dlist_ins_tail_n(&dlist, data + 1, BATCH_TEST_ITEMS - 1) == 0;
+    ok &= clist_ins_tail_n(&clist, data + 1, BATCH_TEST_ITEMS - 1) == 0;
+    ok &= cdlist_ins_tail_n(&cdlist, data + 1, BATCH_TEST_ITEMS - 1) == 0;
+    ok &= list_get_size(&list) == BATCH_TEST_ITEMS;
+    ok &= list_get_tail(&list)->data == data[BATCH_TEST_ITEMS - 1];
+    ok &= dlist_get_tail(&dlist)->data == data[BATCH_TEST_ITEMS - 1];
+    ok &= cdlist_get_tail(&cdlist)->data == data[BATCH_TEST_ITEMS - 1];
+    i = 0;
+    clist_for_each(&clist, elem)
+        ok &= elem->data == data[i++];
+    ok &= i == BATCH_TEST_ITEMS;
+    i = BATCH_TEST_ITEMS;
+    dlist_for_each_elem_rev(dlist_get_tail(&dlist), elem)
+        ok &= elem->data == data[--i];
+    ok &= i == 0;
+    i = BATCH_TEST_ITEMS;
+    cdlist_for_each_rev(&cdlist, elem)
+        ok &= elem->data == data[--i];
+    ok &= i == 0;
+
+    // Draining hands the data out in order and stops when the list runs out
+    ok &= list_rem_head_n(&list, out, 10, NULL) == 10;
+    ok &= dlist_rem_head_n(&dlist, out + 10, 10, NULL) == 10;
+    ok &= clist_rem_head_n(&clist, out + 20, 10, NULL) == 10;
+    ok &= cdlist_rem_head_n(&cdlist, out + 30, 10, NULL) == 10;
+    for (i = 0; i < 40; ++i)
+        ok &= out[i] == data[i % 10];
+    ok &= list_get_head(&list)->data == data[10];
+    ok &= dlist_get_head(&dlist)->prev == NULL;
+    ok &= cdlist_get_head(&cdlist)->prev == &cdlist.link;
+    ok &= clist_get_size(&clist) == BATCH_TEST_ITEMS - 10;
+
+    batch_test_destroyed = 0;
+    ok &= list_rem_head_n(&list, NULL, BATCH_TEST_ITEMS, batch_test_destroy)
+          == BATCH_TEST_ITEMS - 10;
+    ok &= dlist_rem_head_n(&dlist, NULL, BATCH_TEST_ITEMS, batch_test_destroy)
+          == BATCH_TEST_ITEMS - 10;
+    ok &= clist_rem_head_n(&clist, out, BATCH_TEST_ITEMS, batch_test_destroy)
+          == BATCH_TEST_ITEMS - 10;
+    ok &= cdlist_rem_head_n(&cdlist, out, BATCH_TEST_ITEMS, NULL)
+          == BATCH_TEST_ITEMS - 10;
+    ok &= batch_test_destroyed == 3 * (BATCH_TEST_ITEMS - 10);
+    ok &= list_is_empty(&list) && list_get_tail(&list) == NULL;
+    ok &= dlist_is_empty(&dlist) && dlist_get_tail(&dlist) == NULL;
+    ok &= clist_is_empty(&clist) && cdlist_is_empty(&cdlist);
+    ok &= list_rem_head_n(&list, out, 1, NULL) == 0;
+
+    // Elements given back as a chain are reused by the next batch
+    ok &= cdlist_ins_tail_n(&cdlist, data, BATCH_TEST_ITEMS) == 0;
+    ok &= cdlist_get_size(&cdlist) == BATCH_TEST_ITEMS;
+
+    list_destroy(&list, NULL);
+    dlist_destroy(&dlist, NULL);
+    clist_destroy(&clist, NULL);
+    cdlist_destroy(&cdlist, NULL);
+    pool_destroy(&pool);
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
+// Strings are written with their terminating NUL
+static size_t listio_test_encode(const void *data, void *buf, size_t len,
+                                 void *arg) {
+    size_t size = strlen(data) + 1;
+
+    (void)arg;
+    if (size <= len)
+        memcpy(buf, data, size);
+    return size;
+}
+
+// Always wants one byte more than it is given, however much that is
+static size_t listio_test_greedy(const void *data, void *buf, size_t len,
+                                 void *arg) {
+    (void)data;
+    (void)buf;
+    (void)arg;
+    return len + 1;
+}
+
+bool test_listio(void) {
+    // Long enough that the writer's buffer has to grow
+    static char long_word[1000];
+    char *words[] = { "alpha", "be", "", "gamma delta", long_word, "z" };
+    struct listio_codec codec = { listio_test_encode, NULL };
+    struct listio_codec greedy = { listio_test_greedy, NULL };
+    char path[] = "/tmp/structures_listio_XXXXXX";
+    struct listio_view view;
+    struct list list;
+    struct cdlist cdlist;
+    struct clist clist;
+    int fd, i;
+    bool ok = true;
+
+    memset(long_word, 'w', sizeof(long_word) - 1);
+    fd = mkstemp(path);
+    if (fd < 0)
+        return false;
+    close(fd);
+    list_init(&list);
+    cdlist_init(&cdlist);
+    clist_init(&clist);
+    for (i = 0; i < 6; ++i) {
+        list_ins_tail(&list, words[i]);
+        cdlist_ins_tail(&cdlist, words[i]);
+    }
+
+    // A view walks the same data in both directions, whatever wrote it
+    ok &= cdlist_write(&cdlist, path, &codec) == 0;
+    ok &= listio_map(&view, path) == 0;
+    ok &= listio_view_check(&view) == 0;
+    ok &= listio_view_get_kind(&view) == LISTIO_CDLIST;
+    ok &= listio_view_get_size(&view) == 6;
+    i = 0;
+    listio_view_for_each(&view, rec) {
+        ok &= (uintptr_t)listio_record_data(rec) % 8 == 0;
+        ok &= listio_record_size(rec) == strlen(words[i]) + 1;
+        ok &= strcmp(listio_record_data(rec), words[i++]) == 0;
+    }
+    ok &= i == 6;
+    listio_view_for_each_rev(&view, rec)
+        ok &= strcmp(listio_record_data(rec), words[--i]) == 0;
+    ok &= i == 0;
+    listio_unmap(&view);
+
+    ok &= list_write(&list, path, &codec) == 0;
+    ok &= listio_map(&view, path) == 0;
+    ok &= listio_view_get_kind(&view) == LISTIO_LIST;
+    ok &= strcmp(listio_record_data(listio_view_get_tail(&view)), "z") == 0;
+    listio_unmap(&view);
+
+    // An empty list still makes a file that maps
+    ok &= clist_write(&clist, path, &codec) == 0;
+    ok &= listio_map(&view, path) == 0;
+    ok &= listio_view_check(&view) == 0;
+    ok &= listio_view_get_size(&view) == 0;
+    ok &= listio_view_get_head(&view) == NULL;
+    listio_unmap(&view);
+
+    // A failed write, here a codec that never fits, leaves the old file be
+    ok &= list_write(&list, path, &greedy) != 0;
+    ok &= listio_map(&view, path) == 0;
+    ok &= listio_view_get_kind(&view) == LISTIO_CLIST;
+    ok &= listio_view_get_size(&view) == 0;
+    listio_unmap(&view);
+
+    // Anything else is turned away
+    fd = open(path, O_WRONLY | O_TRUNC);
+    ok &= fd >= 0 && write(fd, long_word, 100) == 100;
+    close(fd);
+    ok &= listio_map(&view, path) != 0;
+
+    remove(path);
+    list_destroy(&list, NULL);
+    cdlist_destroy(&cdlist, NULL);
+    clist_destroy(&clist, NULL);
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
+// Orders by value alone, so that equal values show whether the sort is stable
+static int adlist_test_cmp(const void *a, const void *b) {
+    return *(const int *)a / 10 - *(const int *)b / 10;
+}
+
+bool test_adlist(void) {
+    int values[] = { 31, 10, 20, 11, 30, 21 };
+    int sorted[] = { 10, 11, 20, 21, 31, 30 };
+    void *data[] = { &values[0], &values[1], &values[2] };
+    struct adlist l, other;
+    uint32_t head, removed, capacity;
+    void *out[6];
+    int i;
+    bool ok = true;
+
+    adlist_init(&l);
+    ok &= adlist_get_head(&l) == ADLIST_NIL && adlist_is_empty(&l);
+    ok &= adlist_rem_head(&l, NULL) == -1;
+
+    // Built from both ends and the middle: 31 10 20 11 30 21
+    ok &= adlist_ins_tail(&l, &values[2]) == 0;
+    ok &= adlist_ins_head(&l, &values[0]) == 0;
+    ok &= adlist_ins_next(&l, adlist_get_head(&l), &values[1]) == 0;
+    ok &= adlist_ins_tail(&l, &values[5]) == 0;
+    ok &= adlist_ins_prev(&l, adlist_get_tail(&l), &values[4]) == 0;
+    ok &= adlist_ins_prev(&l, adlist_at(&l, adlist_get_tail(&l))->prev,
+                          &values[3]) == 0;
+    ok &= adlist_get_size(&l) == 6;
+    i = 0;
+    adlist_for_each(&l, elem)
+        ok &= elem->data == &values[i++];
+    adlist_for_each_rev(&l, elem)
+        ok &= elem->data == &values[--i];
+
+    // Removed elements are reused before the array grows
+    head = adlist_get_head(&l);
+    adlist_rem_head(&l, NULL);
+    adlist_ins_head(&l, &values[0]);
+    ok &= adlist_get_head(&l) == head && l.used == 6;
+
+    // Sorting relinks without moving, and keeps equal elements in order
+    removed = adlist_get_tail(&l);
+    ok &= adlist_sort(&l, adlist_test_cmp) == 0;
+    i = 0;
+    adlist_for_each(&l, elem)
+        ok &= *(int *)elem->data == sorted[i++];
+    ok &= adlist_at(&l, removed)->data == &values[5];
+
+    // The safe loop survives removal, and compacting keeps the order
+    adlist_for_each_safe(&l, elem)
+        if (*(int *)elem->data % 2 == 1)
+            adlist_rem_elem(&l, adlist_index(&l, elem), NULL);
+    ok &= adlist_get_size(&l) == 3;
+    ok &= adlist_compact(&l) == 0;
+    ok &= l.capacity == 3 && adlist_get_head(&l) == 0;
+    i = 0;
+    adlist_for_each(&l, elem)
+        ok &= *(int *)elem->data == (i++ + 1) * 10;
+
+    // Batches, and moving every element of one list onto another
+    adlist_init(&other);
+    ok &= adlist_ins_tail_n(&other, data, 3) == 0;
+    ok &= adlist_concat(&l, &other) == 0;
+    ok &= adlist_is_empty(&other) && adlist_get_size(&l) == 6;
+    ok &= adlist_at(&l, adlist_get_tail(&l))->data == &values[2];
+    ok &= adlist_rem_head_n(&l, out, 10, NULL) == 6;
+    ok &= out[0] == &values[1] && out[5] == &values[2];
+    ok &= adlist_get_tail(&l) == ADLIST_NIL;
+
+    // A batch that fits in the free list reuses it rather than growing
+    capacity = l.capacity;
+    ok &= adlist_ins_tail_n(&l, data, 3) == 0;
+    ok &= adlist_ins_tail_n(&l, data, 3) == 0;
+    ok &= l.capacity == capacity && adlist_get_size(&l) == 6;
+
+    adlist_destroy(&l, NULL);
+    adlist_destroy(&other, NULL);
+    return ok;
+}
+
+bool test_xlist(void) {
+    int values[] = { 0, 1, 2, 3, 4, 5 };
+    struct xlist_elem *head, *second, *third;
+    struct xlist l;
+    struct pool pool;
+    int i;
+    bool ok = true;
+
+    xlist_init(&l);
+    ok &= xlist_get_head(&l) == NULL && xlist_is_empty(&l);
+    ok &= xlist_rem_tail(&l, NULL) == -1;
+
+    // Built from both ends and the middle: 0 1 2 3 4 5
+    ok &= xlist_ins_tail(&l, &values[2]) == 0;
+    ok &= xlist_ins_head(&l, &values[0]) == 0;
+    ok &= xlist_ins_next(&l, NULL, xlist_get_head(&l), &values[1]) == 0;
+    ok &= xlist_ins_tail(&l, &values[5]) == 0;
+    ok &= xlist_ins_prev(&l, xlist_get_tail(&l), NULL, &values[4]) == 0;
+    head = xlist_get_head(&l);
+    second = xlist_elem_next(head, NULL);
+    ok &= xlist_ins_next(&l, second, xlist_elem_next(second, head),
+                         &values[3]) == 0;
+    ok &= xlist_get_size(&l) == 6;
+    i = 0;
+    xlist_for_each(&l, elem)
+        ok &= elem->data == &values[i++];
+    xlist_for_each_rev(&l, elem)
+        ok &= elem->data == &values[--i];
+    ok &= i == 0;
+
+    // Walking back from the middle, and forward after reversing
+    i = 1;
+    xlist_for_each_elem_rev(second, xlist_elem_next(second, head), elem)
+        ok &= elem->data == &values[i--];
+    ok &= i == -1;
+    xlist_reverse(&l);
+    i = 6;
+    xlist_for_each(&l, elem)
+        ok &= elem->data == &values[--i];
+    xlist_reverse(&l);
+
+    // Either neighbour identifies the element to remove: 0 2 4
+    ok &= xlist_rem_elem(&l, head, second, NULL) == 0;
+    second = xlist_elem_next(head, NULL);
+    third = xlist_elem_next(second, head);
+    ok &= xlist_rem_elem(&l, xlist_elem_next(third, second), third,
+                         NULL) == 0;
+    ok &= xlist_rem_tail(&l, NULL) == 0;
+    i = 0;
+    xlist_for_each(&l, elem) {
+        ok &= elem->data == &values[i];
+        i += 2;
+    }
+    ok &= i == 6 && xlist_get_size(&l) == 3;
+    ok &= *(int *)xlist_get_tail(&l)->data == 4;
+    ok &= xlist_rem_head(&l, NULL) == 0 && xlist_rem_head(&l, NULL) == 0;
+    ok &= xlist_rem_head(&l, NULL) == 0 && xlist_is_empty(&l);
+    ok &= xlist_get_tail(&l) == NULL;
+    xlist_destroy(&l, NULL);
+
+    // Pooled elements go back to the pool on destroy and are reused
+    pool_init(&pool, sizeof(struct xlist_elem), 0);
+    xlist_init_with_pool(&l, &pool);
+    for (i = 0; i < 6; ++i)
+        ok &= xlist_ins_tail(&l, &values[i]) == 0;
+    xlist_destroy(&l, NULL);
+    ok &= xlist_is_empty(&l);
+    for (i = 0; i < 6; ++i)
+        ok &= xlist_ins_head(&l, &values[i]) == 0;
+    i = 6;
+    xlist_for_each(&l, elem)
+        ok &= elem->data == &values[--i];
+    xlist_destroy(&l, NULL);
+    pool_destroy(&pool);
+    return ok;
+}
+
+// Returns the tally of the operation called name, or NULL if it never walked
+static const struct stats_op* stats_test_op(const struct stats *stats,
+                                            const char *name) {
+    for (int i = 0; i < STATS_OPS && stats->ops[i].name != NULL; ++i)
+        if (strcmp(stats->ops[i].name, name) == 0)
+            return &stats->ops[i];
+    return NULL;
+}
+
+bool test_stats(void) {
+    int values[] = { 1, 2, 3 };
+    const struct stats_op *op;
+    struct stats stats;
+    struct pool pool;
+    struct list l;
+    struct clist c;
+    struct cdlist cd;
+    FILE *file;
+    bool ok = true;
+
+    stats_reset();
+    pool_init(&pool, sizeof(struct cdlist_elem), 0);
+    list_init(&l);
+    clist_init(&c);
+    cdlist_init_with_pool(&cd, &pool);
+    for (int i = 0; i < 3; ++i) {
+        list_ins_tail(&l, &values[i]);
+        clist_ins_head(&c, &values[i]);
+        cdlist_ins_tail(&cd, &values[i]);
+    }
+    list_rem_tail(&l, NULL);
+    ok &= clist_get_tail(&c)->data == &values[0];
+    list_destroy(&l, NULL);
+    clist_destroy(&c, NULL);
+    cdlist_destroy(&cd, NULL);
+    pool_destroy(&pool);
+
+    // The hooks count only when the library is built with STRUCTURES_STATS.
+    // Destroying never walks just to count, whichever caches are compiled in;
+    // without the tail cache list_ins_tail walks too.
+    stats_get(STATS_LIST, &stats);
+    if (stats_enabled()) {
+        ok &= stats.allocs == 3 && stats.frees == 3;
+        op = stats_test_op(&stats, "list_rem_tail");
+        ok &= op != NULL && op->walks == 1 && op->steps == 1;
+        ok &= stats_test_op(&stats, "list_get_size") == NULL;
+#ifndef STRUCTURES_NO_TAIL_CACHE
+        ok &= stats.walks == 1 && stats.steps == 1 && stats.histogram[1] == 1;
+        ok &= stats.ops[0].name == op->name && stats.ops[1].name == NULL;
+#else
+        op = stats_test_op(&stats, "list_get_tail");
+        ok &= op != NULL && op->walks == 2 && stats.walks == 3;
+#endif
+        stats_get(STATS_CLIST, &stats);
+        ok &= stats.frees == 3;
+        op = stats_test_op(&stats, "clist_get_tail");
+        ok &= op != NULL && op->longest == 2;
+        ok &= stats_test_op(&stats, "clist_get_size") == NULL;
+        stats_get(STATS_CDLIST, &stats);
+        ok &= stats.allocs == 3 && stats.frees == 3 && stats.walks == 0;
+    } else {
+        ok &= stats.allocs == 0 && stats.walks == 0;
+    }
+
+    // Long walks land in the top buckets and are counted as hot
+    stats_reset();
+    stats_record_walk(STATS_DLIST, "walk", 0);
+    stats_record_walk(STATS_DLIST, "walk", 5000);
+    stats_record_walk(STATS_DLIST, "other", UINT64_MAX);
+    stats_get(STATS_DLIST, &stats);
+    ok &= stats.walks == 3 && stats.hot == 2;
+    ok &= stats.histogram[0] == 1 && stats.histogram[13] == 1;
+    ok &= stats.histogram[STATS_BUCKETS - 1] == 1;
+    ok &= strcmp(stats.ops[0].name, "walk") == 0 && stats.ops[0].walks == 2;
+    ok &= stats.ops[0].longest == 5000 && stats.ops[0].hot == 1;
+    ok &= strcmp(stats.ops[1].name, "other") == 0 && stats.ops[2].name == NULL;
+
+    file = tmpfile();
+    ok &= file != NULL && stats_dump(file) == 0;
+    if (file != NULL)
+        fclose(file);
+    stats_reset();
+    stats_get(STATS_DLIST, &stats);
+    ok &= stats.walks == 0 && stats.ops[0].name == NULL;
+    return ok;
+}